@@ -29,6 +29,8 @@
 
 #include "base/hash.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <limits>
 
@@ -79,28 +81,20 @@ void Mix(T &a, T &b, T &c) {
   c ^= (b >> 15);
 }
 
-}  // namespace
-
-uint32_t Fingerprint32(absl::string_view str) {
-  return Fingerprint32WithSeed(str, kFingerPrint32Seed);
+// Adds the first 12 bytes of |str| to the state.
+inline void AddBlock(absl::string_view str, uint32_t &a, uint32_t &b,
+                     uint32_t &c) {
+  a += ToUint32(str[0], str[1], str[2], str[3]);
+  b += ToUint32(str[4], str[5], str[6], str[7]);
+  c += ToUint32(str[8], str[9], str[10], str[11]);
+  Mix(a, b, c);
 }
 
-uint32_t Fingerprint32WithSeed(absl::string_view str, uint32_t seed) {
-  DCHECK_LE(str.size(), std::numeric_limits<uint32_t>::max());
-  const uint32_t str_len = static_cast<uint32_t>(str.size());
-  uint32_t a = 0x9e3779b9;
-  uint32_t b = a;
-  uint32_t c = seed;
-
-  while (str.size() >= 12) {
-    a += ToUint32(str[0], str[1], str[2], str[3]);
-    b += ToUint32(str[4], str[5], str[6], str[7]);
-    c += ToUint32(str[8], str[9], str[10], str[11]);
-    Mix(a, b, c);
-    str.remove_prefix(12);
-  }
-
-  c += str_len;
+// Adds the last |str| shorter than 12 bytes and the total length to the
+// state, and returns the fingerprint.
+inline uint32_t AddTail(absl::string_view str, uint32_t total_len, uint32_t a,
+                        uint32_t b, uint32_t c) {
+  c += total_len;
   switch (str.size()) {
     case 11:
       c += uint32_t{str[10]} << 24;
@@ -137,10 +131,29 @@ uint32_t Fingerprint32WithSeed(absl::string_view str, uint32_t seed) {
       break;
   }
   Mix(a, b, c);
-
   return c;
 }
 
+}  // namespace
+
+uint32_t Fingerprint32(absl::string_view str) {
+  return Fingerprint32WithSeed(str, kFingerPrint32Seed);
+}
+
+uint32_t Fingerprint32WithSeed(absl::string_view str, uint32_t seed) {
+  DCHECK_LE(str.size(), std::numeric_limits<uint32_t>::max());
+  const uint32_t str_len = static_cast<uint32_t>(str.size());
+  uint32_t a = 0x9e3779b9;
+  uint32_t b = a;
+  uint32_t c = seed;
+
+  while (str.size() >= 12) {
+    AddBlock(str, a, b, c);
+    str.remove_prefix(12);
+  }
+  return AddTail(str, str_len, a, b, c);
+}
+
 uint64_t Fingerprint(absl::string_view str) {
   return FingerprintWithSeed(str, kFingerPrintSeed0);
 }
@@ -155,4 +168,46 @@ uint64_t FingerprintWithSeed(absl::string_view str, uint32_t seed) {
   return result;
 }
 
+FingerprintBuilder::FingerprintBuilder()
+    : hi_{0x9e3779b9, 0x9e3779b9, kFingerPrintSeed0},
+      lo_{0x9e3779b9, 0x9e3779b9, kFingerPrintSeed1} {}
+
+void FingerprintBuilder::Append(absl::string_view str) {
+  DCHECK_LE(str.size(), std::numeric_limits<uint32_t>::max() - size_);
+  size_ += static_cast<uint32_t>(str.size());
+  auto add_block = [this](absl::string_view block) {
+    AddBlock(block, hi_.a, hi_.b, hi_.c);
+    AddBlock(block, lo_.a, lo_.b, lo_.c);
+  };
+  if (buf_size_ > 0) {
+    const size_t len = std::min<size_t>(str.size(), sizeof(buf_) - buf_size_);
+    std::copy_n(str.data(), len, buf_ + buf_size_);
+    buf_size_ += len;
+    str.remove_prefix(len);
+    if (buf_size_ < sizeof(buf_)) {
+      return;
+    }
+    add_block(absl::string_view(buf_, sizeof(buf_)));
+    buf_size_ = 0;
+  }
+  while (str.size() >= sizeof(buf_)) {
+    add_block(str);
+    str.remove_prefix(sizeof(buf_));
+  }
+  std::copy(str.begin(), str.end(), buf_);
+  buf_size_ = str.size();
+}
+
+uint64_t FingerprintBuilder::Build() const {
+  const absl::string_view tail(buf_, buf_size_);
+  const uint32_t hi = AddTail(tail, size_, hi_.a, hi_.b, hi_.c);
+  const uint32_t lo = AddTail(tail, size_, lo_.a, lo_.b, lo_.c);
+  // Same as FingerprintWithSeed().
+  uint64_t result = static_cast<uint64_t>(hi) << 32 | static_cast<uint64_t>(lo);
+  if ((hi == 0) && (lo < 2)) {
+    result ^= 0x130f9bef94a0a928uLL;
+  }
+  return result;
+}
+
 }  // namespace mozc
@@ -46,6 +46,45 @@ uint64_t FingerprintWithSeed(absl::string_view str, uint32_t seed);
 uint32_t Fingerprint32(absl::string_view str);
 uint32_t Fingerprint32WithSeed(absl::string_view str, uint32_t seed);
 
+// Calculates Fingerprint() of the concatenation of the appended strings
+// without building the concatenated string. The builder is copyable, so the
+// state after a common prefix can be reused for different suffixes:
+//
+//   FingerprintBuilder prefix;
+//   prefix.Append(left);
+//   for (absl::string_view right : rights) {
+//     FingerprintBuilder builder = prefix;
+//     builder.Append(right);
+//     // builder.Build() == Fingerprint(absl::StrCat(left, right))
+//   }
+class FingerprintBuilder {
+ public:
+  FingerprintBuilder();
+
+  void Append(absl::string_view str);
+
+  // Returns the fingerprint of the appended strings.
+  uint64_t Build() const;
+
+  // Returns the total size of the appended strings.
+  size_t size() const { return size_; }
+
+ private:
+  struct State {
+    uint32_t a;
+    uint32_t b;
+    uint32_t c;
+  };
+
+  // States for the upper and lower 32 bits.
+  State hi_;
+  State lo_;
+  // Bytes not yet added to the states, which are less than a 12-byte block.
+  char buf_[12];
+  size_t buf_size_ = 0;
+  uint32_t size_ = 0;
+};
+
 template <class T,
           std::enable_if_t<std::is_integral_v<T>, std::nullptr_t> = nullptr>
 uint64_t Fingerprint(T num) {
@@ -29,9 +29,11 @@
 
 #include "base/hash.h"
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
+#include "absl/strings/string_view.h"
 #include "testing/gunit.h"
 
 namespace mozc {
@@ -97,5 +99,25 @@ TEST(HashTest, Fingerprint32WithSeed_IntegralTypes) {
   }
 }
 
+TEST(HashTest, FingerprintBuilder) {
+  EXPECT_EQ(FingerprintBuilder().Build(), Fingerprint(""));
+
+  // Split the string at every position, including the ones in the middle of
+  // 12-byte blocks.
+  const std::string s =
+      "Hello, world!  Hello, Tokyo!  Good afternoon!  Ladies and gentlemen.";
+  for (size_t i = 0; i <= s.size(); ++i) {
+    FingerprintBuilder prefix;
+    prefix.Append(absl::string_view(s).substr(0, i));
+    for (size_t j = i; j <= s.size(); ++j) {
+      FingerprintBuilder builder = prefix;
+      builder.Append(absl::string_view(s).substr(i, j - i));
+      builder.Append(absl::string_view(s).substr(j));
+      EXPECT_EQ(builder.size(), s.size());
+      EXPECT_EQ(builder.Build(), Fingerprint(s)) << i << ", " << j;
+    }
+  }
+}
+
 }  // namespace
 }  // namespace mozc
@@ -30,6 +30,7 @@
 #include "base/mmap.h"
 
 #include <cstddef>
+#include <cstdint>
 #include <optional>
 #include <utility>
 
@@ -389,4 +390,66 @@ int Mmap::MaybeMUnlock(const void *addr, size_t len) { return -1; }
 
 #undef MOZC_HAVE_MLOCK
 
+namespace {
+
+// Returns the page aligned region that covers [addr, addr + len).
+std::pair<char *, size_t> AlignToPages(const void *addr, size_t len,
+                                       size_t page_size) {
+  const uintptr_t begin = reinterpret_cast<uintptr_t>(addr);
+  const uintptr_t aligned_begin = begin - begin % page_size;
+  return {reinterpret_cast<char *>(aligned_begin),
+          len + (begin - aligned_begin)};
+}
+
+}  // namespace
+
+bool Mmap::AdviseWillNeed(const void *addr, size_t len) {
+  absl::StatusOr<size_t> page_size = GetPageSize();
+  if (!page_size.ok() || len == 0) {
+    return false;
+  }
+  const auto [ptr, size] = AlignToPages(addr, len, *page_size);
+#ifdef _WIN32
+  WIN32_MEMORY_RANGE_ENTRY range = {ptr, size};
+  return ::PrefetchVirtualMemory(::GetCurrentProcess(), 1, &range, 0);
+#else   // _WIN32
+  return madvise(ptr, size, MADV_WILLNEED) == 0;
+#endif  // _WIN32
+}
+
+bool Mmap::AdviseHugePages(const void *addr, size_t len) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  absl::StatusOr<size_t> page_size = GetPageSize();
+  if (!page_size.ok() || len == 0) {
+    return false;
+  }
+  const auto [ptr, size] = AlignToPages(addr, len, *page_size);
+  return madvise(ptr, size, MADV_HUGEPAGE) == 0;
+#else   // __linux__ && MADV_HUGEPAGE
+  return false;
+#endif  // __linux__ && MADV_HUGEPAGE
+}
+
+void Mmap::PopulatePages(const void *addr, size_t len) {
+  absl::StatusOr<size_t> page_size = GetPageSize();
+  if (!page_size.ok() || len == 0) {
+    return;
+  }
+  const auto [ptr, size] = AlignToPages(addr, len, *page_size);
+#if defined(__linux__) && defined(MADV_POPULATE_READ)
+  // Available since Linux 5.14. Falls back to touching pages on failure.
+  if (madvise(ptr, size, MADV_POPULATE_READ) == 0) {
+    return;
+  }
+#endif  // __linux__ && MADV_POPULATE_READ
+  // Reads one byte per page. The first page is touched at `addr` since the
+  // aligned address may be outside of the accessible region.
+  const char *const begin = static_cast<const char *>(addr);
+  volatile char sink = *begin;
+  for (size_t offset = *page_size; offset < size; offset += *page_size) {
+    sink = ptr[offset];
+  }
+  (void)sink;
+}
+
 }  // namespace mozc
@@ -88,6 +88,20 @@ class Mmap final {
   static int MaybeMLock(const void *addr, size_t len);
   static int MaybeMUnlock(const void *addr, size_t len);
 
+  // Page-in helpers to avoid page faults on the first access to a region.
+  // They accept any address range, e.g., a section of mapped data, and round
+  // it to the page boundaries.
+  //
+  // Hints that the pages in [addr, addr + len) will be accessed soon, so that
+  // the kernel can start reading them ahead asynchronously. Returns false if
+  // the hint is not supported or fails.
+  static bool AdviseWillNeed(const void *addr, size_t len);
+  // Hints that the region should be backed by transparent huge pages. This is
+  // supported only on Linux, and the kernel may ignore it for file mappings.
+  static bool AdviseHugePages(const void *addr, size_t len);
+  // Faults in all the pages in [addr, addr + len) synchronously.
+  static void PopulatePages(const void *addr, size_t len);
+
   constexpr char &operator[](size_t i) { return data_[i]; }
   constexpr char operator[](size_t i) const { return data_[i]; }
   constexpr char *begin() { return data_.begin(); }
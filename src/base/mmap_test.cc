@@ -148,6 +148,30 @@ TEST(MmapTest, MaybeMLockTest) {
   }
 }
 
+TEST(MmapTest, WarmUp) {
+  constexpr size_t kFileSize = 3 * 4096 + 100;
+  const std::vector<char> data = GetRandomContents(kFileSize);
+  const absl::StatusOr<TempFile> temp_file =
+      TempDirectory::Default().CreateTempFile();
+  ASSERT_OK(temp_file);
+  ASSERT_OK(FileUtil::SetContents(temp_file->path(),
+                                  absl::string_view(data.data(), data.size())));
+  const absl::StatusOr<Mmap> mmap =
+      Mmap::Map(temp_file->path(), Mmap::READ_ONLY);
+  ASSERT_OK(mmap);
+
+  // The helpers accept regions that are not aligned to pages.
+  const char *const region = mmap->data() + 10;
+  const size_t region_size = kFileSize - 20;
+#ifndef _WIN32
+  EXPECT_TRUE(Mmap::AdviseWillNeed(region, region_size));
+#endif  // _WIN32
+  Mmap::AdviseHugePages(region, region_size);
+  Mmap::PopulatePages(region, region_size);
+  Mmap::PopulatePages(region, 1);
+  EXPECT_EQ(mmap->span(), data);
+}
+
 class MmapEntireFileTest : public ::testing::TestWithParam<size_t> {};
 
 TEST_P(MmapEntireFileTest, Read) {
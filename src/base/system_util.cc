@@ -60,6 +60,7 @@
 // clang-format off
 #include <windows.h>
 #include <lmcons.h>
+#include <psapi.h>
 #include <sddl.h>
 #include <shlobj.h>
 #include <versionhelpers.h>
@@ -73,6 +74,7 @@
 #else  // _WIN32
 #include <pwd.h>
 #include <sys/mman.h>
+#include <sys/resource.h>
 #include <unistd.h>
 
 #include "absl/container/fixed_array.h"
@@ -846,4 +848,29 @@ uint64_t SystemUtil::GetTotalPhysicalMemory() {
   // because of no return value.
 }
 
+uint64_t SystemUtil::GetPeakResidentMemory() {
+#if defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS counters = {sizeof(PROCESS_MEMORY_COUNTERS)};
+  if (!::GetProcessMemoryInfo(::GetCurrentProcess(), &counters,
+                              sizeof(counters))) {
+    return 0;
+  }
+  return counters.PeakWorkingSetSize;
+#elif defined(__APPLE__) || defined(__linux__)
+  struct rusage usage = {};
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#if defined(__APPLE__)
+  // ru_maxrss is in bytes on macOS.
+  return static_cast<uint64_t>(usage.ru_maxrss);
+#else   // __APPLE__
+  // ru_maxrss is in kilobytes on Linux.
+  return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif  // __APPLE__
+#else   // _WIN32, __APPLE__, __linux__
+  return 0;
+#endif  // _WIN32, __APPLE__, __linux__
+}
+
 }  // namespace mozc
@@ -51,6 +51,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/strings/strip.h"
+#include "base/bits.h"
 #include "base/strings/unicode.h"
 
 #ifdef _WIN32
@@ -806,20 +807,22 @@ bool Util::IsEnglishTransliteration(absl::string_view value) {
   return true;
 }
 
+namespace {
+
 #define INRANGE(w, a, b) ((w) >= (a) && (w) <= (b))
 
 // script type
 // TODO(yukawa, team): Make a mechanism to keep this classifier up-to-date
 //   based on the original data from Unicode.org.
-Util::ScriptType Util::GetScriptType(char32_t codepoint) {
+constexpr Util::ScriptType ScriptTypeOf(char32_t codepoint) {
   if (INRANGE(codepoint, 0x0030, 0x0039) ||  // ascii number
       INRANGE(codepoint, 0xFF10, 0xFF19)) {  // full width number
-    return NUMBER;
+    return Util::NUMBER;
   } else if (INRANGE(codepoint, 0x0041, 0x005A) ||  // ascii upper
              INRANGE(codepoint, 0x0061, 0x007A) ||  // ascii lower
              INRANGE(codepoint, 0xFF21, 0xFF3A) ||  // fullwidth ascii upper
              INRANGE(codepoint, 0xFF41, 0xFF5A)) {  // fullwidth ascii lower
-    return ALPHABET;
+    return Util::ALPHABET;
   } else if (codepoint == 0x3005 ||  // IDEOGRAPHIC ITERATION MARK "々"
              INRANGE(codepoint, 0x3400,
                      0x4DBF) ||  // CJK Unified Ideographs Extension A
@@ -842,16 +845,16 @@ Util::ScriptType Util::GetScriptType(char32_t codepoint) {
     // [U+2A700, U+2B734]: CJK Unified Ideographs Extension C
     // [U+2B740, U+2B81D]: CJK Unified Ideographs Extension D
     // [U+2F800, U+2FA1D]: CJK Compatibility Ideographs
-    return KANJI;
+    return Util::KANJI;
   } else if (INRANGE(codepoint, 0x3041, 0x309F) ||  // hiragana
              codepoint == 0x1B001) {  // HIRAGANA LETTER ARCHAIC YE
-    return HIRAGANA;
+    return Util::HIRAGANA;
   } else if (INRANGE(codepoint, 0x30A1, 0x30FF) ||  // full width katakana
              INRANGE(codepoint, 0x31F0,
                      0x31FF) ||  // Katakana Phonetic Extensions for Ainu
              INRANGE(codepoint, 0xFF65, 0xFF9F) ||  // half width katakana
              codepoint == 0x1B000) {                // KATAKANA LETTER ARCHAIC E
-    return KATAKANA;
+    return Util::KATAKANA;
   } else if (INRANGE(codepoint, 0x02300, 0x023F3) ||  // Miscellaneous Technical
              INRANGE(codepoint, 0x02700, 0x027BF) ||  // Dingbats
              INRANGE(codepoint, 0x1F000, 0x1F02F) ||  // Mahjong tiles
@@ -868,13 +871,13 @@ Util::ScriptType Util::GetScriptType(char32_t codepoint) {
                      0x1F6FF) ||  // Transport And Map Symbols
              INRANGE(codepoint, 0x1F700, 0x1F77F) ||  // Alchemical Symbols
              codepoint == 0x26CE) {                   // Ophiuchus
-    return EMOJI;
+    return Util::EMOJI;
   }
 
-  return UNKNOWN_SCRIPT;
+  return Util::UNKNOWN_SCRIPT;
 }
 
-Util::FormType Util::GetFormType(char32_t codepoint) {
+constexpr Util::FormType FormTypeOf(char32_t codepoint) {
   // 'Unicode Standard Annex #11: EAST ASIAN WIDTH'
   // http://www.unicode.org/reports/tr11/
 
@@ -883,7 +886,7 @@ Util::FormType Util::GetFormType(char32_t codepoint) {
   if (INRANGE(codepoint, 0x0020, 0x007F) ||  // ascii
       INRANGE(codepoint, 0x27E6, 0x27ED) ||  // narrow mathematical symbols
       INRANGE(codepoint, 0x2985, 0x2986)) {  // narrow white parentheses
-    return HALF_WIDTH;
+    return Util::HALF_WIDTH;
   }
 
   // Other characters marked as 'Na' in
@@ -896,7 +899,7 @@ Util::FormType Util::GetFormType(char32_t codepoint) {
       case 0x00A6:  // BROKEN BAR
       case 0x00AC:  // NOT SIGN
       case 0x00AF:  // MACRON
-        return HALF_WIDTH;
+        return Util::HALF_WIDTH;
     }
   }
 
@@ -909,14 +912,146 @@ Util::FormType Util::GetFormType(char32_t codepoint) {
       INRANGE(codepoint, 0xFFD2, 0xFFD7) ||  // half-width hangul
       INRANGE(codepoint, 0xFFDA, 0xFFDC) ||  // half-width hangul
       INRANGE(codepoint, 0xFFE8, 0xFFEE)) {  // half-width symbols
-    return HALF_WIDTH;
+    return Util::HALF_WIDTH;
   }
 
-  return FULL_WIDTH;
+  return Util::FULL_WIDTH;
 }
 
 #undef INRANGE
 
+// Classifies code points with lookup tables computed at compile time from
+// `kClassify`.  ASCII characters are looked up directly, and characters in BMP
+// are looked up by their 256-character pages if all the characters in the
+// page have the same class, which is the case for kana (except for a few
+// pages), CJK ideographs and most of symbols.  The other characters fall back
+// to `kClassify`.
+template <auto kClassify>
+class CodepointClassifier {
+ public:
+  using Type = decltype(kClassify(char32_t{}));
+
+  static Type Classify(char32_t codepoint) {
+    if (codepoint < kAscii.size()) {
+      return kAscii[codepoint];
+    }
+    if (codepoint <= 0xFFFF) {
+      const uint8_t page = kBmpPages[codepoint >> 8];
+      if (page != kMixedPage) {
+        return static_cast<Type>(page);
+      }
+    }
+    return kClassify(codepoint);
+  }
+
+ private:
+  static constexpr uint8_t kMixedPage = 0xFF;
+
+  static constexpr std::array<Type, 0x80> kAscii = [] {
+    std::array<Type, 0x80> table = {};
+    for (char32_t c = 0; c < table.size(); ++c) {
+      table[c] = kClassify(c);
+    }
+    return table;
+  }();
+
+  static constexpr std::array<uint8_t, 0x100> kBmpPages = [] {
+    std::array<uint8_t, 0x100> table = {};
+    for (char32_t page = 0; page < table.size(); ++page) {
+      const Type type = kClassify(page << 8);
+      table[page] = static_cast<uint8_t>(type);
+      for (char32_t c = 1; c < 0x100; ++c) {
+        if (kClassify((page << 8) | c) != type) {
+          table[page] = kMixedPage;
+          break;
+        }
+      }
+    }
+    return table;
+  }();
+};
+
+using ScriptTypeClassifier = CodepointClassifier<ScriptTypeOf>;
+using FormTypeClassifier = CodepointClassifier<FormTypeOf>;
+
+constexpr uint64_t kHighBits = 0x8080808080808080;
+constexpr uint64_t kOnes = 0x0101010101010101;
+
+// Returns the byte length of the longest ASCII prefix of `str`.  Checks 16
+// bytes at a time.
+size_t GetAsciiPrefixSize(absl::string_view str) {
+  size_t i = 0;
+  for (; i + 16 <= str.size(); i += 16) {
+    const uint64_t w0 = LoadUnaligned<uint64_t>(str.data() + i);
+    const uint64_t w1 = LoadUnaligned<uint64_t>(str.data() + i + 8);
+    if (((w0 | w1) & kHighBits) != 0) {
+      break;
+    }
+  }
+  while (i < str.size() && static_cast<uint8_t>(str[i]) < 0x80) {
+    ++i;
+  }
+  return i;
+}
+
+// Returns the byte length of the longest prefix of `str` consisting of
+// U+0020 - U+007F, which are all HALF_WIDTH.  Checks 16 bytes at a time.
+size_t GetHalfWidthAsciiPrefixSize(absl::string_view str) {
+  // A byte b has the high bit set after this if b >= 0x80 or b < 0x20.
+  constexpr auto non_half_width_ascii = [](uint64_t w) {
+    return (w | (w - 0x20 * kOnes)) & kHighBits;
+  };
+  size_t i = 0;
+  for (; i + 16 <= str.size(); i += 16) {
+    const uint64_t w0 = LoadUnaligned<uint64_t>(str.data() + i);
+    const uint64_t w1 = LoadUnaligned<uint64_t>(str.data() + i + 8);
+    if ((non_half_width_ascii(w0) | non_half_width_ascii(w1)) != 0) {
+      break;
+    }
+  }
+  while (i < str.size() && static_cast<uint8_t>(str[i]) >= 0x20 &&
+         static_cast<uint8_t>(str[i]) < 0x80) {
+    ++i;
+  }
+  return i;
+}
+
+// Decodes the first character of non-empty `str` exactly in the same way as
+// Util::SplitFirstChar32() (and thus ConstChar32Iterator), and returns its
+// byte length, or 0 if it's invalid.  ASCII and 3-byte characters, which
+// cover kana and most of kanji, are decoded inline.
+size_t DecodeFirstChar32(absl::string_view str, char32_t *codepoint) {
+  const uint8_t b0 = static_cast<uint8_t>(str[0]);
+  if (b0 < 0x80) {
+    *codepoint = b0;
+    return 1;
+  }
+  if ((b0 & 0xF0) == 0xE0 && str.size() >= 3) {
+    const uint8_t b1 = static_cast<uint8_t>(str[1]);
+    const uint8_t b2 = static_cast<uint8_t>(str[2]);
+    const char32_t c = ((b0 & 0x0F) << 12) | ((b1 & 0x3F) << 6) | (b2 & 0x3F);
+    if ((b1 & 0xC0) == 0x80 && (b2 & 0xC0) == 0x80 && c >= 0x0800) {
+      *codepoint = c;
+      return 3;
+    }
+  }
+  absl::string_view rest;
+  if (!Util::SplitFirstChar32(str, codepoint, &rest)) {
+    return 0;
+  }
+  return str.size() - rest.size();
+}
+
+}  // namespace
+
+Util::ScriptType Util::GetScriptType(char32_t codepoint) {
+  return ScriptTypeOf(codepoint);
+}
+
+Util::FormType Util::GetFormType(char32_t codepoint) {
+  return FormTypeOf(codepoint);
+}
+
 // Returns the script type of the first character in `str`.
 Util::ScriptType Util::GetFirstScriptType(absl::string_view str,
                                           size_t *mblen) {
@@ -963,7 +1098,7 @@ Util::ScriptType GetScriptTypeInternal(absl::string_view str,
       continue;
     }
 
-    Util::ScriptType type = Util::GetScriptType(codepoint);
+    Util::ScriptType type = ScriptTypeClassifier::Classify(codepoint);
     // Ignore symbols
     // Regard UNKNOWN_SCRIPT as symbols here
     if (ignore_symbols && type == Util::UNKNOWN_SCRIPT) {
@@ -993,10 +1128,14 @@ Util::ScriptType Util::GetScriptTypeWithoutSymbols(absl::string_view str) {
 
 // return true if all script_type in str is "type"
 bool Util::IsScriptType(absl::string_view str, Util::ScriptType type) {
-  for (ConstChar32Iterator iter(str); !iter.Done(); iter.Next()) {
-    const char32_t codepoint = iter.Get();
+  char32_t codepoint;
+  for (size_t len; !str.empty(); str.remove_prefix(len)) {
+    len = DecodeFirstChar32(str, &codepoint);
+    if (len == 0) {
+      break;
+    }
     // Exception: 30FC (PROLONGEDSOUND MARK is categorized as HIRAGANA as well)
-    if (type != GetScriptType(codepoint) &&
+    if (type != ScriptTypeClassifier::Classify(codepoint) &&
         (codepoint != 0x30FC || type != HIRAGANA)) {
       return false;
     }
@@ -1006,8 +1145,13 @@ bool Util::IsScriptType(absl::string_view str, Util::ScriptType type) {
 
 // return true if the string contains script_type char
 bool Util::ContainsScriptType(absl::string_view str, ScriptType type) {
-  for (ConstChar32Iterator iter(str); !iter.Done(); iter.Next()) {
-    if (type == GetScriptType(iter.Get())) {
+  char32_t codepoint;
+  for (size_t len; !str.empty(); str.remove_prefix(len)) {
+    len = DecodeFirstChar32(str, &codepoint);
+    if (len == 0) {
+      break;
+    }
+    if (type == ScriptTypeClassifier::Classify(codepoint)) {
       return true;
     }
   }
@@ -1019,8 +1163,22 @@ Util::FormType Util::GetFormType(absl::string_view str) {
   // TODO(hidehiko): get rid of using FORM_TYPE_SIZE.
   FormType result = FORM_TYPE_SIZE;
 
-  for (ConstChar32Iterator iter(str); !iter.Done(); iter.Next()) {
-    const FormType type = GetFormType(iter.Get());
+  char32_t codepoint;
+  for (size_t len; !str.empty(); str.remove_prefix(len)) {
+    // Fast path for a run of HALF_WIDTH ASCII characters.
+    len = GetHalfWidthAsciiPrefixSize(str);
+    if (len > 0) {
+      if (result == FULL_WIDTH) {
+        return UNKNOWN_FORM;
+      }
+      result = HALF_WIDTH;
+      continue;
+    }
+    len = DecodeFirstChar32(str, &codepoint);
+    if (len == 0) {
+      break;
+    }
+    const FormType type = FormTypeClassifier::Classify(codepoint);
     if (type == UNKNOWN_FORM || (result != FORM_TYPE_SIZE && type != result)) {
       return UNKNOWN_FORM;
     }
@@ -1031,7 +1189,7 @@ Util::FormType Util::GetFormType(absl::string_view str) {
 }
 
 bool Util::IsAscii(absl::string_view str) {
-  return absl::c_all_of(str, absl::ascii_isascii);
+  return GetAsciiPrefixSize(str) == str.size();
 }
 
 namespace {
@@ -42,7 +42,10 @@
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/log/check.h"
+#include "absl/random/random.h"
+#include "absl/strings/ascii.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
 #include "testing/gmock.h"
@@ -872,6 +875,101 @@ TEST(UtilTest, IsAscii) {
   EXPECT_FALSE(Util::IsAscii("\x80"));
 }
 
+// The original implementations, which decode one character at a time with
+// ConstChar32Iterator, as the references of the differential tests below.
+bool IsScriptTypeForTest(absl::string_view str, Util::ScriptType type) {
+  for (ConstChar32Iterator iter(str); !iter.Done(); iter.Next()) {
+    const char32_t codepoint = iter.Get();
+    if (type != Util::GetScriptType(codepoint) &&
+        (codepoint != 0x30FC || type != Util::HIRAGANA)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ContainsScriptTypeForTest(absl::string_view str, Util::ScriptType type) {
+  for (ConstChar32Iterator iter(str); !iter.Done(); iter.Next()) {
+    if (type == Util::GetScriptType(iter.Get())) {
+      return true;
+    }
+  }
+  return false;
+}
+
+Util::FormType GetFormTypeForTest(absl::string_view str) {
+  Util::FormType result = Util::FORM_TYPE_SIZE;
+  for (ConstChar32Iterator iter(str); !iter.Done(); iter.Next()) {
+    const Util::FormType type = Util::GetFormType(iter.Get());
+    if (result != Util::FORM_TYPE_SIZE && type != result) {
+      return Util::UNKNOWN_FORM;
+    }
+    result = type;
+  }
+  return result;
+}
+
+TEST(UtilTest, ClassifyAllCodepoints) {
+  for (char32_t c = 0; c <= 0x10FFFF; ++c) {
+    const std::string str = Util::CodepointToUtf8(c);
+    if (str.empty()) {
+      continue;
+    }
+    const Util::ScriptType script_type = Util::GetScriptType(c);
+    ASSERT_TRUE(Util::IsScriptType(str, script_type)) << static_cast<uint32_t>(c);
+    ASSERT_TRUE(Util::ContainsScriptType(str, script_type)) << static_cast<uint32_t>(c);
+    ASSERT_EQ(Util::GetFormType(str), Util::GetFormType(c)) << static_cast<uint32_t>(c);
+    ASSERT_EQ(Util::IsAscii(str), c < 0x80) << static_cast<uint32_t>(c);
+    if (script_type != Util::UNKNOWN_SCRIPT && c != U'ー' && c != U'・' &&
+        (c < 0x3099 || c > 0x309C)) {
+      ASSERT_EQ(Util::GetScriptType(str), script_type) << static_cast<uint32_t>(c);
+    }
+  }
+}
+
+TEST(UtilTest, ClassifyRandomStrings) {
+  // Pieces including ASCII runs longer than 16 bytes, all the script types,
+  // and invalid or truncated UTF-8 sequences.
+  constexpr absl::string_view kPieces[] = {
+      // ASCII
+      "a", "Z", "0", "9", " ", ".", "\t", "\x7F", absl::string_view("\0", 1),
+      "abcdefghijklmnopqrstuvwxyz", "0123456789012345678",
+      // Kana and kanji
+      "あ", "ん", "ー", "・", "゛", "ア", "ヶ", "ｱ", "ﾟ", "漢", "々", "㐀", "𠀋",
+      // Full-width alphanumerics, emoji and symbols
+      "０", "Ｚ", "ｚ", "😀", "☺", "⌚", "é", "¢", "₩", "　",
+      // Invalid or truncated sequences
+      "\xE3", "\xE3\x81", "\x80", "\xFF", "\xE0\x80\x80", "\xC0\xAF",
+      "\xED\xA0\x80", "\xF4\x90\x80\x80",
+  };
+  constexpr Util::ScriptType kScriptTypes[] = {
+      Util::UNKNOWN_SCRIPT, Util::KATAKANA, Util::HIRAGANA, Util::KANJI,
+      Util::NUMBER,         Util::ALPHABET, Util::EMOJI,
+  };
+  absl::BitGen gen;
+  for (int i = 0; i < 20000; ++i) {
+    std::string str;
+    const int num_pieces = absl::Uniform(gen, 0, 12);
+    // Bias towards strings of a single script.
+    const size_t range = absl::Uniform(gen, 1u, std::size(kPieces) + 1);
+    const size_t offset =
+        absl::Uniform(gen, 0u, std::size(kPieces) - range + 1);
+    for (int j = 0; j < num_pieces; ++j) {
+      str.append(kPieces[offset + absl::Uniform(gen, 0u, range)]);
+    }
+    for (const Util::ScriptType type : kScriptTypes) {
+      ASSERT_EQ(Util::IsScriptType(str, type), IsScriptTypeForTest(str, type))
+          << str << " " << type;
+      ASSERT_EQ(Util::ContainsScriptType(str, type),
+                ContainsScriptTypeForTest(str, type))
+          << str << " " << type;
+    }
+    ASSERT_EQ(Util::GetFormType(str), GetFormTypeForTest(str)) << str;
+    ASSERT_EQ(Util::IsAscii(str), absl::c_all_of(str, absl::ascii_isascii))
+        << str;
+  }
+}
+
 TEST(UtilTest, IsJisX0208) {
   EXPECT_TRUE(Util::IsJisX0208("\u007F"));
   EXPECT_FALSE(Util::IsJisX0208("\u0080"));
@@ -37,6 +37,7 @@
 #include <memory>
 #include <ostream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/base/attributes.h"
@@ -45,6 +46,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "base/const.h"
 #include "base/file_stream.h"
 #include "base/file_util.h"
@@ -328,6 +330,44 @@ bool Client::SendKeyWithContext(const commands::KeyEvent &key,
   return EnsureCallCommand(&input, output);
 }
 
+bool Client::SendKeys(const absl::Span<const commands::KeyEvent> keys,
+                      std::vector<commands::Output> *outputs) {
+  outputs->clear();
+  if (keys.empty()) {
+    return true;
+  }
+
+  // The inputs in the batch use the session ID of the batch input.
+  commands::Input input;
+  input.set_type(commands::Input::EVAL_BATCH);
+  for (const commands::KeyEvent &key : keys) {
+    commands::Input *key_input = input.add_batch_inputs();
+    key_input->set_type(commands::Input::SEND_KEY);
+    *key_input->mutable_key() = key;
+  }
+  commands::Output output;
+  if (!EnsureCallCommand(&input, &output)) {
+    return false;
+  }
+  if (output.batch_outputs_size() != input.batch_inputs_size()) {
+    LOG(ERROR) << "Invalid number of outputs: " << output.batch_outputs_size();
+    return false;
+  }
+
+  outputs->reserve(keys.size());
+  for (int i = 0; i < output.batch_outputs_size(); ++i) {
+    commands::Output &key_output = *output.mutable_batch_outputs(i);
+    if (key_output.id() != input.id()) {
+      LOG(ERROR) << "Session id is void: " << key_output.id();
+      return false;
+    }
+    // Records the inputs one by one, as SendKey() does, to play them back.
+    PushHistory(input.batch_inputs(i), key_output);
+    outputs->push_back(std::move(key_output));
+  }
+  return true;
+}
+
 bool Client::TestSendKeyWithContext(const commands::KeyEvent &key,
                                     const commands::Context &context,
                                     commands::Output *output) {
@@ -40,6 +40,7 @@
 
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "base/run_level.h"
 #include "base/strings/assign.h"
 #include "client/client_interface.h"
@@ -124,6 +125,8 @@ class Client : public ClientInterface {
   bool SendKeyWithContext(const commands::KeyEvent &key,
                           const commands::Context &context,
                           commands::Output *output) override;
+  bool SendKeys(absl::Span<const commands::KeyEvent> keys,
+                std::vector<commands::Output> *outputs) override;
   bool TestSendKeyWithContext(const commands::KeyEvent &key,
                               const commands::Context &context,
                               commands::Output *output) override;
@@ -35,9 +35,11 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "ipc/ipc.h"
 #include "protocol/commands.pb.h"
 #include "protocol/config.pb.h"
@@ -140,6 +142,10 @@ class ClientInterface {
   virtual bool SendKeyWithContext(const commands::KeyEvent &key,
                                   const commands::Context &context,
                                   commands::Output *output) = 0;
+  // Sends |keys| in one request and stores the outputs for them to |outputs|
+  // in the same order.
+  virtual bool SendKeys(absl::Span<const commands::KeyEvent> keys,
+                        std::vector<commands::Output> *outputs) = 0;
   virtual bool TestSendKeyWithContext(const commands::KeyEvent &key,
                                       const commands::Context &context,
                                       commands::Output *output) = 0;
@@ -32,9 +32,11 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "client/client_interface.h"
 #include "ipc/ipc.h"
 #include "protocol/commands.pb.h"
@@ -59,6 +61,10 @@ class ClientMock : public client::ClientInterface {
               (const commands::KeyEvent &argument,
                const commands::Context &context, commands::Output *output),
               (override));
+  MOCK_METHOD(bool, SendKeys,
+              (absl::Span<const commands::KeyEvent> keys,
+               std::vector<commands::Output> *outputs),
+              (override));
   MOCK_METHOD(bool, TestSendKeyWithContext,
               (const commands::KeyEvent &argument,
                const commands::Context &context, commands::Output *output),
@@ -42,6 +42,7 @@
 #include "absl/log/check.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
+#include "base/hash.h"
 #include "base/number_util.h"
 #include "base/util.h"
 #include "base/vlog.h"
@@ -56,9 +57,24 @@
 
 namespace mozc {
 namespace converter {
+namespace candidate_filter_internal {
+
+CandidateKey::CandidateKey(const Segment::Candidate &candidate)
+    : fingerprint(FingerprintWithSeed(
+          candidate.value,
+          static_cast<uint32_t>(candidate.lid) << 16 | candidate.rid)),
+      value(candidate.value),
+      lid(candidate.lid),
+      rid(candidate.rid) {}
+
+}  // namespace candidate_filter_internal
+
 namespace {
 
+using ::mozc::converter::candidate_filter_internal::CandidateEq;
+using ::mozc::converter::candidate_filter_internal::CandidateHasher;
 using ::mozc::converter::candidate_filter_internal::CandidateId;
+using ::mozc::converter::candidate_filter_internal::CandidateKey;
 using ::mozc::dictionary::PosMatcher;
 using ::mozc::dictionary::SuppressionDictionary;
 
@@ -254,16 +270,36 @@ CandidateFilter::CandidateFilter(
     : suppression_dictionary_(suppression_dictionary),
       pos_matcher_(pos_matcher),
       suggestion_filter_(suggestion_filter),
+      seen_(0, CandidateHasher(), CandidateEq(&seen_values_)),
       top_candidate_(nullptr) {
   CHECK(suppression_dictionary_);
   CHECK(pos_matcher_);
 }
 
 void CandidateFilter::Reset() {
-  seen_.clear();
+  // clear() releases the memory of large tables.
+  seen_.erase(seen_.begin(), seen_.end());
+  seen_values_.clear();
   top_candidate_ = nullptr;
 }
 
+bool CandidateFilter::InsertSeen(const Segment::Candidate &candidate) {
+  const CandidateKey key(candidate);
+  if (seen_.contains(key)) {
+    return false;
+  }
+  const CandidateId id = {
+      .fingerprint = key.fingerprint,
+      .value_begin = static_cast<uint32_t>(seen_values_.size()),
+      .value_size = static_cast<uint32_t>(key.value.size()),
+      .lid = key.lid,
+      .rid = key.rid,
+  };
+  seen_values_.append(key.value);
+  seen_.insert(id);
+  return true;
+}
+
 CandidateFilter::ResultType CandidateFilter::CheckRequestType(
     const ConversionRequest &request, const absl::string_view original_key,
     const Segment::Candidate &candidate,
@@ -394,7 +430,7 @@ CandidateFilter::ResultType CandidateFilter::FilterCandidateInternal(
   }
 
   // The candidate is already seen.
-  if (seen_.contains(*candidate)) {
+  if (seen_.contains(CandidateKey(*candidate))) {
     MOZC_CANDIDATE_LOG(candidate, "already seen");
     return CandidateFilter::BAD_CANDIDATE;
   }
@@ -649,15 +685,14 @@ CandidateFilter::ResultType CandidateFilter::FilterCandidate(
     // In reverse conversion, only remove duplicates because the filtering
     // criteria of FilterCandidateInternal() are completely designed for
     // (forward) conversion.
-    const bool inserted = seen_.insert(CandidateId(*candidate)).second;
-    return inserted ? GOOD_CANDIDATE : BAD_CANDIDATE;
+    return InsertSeen(*candidate) ? GOOD_CANDIDATE : BAD_CANDIDATE;
   } else {
     const ResultType result = FilterCandidateInternal(
         request, original_key, candidate, top_nodes, nodes);
     if (result != GOOD_CANDIDATE) {
       return result;
     }
-    seen_.insert(CandidateId(*candidate));
+    InsertSeen(*candidate);
     return result;
   }
 }
@@ -32,11 +32,9 @@
 
 #include <cstddef>
 #include <cstdint>
-#include <functional>
 #include <string>
 
 #include "absl/container/flat_hash_set.h"
-#include "absl/hash/hash.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "converter/node.h"
@@ -50,26 +48,25 @@ namespace mozc {
 namespace converter {
 
 namespace candidate_filter_internal {
-// ID of the candidate for filtering.
-struct CandidateId {
-  explicit CandidateId(const Segment::Candidate &candidate)
-      : value(candidate.value), lid(candidate.lid), rid(candidate.rid) {}
 
-  template <typename H>
-  friend H AbslHashValue(H h, const CandidateId &c) {
-    return H::combine(std::move(h), c.value, c.lid, c.rid);
-  }
+// Key of the candidate to look up the seen candidates. |fingerprint| is the
+// fingerprint of (value, lid, rid).
+struct CandidateKey {
+  explicit CandidateKey(const Segment::Candidate &candidate);
 
-  friend bool operator==(const CandidateId &lhs, const CandidateId &rhs) {
-    // Comparing the int values first for performance.
-    return lhs.lid == rhs.lid && lhs.rid == rhs.rid && lhs.value == rhs.value;
-  }
-  friend bool operator==(const CandidateId &lhs,
-                         const Segment::Candidate &rhs) {
-    return lhs.lid == rhs.lid && lhs.rid == rhs.rid && lhs.value == rhs.value;
-  }
+  uint64_t fingerprint;
+  absl::string_view value;
+  uint16_t lid;
+  uint16_t rid;
+};
 
-  std::string value;
+// ID of the seen candidate. The value is not copied into each ID but kept in
+// a buffer shared by all the IDs, so that adding an ID doesn't allocate once
+// the buffer is large enough.
+struct CandidateId {
+  uint64_t fingerprint;
+  uint32_t value_begin;
+  uint32_t value_size;
   uint16_t lid;
   uint16_t rid;
 };
@@ -77,10 +74,36 @@ struct CandidateId {
 struct CandidateHasher {
   using is_transparent = void;
 
-  size_t operator()(const CandidateId &c) const { return absl::HashOf(c); }
-  size_t operator()(const Segment::Candidate &c) const {
-    return absl::HashOf(c.value, c.lid, c.rid);
+  size_t operator()(const CandidateId &c) const { return c.fingerprint; }
+  size_t operator()(const CandidateKey &c) const { return c.fingerprint; }
+};
+
+// Compares the values only when the fingerprints match, which is almost
+// always a match of the candidates.
+class CandidateEq {
+ public:
+  using is_transparent = void;
+
+  explicit CandidateEq(const std::string *values) : values_(values) {}
+
+  bool operator()(const CandidateId &lhs, const CandidateId &rhs) const {
+    return lhs.fingerprint == rhs.fingerprint && lhs.lid == rhs.lid &&
+           lhs.rid == rhs.rid && GetValue(lhs) == GetValue(rhs);
+  }
+  bool operator()(const CandidateId &lhs, const CandidateKey &rhs) const {
+    return lhs.fingerprint == rhs.fingerprint && lhs.lid == rhs.lid &&
+           lhs.rid == rhs.rid && GetValue(lhs) == rhs.value;
+  }
+  bool operator()(const CandidateKey &lhs, const CandidateId &rhs) const {
+    return (*this)(rhs, lhs);
   }
+
+ private:
+  absl::string_view GetValue(const CandidateId &c) const {
+    return absl::string_view(*values_).substr(c.value_begin, c.value_size);
+  }
+
+  const std::string *values_;
 };
 
 }  // namespace candidate_filter_internal
@@ -110,10 +133,15 @@ class CandidateFilter {
                              absl::Span<const Node *const> top_nodes,
                              absl::Span<const Node *const> nodes);
 
-  // Resets the internal state.
+  // Resets the internal state. The memory for the seen candidates is kept to
+  // be reused.
   void Reset();
 
  private:
+  // Adds |candidate| to the seen candidates. Returns false if it was already
+  // seen.
+  bool InsertSeen(const Segment::Candidate &candidate);
+
   ResultType CheckRequestType(const ConversionRequest &request,
                               absl::string_view original_key,
                               const Segment::Candidate &candidate,
@@ -128,9 +156,11 @@ class CandidateFilter {
   const dictionary::PosMatcher *pos_matcher_;
   const SuggestionFilter &suggestion_filter_;
 
+  // Values of the candidates in |seen_|.
+  std::string seen_values_;
   absl::flat_hash_set<candidate_filter_internal::CandidateId,
                       candidate_filter_internal::CandidateHasher,
-                      std::equal_to<>>
+                      candidate_filter_internal::CandidateEq>
       seen_;
   const Segment::Candidate *top_candidate_;
 };
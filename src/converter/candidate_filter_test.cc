@@ -39,6 +39,7 @@
 #include "absl/log/log.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
 #include "base/container/freelist.h"
 #include "converter/node.h"
 #include "converter/segments.h"
@@ -1275,6 +1276,73 @@ TEST_F(CandidateFilterTest, ReverseConversion) {
   }
 }
 
+TEST_F(CandidateFilterTest, DeduplicationBySameValueWithDifferentPos) {
+  const ConversionRequest convreq =
+      ConvReq(ConversionRequest::REVERSE_CONVERSION);
+  std::unique_ptr<CandidateFilter> filter(CreateCandidateFilter());
+  std::vector<const Node *> nodes;
+  GetDefaultNodes(&nodes);
+
+  struct Id {
+    const char *value;
+    uint16_t lid;
+    uint16_t rid;
+  };
+  // The same value with different lid/rid, and the values which are prefixes
+  // of each other, are different candidates.
+  constexpr Id kIds[] = {
+      {"ほん", 1, 1}, {"ほん", 1, 2}, {"ほん", 2, 1},
+      {"ほ", 1, 1},   {"ほんと", 1, 1},
+  };
+  for (int round = 0; round < 2; ++round) {
+    for (const Id &id : kIds) {
+      Segment::Candidate *c = NewCandidate();
+      c->key = "本";
+      c->value = id.value;
+      c->lid = id.lid;
+      c->rid = id.rid;
+      EXPECT_EQ(filter->FilterCandidate(convreq, "本", c, nodes, nodes),
+                round == 0 ? CandidateFilter::GOOD_CANDIDATE
+                           : CandidateFilter::BAD_CANDIDATE)
+          << id.value << " " << id.lid << " " << id.rid;
+    }
+  }
+}
+
+TEST_F(CandidateFilterTest, FilterAfterReset) {
+  const ConversionRequest convreq =
+      ConvReq(ConversionRequest::REVERSE_CONVERSION);
+  std::unique_ptr<CandidateFilter> filter(CreateCandidateFilter());
+  std::vector<const Node *> nodes;
+  GetDefaultNodes(&nodes);
+
+  auto filter_value = [&](absl::string_view value) {
+    Segment::Candidate *c = NewCandidate();
+    c->key = "key";
+    c->value = std::string(value);
+    return filter->FilterCandidate(convreq, "key", c, nodes, nodes);
+  };
+
+  // More candidates than the kept capacity of the seen set, so that the
+  // memory reused after Reset() has held other values.
+  constexpr int kSize = 300;
+  for (int i = 0; i < kSize; ++i) {
+    EXPECT_EQ(filter_value(absl::StrFormat("value%d", i)),
+              CandidateFilter::GOOD_CANDIDATE);
+  }
+
+  for (int round = 0; round < 2; ++round) {
+    filter->Reset();
+    // The candidates seen before Reset() are accepted again, once.
+    for (int i = kSize - 1; i >= 0; --i) {
+      const std::string value = absl::StrFormat("value%d", i);
+      EXPECT_EQ(filter_value(value), CandidateFilter::GOOD_CANDIDATE) << value;
+      EXPECT_EQ(filter_value(value), CandidateFilter::BAD_CANDIDATE) << value;
+    }
+    EXPECT_EQ(filter_value("new"), CandidateFilter::GOOD_CANDIDATE);
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(TestForRequest, CandidateFilterTestWithParam,
                          ::testing::ValuesIn(kRequestTypes),
                          RequestParamToString);
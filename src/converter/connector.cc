@@ -29,6 +29,7 @@
 
 #include "converter/connector.h"
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <limits>
@@ -38,7 +39,6 @@
 #include <utility>
 #include <vector>
 
-#include "absl/algorithm/container.h"
 #include "absl/base/attributes.h"
 #include "absl/base/const_init.h"
 #include "absl/status/status.h"
@@ -70,6 +70,12 @@ inline uint32_t EncodeKey(uint16_t rid, uint16_t lid) {
   return (static_cast<uint32_t>(rid) << 16) | lid;
 }
 
+// Packs the key and the cost into one word so that a cache entry can be read
+// and written atomically.
+inline uint64_t EncodeCacheEntry(uint32_t key, int value) {
+  return (static_cast<uint64_t>(key) << 32) | static_cast<uint32_t>(value);
+}
+
 absl::Status IsMemoryAligned32(const void *ptr) {
   const auto addr = reinterpret_cast<std::uintptr_t>(ptr);
   const auto alignment = addr % 4;
@@ -200,8 +206,7 @@ absl::Status Connector::Init(absl::string_view connection_data,
         "connector.cc: Cache size must be 2^n: size=", cache_size));
   }
   cache_hash_mask_ = cache_size - 1;
-  cache_key_.resize(cache_size);
-  cache_value_.resize(cache_size);
+  cache_ = std::vector<std::atomic<uint64_t>>(cache_size);
 
   absl::StatusOr<Metadata> metadata =
       ParseMetadata(connection_data.data(), connection_data.size());
@@ -308,16 +313,24 @@ absl::Status Connector::Init(absl::string_view connection_data,
 int Connector::GetTransitionCost(uint16_t rid, uint16_t lid) const {
   const uint32_t index = EncodeKey(rid, lid);
   const uint32_t bucket = GetHashValue(rid, lid, cache_hash_mask_);
-  if (cache_key_[bucket] == index) {
-    return cache_value_[bucket];
+  // Relaxed ordering is enough: the cost is a pure function of the key and the
+  // immutable connection data, and the entry carries both.
+  const uint64_t entry = cache_[bucket].load(std::memory_order_relaxed);
+  if (static_cast<uint32_t>(entry >> 32) == index) {
+    return static_cast<int32_t>(static_cast<uint32_t>(entry));
   }
   const int value = LookupCost(rid, lid);
-  cache_key_[bucket] = index;
-  cache_value_[bucket] = value;
+  cache_[bucket].store(EncodeCacheEntry(index, value),
+                       std::memory_order_relaxed);
   return value;
 }
 
-void Connector::ClearCache() { absl::c_fill(cache_key_, kInvalidCacheKey); }
+void Connector::ClearCache() {
+  for (std::atomic<uint64_t> &entry : cache_) {
+    entry.store(EncodeCacheEntry(kInvalidCacheKey, 0),
+                std::memory_order_relaxed);
+  }
+}
 
 int Connector::LookupCost(uint16_t rid, uint16_t lid) const {
   std::optional<uint16_t> value = rows_[rid].GetValue(lid);
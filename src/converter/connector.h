@@ -30,6 +30,7 @@
 #ifndef MOZC_CONVERTER_CONNECTOR_H_
 #define MOZC_CONVERTER_CONNECTOR_H_
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <optional>
@@ -42,6 +43,11 @@
 
 namespace mozc {
 
+// Thread safety: all const methods, including GetTransitionCost(), may be
+// called concurrently from multiple threads. The transition cost cache is a
+// table of atomic words, each of which packs a key and its cost, so a reader
+// either sees a complete entry or misses. ClearCache() is also safe to call
+// concurrently; it only causes misses.
 class Connector final {
  public:
   static constexpr int16_t kInvalidCost = 30000;
@@ -68,8 +74,8 @@ class Connector final {
   const uint16_t *default_cost_ = nullptr;
   int resolution_ = 0;
   uint32_t cache_hash_mask_ = 0;
-  mutable std::vector<uint32_t> cache_key_;
-  mutable std::vector<int> cache_value_;
+  // Each entry holds (key << 32 | cost). See GetTransitionCost().
+  mutable std::vector<std::atomic<uint64_t>> cache_;
 };
 
 class Connector::Row final {
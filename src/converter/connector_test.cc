@@ -39,6 +39,7 @@
 #include "absl/random/random.h"
 #include "absl/status/statusor.h"
 #include "base/mmap.h"
+#include "base/thread.h"
 #include "base/vlog.h"
 #include "data_manager/connection_file_reader.h"
 #include "testing/gmock.h"
@@ -92,6 +93,48 @@ TEST(ConnectorTest, CompareWithRawData) {
   }
 }
 
+TEST(ConnectorTest, ConcurrentLookup) {
+  const std::string path = testing::GetSourceFileOrDie(
+      {MOZC_SRC_COMPONENTS("data_manager"), "testing", "connection.data"});
+  absl::StatusOr<Mmap> cmmap = Mmap::Map(path);
+  ASSERT_OK(cmmap) << cmmap.status();
+  // A small cache makes the threads collide on the same buckets.
+  auto status_or_connector = Connector::Create(cmmap->string_view(), 64);
+  ASSERT_OK(status_or_connector);
+  const Connector connector = std::move(status_or_connector).value();
+
+  const std::string connection_text_path = testing::GetSourceFileOrDie(
+      {MOZC_DICT_DIR_COMPONENTS, "test", "dictionary",
+       "connection_single_column.txt"});
+  std::vector<ConnectionDataEntry> data;
+  for (ConnectionFileReader reader(connection_text_path); !reader.done();
+       reader.Next()) {
+    ConnectionDataEntry entry;
+    entry.rid = reader.rid_of_left_node();
+    entry.lid = reader.lid_of_right_node();
+    entry.cost = reader.cost();
+    data.push_back(entry);
+  }
+  // Every thread checks a different sample so that they race on the cache.
+  constexpr size_t kNumThreads = 4;
+  constexpr size_t kNumLookups = 100000;
+  std::vector<Thread> threads;
+  for (size_t t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&connector, &data] {
+      absl::BitGen urbg;
+      for (size_t i = 0; i < kNumLookups; ++i) {
+        const ConnectionDataEntry &entry =
+            data[absl::Uniform<size_t>(urbg, 0, data.size())];
+        ASSERT_EQ(connector.GetTransitionCost(entry.rid, entry.lid),
+                  entry.cost);
+      }
+    });
+  }
+  for (Thread &thread : threads) {
+    thread.Join();
+  }
+}
+
 TEST(ConnectorTest, BrokenData) {
   const std::string path = testing::GetSourceFileOrDie(
       {MOZC_SRC_COMPONENTS("data_manager"), "testing", "connection.data"});
@@ -45,6 +45,7 @@
         'nbest_generator_test.cc',
         'segments_matchers_test.cc',
         'segments_test.cc',
+        'viterbi_kernel_test.cc',
       ],
       'dependencies': [
         '<(mozc_oss_src_dir)/base/absl.gyp:absl_strings',
@@ -63,6 +63,7 @@
 #include "converter/node_list_builder.h"
 #include "converter/segmenter.h"
 #include "converter/segments.h"
+#include "converter/viterbi_kernel.h"
 #include "dictionary/dictionary_interface.h"
 #include "dictionary/dictionary_token.h"
 #include "dictionary/pos_group.h"
@@ -967,13 +968,71 @@ class CachingConnector final {
 // calculated based on kVeryBigCost.
 constexpr int kVeryBigCost = (INT_MAX >> 2);
 
+// Viterbi-relevant fields of the valid nodes ending at a position, stored in
+// contiguous arrays. The left nodes are scanned once for every right node, so
+// reading them from the arrays instead of following |enext| through the nodes
+// keeps the inner loop within a few cache lines.
+class LeftNodes {
+ public:
+  // Collects the valid nodes ending at |pos|.
+  void Collect(const Lattice &lattice, size_t pos) {
+    costs_.clear();
+    rids_.clear();
+    nodes_.clear();
+    transition_costs_lid_ = kNoLid;
+    for (Node *lnode = lattice.end_nodes(pos); lnode != nullptr;
+         lnode = lnode->enext) {
+      if (lnode->prev == nullptr) {
+        // Invalid lnode.
+        continue;
+      }
+      costs_.push_back(lnode->cost);
+      rids_.push_back(lnode->rid);
+      nodes_.push_back(lnode);
+    }
+  }
+
+  // Finds the node which connects to |rnode_lid| with minimum cost. Returns
+  // kVeryBigCost and nullptr if no node is available.
+  std::pair<int, Node *> FindBest(CachingConnector &conn, uint16_t rnode_lid) {
+    // Right nodes are mostly ordered by lid, so the transition costs gathered
+    // for the previous right node are often reusable as is.
+    if (transition_costs_lid_ != rnode_lid) {
+      transition_costs_.resize(rids_.size());
+      for (size_t i = 0; i < rids_.size(); ++i) {
+        transition_costs_[i] = conn.GetTransitionCost(rids_[i], rnode_lid);
+      }
+      transition_costs_lid_ = rnode_lid;
+    }
+    int best_cost;
+    const size_t best_index =
+        converter::FindMinCostIndex(costs_, transition_costs_, &best_cost);
+    if (best_index == nodes_.size() || best_cost >= kVeryBigCost) {
+      return {kVeryBigCost, nullptr};
+    }
+    return {best_cost, nodes_[best_index]};
+  }
+
+ private:
+  static constexpr int kNoLid = -1;
+
+  std::vector<int> costs_;
+  std::vector<uint16_t> rids_;
+  std::vector<Node *> nodes_;
+  // Transition costs from |rids_| to |transition_costs_lid_|.
+  std::vector<int> transition_costs_;
+  int transition_costs_lid_ = kNoLid;
+};
+
 // Runs viterbi algorithm at position |pos|. The left_boundary/right_boundary
 // are the next boundary looked from pos. (If pos is on the boundary,
 // left_boundary should be the previous one, and right_boundary should be
-// the next).
+// the next). |left_nodes| is a buffer reused across the positions.
 inline void ViterbiInternal(const Connector &connector, size_t pos,
-                            size_t right_boundary, Lattice *lattice) {
+                            size_t right_boundary, Lattice *lattice,
+                            LeftNodes *left_nodes) {
   CachingConnector conn(connector);
+  left_nodes->Collect(*lattice, pos);
   for (Node *rnode = lattice->begin_nodes(pos); rnode != nullptr;
        rnode = rnode->bnext) {
     if (rnode->end_pos > right_boundary) {
@@ -997,22 +1056,8 @@ inline void ViterbiInternal(const Connector &connector, size_t pos,
     }
 
     // Find a valid node which connects to the rnode with minimum cost.
-    int best_cost = kVeryBigCost;
-    Node *best_node = nullptr;
-    for (Node *lnode = lattice->end_nodes(pos); lnode != nullptr;
-         lnode = lnode->enext) {
-      if (lnode->prev == nullptr) {
-        // Invalid lnode.
-        continue;
-      }
-
-      int cost = lnode->cost + conn.GetTransitionCost(lnode->rid, rnode->lid);
-      if (cost < best_cost) {
-        best_cost = cost;
-        best_node = lnode;
-      }
-    }
-
+    const auto [best_cost, best_node] =
+        left_nodes->FindBest(conn, rnode->lid);
     rnode->prev = best_node;
     rnode->cost = best_cost + rnode->wcost;
   }
@@ -1049,6 +1094,7 @@ bool ImmutableConverter::Viterbi(const Segments &segments,
   }
 
   size_t left_boundary = 0;
+  LeftNodes left_nodes;
 
   // Specialization for the first segment.
   // Don't run on the left boundary (the connection with BOS node),
@@ -1057,7 +1103,7 @@ bool ImmutableConverter::Viterbi(const Segments &segments,
     const size_t right_boundary =
         left_boundary + segments.segment(0).key().size();
     for (size_t pos = left_boundary + 1; pos < right_boundary; ++pos) {
-      ViterbiInternal(connector_, pos, right_boundary, lattice);
+      ViterbiInternal(connector_, pos, right_boundary, lattice, &left_nodes);
     }
     left_boundary = right_boundary;
   }
@@ -1067,7 +1113,7 @@ bool ImmutableConverter::Viterbi(const Segments &segments,
     // Run Viterbi for each position the segment.
     const size_t right_boundary = left_boundary + segment.key().size();
     for (size_t pos = left_boundary; pos < right_boundary; ++pos) {
-      ViterbiInternal(connector_, pos, right_boundary, lattice);
+      ViterbiInternal(connector_, pos, right_boundary, lattice, &left_nodes);
     }
     left_boundary = right_boundary;
   }
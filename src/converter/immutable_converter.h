@@ -79,6 +79,7 @@ class ImmutableConverter : public ImmutableConverterInterface {
   FRIEND_TEST(NBestGeneratorTest, NoPartialCandidateBetweenAlphabets);
   FRIEND_TEST(NBestGeneratorTest, NoAlphabetsConnection2Nodes);
   FRIEND_TEST(NBestGeneratorTest, NoAlphabetsConnection3Nodes);
+  FRIEND_TEST(NBestGeneratorTest, CacheExpansions);
   friend class NBestGeneratorTest;
 
   enum InsertCandidatesType {
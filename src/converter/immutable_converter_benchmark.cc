@@ -0,0 +1,136 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Measures whole-sentence conversion of long inputs.
+//
+// immutable_converter_benchmark
+//  --engine_data_path=mozc.data --lengths=20,50,100,200 --iterations=100
+//
+// For each input length, converts a hiragana sentence of that many characters
+// and prints the time per conversion, which includes building the lattice,
+// the Viterbi search and the N-best generation.
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/flags/flag.h"
+#include "absl/log/check.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "base/init_mozc.h"
+#include "base/stopwatch.h"
+#include "base/util.h"
+#include "converter/immutable_converter.h"
+#include "converter/segments.h"
+#include "data_manager/data_manager.h"
+#include "engine/modules.h"
+#include "request/conversion_request.h"
+
+ABSL_FLAG(std::string, engine_data_path, "", "path to engine data file");
+ABSL_FLAG(std::string, magic, "", "expected magic number of data file");
+ABSL_FLAG(std::string, lengths, "20,50,100,200",
+          "comma separated numbers of input characters");
+ABSL_FLAG(int32_t, iterations, 100, "number of conversions per length");
+
+namespace mozc {
+namespace {
+
+constexpr absl::string_view kSentence =
+    "きょうはいいてんきなので"
+    "ともだちとこうえんにさんぽにいきました"
+    "わたしのなまえはなかのです"
+    "よろしくおねがいします";
+
+// Returns the first |length| characters of kSentence repeated.
+std::string MakeInput(size_t length) {
+  const size_t sentence_length = Util::CharsLen(kSentence);
+  std::string input;
+  for (; length >= sentence_length; length -= sentence_length) {
+    input.append(kSentence);
+  }
+  input.append(Util::Utf8SubString(kSentence, 0, length));
+  return input;
+}
+
+void RunBenchmark(const ImmutableConverter &converter, size_t length,
+                  int iterations) {
+  const std::string input = MakeInput(length);
+  const ConversionRequest request;
+  // Accumulates the results so that the conversions cannot be optimized away.
+  size_t num_segments = 0;
+  Stopwatch stopwatch = Stopwatch::StartNew();
+  for (int i = 0; i < iterations; ++i) {
+    Segments segments;
+    segments.add_segment()->set_key(input);
+    CHECK(converter.ConvertForRequest(request, &segments)) << input;
+    num_segments += segments.segments_size();
+  }
+  stopwatch.Stop();
+  std::cout << absl::StreamFormat(
+      "length=%4d  %10.1f us/conversion  (%d segments)\n", length,
+      absl::ToDoubleMicroseconds(stopwatch.GetElapsed()) / iterations,
+      num_segments / iterations);
+}
+
+}  // namespace
+}  // namespace mozc
+
+int main(int argc, char **argv) {
+  mozc::InitMozc(argv[0], &argc, &argv);
+
+  absl::StatusOr<std::unique_ptr<mozc::DataManager>> data_manager =
+      absl::GetFlag(FLAGS_magic).empty()
+          ? mozc::DataManager::CreateFromFile(
+                absl::GetFlag(FLAGS_engine_data_path))
+          : mozc::DataManager::CreateFromFile(
+                absl::GetFlag(FLAGS_engine_data_path),
+                absl::GetFlag(FLAGS_magic));
+  CHECK_OK(data_manager);
+
+  mozc::engine::Modules modules;
+  CHECK_OK(modules.Init(*std::move(data_manager)));
+  const mozc::ImmutableConverter converter(modules);
+
+  const int iterations = absl::GetFlag(FLAGS_iterations);
+  for (absl::string_view length_str :
+       absl::StrSplit(absl::GetFlag(FLAGS_lengths), ',', absl::SkipEmpty())) {
+    size_t length = 0;
+    CHECK(absl::SimpleAtoi(length_str, &length)) << length_str;
+    mozc::RunBenchmark(converter, length, iterations);
+  }
+  return 0;
+}
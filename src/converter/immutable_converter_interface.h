@@ -38,6 +38,7 @@ namespace mozc {
 
 // Perform one-shot conversion with constraints.
 // Constraints are encoded in |segments|
+// ConvertForRequest() may be called concurrently for different |segments|.
 class ImmutableConverterInterface {
  public:
   virtual ~ImmutableConverterInterface() = default;
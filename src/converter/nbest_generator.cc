@@ -33,7 +33,9 @@
 #include <cstdint>
 #include <cstdlib>
 #include <iterator>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/base/nullability.h"
@@ -133,6 +135,9 @@ void NBestGenerator::Reset(absl::Nonnull<const Node *> begin_node,
   filter_.Reset();
   viterbi_result_checked_ = false;
   options_ = options;
+  stats_ = Stats();
+  expansion_ranges_.clear();
+  expansions_.clear();
 
   begin_node_ = begin_node;
   end_node_ = end_node;
@@ -339,6 +344,12 @@ void NBestGenerator::SetCandidates(const ConversionRequest &request,
       break;
     }
   }
+  MOZC_VLOG(2) << "pops: " << stats_.num_pops
+               << " pushes: " << stats_.num_pushes
+               << " expansion computations: "
+               << stats_.num_expansion_computations
+               << " good candidates: " << stats_.num_good_candidates
+               << " bad candidates: " << stats_.num_bad_candidates;
 #ifdef MOZC_CANDIDATE_DEBUG
   // Append moved bad_candidates_ to segment->removed_candidates_for_debug_.
   segment->removed_candidates_for_debug_.insert(
@@ -385,6 +396,7 @@ bool NBestGenerator::Next(const ConversionRequest &request,
     // Viterbi-best path.
     switch (InsertTopResult(request, original_key, candidate)) {
       case CandidateFilter::GOOD_CANDIDATE:
+        ++stats_.num_good_candidates;
         return true;
       case CandidateFilter::STOP_ENUMERATION:
         return false;
@@ -400,12 +412,19 @@ bool NBestGenerator::Next(const ConversionRequest &request,
     }
   }
 
+  // The heuristic h(x) is the exact Viterbi cost from BOS, so complete paths
+  // are popped in the order of their costs and the search returns at the
+  // first accepted one. No tighter cost bound can stop the search earlier
+  // without changing the results: CandidateFilter also rejects candidates by
+  // structure cost, POS and duplicates, so a path costlier than a rejected
+  // one may still be accepted.
   const int KMaxTrial = 500;
   int num_trials = 0;
 
   while (!agenda_.IsEmpty()) {
     absl::Nonnull<const QueueElement *> top = agenda_.Top();
     agenda_.Pop();
+    ++stats_.num_pops;
     absl::Nonnull<const Node *> rnode = top->node;
 
     if (num_trials++ > KMaxTrial) {  // too many trials
@@ -420,10 +439,12 @@ bool NBestGenerator::Next(const ConversionRequest &request,
 
       switch (filter_result) {
         case CandidateFilter::GOOD_CANDIDATE:
+          ++stats_.num_good_candidates;
           return true;
         case CandidateFilter::STOP_ENUMERATION:
           return false;
         case CandidateFilter::BAD_CANDIDATE:
+          ++stats_.num_bad_candidates;
 #ifdef MOZC_CANDIDATE_DEBUG
           bad_candidates_.push_back(candidate);
           break;
@@ -437,120 +458,155 @@ bool NBestGenerator::Next(const ConversionRequest &request,
 
     DCHECK_NE(rnode->end_pos, begin_node_->end_pos);
 
-    const QueueElement *best_left_elm = nullptr;
-    const bool is_right_edge = rnode->begin_pos == end_node_->begin_pos;
-    const bool is_left_edge = rnode->begin_pos == begin_node_->end_pos;
-    DCHECK(!(is_right_edge && is_left_edge));
-
-    // is_edge is true if current lnode/rnode has same boundary as
-    // begin/end node regardless of its value.
-    const bool is_edge = (is_right_edge || is_left_edge);
-
-    for (Node *lnode = lattice_->end_nodes(rnode->begin_pos); lnode != nullptr;
-         lnode = lnode->enext) {
-      // is_invalid_position is true if the lnode's location is invalid
-      //  1.   |<-- begin_node_-->|
-      //                    |<--lnode-->|  <== overlapped.
-      //
-      //  2.   |<-- begin_node_-->|
-      //         |<--lnode-->|    <== exceeds begin_node.
-      // This case can't be happened because the |rnode| is always at just
-      // right of the |lnode|. By avoiding case1, this can't be happen.
-      //  2'.  |<-- begin_node_-->|
-      //         |<--lnode-->||<--rnode-->|
-      const bool is_valid_position =
-          !((lnode->begin_pos < begin_node_->end_pos &&
-             begin_node_->end_pos < lnode->end_pos));
-      if (!is_valid_position) {
-        continue;
-      }
+    for (const Expansion &expansion : GetExpansions(*rnode)) {
+      const int32_t gx = expansion.cost_diff + top->gx;
+      // |lnode->cost| is heuristics function of A* search, h(x).
+      // After Viterbi search, we already know an exact value of h(x).
+      // f(x) = h(x) + g(x): cost for the path
+      const int32_t fx = expansion.lnode->cost + gx;
+      const int32_t structure_gx =
+          expansion.structure_cost_diff + top->structure_gx;
+      const int32_t w_gx = expansion.wcost_diff + top->w_gx;
+      agenda_.Push(
+          CreateNewElement(expansion.lnode, top, fx, gx, structure_gx, w_gx));
+      ++stats_.num_pushes;
+    }
+  }
 
-      // If left_node is left edge, there is a cost-based constraint.
-      const bool is_valid_cost = (lnode->cost - begin_node_->cost) <= kCostDiff;
-      if (is_left_edge && !is_valid_cost) {
-        continue;
-      }
+  return false;
+}
 
-      // We can omit the search for the node which has the
-      // same rid with |begin_node_| because:
-      //  1. |begin_node_| is the part of the best route.
-      //  2. The cost diff of 'LEFT_EDGE' is decided only by
-      //     transition_cost for lnode.
-      // Actually, checking for each rid once is enough.
-      const bool can_omit_search =
-          lnode->rid == begin_node_->rid && lnode != begin_node_;
-      if (is_left_edge && can_omit_search) {
-        continue;
-      }
+absl::Span<const NBestGenerator::Expansion> NBestGenerator::GetExpansions(
+    const Node &rnode) {
+  if (!options_.cache_expansions) {
+    expansions_.clear();
+    ComputeExpansions(rnode, expansions_);
+    ++stats_.num_expansion_computations;
+    return expansions_;
+  }
 
-      const BoundaryCheckResult boundary_result =
-          BoundaryCheck(*lnode, *rnode, is_edge);
-      if (boundary_result == INVALID) {
-        continue;
-      }
+  const auto [it, inserted] = expansion_ranges_.try_emplace(&rnode);
+  if (inserted) {
+    const uint32_t begin = expansions_.size();
+    ComputeExpansions(rnode, expansions_);
+    ++stats_.num_expansion_computations;
+    it->second = {begin, expansions_.size()};
+  }
+  const auto [begin, end] = it->second;
+  return absl::MakeConstSpan(expansions_).subspan(begin, end - begin);
+}
 
-      // We can expand candidates from |rnode| to |lnode|.
-      const int transition_cost = GetTransitionCost(*lnode, *rnode);
-
-      // How likely the costs get increased after expanding rnode.
-      int cost_diff = 0;
-      int structure_cost_diff = 0;
-      int wcost_diff = 0;
-
-      if (is_right_edge) {
-        // use |rnode->cost - end_node_->cost| is an approximation
-        // of marginalized word cost.
-        cost_diff = transition_cost + (rnode->cost - end_node_->cost);
-        structure_cost_diff = 0;
-        wcost_diff = 0;
-      } else if (is_left_edge) {
-        // use |lnode->cost - begin_node_->cost| is an approximation
-        // of marginalized word cost.
-        cost_diff =
-            transition_cost + rnode->wcost + (lnode->cost - begin_node_->cost);
-        structure_cost_diff = 0;
-        wcost_diff = rnode->wcost;
-      } else {
-        // use rnode->wcost.
-        cost_diff = transition_cost + rnode->wcost;
-        structure_cost_diff = transition_cost;
-        wcost_diff = transition_cost + rnode->wcost;
-      }
+void NBestGenerator::ComputeExpansions(
+    const Node &rnode, std::vector<Expansion> &expansions) const {
+  const bool is_right_edge = rnode.begin_pos == end_node_->begin_pos;
+  const bool is_left_edge = rnode.begin_pos == begin_node_->end_pos;
+  DCHECK(!(is_right_edge && is_left_edge));
+
+  // is_edge is true if current lnode/rnode has same boundary as
+  // begin/end node regardless of its value.
+  const bool is_edge = (is_right_edge || is_left_edge);
+
+  // For the left edge, only the best left node is kept. See below.
+  std::optional<Expansion> best_left_expansion;
+
+  for (Node *lnode = lattice_->end_nodes(rnode.begin_pos); lnode != nullptr;
+       lnode = lnode->enext) {
+    // is_invalid_position is true if the lnode's location is invalid
+    //  1.   |<-- begin_node_-->|
+    //                    |<--lnode-->|  <== overlapped.
+    //
+    //  2.   |<-- begin_node_-->|
+    //         |<--lnode-->|    <== exceeds begin_node.
+    // This case can't be happened because the |rnode| is always at just
+    // right of the |lnode|. By avoiding case1, this can't be happen.
+    //  2'.  |<-- begin_node_-->|
+    //         |<--lnode-->||<--rnode-->|
+    const bool is_valid_position =
+        !((lnode->begin_pos < begin_node_->end_pos &&
+           begin_node_->end_pos < lnode->end_pos));
+    if (!is_valid_position) {
+      continue;
+    }
 
-      if (boundary_result == VALID_WEAK_CONNECTED) {
-        constexpr int kWeakConnectedPenalty = 3453;  // log prob of 1/1000
-        cost_diff += kWeakConnectedPenalty;
-        structure_cost_diff += kWeakConnectedPenalty / 2;
-        wcost_diff += kWeakConnectedPenalty / 2;
-      }
+    // If left_node is left edge, there is a cost-based constraint.
+    const bool is_valid_cost = (lnode->cost - begin_node_->cost) <= kCostDiff;
+    if (is_left_edge && !is_valid_cost) {
+      continue;
+    }
 
-      const int32_t gx = cost_diff + top->gx;
-      // |lnode->cost| is heuristics function of A* search, h(x).
-      // After Viterbi search, we already know an exact value of h(x).
-      // f(x) = h(x) + g(x): cost for the path
-      const int32_t fx = lnode->cost + gx;
-      const int32_t structure_gx = structure_cost_diff + top->structure_gx;
-      const int32_t w_gx = wcost_diff + top->w_gx;
-      if (is_left_edge) {
-        // We only need to only 1 left node here.
-        // Even if expand all left nodes, all the |value| part should
-        // be identical. Here, we simply use the best left edge node.
-        // This hack reduces the number of redundant calls of pop().
-        if (best_left_elm == nullptr || best_left_elm->fx > fx) {
-          best_left_elm =
-              CreateNewElement(lnode, top, fx, gx, structure_gx, w_gx);
-        }
-      } else {
-        agenda_.Push(CreateNewElement(lnode, top, fx, gx, structure_gx, w_gx));
-      }
+    // We can omit the search for the node which has the
+    // same rid with |begin_node_| because:
+    //  1. |begin_node_| is the part of the best route.
+    //  2. The cost diff of 'LEFT_EDGE' is decided only by
+    //     transition_cost for lnode.
+    // Actually, checking for each rid once is enough.
+    const bool can_omit_search =
+        lnode->rid == begin_node_->rid && lnode != begin_node_;
+    if (is_left_edge && can_omit_search) {
+      continue;
+    }
+
+    const BoundaryCheckResult boundary_result =
+        BoundaryCheck(*lnode, rnode, is_edge);
+    if (boundary_result == INVALID) {
+      continue;
     }
 
-    if (best_left_elm != nullptr) {
-      agenda_.Push(best_left_elm);
+    // We can expand candidates from |rnode| to |lnode|.
+    const int transition_cost = GetTransitionCost(*lnode, rnode);
+
+    // How likely the costs get increased after expanding rnode.
+    int cost_diff = 0;
+    int structure_cost_diff = 0;
+    int wcost_diff = 0;
+
+    if (is_right_edge) {
+      // use |rnode.cost - end_node_->cost| is an approximation
+      // of marginalized word cost.
+      cost_diff = transition_cost + (rnode.cost - end_node_->cost);
+      structure_cost_diff = 0;
+      wcost_diff = 0;
+    } else if (is_left_edge) {
+      // use |lnode->cost - begin_node_->cost| is an approximation
+      // of marginalized word cost.
+      cost_diff =
+          transition_cost + rnode.wcost + (lnode->cost - begin_node_->cost);
+      structure_cost_diff = 0;
+      wcost_diff = rnode.wcost;
+    } else {
+      // use rnode.wcost.
+      cost_diff = transition_cost + rnode.wcost;
+      structure_cost_diff = transition_cost;
+      wcost_diff = transition_cost + rnode.wcost;
+    }
+
+    if (boundary_result == VALID_WEAK_CONNECTED) {
+      constexpr int kWeakConnectedPenalty = 3453;  // log prob of 1/1000
+      cost_diff += kWeakConnectedPenalty;
+      structure_cost_diff += kWeakConnectedPenalty / 2;
+      wcost_diff += kWeakConnectedPenalty / 2;
+    }
+
+    const Expansion expansion = {lnode, cost_diff, structure_cost_diff,
+                                 wcost_diff};
+    if (is_left_edge) {
+      // We only need to only 1 left node here.
+      // Even if expand all left nodes, all the |value| part should
+      // be identical. Here, we simply use the best left edge node.
+      // This hack reduces the number of redundant calls of pop().
+      if (!best_left_expansion.has_value() ||
+          best_left_expansion->lnode->cost + best_left_expansion->cost_diff >
+              lnode->cost + cost_diff) {
+        best_left_expansion = expansion;
+      }
+    } else {
+      expansions.push_back(expansion);
     }
   }
 
-  return false;
+  if (best_left_expansion.has_value()) {
+    expansions.push_back(*best_left_expansion);
+  }
 }
 
 NBestGenerator::BoundaryCheckResult NBestGenerator::BoundaryCheck(
@@ -33,9 +33,11 @@
 #include <cstddef>
 #include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/base/nullability.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/types/span.h"
 #include "base/container/freelist.h"
 #include "converter/candidate_filter.h"
@@ -95,6 +97,24 @@ class NBestGenerator {
   struct Options {
     BoundaryCheckMode boundary_mode = STRICT;
     uint32_t candidate_mode = CANDIDATE_MODE_NONE;
+    // If true, the expansions from a node (boundary checks and transition
+    // costs to its left nodes) are computed only once per Reset() and reused
+    // whenever the node is popped from the agenda again. The results are the
+    // same in both modes.
+    bool cache_expansions = true;
+  };
+
+  // Counters of the search since the last Reset().
+  struct Stats {
+    // The number of elements popped from the agenda.
+    size_t num_pops = 0;
+    // The number of elements pushed to the agenda.
+    size_t num_pushes = 0;
+    // The number of times the expansions of a node were computed.
+    size_t num_expansion_computations = 0;
+    // The number of candidates accepted and rejected by the filter.
+    size_t num_good_candidates = 0;
+    size_t num_bad_candidates = 0;
   };
 
   // Try to enumerate N-best results between begin_node and end_node.
@@ -116,6 +136,8 @@ class NBestGenerator {
                      const std::string &original_key, size_t expand_size,
                      absl::Nonnull<Segment *> segment);
 
+  const Stats &stats() const { return stats_; }
+
  private:
   enum BoundaryCheckResult {
     VALID = 0,
@@ -144,6 +166,16 @@ class NBestGenerator {
     }
   };
 
+  // An expansion from the right node of an agenda element to one of its left
+  // nodes. Only the valid expansions are kept, and the costs depend only on
+  // the pair of the nodes.
+  struct Expansion {
+    absl::Nonnull<const Node *> lnode;
+    int32_t cost_diff;
+    int32_t structure_cost_diff;
+    int32_t wcost_diff;
+  };
+
   // This is just a priority_queue of const QueueElement*, but supports
   // more operations in addition to std::priority_queue.
   class Agenda {
@@ -204,6 +236,12 @@ class NBestGenerator {
 
   int GetTransitionCost(const Node &lnode, const Node &rnode) const;
 
+  // Returns the valid expansions from |rnode|. The returned span is valid
+  // until the next call.
+  absl::Span<const Expansion> GetExpansions(const Node &rnode);
+  void ComputeExpansions(const Node &rnode,
+                         std::vector<Expansion> &expansions) const;
+
   // Create queue element from freelist
   absl::Nonnull<const QueueElement *> CreateNewElement(
       absl::Nonnull<const Node *> node,
@@ -226,6 +264,13 @@ class NBestGenerator {
   converter::CandidateFilter filter_;
   bool viterbi_result_checked_ = false;
   Options options_;
+  Stats stats_;
+
+  // Expansions cached by right node. The value is the [begin, end) range in
+  // |expansions_|.
+  absl::flat_hash_map<const Node *, std::pair<uint32_t, uint32_t>>
+      expansion_ranges_;
+  std::vector<Expansion> expansions_;
 
 #ifdef MOZC_CANDIDATE_DEBUG
   std::vector<Segment::Candidate> bad_candidates_;
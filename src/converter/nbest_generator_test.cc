@@ -421,4 +421,71 @@ TEST_F(NBestGeneratorTest, NoAlphabetsConnection3Nodes) {
   }
 }
 
+TEST_F(NBestGeneratorTest, CacheExpansions) {
+  auto data_and_converter = std::make_unique<MockDataAndImmutableConverter>();
+  ImmutableConverter *converter = data_and_converter->GetConverter();
+
+  Segments segments;
+  std::string kText = "わたしのなまえはなかのです";
+  {
+    Segment *segment = segments.add_segment();
+    segment->set_segment_type(Segment::FREE);
+    segment->set_key(kText);
+  }
+
+  Lattice lattice;
+  lattice.SetKey(kText);
+  const ConversionRequest request = ConvReq(ConversionRequest::CONVERSION);
+  converter->MakeLattice(request, &segments, &lattice);
+
+  std::vector<uint16_t> group;
+  converter->MakeGroup(segments, &group);
+  converter->Viterbi(segments, &lattice);
+
+  std::unique_ptr<NBestGenerator> nbest_generator =
+      data_and_converter->CreateNBestGenerator(&lattice);
+
+  constexpr bool kSingleSegment = true;  // For real time conversion
+  const Node *begin_node = lattice.bos_nodes();
+  const Node *end_node = GetEndNode(request, *converter, segments, *begin_node,
+                                    group, kSingleSegment);
+
+  NBestGenerator::Options options = {
+      .boundary_mode = NBestGenerator::ONLY_EDGE,
+      .candidate_mode = NBestGenerator::FILL_INNER_SEGMENT_INFO,
+      .cache_expansions = false,
+  };
+  nbest_generator->Reset(begin_node, end_node, options);
+  Segment expected_segment;
+  nbest_generator->SetCandidates(request, "", 50, &expected_segment);
+  const NBestGenerator::Stats expected_stats = nbest_generator->stats();
+  ASSERT_LT(1, expected_segment.candidates_size());
+  EXPECT_EQ(expected_stats.num_good_candidates,
+            expected_segment.candidates_size());
+
+  options.cache_expansions = true;
+  nbest_generator->Reset(begin_node, end_node, options);
+  Segment result_segment;
+  nbest_generator->SetCandidates(request, "", 50, &result_segment);
+  const NBestGenerator::Stats &stats = nbest_generator->stats();
+
+  // The cache doesn't change the search.
+  ASSERT_EQ(result_segment.candidates_size(),
+            expected_segment.candidates_size());
+  for (size_t i = 0; i < result_segment.candidates_size(); ++i) {
+    EXPECT_EQ(result_segment.candidate(i).value,
+              expected_segment.candidate(i).value);
+    EXPECT_EQ(result_segment.candidate(i).cost,
+              expected_segment.candidate(i).cost);
+  }
+  EXPECT_EQ(stats.num_pops, expected_stats.num_pops);
+  EXPECT_EQ(stats.num_pushes, expected_stats.num_pushes);
+  EXPECT_EQ(stats.num_good_candidates, expected_stats.num_good_candidates);
+  EXPECT_EQ(stats.num_bad_candidates, expected_stats.num_bad_candidates);
+
+  // But the expansions of a node are computed only once.
+  EXPECT_LT(stats.num_expansion_computations,
+            expected_stats.num_expansion_computations);
+}
+
 }  // namespace mozc
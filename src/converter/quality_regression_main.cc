@@ -27,8 +27,13 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <istream>
 #include <memory>
 #include <ostream>
 #include <string>
@@ -39,42 +44,198 @@
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "base/file/temp_dir.h"
+#include "base/file_stream.h"
 #include "base/init_mozc.h"
+#include "base/stopwatch.h"
 #include "base/system_util.h"
+#include "base/thread.h"
 #include "converter/quality_regression_util.h"
 #include "engine/engine.h"
 #include "engine/eval_engine_factory.h"
+#include "protocol/config.pb.h"
 
-ABSL_FLAG(std::vector<std::string>, test_files, {}, "regression test files");
+ABSL_FLAG(std::vector<std::string>, test_files, {},
+          "regression test files. Reads stdin if empty.");
 ABSL_FLAG(std::string, data_file, "", "engine data file");
 ABSL_FLAG(std::string, data_type, "", "engine data type");
 ABSL_FLAG(std::string, engine_type, "desktop", "engine type");
 ABSL_FLAG(std::string, output, "", "output file");
+ABSL_FLAG(int32_t, num_threads, 1,
+          "number of threads. Each thread has its own engine instance. The "
+          "user history is not learned when it is more than 1.");
+ABSL_FLAG(int32_t, chunk_size, 10000,
+          "number of test items read and evaluated at once");
+ABSL_FLAG(bool, print_stats, true,
+          "print the throughput and latency stats to stderr");
 
 namespace {
 
 using ::mozc::Engine;
+using ::mozc::Stopwatch;
 using ::mozc::TempDirectory;
 using ::mozc::quality_regression::QualityRegressionUtil;
 
-absl::Status Run(std::ostream &out, const Engine &engine,
-                 absl::Span<const QualityRegressionUtil::TestItem> items) {
-  QualityRegressionUtil util(engine.GetConverter());
-  for (const QualityRegressionUtil::TestItem &item : items) {
-    std::string actual_value;
-    const absl::StatusOr<bool> result =
-        util.ConvertAndTest(item, &actual_value);
-    if (!result.ok()) {
-      return result.status();
+struct ItemResult {
+  absl::Status status;
+  std::string line;
+  absl::Duration latency;
+};
+
+// Throughput and latency stats of the evaluation. Latencies are kept in a
+// histogram of power-of-two microsecond buckets so that the memory usage does
+// not depend on the size of the test set.
+class EvalStats {
+ public:
+  void Add(absl::Duration latency) {
+    const int64_t usec = absl::ToInt64Microseconds(latency);
+    size_t bucket = 0;
+    while (bucket + 1 < buckets_.size() && (int64_t{1} << bucket) <= usec) {
+      ++bucket;
+    }
+    ++buckets_[bucket];
+    ++num_items_;
+    total_ += latency;
+    max_ = std::max(max_, latency);
+  }
+
+  std::string ToString(absl::Duration elapsed) const {
+    const double seconds = absl::ToDoubleSeconds(elapsed);
+    return absl::StrFormat(
+        "items: %d, elapsed: %.3fs, throughput: %.1f items/s, "
+        "latency avg: %dus, p50: <%dus, p90: <%dus, p99: <%dus, max: %dus",
+        num_items_, seconds, seconds > 0 ? num_items_ / seconds : 0.0,
+        num_items_ > 0 ? absl::ToInt64Microseconds(total_ / num_items_) : 0,
+        Percentile(0.5), Percentile(0.9), Percentile(0.99),
+        absl::ToInt64Microseconds(max_));
+  }
+
+ private:
+  // Returns the upper bound of the bucket containing the |p|-th quantile.
+  int64_t Percentile(double p) const {
+    const uint64_t rank = static_cast<uint64_t>(p * num_items_);
+    uint64_t count = 0;
+    for (size_t i = 0; i < buckets_.size(); ++i) {
+      count += buckets_[i];
+      if (count > rank) {
+        return int64_t{1} << i;
+      }
+    }
+    return int64_t{1} << (buckets_.size() - 1);
+  }
+
+  std::array<uint64_t, 40> buckets_ = {};
+  uint64_t num_items_ = 0;
+  absl::Duration total_;
+  absl::Duration max_;
+};
+
+void Evaluate(QualityRegressionUtil &util,
+              const QualityRegressionUtil::TestItem &item,
+              ItemResult &result) {
+  const Stopwatch stopwatch = Stopwatch::StartNew();
+  std::string actual_value;
+  const absl::StatusOr<bool> ok = util.ConvertAndTest(item, &actual_value);
+  result.latency = stopwatch.GetElapsed();
+  if (!ok.ok()) {
+    result.status = ok.status();
+    return;
+  }
+  absl::StrAppend(&result.line, (ok.value() ? "OK:\t" : "FAILED:\t"),
+                  item.key, "\t", actual_value, "\t", item.command);
+  if (item.expected_rank != 0) {
+    absl::StrAppend(&result.line, " ", item.expected_rank);
+  }
+  absl::StrAppend(&result.line, "\t", item.expected_value, "\t\n");
+}
+
+// Evaluates |items| with |utils| in parallel and stores the result of
+// items[i] to results[i], so the output order doesn't depend on scheduling.
+// The k-th util evaluates the k-th contiguous block of |items|, so the
+// assignment doesn't depend on scheduling either.
+void EvaluateChunk(
+    absl::Span<const std::unique_ptr<QualityRegressionUtil>> utils,
+    absl::Span<const QualityRegressionUtil::TestItem> items,
+    absl::Span<ItemResult> results) {
+  auto worker = [&](size_t k) {
+    const size_t begin = items.size() * k / utils.size();
+    const size_t end = items.size() * (k + 1) / utils.size();
+    for (size_t i = begin; i < end; ++i) {
+      Evaluate(*utils[k], items[i], results[i]);
+    }
+  };
+  if (utils.size() == 1) {
+    worker(0);
+    return;
+  }
+  std::vector<mozc::Thread> threads;
+  threads.reserve(utils.size());
+  for (size_t k = 0; k < utils.size(); ++k) {
+    threads.emplace_back(worker, k);
+  }
+  for (mozc::Thread &thread : threads) {
+    thread.Join();
+  }
+}
+
+// Reads the test items from |is| chunk by chunk and writes the results to
+// |out| in the input order.
+absl::Status Run(std::istream &is, std::ostream &out,
+                 absl::Span<const std::unique_ptr<QualityRegressionUtil>> utils,
+                 EvalStats &stats) {
+  const size_t chunk_size = std::max(absl::GetFlag(FLAGS_chunk_size), 1);
+  std::vector<QualityRegressionUtil::TestItem> items;
+  std::vector<ItemResult> results;
+  while (true) {
+    items.clear();
+    if (absl::Status status =
+            QualityRegressionUtil::ParseStream(is, chunk_size, &items);
+        !status.ok()) {
+      return status;
+    }
+    if (items.empty()) {
+      return absl::OkStatus();
+    }
+    results.assign(items.size(), ItemResult());
+    EvaluateChunk(utils, items, absl::MakeSpan(results));
+    for (const ItemResult &result : results) {
+      if (!result.status.ok()) {
+        return result.status;
+      }
+      out << result.line;
+      stats.Add(result.latency);
+    }
+    out.flush();
+  }
+}
+
+absl::Status RunAll(
+    std::ostream &out,
+    absl::Span<const std::unique_ptr<QualityRegressionUtil>> utils) {
+  EvalStats stats;
+  const Stopwatch stopwatch = Stopwatch::StartNew();
+  const std::vector<std::string> test_files = absl::GetFlag(FLAGS_test_files);
+  if (test_files.empty()) {
+    if (absl::Status status = Run(std::cin, out, utils, stats); !status.ok()) {
+      return status;
+    }
+  }
+  for (const std::string &filename : test_files) {
+    mozc::InputFileStream ifs(filename);
+    if (!ifs.good()) {
+      return absl::UnavailableError(
+          absl::StrCat("Failed to read: ", filename));
     }
-    out << (result.value() ? "OK:\t" : "FAILED:\t") << item.key << "\t"
-        << actual_value << "\t" << item.command;
-    if (item.expected_rank != 0) {
-      out << " " << item.expected_rank;
+    if (absl::Status status = Run(ifs, out, utils, stats); !status.ok()) {
+      return status;
     }
-    out << "\t" << item.expected_value << "\t" << std::endl;
+  }
+  if (absl::GetFlag(FLAGS_print_stats)) {
+    std::cerr << stats.ToString(stopwatch.GetElapsed()) << std::endl;
   }
   return absl::OkStatus();
 }
@@ -88,29 +249,39 @@ int main(int argc, char **argv) {
   CHECK_OK(temp_dir);
   mozc::SystemUtil::SetUserProfileDirectory(temp_dir->path());
 
-  absl::StatusOr<std::unique_ptr<Engine>> create_result =
-      mozc::CreateEvalEngine(absl::GetFlag(FLAGS_data_file),
-                             absl::GetFlag(FLAGS_data_type),
-                             absl::GetFlag(FLAGS_engine_type));
-  if (!create_result.ok()) {
-    LOG(ERROR) << create_result.status();
-    return static_cast<int>(create_result.status().code());
-  }
-
-  std::vector<QualityRegressionUtil::TestItem> items;
-  const absl::Status parse_result = QualityRegressionUtil::ParseFiles(
-      absl::GetFlag(FLAGS_test_files), &items);
-  if (!parse_result.ok()) {
-    LOG(ERROR) << parse_result;
-    return static_cast<int>(parse_result.code());
+  // Engine instances are not shared between threads, as the conversion
+  // updates the state of the engine (e.g. the user history). When running in
+  // parallel, learning is disabled so that every item is evaluated
+  // independently and the engines never write the user profile shared by
+  // them. A single thread keeps learning across the items in order.
+  const int num_threads = std::max(absl::GetFlag(FLAGS_num_threads), 1);
+  mozc::config::Config config;
+  config.set_history_learning_level(mozc::config::Config::NO_HISTORY);
+  std::vector<std::unique_ptr<Engine>> engines;
+  std::vector<std::unique_ptr<QualityRegressionUtil>> utils;
+  for (int i = 0; i < num_threads; ++i) {
+    absl::StatusOr<std::unique_ptr<Engine>> create_result =
+        mozc::CreateEvalEngine(absl::GetFlag(FLAGS_data_file),
+                               absl::GetFlag(FLAGS_data_type),
+                               absl::GetFlag(FLAGS_engine_type));
+    if (!create_result.ok()) {
+      LOG(ERROR) << create_result.status();
+      return static_cast<int>(create_result.status().code());
+    }
+    engines.push_back(*std::move(create_result));
+    utils.push_back(std::make_unique<QualityRegressionUtil>(
+        engines.back()->GetConverter()));
+    if (num_threads > 1) {
+      utils.back()->SetConfig(config);
+    }
   }
 
   absl::Status status;
   if (!absl::GetFlag(FLAGS_output).empty()) {
     std::ofstream out(absl::GetFlag(FLAGS_output));
-    status = Run(out, *create_result.value(), items);
+    status = RunAll(out, utils);
   } else {
-    status = Run(std::cout, *create_result.value(), items);
+    status = RunAll(std::cout, utils);
   }
   if (!status.ok()) {
     LOG(ERROR) << status;
@@ -31,7 +31,9 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <istream>
 #include <iterator>
+#include <limits>
 #include <sstream>  // NOLINT
 #include <string>
 #include <utility>
@@ -196,19 +198,8 @@ absl::Status ParseFileInternal(
   if (!ifs.good()) {
     return absl::UnavailableError(absl::StrCat("Failed to read: ", filename));
   }
-  std::string line;
-  while (!std::getline(ifs, line).fail()) {
-    if (line.empty() || line.c_str()[0] == '#') {
-      continue;
-    }
-    QualityRegressionUtil::TestItem item;
-    if (!item.ParseFromTSV(line).ok()) {
-      return absl::InvalidArgumentError(
-          absl::StrCat("Failed to parse: ", line));
-    }
-    outputs->push_back(item);
-  }
-  return absl::OkStatus();
+  return QualityRegressionUtil::ParseStream(
+      ifs, std::numeric_limits<size_t>::max(), outputs);
 }
 }  // namespace
 
@@ -232,6 +223,26 @@ absl::Status QualityRegressionUtil::ParseFiles(
   return absl::OkStatus();
 }
 
+// static
+absl::Status QualityRegressionUtil::ParseStream(
+    std::istream &is, size_t max_items, std::vector<TestItem> *outputs) {
+  std::string line;
+  for (size_t num_items = 0;
+       num_items < max_items && !std::getline(is, line).fail();) {
+    if (line.empty() || line.c_str()[0] == '#') {
+      continue;
+    }
+    TestItem item;
+    if (!item.ParseFromTSV(line).ok()) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Failed to parse: ", line));
+    }
+    outputs->push_back(std::move(item));
+    ++num_items;
+  }
+  return absl::OkStatus();
+}
+
 absl::StatusOr<bool> QualityRegressionUtil::ConvertAndTest(
     const TestItem &item, std::string *actual_value) {
   const std::string &key = item.key;
@@ -30,7 +30,9 @@
 #ifndef MOZC_CONVERTER_QUALITY_REGRESSION_UTIL_H_
 #define MOZC_CONVERTER_QUALITY_REGRESSION_UTIL_H_
 
+#include <cstddef>
 #include <cstdint>
+#include <istream>
 #include <string>
 #include <vector>
 
@@ -83,6 +85,11 @@ class QualityRegressionUtil {
                                 std::vector<TestItem> *outputs);
   static absl::Status ParseFiles(absl::Span<const std::string> filenames,
                                  std::vector<TestItem> *outputs);
+  // Reads at most |max_items| test items from |is| and appends them to
+  // |outputs|. Fewer items are returned only at the end of the stream, so a
+  // large test set can be evaluated chunk by chunk in bounded memory.
+  static absl::Status ParseStream(std::istream &is, size_t max_items,
+                                  std::vector<TestItem> *outputs);
 
   absl::StatusOr<bool> ConvertAndTest(const TestItem &item,
                                       std::string *actual_value);
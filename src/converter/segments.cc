@@ -461,6 +461,78 @@ Segments &Segments::operator=(const Segments &x) {
   return *this;
 }
 
+void Segments::Snapshot(Segments *snapshot) {
+  DCHECK_NE(snapshot, this);
+  snapshot->Clear();
+  snapshot->max_history_segments_size_ = max_history_segments_size_;
+  snapshot->resized_ = resized_;
+  for (Segment *&segment : segments_) {
+    std::shared_ptr<Segment> shared = ShareSegment(segment);
+    snapshot->segments_.push_back(shared.get());
+    snapshot->shared_segments_.emplace(shared.get(), std::move(shared));
+  }
+  snapshot->revert_entries_ = revert_entries_;
+}
+
+std::shared_ptr<Segment> Segments::ShareSegment(Segment *&segment) {
+  if (const auto it = shared_segments_.find(segment);
+      it != shared_segments_.end()) {
+    return it->second;
+  }
+  auto shared = std::make_shared<Segment>(std::move(*segment));
+  pool_.Release(segment);
+  segment = shared.get();
+  shared_segments_.emplace(segment, shared);
+  return shared;
+}
+
+Segment *Segments::CopySharedSegment(Segment *&segment) {
+  const auto it = shared_segments_.find(segment);
+  // A shared segment that the snapshots no longer refer to is used as is.
+  if (it == shared_segments_.end() || it->second.use_count() == 1) {
+    return segment;
+  }
+  Segment *copy = pool_.Alloc();
+  *copy = *segment;
+  shared_segments_.erase(it);
+  segment = copy;
+  return segment;
+}
+
+void Segments::MakeSegmentsUnique(inner_iterator first, inner_iterator last) {
+  if (shared_segments_.empty()) {
+    return;
+  }
+  for (; first != last; ++first) {
+    CopySharedSegment(*first);
+  }
+}
+
+void Segments::ReleaseSegment(Segment *segment) {
+  if (shared_segments_.erase(segment) == 0) {
+    pool_.Release(segment);
+  }
+}
+
+void Segments::MemoryUsage::Add(const Segments &segments) {
+  for (const Segment &segment : segments) {
+    if (!counted_segments_.insert(&segment).second) {
+      continue;
+    }
+    bytes_ += sizeof(Segment) + segment.key().capacity();
+    for (const Segment::Candidate *candidate : segment.candidates()) {
+      bytes_ += sizeof(Segment::Candidate) + candidate->key.capacity() +
+                candidate->value.capacity() +
+                candidate->content_key.capacity() +
+                candidate->content_value.capacity() +
+                candidate->prefix.capacity() + candidate->suffix.capacity() +
+                candidate->description.capacity() +
+                candidate->inner_segment_boundary.capacity() *
+                    sizeof(uint32_t);
+    }
+  }
+}
+
 Segment *Segments::insert_segment(size_t i) {
   Segment *segment = pool_.Alloc();
   segment->Clear();
@@ -514,7 +586,9 @@ size_t Segments::history_segments_size() const {
 }
 
 Segments::range Segments::history_segments() {
-  return make_range(begin(), history_segments_end());
+  const iterator end = history_segments_end();
+  MakeSegmentsUnique(segments_.begin(), end.iterator_);
+  return make_range(iterator{segments_.begin()}, end);
 }
 
 Segments::const_range Segments::history_segments() const {
@@ -522,7 +596,9 @@ Segments::const_range Segments::history_segments() const {
 }
 
 Segments::range Segments::conversion_segments() {
-  return make_range(history_segments_end(), end());
+  const iterator begin = history_segments_end();
+  MakeSegmentsUnique(begin.iterator_, segments_.end());
+  return make_range(begin, end());
 }
 
 Segments::const_range Segments::conversion_segments() const {
@@ -533,11 +609,11 @@ void Segments::erase_segment(size_t i) {
   if (i >= segments_size()) {
     return;
   }
-  erase_segment(begin() + i);
+  erase_segment(iterator{segments_.begin()} + i);
 }
 
 Segments::iterator Segments::erase_segment(iterator position) {
-  pool_.Release(&*position);
+  ReleaseSegment(*position.iterator_);
   return iterator{segments_.erase(position.iterator_)};
 }
 
@@ -546,28 +622,27 @@ void Segments::erase_segments(size_t i, size_t size) {
   if (i >= segments_size() || end > segments_size()) {
     return;
   }
-  erase_segments(begin() + i, begin() + end);
+  const iterator begin{segments_.begin()};
+  erase_segments(begin + i, begin + end);
 }
 
 Segments::iterator Segments::erase_segments(iterator first, iterator last) {
-  for (auto it = first; it != last; ++it) {
-    pool_.Release(&*it);
+  for (auto it = first.iterator_; it != last.iterator_; ++it) {
+    ReleaseSegment(*it);
   }
   return iterator{segments_.erase(first.iterator_, last.iterator_)};
 }
 
 void Segments::pop_front_segment() {
   if (!segments_.empty()) {
-    Segment *seg = segments_.front();
-    pool_.Release(seg);
+    ReleaseSegment(segments_.front());
     segments_.pop_front();
   }
 }
 
 void Segments::pop_back_segment() {
   if (!segments_.empty()) {
-    Segment *seg = segments_.back();
-    pool_.Release(seg);
+    ReleaseSegment(segments_.back());
     segments_.pop_back();
   }
 }
@@ -578,6 +653,7 @@ void Segments::Clear() {
 }
 
 void Segments::clear_segments() {
+  shared_segments_.clear();
   pool_.Free();
   resized_ = false;
   segments_.clear();
@@ -41,6 +41,8 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
@@ -341,6 +343,8 @@ class Segment final {
 
   Segment(const Segment &x);
   Segment &operator=(const Segment &x);
+  Segment(Segment &&x) = default;
+  Segment &operator=(Segment &&x) = default;
 
   SegmentType segment_type() const { return segment_type_; }
   void set_segment_type(const SegmentType segment_type) {
@@ -480,6 +484,8 @@ class Segments final {
   // This class wraps an iterator as is, except that `operator*` dereferences
   // twice. For example, if `InnerIterator` is the iterator of
   // `std::deque<Segment *>`, `operator*` dereferences to `Segment&`.
+  // The functions returning a non-const iterator or range first copy the
+  // segments in it that are shared with a snapshot (see `Snapshot()`).
   using inner_iterator = std::deque<Segment *>::iterator;
   using inner_const_iterator = std::deque<Segment *>::const_iterator;
   template <typename InnerIterator, bool is_const = false>
@@ -622,8 +628,31 @@ class Segments final {
   Segments(const Segments &x);
   Segments &operator=(const Segments &x);
 
+  // Makes `snapshot` a copy of this Segments that shares the segments with
+  // this one, for the undo stack of a session. Either of them copies a shared
+  // segment the first time it modifies the segment, so taking a snapshot
+  // costs O(segments_size()) instead of copying every candidate. Unlike the
+  // copy constructor, this invalidates the `Segment` pointers obtained from
+  // this Segments before the call.
+  void Snapshot(Segments *snapshot);
+
+  // Approximate heap memory of a set of Segments, which may share segments
+  // through `Snapshot()`. A shared segment is counted once.
+  class MemoryUsage {
+   public:
+    void Add(const Segments &segments);
+    size_t bytes() const { return bytes_; }
+
+   private:
+    absl::flat_hash_set<const Segment *> counted_segments_;
+    size_t bytes_ = 0;
+  };
+
   // iterators
-  iterator begin() { return iterator{segments_.begin()}; }
+  iterator begin() {
+    MakeSegmentsUnique(segments_.begin(), segments_.end());
+    return iterator{segments_.begin()};
+  }
   iterator end() { return iterator{segments_.end()}; }
   const_iterator begin() const { return const_iterator{segments_.begin()}; }
   const_iterator end() const { return const_iterator{segments_.end()}; }
@@ -650,11 +679,13 @@ class Segments final {
   const Segment &history_segment(size_t i) const { return *segments_[i]; }
 
   // setter
-  Segment *mutable_segment(size_t i) { return segments_[i]; }
+  Segment *mutable_segment(size_t i) { return MakeSegmentUnique(segments_[i]); }
   Segment *mutable_conversion_segment(size_t i) {
-    return segments_[i + history_segments_size()];
+    return MakeSegmentUnique(segments_[i + history_segments_size()]);
+  }
+  Segment *mutable_history_segment(size_t i) {
+    return MakeSegmentUnique(segments_[i]);
   }
-  Segment *mutable_history_segment(size_t i) { return segments_[i]; }
 
   // push and insert segments
   Segment *push_front_segment();
@@ -717,6 +748,9 @@ class Segments final {
   RevertEntry *mutable_revert_entry(size_t i) { return &revert_entries_[i]; }
 
   // setter
+  // The lattice is the per-request scratch state of ImmutableConverter. It is
+  // owned by this Segments, so conversions on different Segments don't share
+  // it.
   Lattice *mutable_cached_lattice() { return &cached_lattice_; }
 
  private:
@@ -725,12 +759,29 @@ class Segments final {
   iterator history_segments_end();
   const_iterator history_segments_end() const;
 
+  // Copies `segment` to `pool_` if it is shared with a snapshot, and returns
+  // the segment that only this Segments refers to.
+  Segment *MakeSegmentUnique(Segment *&segment) {
+    return shared_segments_.empty() ? segment : CopySharedSegment(segment);
+  }
+  Segment *CopySharedSegment(Segment *&segment);
+  void MakeSegmentsUnique(inner_iterator first, inner_iterator last);
+  // Moves `segment` out of `pool_` if it is not shared yet, and returns the
+  // shared segment.
+  std::shared_ptr<Segment> ShareSegment(Segment *&segment);
+  // Returns `segment` to `pool_` or drops the reference to it if it is shared.
+  void ReleaseSegment(Segment *segment);
+
   // LINT.IfChange
   size_t max_history_segments_size_;
   bool resized_;
 
   ObjectPool<Segment> pool_;
   std::deque<Segment *> segments_;
+  // The segments in `segments_` that are not in `pool_` but shared with
+  // snapshots. Empty unless `Snapshot()` was called.
+  absl::flat_hash_map<const Segment *, std::shared_ptr<Segment>>
+      shared_segments_;
   std::vector<RevertEntry> revert_entries_;
   Lattice cached_lattice_;
   // LINT.ThenChange(//converter/segments_matchers.h)
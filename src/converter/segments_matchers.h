@@ -207,8 +207,9 @@ MATCHER_P(ContainsCandidate, matcher, "") {
 }
 
 // Checks if a segments exactly matches the given segments except for the
-// following three fields:
+// following four fields:
 //   * pool_
+//   * shared_segments_
 //   * revert_entries_
 //   * cached_lattice_
 // Note: this is more useful than defining operator==() in testing as it can
@@ -402,6 +402,93 @@ TEST(SegmentsTest, CopyTest) {
   }
 }
 
+TEST(SegmentsTest, Snapshot) {
+  Segments src;
+  src.set_max_history_segments_size(3);
+  for (int i = 0; i < 3; ++i) {
+    Segment *segment = src.add_segment();
+    segment->set_key(absl::StrFormat("segment_%d", i));
+    segment->add_candidate()->value = absl::StrFormat("candidate_%d", i);
+  }
+  src.mutable_segment(0)->set_segment_type(Segment::HISTORY);
+
+  Segments snapshot;
+  src.Snapshot(&snapshot);
+  EXPECT_EQ(snapshot.max_history_segments_size(), 3);
+  ASSERT_EQ(snapshot.segments_size(), 3);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(&snapshot.segment(i), &src.segment(i));
+  }
+
+  // Modifying a segment copies only the segment.
+  src.mutable_segment(1)->set_key("modified");
+  EXPECT_EQ(src.segment(1).key(), "modified");
+  EXPECT_EQ(snapshot.segment(1).key(), "segment_1");
+  EXPECT_EQ(&snapshot.segment(0), &src.segment(0));
+  EXPECT_EQ(&snapshot.segment(2), &src.segment(2));
+
+  // The segment is copied only once.
+  const Segment *modified = &src.segment(1);
+  EXPECT_EQ(src.mutable_segment(1), modified);
+
+  // A non-const range copies the segments in it.
+  for (Segment &segment : src.conversion_segments()) {
+    segment.mutable_candidate(0)->value = "modified";
+  }
+  EXPECT_EQ(&snapshot.history_segment(0), &src.history_segment(0));
+  EXPECT_EQ(snapshot.segment(2).candidate(0).value, "candidate_2");
+  EXPECT_EQ(src.segment(2).candidate(0).value, "modified");
+
+  // The snapshot is also copied on write.
+  snapshot.mutable_history_segment(0)->set_key("snapshot");
+  EXPECT_EQ(src.history_segment(0).key(), "segment_0");
+
+  // Erasing a shared segment doesn't affect the other.
+  src.pop_front_segment();
+  EXPECT_EQ(src.segments_size(), 2);
+  EXPECT_EQ(snapshot.segments_size(), 3);
+  EXPECT_EQ(snapshot.segment(0).key(), "snapshot");
+}
+
+TEST(SegmentsTest, SnapshotOutlivesSource) {
+  Segments snapshot;
+  {
+    Segments src;
+    src.add_segment()->set_key("key");
+    src.Snapshot(&snapshot);
+  }
+  ASSERT_EQ(snapshot.segments_size(), 1);
+  EXPECT_EQ(snapshot.segment(0).key(), "key");
+
+  // The segment no longer shared is modified in place.
+  const Segment *segment = &snapshot.segment(0);
+  EXPECT_EQ(snapshot.mutable_segment(0), segment);
+}
+
+TEST(SegmentsTest, MemoryUsage) {
+  Segments src;
+  Segment *segment = src.add_segment();
+  segment->set_key("key");
+  segment->add_candidate()->value = std::string(100, 'a');
+
+  Segments::MemoryUsage src_usage;
+  src_usage.Add(src);
+  EXPECT_GE(src_usage.bytes(), sizeof(Segment) + 100);
+
+  // The segments shared with a snapshot are counted once.
+  Segments snapshot;
+  src.Snapshot(&snapshot);
+  Segments::MemoryUsage total_usage;
+  total_usage.Add(src);
+  total_usage.Add(snapshot);
+  EXPECT_EQ(total_usage.bytes(), src_usage.bytes());
+
+  // A copy doesn't share the segments.
+  const Segments copy = src;
+  total_usage.Add(copy);
+  EXPECT_EQ(total_usage.bytes(), src_usage.bytes() * 2);
+}
+
 TEST(CandidateTest, functional_key) {
   Segment::Candidate candidate;
 
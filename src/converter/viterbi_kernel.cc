@@ -0,0 +1,142 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "converter/viterbi_kernel.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+
+#include "absl/log/check.h"
+#include "absl/numeric/bits.h"
+#include "absl/types/span.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MOZC_VITERBI_KERNEL_USE_SSE2
+#endif  // __SSE2__ || _M_X64
+
+namespace mozc {
+namespace converter {
+namespace viterbi_kernel_internal {
+
+size_t FindMinCostIndexScalar(absl::Span<const int> costs,
+                              absl::Span<const int> transition_costs,
+                              int *min_cost) {
+  DCHECK_EQ(costs.size(), transition_costs.size());
+  size_t best_index = costs.size();
+  int best_cost = std::numeric_limits<int>::max();
+  for (size_t i = 0; i < costs.size(); ++i) {
+    const int cost = costs[i] + transition_costs[i];
+    if (cost < best_cost) {
+      best_cost = cost;
+      best_index = i;
+    }
+  }
+  *min_cost = best_cost;
+  return best_index;
+}
+
+}  // namespace viterbi_kernel_internal
+
+#ifdef MOZC_VITERBI_KERNEL_USE_SSE2
+namespace {
+
+// SSE2 has no _mm_min_epi32 (SSE4.1), so select by comparison.
+inline __m128i Min(__m128i a, __m128i b) {
+  const __m128i a_is_less = _mm_cmplt_epi32(a, b);
+  return _mm_or_si128(_mm_and_si128(a_is_less, a),
+                      _mm_andnot_si128(a_is_less, b));
+}
+
+inline __m128i LoadSum(const int *costs, const int *transition_costs,
+                       size_t i) {
+  return _mm_add_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(costs + i)),
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(transition_costs + i)));
+}
+
+}  // namespace
+#endif  // MOZC_VITERBI_KERNEL_USE_SSE2
+
+size_t FindMinCostIndex(absl::Span<const int> costs,
+                        absl::Span<const int> transition_costs,
+                        int *min_cost) {
+#ifdef MOZC_VITERBI_KERNEL_USE_SSE2
+  DCHECK_EQ(costs.size(), transition_costs.size());
+  constexpr size_t kLanes = 4;
+  const size_t size = costs.size();
+  if (size < 2 * kLanes) {
+    return viterbi_kernel_internal::FindMinCostIndexScalar(
+        costs, transition_costs, min_cost);
+  }
+  const int *c = costs.data();
+  const int *t = transition_costs.data();
+  const size_t vector_end = size - size % kLanes;
+
+  // First pass: the minimum of all the sums.
+  __m128i min4 = _mm_set1_epi32(std::numeric_limits<int>::max());
+  for (size_t i = 0; i < vector_end; i += kLanes) {
+    min4 = Min(min4, LoadSum(c, t, i));
+  }
+  min4 = Min(min4, _mm_shuffle_epi32(min4, _MM_SHUFFLE(1, 0, 3, 2)));
+  min4 = Min(min4, _mm_shuffle_epi32(min4, _MM_SHUFFLE(2, 3, 0, 1)));
+  int best_cost = _mm_cvtsi128_si32(min4);
+  for (size_t i = vector_end; i < size; ++i) {
+    best_cost = std::min(best_cost, c[i] + t[i]);
+  }
+
+  // Second pass: the first index having the minimum. This usually stops
+  // early, and keeps the same tie-breaking as the scalar loop.
+  const __m128i best4 = _mm_set1_epi32(best_cost);
+  size_t i = 0;
+  for (; i < vector_end; i += kLanes) {
+    const int mask =
+        _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(LoadSum(c, t, i),
+                                                         best4)));
+    if (mask != 0) {
+      *min_cost = best_cost;
+      return i + absl::countr_zero(static_cast<unsigned int>(mask));
+    }
+  }
+  for (; i < size; ++i) {
+    if (c[i] + t[i] == best_cost) {
+      break;
+    }
+  }
+  *min_cost = best_cost;
+  return i;
+#else   // MOZC_VITERBI_KERNEL_USE_SSE2
+  return viterbi_kernel_internal::FindMinCostIndexScalar(
+      costs, transition_costs, min_cost);
+#endif  // MOZC_VITERBI_KERNEL_USE_SSE2
+}
+
+}  // namespace converter
+}  // namespace mozc
@@ -0,0 +1,61 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef MOZC_CONVERTER_VITERBI_KERNEL_H_
+#define MOZC_CONVERTER_VITERBI_KERNEL_H_
+
+#include <cstddef>
+
+#include "absl/types/span.h"
+
+namespace mozc {
+namespace converter {
+
+// Finds the index i minimizing costs[i] + transition_costs[i], which is the
+// inner loop of Viterbi algorithm for one right node. Returns the first such
+// index, i.e., the same one as the scalar loop updating the best on strict
+// `<`, and stores the minimum in |min_cost|. Returns costs.size() if the spans
+// are empty. The sums must not overflow int.
+//
+// The minimum is reduced four lanes at a time with SSE2 where available.
+size_t FindMinCostIndex(absl::Span<const int> costs,
+                        absl::Span<const int> transition_costs, int *min_cost);
+
+namespace viterbi_kernel_internal {
+
+// Plain loop version of FindMinCostIndex(). Exposed for testing.
+size_t FindMinCostIndexScalar(absl::Span<const int> costs,
+                              absl::Span<const int> transition_costs,
+                              int *min_cost);
+
+}  // namespace viterbi_kernel_internal
+}  // namespace converter
+}  // namespace mozc
+
+#endif  // MOZC_CONVERTER_VITERBI_KERNEL_H_
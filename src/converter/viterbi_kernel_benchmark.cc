@@ -0,0 +1,116 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Compares FindMinCostIndex() with the scalar loop it replaces.
+//
+// viterbi_kernel_benchmark --sizes=8,64,300 --iterations=1000000
+//
+// For each number of left nodes, prints the time per call of both versions
+// on random costs.
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/log/check.h"
+#include "absl/random/random.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "base/init_mozc.h"
+#include "base/stopwatch.h"
+#include "converter/viterbi_kernel.h"
+
+ABSL_FLAG(std::string, sizes, "8,64,300",
+          "comma separated numbers of left nodes");
+ABSL_FLAG(int32_t, iterations, 1000000, "number of calls per size");
+
+namespace mozc {
+namespace converter {
+namespace {
+
+using FindMinCostIndexFunc = size_t (*)(absl::Span<const int>,
+                                        absl::Span<const int>, int *);
+
+double MeasureNanosecondsPerCall(FindMinCostIndexFunc func,
+                                 absl::Span<const int> costs,
+                                 absl::Span<const int> transition_costs,
+                                 int iterations) {
+  // Accumulates the results so that the calls cannot be optimized away.
+  size_t checksum = 0;
+  Stopwatch stopwatch = Stopwatch::StartNew();
+  for (int i = 0; i < iterations; ++i) {
+    int min_cost = 0;
+    checksum += func(costs, transition_costs, &min_cost);
+    checksum += min_cost;
+  }
+  stopwatch.Stop();
+  CHECK_NE(checksum, 1);
+  return absl::ToDoubleNanoseconds(stopwatch.GetElapsed()) / iterations;
+}
+
+void RunBenchmark(size_t size, int iterations) {
+  absl::BitGen gen;
+  std::vector<int> costs(size), transition_costs(size);
+  for (size_t i = 0; i < size; ++i) {
+    costs[i] = absl::Uniform(gen, 0, 30000);
+    transition_costs[i] = absl::Uniform(gen, 0, 10000);
+  }
+  const double scalar_ns = MeasureNanosecondsPerCall(
+      &viterbi_kernel_internal::FindMinCostIndexScalar, costs,
+      transition_costs, iterations);
+  const double kernel_ns = MeasureNanosecondsPerCall(
+      &FindMinCostIndex, costs, transition_costs, iterations);
+  std::cout << absl::StreamFormat(
+      "size=%5d  scalar=%8.1f ns/call  kernel=%8.1f ns/call  (x%.2f)\n", size,
+      scalar_ns, kernel_ns, scalar_ns / kernel_ns);
+}
+
+}  // namespace
+}  // namespace converter
+}  // namespace mozc
+
+int main(int argc, char **argv) {
+  mozc::InitMozc(argv[0], &argc, &argv);
+
+  const int iterations = absl::GetFlag(FLAGS_iterations);
+  for (absl::string_view size_str :
+       absl::StrSplit(absl::GetFlag(FLAGS_sizes), ',', absl::SkipEmpty())) {
+    size_t size = 0;
+    CHECK(absl::SimpleAtoi(size_str, &size)) << size_str;
+    mozc::converter::RunBenchmark(size, iterations);
+  }
+  return 0;
+}
@@ -0,0 +1,107 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "converter/viterbi_kernel.h"
+
+#include <cstddef>
+#include <vector>
+
+#include "absl/random/random.h"
+#include "testing/gunit.h"
+
+namespace mozc {
+namespace converter {
+namespace {
+
+using ::mozc::converter::viterbi_kernel_internal::FindMinCostIndexScalar;
+
+TEST(ViterbiKernelTest, Empty) {
+  int min_cost = 0;
+  EXPECT_EQ(FindMinCostIndex({}, {}, &min_cost), 0);
+}
+
+TEST(ViterbiKernelTest, FirstMinimumIsReturned) {
+  // Sums: 10 7 9 7 7 8 7 12 7
+  const std::vector<int> costs = {5, 4, 6, 1, 2, 3, 0, 6, 3};
+  const std::vector<int> transition_costs = {5, 3, 3, 6, 5, 5, 7, 6, 4};
+  int min_cost = 0;
+  EXPECT_EQ(FindMinCostIndex(costs, transition_costs, &min_cost), 1);
+  EXPECT_EQ(min_cost, 7);
+}
+
+TEST(ViterbiKernelTest, MinimumInRemainder) {
+  std::vector<int> costs(11, 100);
+  std::vector<int> transition_costs(11, 100);
+  costs[10] = 50;
+  int min_cost = 0;
+  EXPECT_EQ(FindMinCostIndex(costs, transition_costs, &min_cost), 10);
+  EXPECT_EQ(min_cost, 150);
+}
+
+// Differential test against the scalar loop, including sizes that are not a
+// multiple of the vector width and many ties.
+TEST(ViterbiKernelTest, SameAsScalar) {
+  absl::BitGen gen;
+  for (int trial = 0; trial < 2000; ++trial) {
+    const size_t size = absl::Uniform<size_t>(gen, 0, 300);
+    const int max_cost = absl::Uniform(gen, 1, 30000);
+    std::vector<int> costs(size), transition_costs(size);
+    for (size_t i = 0; i < size; ++i) {
+      costs[i] = absl::Uniform(gen, -max_cost, (1 << 28));
+      transition_costs[i] = absl::Uniform(gen, 0, max_cost);
+    }
+    int expected_cost = 0, actual_cost = 0;
+    const size_t expected =
+        FindMinCostIndexScalar(costs, transition_costs, &expected_cost);
+    const size_t actual =
+        FindMinCostIndex(costs, transition_costs, &actual_cost);
+    ASSERT_EQ(actual, expected) << "size=" << size;
+    if (size > 0) {
+      EXPECT_EQ(actual_cost, expected_cost);
+    }
+
+    // Small ranges produce many ties.
+    for (size_t i = 0; i < size; ++i) {
+      costs[i] = absl::Uniform(gen, 0, 4);
+      transition_costs[i] = absl::Uniform(gen, 0, 4);
+    }
+    const size_t expected_tie =
+        FindMinCostIndexScalar(costs, transition_costs, &expected_cost);
+    const size_t actual_tie =
+        FindMinCostIndex(costs, transition_costs, &actual_cost);
+    ASSERT_EQ(actual_tie, expected_tie) << "size=" << size;
+    if (size > 0) {
+      EXPECT_EQ(actual_cost, expected_cost);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace converter
+}  // namespace mozc
@@ -29,8 +29,10 @@
 
 #include "data_manager/data_manager.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <memory>
 #include <new>
 #include <optional>
@@ -50,6 +52,7 @@
 #include "absl/types/span.h"
 #include "base/container/serialized_string_array.h"
 #include "base/mmap.h"
+#include "base/thread.h"
 #include "base/version.h"
 #include "base/vlog.h"
 #include "data_manager/dataset_reader.h"
@@ -99,8 +102,19 @@ absl::Span<const T> MakeSpanFromAlignedBuffer(const absl::string_view buf) {
                         buf.size() / sizeof(T));
 }
 
+// The number of hot sections at the beginning of GetSectionsInAccessOrder().
+constexpr size_t kNumHotSections = 6;
+
+// The background warm-up checks for cancellation at this interval.
+constexpr size_t kWarmUpChunkSize = 1 << 20;
+
 }  // namespace
 
+DataManager::~DataManager() {
+  // `warm_up_` is destroyed before the other members and waits for the thread.
+  cancel_warm_up_ = true;
+}
+
 // static
 std::string DataManager::StatusCodeToString(Status code) {
   std::string s;
@@ -178,6 +192,7 @@ DataManager::Status DataManager::InitFromArray(absl::string_view array,
 }
 
 DataManager::Status DataManager::InitFromReader(const DataSetReader &reader) {
+  data_checksum_ = reader.checksum();
   const Status status = InitUserPosManagerDataFromReader(
       reader, &pos_matcher_data_, &user_pos_token_array_data_,
       &user_pos_string_array_data_);
@@ -620,6 +635,113 @@ void DataManager::GetUsageRewriterData(
 
 absl::string_view DataManager::GetDataVersion() const { return data_version_; }
 
+std::vector<absl::string_view> DataManager::GetSectionsInAccessOrder() const {
+  const absl::string_view sections[] = {
+      // Hot sections, which are read by every conversion.
+      dictionary_data_,
+      connection_data_,
+      segmenter_bitarray_,
+      segmenter_ltable_,
+      segmenter_rtable_,
+      pos_matcher_data_,
+      // Read by the converter and the predictor on most inputs.
+      boundary_data_,
+      suggestion_filter_data_,
+      suffix_key_array_data_,
+      suffix_value_array_data_,
+      suffix_token_array_data_,
+      collocation_data_,
+      collocation_suppression_data_,
+      pos_group_data_,
+      counter_suffix_data_,
+      // Read by rewriters and predictors for specific inputs.
+      single_kanji_token_array_data_,
+      single_kanji_string_array_data_,
+      single_kanji_variant_type_data_,
+      single_kanji_variant_token_array_data_,
+      single_kanji_variant_string_array_data_,
+      single_kanji_noun_prefix_token_array_data_,
+      single_kanji_noun_prefix_string_array_data_,
+      zero_query_token_array_data_,
+      zero_query_string_array_data_,
+      zero_query_number_token_array_data_,
+      zero_query_number_string_array_data_,
+      reading_correction_value_array_data_,
+      reading_correction_error_array_data_,
+      reading_correction_correction_array_data_,
+      symbol_token_array_data_,
+      symbol_string_array_data_,
+      emoticon_token_array_data_,
+      emoticon_string_array_data_,
+      emoji_token_array_data_,
+      emoji_string_array_data_,
+      usage_base_conjugation_suffix_data_,
+      usage_conjugation_suffix_data_,
+      usage_conjugation_index_data_,
+      usage_items_data_,
+      usage_string_array_data_,
+      a11y_description_token_array_data_,
+      a11y_description_string_array_data_,
+      user_pos_token_array_data_,
+      user_pos_string_array_data_,
+  };
+  std::vector<absl::string_view> result;
+  result.reserve(std::size(sections));
+  for (absl::string_view section : sections) {
+    if (!section.empty()) {
+      result.push_back(section);
+    }
+  }
+  return result;
+}
+
+void DataManager::WarmUp(const WarmUpOptions &options) const {
+  std::vector<absl::string_view> sections = GetSectionsInAccessOrder();
+  const absl::Span<const absl::string_view> hot_sections =
+      absl::MakeConstSpan(sections).first(
+          std::min(kNumHotSections, sections.size()));
+
+  if (options.huge_pages) {
+    for (absl::string_view section : hot_sections) {
+      Mmap::AdviseHugePages(section.data(), section.size());
+    }
+  }
+
+  switch (options.policy) {
+    case WarmUpPolicy::NONE:
+      break;
+    case WarmUpPolicy::WILL_NEED:
+      for (absl::string_view section : hot_sections) {
+        Mmap::AdviseWillNeed(section.data(), section.size());
+      }
+      break;
+    case WarmUpPolicy::POPULATE:
+      for (absl::string_view section : hot_sections) {
+        Mmap::PopulatePages(section.data(), section.size());
+      }
+      break;
+    case WarmUpPolicy::BACKGROUND:
+      if (warm_up_.has_value()) {
+        break;
+      }
+      warm_up_.emplace([this, sections = std::move(sections)]() {
+        for (absl::string_view section : sections) {
+          for (size_t offset = 0; offset < section.size();
+               offset += kWarmUpChunkSize) {
+            if (cancel_warm_up_) {
+              return;
+            }
+            const size_t size =
+                std::min(kWarmUpChunkSize, section.size() - offset);
+            Mmap::PopulatePages(section.data() + offset, size);
+          }
+        }
+        MOZC_VLOG(1) << "Background warm-up of the data set finished";
+      });
+      break;
+  }
+}
+
 std::optional<std::pair<size_t, size_t>> DataManager::GetOffsetAndSize(
     absl::string_view name) const {
   if (const auto iter = offset_and_size_.find(name);
@@ -30,6 +30,7 @@
 #ifndef MOZC_DATA_MANAGER_DATA_MANAGER_H_
 #define MOZC_DATA_MANAGER_DATA_MANAGER_H_
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <iosfwd>
@@ -38,12 +39,14 @@
 #include <ostream>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "base/mmap.h"
+#include "base/thread.h"
 
 namespace mozc {
 
@@ -65,6 +68,24 @@ class DataManager {
     UNKNOWN = 5,
   };
 
+  // Policies to page in the data set before the first conversion.
+  enum class WarmUpPolicy {
+    // Pages are faulted in on demand.
+    NONE,
+    // Asks the kernel to read ahead the hot sections asynchronously.
+    WILL_NEED,
+    // Reads the hot sections synchronously in WarmUp().
+    POPULATE,
+    // Reads all the sections in access-frequency order in a background thread.
+    BACKGROUND,
+  };
+
+  struct WarmUpOptions {
+    WarmUpPolicy policy = WarmUpPolicy::NONE;
+    // Hints transparent huge pages for the hot sections.
+    bool huge_pages = false;
+  };
+
   static std::string StatusCodeToString(Status code);
   static absl::string_view GetDataSetMagicNumber(absl::string_view type);
 
@@ -78,7 +99,7 @@ class DataManager {
   DataManager() = default;
   DataManager(const DataManager &) = delete;
   DataManager &operator=(const DataManager &) = delete;
-  virtual ~DataManager() = default;
+  virtual ~DataManager();
 
   // Parses |array| and extracts byte blocks of data set.  The |array| must
   // outlive this instance.  The second version specifies a custom magic number
@@ -161,12 +182,26 @@ class DataManager {
 
   virtual absl::string_view GetDataVersion() const;
 
+  // Pages in the data according to `options`. The hot sections are the ones
+  // read by every conversion, i.e., the system dictionary, the connection
+  // matrix, the segmenter and the POS matcher. The background thread, if any,
+  // is stopped on destruction.
+  void WarmUp(const WarmUpOptions &options) const;
+
+  // Returns the checksum stored in the data set.  It identifies the content of
+  // the data regardless of the file path it is loaded from.
+  absl::string_view GetDataChecksum() const { return data_checksum_; }
+
   virtual std::optional<std::pair<size_t, size_t>> GetOffsetAndSize(
       absl::string_view name) const;
 
  private:
   Status InitFromReader(const DataSetReader &reader);
 
+  // Returns the non-empty sections in the order of access frequency. The hot
+  // sections come first; see WarmUp().
+  std::vector<absl::string_view> GetSectionsInAccessOrder() const;
+
   std::optional<std::string> filename_ = std::nullopt;
   Mmap mmap_;
   absl::string_view pos_matcher_data_;
@@ -216,7 +251,12 @@ class DataManager {
   absl::string_view usage_items_data_;
   absl::string_view usage_string_array_data_;
   absl::string_view data_version_;
+  absl::string_view data_checksum_;
   absl::flat_hash_map<std::string, std::pair<size_t, size_t>> offset_and_size_;
+
+  mutable std::atomic<bool> cancel_warm_up_ = false;
+  // Declared after mmap_ so that the thread is joined before unmapping.
+  mutable std::optional<BackgroundFuture<void>> warm_up_;
 };
 
 // Print helper for DataManager::Status.  Logging, e.g., CHECK_EQ(), requires
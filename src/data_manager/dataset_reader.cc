@@ -50,6 +50,10 @@ namespace {
 // The size of the file footer, which contains some metadata; see dataset.proto.
 constexpr size_t kFooterSize = 36;
 
+// The SHA1 checksum is stored at the beginning of the last 28 bytes.
+constexpr size_t kChecksumOffsetFromEnd = 28;
+constexpr size_t kSHA1Length = 20;
+
 }  // namespace
 
 bool DataSetReader::Init(absl::string_view memblock, absl::string_view magic) {
@@ -165,18 +169,25 @@ std::optional<std::pair<size_t, size_t>> DataSetReader::GetOffsetAndSize(
   return std::make_pair(offset, data.size());
 }
 
+absl::string_view DataSetReader::checksum() const {
+  if (memblock_.size() < kFooterSize) {
+    return absl::string_view();
+  }
+  return absl::ClippedSubstr(
+      memblock_, memblock_.size() - kChecksumOffsetFromEnd, kSHA1Length);
+}
+
 bool DataSetReader::VerifyChecksum(absl::string_view memblock) {
   if (memblock.size() < kFooterSize) {
     return false;
   }
   // Checksum is computed for all but last 28 bytes.
   const std::string& actual_checksum = internal::UnverifiedSHA1::MakeDigest(
-      memblock.substr(0, memblock.size() - 28));
+      memblock.substr(0, memblock.size() - kChecksumOffsetFromEnd));
 
   // Extract the stored SHA1; see dataset.proto for file format.
-  const std::size_t kSHA1Length = 20;
-  absl::string_view expected_checksum =
-      absl::ClippedSubstr(memblock, memblock.size() - 28, kSHA1Length);
+  absl::string_view expected_checksum = absl::ClippedSubstr(
+      memblock, memblock.size() - kChecksumOffsetFromEnd, kSHA1Length);
 
   return actual_checksum == expected_checksum;
 }
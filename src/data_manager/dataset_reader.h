@@ -60,6 +60,10 @@ class DataSetReader {
   std::optional<std::pair<size_t, size_t>> GetOffsetAndSize(
       absl::string_view name) const;
 
+  // Returns the SHA1 checksum stored in the footer of the binary image.  The
+  // checksum itself is not verified.
+  absl::string_view checksum() const;
+
   // Verifies the checksum of binary image.
   static bool VerifyChecksum(absl::string_view memblock);
 
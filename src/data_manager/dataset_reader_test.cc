@@ -84,6 +84,10 @@ TEST(DataSetReaderTest, ValidData) {
   EXPECT_FALSE(r.Get("foo", &data));
   EXPECT_EQ(r.GetOffsetAndSize(""), std::nullopt);
   EXPECT_EQ(r.GetOffsetAndSize("foo"), std::nullopt);
+
+  // The SHA1 checksum is stored right before the 8-byte file size.
+  EXPECT_EQ(r.checksum(),
+            absl::string_view(image).substr(image.size() - 28, 20));
 }
 
 TEST(DataSetReaderTest, InvalidMagicString) {
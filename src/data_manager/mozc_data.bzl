@@ -63,6 +63,7 @@ def mozc_dataset(
         zero_query_number_def,
         suggestion_filter_safe_def_srcs = [],
         usage_dict = None,
+        dictionary_subtree_cost = False,
         extra_data = []):
     """Macro for Mozc data set.
 
@@ -135,6 +136,8 @@ def mozc_dataset(
       zero_query_number_def: rule-based zero query number suggestion data file.
       suggestion_filter_safe_def_srcs: safe list for suggestion filter.
       usage_dict: usage dictionary data.
+      dictionary_subtree_cost: if true, store the subtree costs in the system
+        dictionary for the cost-ordered predictive lookup.
       extra_data: a list of any data files to include.
     """
     sources = [
@@ -369,6 +372,7 @@ def mozc_dataset(
             "$(location //dictionary:gen_system_dictionary_data_main) " +
             "--input=\"" + " ".join(["$(locations %s)" % s for s in dictionary_srcs]) + "\" " +
             "--user_pos_manager_data=$(location :" + name + "@user_pos_manager_data) " +
+            "--subtree_cost=" + ("true" if dictionary_subtree_cost else "false") + " " +
             "--output=$@"
         ),
         tools = ["//dictionary:gen_system_dictionary_data_main"],
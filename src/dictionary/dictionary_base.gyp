@@ -184,6 +184,8 @@
         '<(mozc_oss_src_dir)/protocol/protocol.gyp:config_proto',
         '<(mozc_oss_src_dir)/protocol/protocol.gyp:user_dictionary_storage_proto',
         '<(mozc_oss_src_dir)/request/request.gyp:conversion_request',
+        '<(mozc_oss_src_dir)/storage/louds/louds.gyp:louds_trie',
+        '<(mozc_oss_src_dir)/storage/louds/louds.gyp:louds_trie_builder',
         '<(mozc_oss_src_dir)/usage_stats/usage_stats_base.gyp:usage_stats',
         'gen_pos_map#host',
         'pos_matcher',
@@ -41,6 +41,8 @@
 namespace mozc {
 namespace dictionary {
 
+// The lookup methods are const and may be called concurrently from multiple
+// threads. Implementations keep any per-lookup state local to the call.
 class DictionaryInterface {
  public:
   // Callback interface for dictionary traversal (currently implemented only for
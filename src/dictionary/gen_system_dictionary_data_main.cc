@@ -34,10 +34,13 @@
 //  --output="output.h"
 //  --make_header
 
+#include <algorithm>
+#include <cstdint>
 #include <ios>
 #include <memory>
 #include <ostream>
 #include <string>
+#include <thread>  // NOLINT
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -58,6 +61,16 @@
 ABSL_FLAG(std::string, input, "", "space separated input text files");
 ABSL_FLAG(std::string, user_pos_manager_data, "", "user pos manager data");
 ABSL_FLAG(std::string, output, "", "output binary file");
+ABSL_FLAG(int32_t, num_threads, 0,
+          "number of threads to parse and build the dictionary with; 0 uses "
+          "all the available cores. The output does not depend on this.");
+ABSL_FLAG(bool, value_array, false,
+          "also store plain value strings so that lookups skip restoring "
+          "values from the value trie. Makes the dictionary larger.");
+ABSL_FLAG(bool, subtree_cost, false,
+          "also store the minimum token cost under each key trie node so that "
+          "predictive lookups collect the cheapest keys first. Makes the "
+          "dictionary larger.");
 
 namespace mozc {
 namespace {
@@ -114,10 +127,19 @@ int main(int argc, char **argv) {
   const mozc::dictionary::PosMatcher pos_matcher(
       data_manager.GetPosMatcherData());
 
+  int num_threads = absl::GetFlag(FLAGS_num_threads);
+  if (num_threads <= 0) {
+    num_threads = std::max<int>(std::thread::hardware_concurrency(), 1);
+  }
+
   mozc::dictionary::TextDictionaryLoader loader(pos_matcher);
+  loader.set_num_threads(num_threads);
   loader.Load(system_dictionary_input, reading_correction_input);
 
   mozc::dictionary::SystemDictionaryBuilder builder;
+  builder.set_num_threads(num_threads);
+  builder.set_store_value_array(absl::GetFlag(FLAGS_value_array));
+  builder.set_store_subtree_cost(absl::GetFlag(FLAGS_subtree_cost));
   builder.BuildFromTokens(loader.tokens());
 
   std::unique_ptr<std::ostream> output_stream(new mozc::OutputFileStream(
@@ -73,10 +73,10 @@ void SuppressionDictionary::UnLock() ABSL_UNLOCK_FUNCTION(mutex_) {
 }
 
 bool SuppressionDictionary::IsEmpty() const {
-  if (mutex_.TryLock()) {
+  if (mutex_.ReaderTryLock()) {
     bool is_empty =
         keys_only_.empty() && values_only_.empty() && keys_values_.empty();
-    mutex_.Unlock();
+    mutex_.ReaderUnlock();
     return is_empty;
   }
 
@@ -85,17 +85,17 @@ bool SuppressionDictionary::IsEmpty() const {
 
 bool SuppressionDictionary::SuppressEntry(const absl::string_view key,
                                           const absl::string_view value) const {
-  if (mutex_.TryLock()) {
+  if (mutex_.ReaderTryLock()) {
     if (keys_only_.empty() && values_only_.empty() && keys_values_.empty()) {
       // Almost all users don't use word suppression function.
       // We can return false as early as possible.
-      mutex_.Unlock();
+      mutex_.ReaderUnlock();
       return false;
     }
 
     bool suppress = keys_values_.contains(std::make_pair(key, value)) ||
                     keys_only_.contains(key) || values_only_.contains(value);
-    mutex_.Unlock();
+    mutex_.ReaderUnlock();
     return suppress;
   }
 
@@ -44,10 +44,11 @@ namespace mozc {
 namespace dictionary {
 
 // Provides a functionality to test if a word should be suppressed in conversion
-// results. This class is not thread safe in general use but is safe under
-// single-producer single-consumer model, provided that the usage is correct. In
-// our usage, the producer is UserDictionary::UserDictionaryReloader thread and
-// the consumer is the main converter thread.
+// results. This class is safe under single-producer multiple-consumer model,
+// provided that the usage is correct. In our usage, the producer is
+// UserDictionary::UserDictionaryReloader thread and the consumers are the
+// converter threads. Consumers take the lock in shared mode, so concurrent
+// conversions don't exclude each other.
 class ABSL_LOCKABLE SuppressionDictionary final {
  public:
   SuppressionDictionary() = default;
@@ -76,9 +77,9 @@ class ABSL_LOCKABLE SuppressionDictionary final {
   // Clears the dictionary.
   void Clear() ABSL_EXCLUSIVE_LOCKS_REQUIRED(this);
 
-  // Methods for the consumer thread. If the producer thread is updating the
+  // Methods for the consumer threads. If the producer thread is updating the
   // dictionary contents, the following methods behave as if the dictionary is
-  // empty.
+  // empty. They may be called concurrently from multiple threads.
 
   // Returns true if SuppressionDictionary doesn't have any entries.
   bool IsEmpty() const;
@@ -137,6 +137,36 @@ TEST(SuppressionDictionary, ThreadTest) {
   }
 }
 
+TEST(SuppressionDictionary, ConcurrentConsumers) {
+  SuppressionDictionary dic;
+  {
+    const SuppressionDictionaryLock l(&dic);
+    for (int i = 0; i < 100; ++i) {
+      EXPECT_TRUE(
+          dic.AddEntry(absl::StrCat("key", i), absl::StrCat("value", i)));
+    }
+  }
+
+  // Consumers must not see each other's lock as the producer's one, i.e., the
+  // dictionary must not look empty to them.
+  std::vector<Thread> consumers;
+  for (int t = 0; t < 4; ++t) {
+    consumers.emplace_back([&dic] {
+      for (int iter = 0; iter < 1000; ++iter) {
+        const int i = iter % 100;
+        ASSERT_FALSE(dic.IsEmpty());
+        ASSERT_TRUE(dic.SuppressEntry(absl::StrCat("key", i),
+                                      absl::StrCat("value", i)));
+        ASSERT_FALSE(dic.SuppressEntry(absl::StrCat("key", i),
+                                       absl::StrCat("value", i + 1)));
+      }
+    });
+  }
+  for (Thread &consumer : consumers) {
+    consumer.Join();
+  }
+}
+
 }  // namespace
 }  // namespace dictionary
 }  // namespace mozc
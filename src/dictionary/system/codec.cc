@@ -29,6 +29,7 @@
 
 #include "dictionary/system/codec.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <string>
@@ -83,6 +84,8 @@ constexpr char kKeySectionName[] = "k";
 constexpr char kValueSectionName[] = "v";
 constexpr char kTokensSectionName[] = "t";
 constexpr char kPosSectionName[] = "p";
+constexpr char kValueArraySectionName[] = "a";
+constexpr char kSubtreeCostSectionName[] = "c";
 
 //// Constants for validation ////
 // 12 bits
@@ -216,6 +219,14 @@ std::string SystemDictionaryCodec::GetSectionNameForPos() const {
   return kPosSectionName;
 }
 
+std::string SystemDictionaryCodec::GetSectionNameForValueArray() const {
+  return kValueArraySectionName;
+}
+
+std::string SystemDictionaryCodec::GetSectionNameForSubtreeCost() const {
+  return kSubtreeCostSectionName;
+}
+
 void SystemDictionaryCodec::EncodeKey(const absl::string_view src,
                                       std::string *dst) const {
   EncodeDecodeKeyImpl(src, dst);
@@ -361,6 +372,16 @@ uint8_t SystemDictionaryCodec::GetTokensTerminationFlag() const {
   return kTokenTerminationFlag;
 }
 
+uint8_t SystemDictionaryCodec::EncodeSubtreeCost(int cost) const {
+  // Dropping the lower 8 bits rounds down like the small cost encoding, so
+  // the decoded value is a lower bound of both encodings of the cost.
+  return std::clamp(cost, 0, kCostMax) >> 8;
+}
+
+int SystemDictionaryCodec::DecodeSubtreeCost(uint8_t encoded) const {
+  return encoded << 8;
+}
+
 void SystemDictionaryCodec::EncodeTokens(absl::Span<const TokenInfo> tokens,
                                          std::string *output) const {
   DCHECK(output);
@@ -56,6 +56,12 @@ class SystemDictionaryCodec : public SystemDictionaryCodecInterface {
   // Return section name for frequent pos map
   std::string GetSectionNameForPos() const override;
 
+  // Return section name for the optional array of decoded values
+  std::string GetSectionNameForValueArray() const override;
+
+  // Return section name for the per-node subtree cost of the key trie
+  std::string GetSectionNameForSubtreeCost() const override;
+
   // Compresses key string into small bytes.
   void EncodeKey(absl::string_view src, std::string *dst) const override;
 
@@ -95,6 +101,10 @@ class SystemDictionaryCodec : public SystemDictionaryCodecInterface {
 
   uint8_t GetTokensTerminationFlag() const override;
 
+  // Subtree costs are stored with the resolution of the small cost encoding.
+  uint8_t EncodeSubtreeCost(int cost) const override;
+  int DecodeSubtreeCost(uint8_t encoded) const override;
+
  private:
   void EncodeToken(absl::Span<const TokenInfo> tokens, int index,
                    std::string *output) const;
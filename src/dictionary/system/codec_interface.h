@@ -66,6 +66,12 @@ class SystemDictionaryCodecInterface {
   // Return section name for frequent pos map
   virtual std::string GetSectionNameForPos() const = 0;
 
+  // Return section name for the optional array of decoded values
+  virtual std::string GetSectionNameForValueArray() const = 0;
+
+  // Return section name for the per-node subtree cost of the key trie
+  virtual std::string GetSectionNameForSubtreeCost() const = 0;
+
   // Encode value(word) string
   virtual void EncodeValue(absl::string_view src, std::string *dst) const = 0;
 
@@ -106,6 +112,13 @@ class SystemDictionaryCodecInterface {
 
   // Return termination flag for tokens
   virtual uint8_t GetTokensTerminationFlag() const = 0;
+
+  // Encode the minimum token cost in a key trie subtree into one byte. The
+  // decoded value never exceeds the cost decoded by DecodeToken().
+  virtual uint8_t EncodeSubtreeCost(int cost) const = 0;
+
+  // Decode the lower bound of the subtree cost
+  virtual int DecodeSubtreeCost(uint8_t encoded) const = 0;
 };
 
 class SystemDictionaryCodecFactory {
@@ -322,6 +322,8 @@ class SystemDictionaryCodecMock : public SystemDictionaryCodecInterface {
   std::string GetSectionNameForValue() const override { return "Mock"; }
   std::string GetSectionNameForTokens() const override { return "Mock"; }
   std::string GetSectionNameForPos() const override { return "Mock"; }
+  std::string GetSectionNameForValueArray() const override { return "Mock"; }
+  std::string GetSectionNameForSubtreeCost() const override { return "Mock"; }
   void EncodeKey(const absl::string_view src, std::string *dst) const override {
   }
   void DecodeKey(const absl::string_view src, std::string *dst) const override {
@@ -350,6 +352,8 @@ class SystemDictionaryCodecMock : public SystemDictionaryCodecInterface {
     return false;
   }
   uint8_t GetTokensTerminationFlag() const override { return 0xff; }
+  uint8_t EncodeSubtreeCost(int cost) const override { return 0; }
+  int DecodeSubtreeCost(uint8_t encoded) const override { return 0; }
 };
 
 TEST_F(SystemDictionaryCodecTest, FactoryTest) {
@@ -743,6 +747,25 @@ TEST_F(SystemDictionaryCodecTest, ReadTokenRandomTest) {
   EXPECT_EQ(read_num, source_tokens_.size());
 }
 
+TEST_F(SystemDictionaryCodecTest, SubtreeCostIsLowerBoundOfTokenCost) {
+  SystemDictionaryCodec codec;
+  InitTokens(100);
+  SetRandCost();
+  std::string encoded;
+  codec.EncodeTokens(source_tokens_, &encoded);
+  codec.DecodeTokens(reinterpret_cast<const unsigned char *>(encoded.data()),
+                     &decoded_tokens_);
+  ASSERT_EQ(decoded_tokens_.size(), source_tokens_.size());
+  for (size_t i = 0; i < source_tokens_.size(); ++i) {
+    const int cost = source_tokens_[i].token->cost;
+    const int bound = codec.DecodeSubtreeCost(codec.EncodeSubtreeCost(cost));
+    EXPECT_LE(bound, cost);
+    EXPECT_LE(bound, decoded_tokens_[i].token->cost);
+    EXPECT_GT(bound + 256, cost);
+  }
+  EXPECT_EQ(codec.DecodeSubtreeCost(codec.EncodeSubtreeCost(-1)), 0);
+}
+
 TEST_F(SystemDictionaryCodecTest, CodecTest) {
   std::unique_ptr<SystemDictionaryCodec> impl(new SystemDictionaryCodec);
   SystemDictionaryCodecFactory::SetCodec(impl.get());
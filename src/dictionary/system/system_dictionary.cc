@@ -43,6 +43,11 @@
 //       Frequenty appearing POSs are stored as POS ids in token info for
 //       reducing binary size. This table is the map from the id to the
 //       actual ids.
+//  (5) Value array (optional)
+//       Plain value strings indexed by the id in value trie.
+//  (6) Subtree cost (optional)
+//       Lower bound of the token costs under each node of key trie, indexed
+//       by node id. Used for predictive lookup in cost order.
 
 #include "dictionary/system/system_dictionary.h"
 
@@ -50,6 +55,7 @@
 #include <cstdint>
 #include <cstring>
 #include <iterator>
+#include <limits>
 #include <map>
 #include <memory>
 #include <queue>
@@ -64,6 +70,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "base/japanese_util.h"
 #include "base/mmap.h"
 #include "base/strings/unicode.h"
@@ -475,6 +482,15 @@ bool SystemDictionary::OpenDictionaryFile(bool enable_reverse_lookup_index) {
     return false;
   }
 
+  value_array_.clear();
+  const char *value_array_image = dictionary_file_->GetSection(
+      codec_->GetSectionNameForValueArray(), &len);
+  if (value_array_image != nullptr &&
+      !value_array_.Init(absl::string_view(value_array_image, len))) {
+    LOG(ERROR) << "can not open value array";
+    return false;
+  }
+
   const unsigned char *token_image = reinterpret_cast<const unsigned char *>(
       dictionary_file_->GetSection(codec_->GetSectionNameForTokens(), &len));
   token_array_.Open(token_image);
@@ -486,6 +502,21 @@ bool SystemDictionary::OpenDictionaryFile(bool enable_reverse_lookup_index) {
     return false;
   }
 
+  subtree_cost_ = {};
+  const uint8_t *subtree_cost_image = reinterpret_cast<const uint8_t *>(
+      dictionary_file_->GetSection(codec_->GetSectionNameForSubtreeCost(),
+                                   &len));
+  if (subtree_cost_image != nullptr) {
+    // The section has one byte for each node ID, where ID 0 is unused. The
+    // lookup falls back to BFS order if it doesn't match the key trie.
+    if (static_cast<size_t>(len) == key_trie_.num_nodes() + 1) {
+      subtree_cost_ = absl::MakeConstSpan(subtree_cost_image, len);
+    } else {
+      LOG(WARNING) << "Ignoring subtree cost section of size " << len
+                   << " for " << key_trie_.num_nodes() << " nodes";
+    }
+  }
+
   if (enable_reverse_lookup_index) {
     InitReverseLookupIndex();
   }
@@ -546,8 +577,8 @@ bool SystemDictionary::HasValue(absl::string_view value) const {
   const uint8_t *encoded_tokens_ptr = GetTokenArrayPtr(token_array_, key_id);
 
   // Check tokens.
-  for (TokenDecodeIterator iter(codec_, value_trie_, frequent_pos_, key,
-                                encoded_tokens_ptr);
+  for (TokenDecodeIterator iter(codec_, value_trie_, value_array_,
+                                frequent_pos_, key, encoded_tokens_ptr);
        !iter.Done(); iter.Next()) {
     const Token *token = iter.Get().token;
     if (value == token->value) {
@@ -571,17 +602,20 @@ void SystemDictionary::CollectPredictiveNodesInBfsOrder(
       const char target_char = encoded_key[state.key_pos];
       const ExpandedKey &chars = table.ExpandKey(target_char);
 
-      for (key_trie_.MoveToFirstChild(&state.node);
-           key_trie_.IsValidNode(state.node);
-           key_trie_.MoveToNextSibling(&state.node)) {
-        const char c = key_trie_.GetEdgeLabelToParentNode(state.node);
+      const LoudsTrie::Node first_child =
+          key_trie_.MoveToFirstChild(state.node);
+      const absl::string_view labels =
+          key_trie_.GetSiblingLabels(first_child);
+      for (size_t i = 0; i < labels.size(); ++i) {
+        const char c = labels[i];
         if (!chars.IsHit(c)) {
           continue;
         }
         const int num_expanded =
             state.num_expanded + static_cast<int>(c != target_char);
-        queue.push(PredictiveLookupSearchState(state.node, state.key_pos + 1,
-                                               num_expanded));
+        queue.push(PredictiveLookupSearchState(
+            LoudsTrie::MoveToNextSibling(first_child, i), state.key_pos + 1,
+            num_expanded));
       }
       continue;
     }
@@ -622,6 +656,94 @@ void SystemDictionary::CollectPredictiveNodesInBfsOrder(
   } while (!queue.empty());
 }
 
+int SystemDictionary::GetMinTokenCost(int key_id) const {
+  Token token;
+  TokenInfo token_info(&token);
+  const uint8_t *ptr = GetTokenArrayPtr(token_array_, key_id);
+  int min_cost = std::numeric_limits<int>::max();
+  bool has_next = true;
+  while (has_next) {
+    // Only the cost is needed, so values are not restored here.
+    token_info.Clear();
+    token_info.token = &token;
+    int read_bytes;
+    has_next = codec_->DecodeToken(ptr, &token_info, &read_bytes);
+    ptr += read_bytes;
+    min_cost = std::min(min_cost, token.cost);
+  }
+  return min_cost;
+}
+
+void SystemDictionary::CollectPredictiveNodesInCostOrder(
+    absl::string_view encoded_key, const KeyExpansionTable &table, size_t limit,
+    std::vector<PredictiveLookupSearchState> *result) const {
+  // A subtree is expanded when its lower bound is the smallest in the queue,
+  // and a key is collected when its exact cost is. Hence keys are collected
+  // in the order of their minimum token cost, and the search stops as soon as
+  // |limit| keys are found without visiting the rest of the subtrees.
+  struct Entry {
+    int cost;
+    bool is_key;
+    PredictiveLookupSearchState state;
+  };
+  auto greater = [](const Entry &lhs, const Entry &rhs) {
+    return lhs.cost > rhs.cost;
+  };
+  std::priority_queue<Entry, std::vector<Entry>, decltype(greater)> queue(
+      greater);
+  auto push_subtree = [&](const PredictiveLookupSearchState &state) {
+    queue.push({codec_->DecodeSubtreeCost(subtree_cost_[state.node.node_id()]),
+                false, state});
+  };
+
+  // Find the nodes for |encoded_key| and its expanded keys.
+  std::vector<PredictiveLookupSearchState> stack;
+  stack.push_back(PredictiveLookupSearchState(LoudsTrie::Node(), 0, 0));
+  while (!stack.empty()) {
+    const PredictiveLookupSearchState state = stack.back();
+    stack.pop_back();
+    if (state.key_pos == encoded_key.size()) {
+      push_subtree(state);
+      continue;
+    }
+    const char target_char = encoded_key[state.key_pos];
+    const ExpandedKey &chars = table.ExpandKey(target_char);
+    const LoudsTrie::Node first_child = key_trie_.MoveToFirstChild(state.node);
+    const absl::string_view labels = key_trie_.GetSiblingLabels(first_child);
+    for (size_t i = 0; i < labels.size(); ++i) {
+      const char c = labels[i];
+      if (!chars.IsHit(c)) {
+        continue;
+      }
+      const int num_expanded =
+          state.num_expanded + static_cast<int>(c != target_char);
+      stack.push_back(PredictiveLookupSearchState(
+          LoudsTrie::MoveToNextSibling(first_child, i), state.key_pos + 1,
+          num_expanded));
+    }
+  }
+
+  while (!queue.empty() && result->size() < limit) {
+    Entry entry = queue.top();
+    queue.pop();
+    if (entry.is_key) {
+      result->push_back(entry.state);
+      continue;
+    }
+    PredictiveLookupSearchState &state = entry.state;
+    if (key_trie_.IsTerminalNode(state.node)) {
+      const int key_id = key_trie_.GetKeyIdOfTerminalNode(state.node);
+      queue.push({GetMinTokenCost(key_id), true, state});
+    }
+    for (key_trie_.MoveToFirstChild(&state.node);
+         key_trie_.IsValidNode(state.node);
+         key_trie_.MoveToNextSibling(&state.node)) {
+      push_subtree(PredictiveLookupSearchState(state.node, state.key_pos + 1,
+                                               state.num_expanded));
+    }
+  }
+}
+
 void SystemDictionary::LookupPredictive(
     absl::string_view key, const ConversionRequest &conversion_request,
     Callback *callback) const {
@@ -649,7 +771,14 @@ void SystemDictionary::LookupPredictive(
   constexpr size_t kLookupLimit = 64;
   std::vector<PredictiveLookupSearchState> result;
   result.reserve(kLookupLimit);
-  CollectPredictiveNodesInBfsOrder(encoded_key, table, kLookupLimit, &result);
+  if (conversion_request.options().predictive_lookup_in_cost_order &&
+      !subtree_cost_.empty()) {
+    CollectPredictiveNodesInCostOrder(encoded_key, table, kLookupLimit,
+                                      &result);
+  } else {
+    CollectPredictiveNodesInBfsOrder(encoded_key, table, kLookupLimit,
+                                     &result);
+  }
 
   // Reused buffer and instances inside the following loop.
   char encoded_actual_key_buffer[LoudsTrie::kMaxDepth + 1];
@@ -705,8 +834,8 @@ void SystemDictionary::LookupPredictive(
     }
 
     const int key_id = key_trie_.GetKeyIdOfTerminalNode(state.node);
-    for (TokenDecodeIterator iter(codec_, value_trie_, frequent_pos_,
-                                  actual_key,
+    for (TokenDecodeIterator iter(codec_, value_trie_, value_array_,
+                                  frequent_pos_, actual_key,
                                   GetTokenArrayPtr(token_array_, key_id));
          !iter.Done(); iter.Next()) {
       const TokenInfo &token_info = iter.Get();
@@ -742,6 +871,7 @@ namespace {
 template <typename Func>
 void RunCallbackOnEachPrefix(const LoudsTrie &key_trie,
                              const LoudsTrie &value_trie,
+                             const SerializedStringArray &value_array,
                              const BitVectorBasedArray &token_array,
                              const SystemDictionaryCodecInterface *codec,
                              const uint32_t *frequent_pos, const char *key,
@@ -783,7 +913,8 @@ void RunCallbackOnEachPrefix(const LoudsTrie &key_trie,
     }
 
     const int key_id = key_trie.GetKeyIdOfTerminalNode(node);
-    for (TokenDecodeIterator iter(codec, value_trie, frequent_pos, prefix,
+    for (TokenDecodeIterator iter(codec, value_trie, value_array, frequent_pos,
+                                  prefix,
                                   GetTokenArrayPtr(token_array, key_id));
          !iter.Done(); iter.Next()) {
       const TokenInfo &token_info = iter.Get();
@@ -887,8 +1018,8 @@ SystemDictionary::LookupPrefixWithKeyExpansionImpl(
     }
 
     const int key_id = key_trie_.GetKeyIdOfTerminalNode(node);
-    for (TokenDecodeIterator iter(codec_, value_trie_, frequent_pos_,
-                                  *actual_prefix,
+    for (TokenDecodeIterator iter(codec_, value_trie_, value_array_,
+                                  frequent_pos_, *actual_prefix,
                                   GetTokenArrayPtr(token_array_, key_id));
          !iter.Done(); iter.Next()) {
       const TokenInfo &token_info = iter.Get();
@@ -909,15 +1040,17 @@ SystemDictionary::LookupPrefixWithKeyExpansionImpl(
   }
   const char current_char = encoded_key[key_pos];
   const ExpandedKey &chars = table.ExpandKey(current_char);
-  for (key_trie_.MoveToFirstChild(&node); key_trie_.IsValidNode(node);
-       key_trie_.MoveToNextSibling(&node)) {
-    const char c = key_trie_.GetEdgeLabelToParentNode(node);
+  const LoudsTrie::Node first_child = key_trie_.MoveToFirstChild(node);
+  const absl::string_view labels = key_trie_.GetSiblingLabels(first_child);
+  for (size_t i = 0; i < labels.size(); ++i) {
+    const char c = labels[i];
     if (!chars.IsHit(c)) {
       continue;
     }
     actual_key_buffer[key_pos] = c;
     const Callback::ResultType result = LookupPrefixWithKeyExpansionImpl(
-        key, encoded_key, table, callback, node, key_pos + 1,
+        key, encoded_key, table, callback,
+        LoudsTrie::MoveToNextSibling(first_child, i), key_pos + 1,
         num_expanded + static_cast<int>(c != current_char), actual_key_buffer,
         actual_prefix);
     if (result == Callback::TRAVERSE_DONE) {
@@ -935,9 +1068,9 @@ void SystemDictionary::LookupPrefix(absl::string_view key,
   codec_->EncodeKey(key, &encoded_key);
 
   if (!conversion_request.IsKanaModifierInsensitiveConversion()) {
-    RunCallbackOnEachPrefix(key_trie_, value_trie_, token_array_, codec_,
-                            frequent_pos_, key.data(), encoded_key, callback,
-                            SelectAllTokens());
+    RunCallbackOnEachPrefix(key_trie_, value_trie_, value_array_, token_array_,
+                            codec_, frequent_pos_, key.data(), encoded_key,
+                            callback, SelectAllTokens());
     return;
   }
 
@@ -967,7 +1100,8 @@ void SystemDictionary::LookupExact(absl::string_view key,
     return;
   }
   // Callback on each token.
-  for (TokenDecodeIterator iter(codec_, value_trie_, frequent_pos_, key,
+  for (TokenDecodeIterator iter(codec_, value_trie_, value_array_,
+                                frequent_pos_, key,
                                 GetTokenArrayPtr(token_array_, key_id));
        !iter.Done(); iter.Next()) {
     if (callback->OnToken(key, key, *iter.Get().token) !=
@@ -1015,9 +1149,6 @@ void SystemDictionary::PopulateReverseLookupCache(absl::string_view str) const {
     // as we have already built the index for reverse lookup.
     return;
   }
-  reverse_lookup_cache_ = std::make_unique<ReverseLookupCache>();
-  DCHECK(reverse_lookup_cache_.get());
-
   // Iterate each suffix and collect IDs of all substrings.
   absl::btree_set<int> id_set;
   int pos = 0;
@@ -1031,11 +1162,16 @@ void SystemDictionary::PopulateReverseLookupCache(absl::string_view str) const {
     pos += strings::OneCharLen(suffix.data());
   }
   // Collect tokens for all IDs.
-  ScanTokens(id_set, reverse_lookup_cache_.get());
+  auto cache = std::make_shared<ReverseLookupCache>();
+  ScanTokens(id_set, cache.get());
+  std::atomic_store(
+      &reverse_lookup_cache_,
+      std::shared_ptr<const ReverseLookupCache>(std::move(cache)));
 }
 
 void SystemDictionary::ClearReverseLookupCache() const {
-  reverse_lookup_cache_.reset();
+  std::atomic_store(&reverse_lookup_cache_,
+                    std::shared_ptr<const ReverseLookupCache>());
 }
 
 namespace {
@@ -1073,9 +1209,9 @@ void SystemDictionary::RegisterReverseLookupTokensForT13N(
   std::string hiragana_value = japanese_util::KatakanaToHiragana(value);
   std::string encoded_key;
   codec_->EncodeKey(hiragana_value, &encoded_key);
-  RunCallbackOnEachPrefix(key_trie_, value_trie_, token_array_, codec_,
-                          frequent_pos_, hiragana_value.data(), encoded_key,
-                          callback,
+  RunCallbackOnEachPrefix(key_trie_, value_trie_, value_array_, token_array_,
+                          codec_, frequent_pos_, hiragana_value.data(),
+                          encoded_key, callback,
                           FilterTokenForRegisterReverseLookupTokensForT13N());
 }
 
@@ -1087,14 +1223,16 @@ void SystemDictionary::RegisterReverseLookupTokensForValue(
   absl::btree_set<int> id_set;
   AddKeyIdsOfAllPrefixes(value_trie_, lookup_key, &id_set);
 
-  ReverseLookupCache *results = nullptr;
+  const ReverseLookupCache *results = nullptr;
   ReverseLookupCache non_cached_results;
+  // Holds the cache alive even if another thread replaces it meanwhile.
+  const std::shared_ptr<const ReverseLookupCache> cache =
+      std::atomic_load(&reverse_lookup_cache_);
   if (reverse_lookup_index_ != nullptr) {
     reverse_lookup_index_->FillResultMap(id_set, &non_cached_results.results);
     results = &non_cached_results;
-  } else if (reverse_lookup_cache_ != nullptr &&
-             reverse_lookup_cache_->IsAvailable(id_set)) {
-    results = reverse_lookup_cache_.get();
+  } else if (cache != nullptr && cache->IsAvailable(id_set)) {
+    results = cache.get();
   } else {
     // Cache is not available. Get token for each ID.
     ScanTokens(id_set, &non_cached_results);
@@ -1141,7 +1279,7 @@ void SystemDictionary::RegisterReverseLookupResults(
         continue;
       }
       for (TokenDecodeIterator iter(
-               codec_, value_trie_, frequent_pos_, tokens_key,
+               codec_, value_trie_, value_array_, frequent_pos_, tokens_key,
                encoded_tokens_ptr + reverse_result.tokens_offset);
            !iter.Done(); iter.Next()) {
         const TokenInfo &token_info = iter.Get();
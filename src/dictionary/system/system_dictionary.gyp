@@ -59,6 +59,7 @@
         '<(mozc_oss_src_dir)/base/absl.gyp:absl_status',
         '<(mozc_oss_src_dir)/base/base.gyp:base_core',
         '<(mozc_oss_src_dir)/base/base.gyp:japanese_util',
+        '<(mozc_oss_src_dir)/base/base.gyp:serialized_string_array',
         '<(mozc_oss_src_dir)/request/request.gyp:conversion_request',
         '<(mozc_oss_src_dir)/storage/louds/louds.gyp:bit_vector_based_array',
         '<(mozc_oss_src_dir)/storage/louds/louds.gyp:louds_trie',
@@ -94,7 +95,9 @@
       'dependencies': [
         '<(mozc_oss_src_dir)/base/base.gyp:base_core',
         '<(mozc_oss_src_dir)/base/base.gyp:japanese_util',
+        '<(mozc_oss_src_dir)/base/base.gyp:serialized_string_array',
         '<(mozc_oss_src_dir)/storage/louds/louds.gyp:bit_vector_based_array_builder',
+        '<(mozc_oss_src_dir)/storage/louds/louds.gyp:louds_trie',
         '<(mozc_oss_src_dir)/storage/louds/louds.gyp:louds_trie_builder',
         '<(mozc_oss_src_dir)/dictionary/dictionary_base.gyp:pos_matcher',
         '<(mozc_oss_src_dir)/dictionary/dictionary_base.gyp:text_dictionary_loader',
@@ -39,6 +39,8 @@
 #include "absl/container/btree_set.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "base/container/serialized_string_array.h"
 #include "dictionary/dictionary_interface.h"
 #include "dictionary/file/codec_interface.h"
 #include "dictionary/file/dictionary_file.h"
@@ -51,6 +53,10 @@
 namespace mozc {
 namespace dictionary {
 
+// All the lookup methods are safe to call concurrently once the dictionary is
+// built. The reverse lookup cache is swapped atomically; populating it on one
+// thread never invalidates a lookup on another thread and at worst causes a
+// cache miss there.
 class SystemDictionary : public DictionaryInterface {
  public:
   // System dictionary options represented as bitwise enum.
@@ -187,15 +193,25 @@ class SystemDictionary : public DictionaryInterface {
   void CollectPredictiveNodesInBfsOrder(
       absl::string_view encoded_key, const KeyExpansionTable &table,
       size_t limit, std::vector<PredictiveLookupSearchState> *result) const;
+  void CollectPredictiveNodesInCostOrder(
+      absl::string_view encoded_key, const KeyExpansionTable &table,
+      size_t limit, std::vector<PredictiveLookupSearchState> *result) const;
+  int GetMinTokenCost(int key_id) const;
 
   storage::louds::LoudsTrie key_trie_;
   storage::louds::LoudsTrie value_trie_;
+  // Optional; empty unless the dictionary was built with the value array.
+  SerializedStringArray value_array_;
   storage::louds::BitVectorBasedArray token_array_;
   const uint32_t *frequent_pos_;
+  // Optional; empty for dictionaries built without the annotation.
+  absl::Span<const uint8_t> subtree_cost_;
   const SystemDictionaryCodecInterface *codec_;
   KeyExpansionTable hiragana_expansion_table_;
   std::unique_ptr<DictionaryFile> dictionary_file_;
-  mutable std::unique_ptr<ReverseLookupCache> reverse_lookup_cache_;
+  // Accessed only through std::atomic_load/store so that a reverse lookup
+  // running on another thread keeps its own snapshot of the cache.
+  mutable std::shared_ptr<const ReverseLookupCache> reverse_lookup_cache_;
   std::unique_ptr<ReverseLookupIndex> reverse_lookup_index_;
 };
 
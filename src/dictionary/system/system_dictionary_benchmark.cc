@@ -27,3 +27,139 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+// Measures the size/speed trade-off of the optional value array section.
+//
+// system_dictionary_benchmark
+//  --input="dictionary00.txt dictionary01.txt"
+//  --user_pos_manager_data=user_pos_manager.data
+//
+// Builds the system dictionary with and without the value array, then prints
+// the image sizes and the time to look up every key in the input.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/log/check.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "base/init_mozc.h"
+#include "base/stopwatch.h"
+#include "data_manager/data_manager.h"
+#include "dictionary/dictionary_interface.h"
+#include "dictionary/dictionary_token.h"
+#include "dictionary/pos_matcher.h"
+#include "dictionary/system/system_dictionary.h"
+#include "dictionary/system/system_dictionary_builder.h"
+#include "dictionary/text_dictionary_loader.h"
+#include "request/conversion_request.h"
+
+ABSL_FLAG(std::string, input, "", "space separated input text files");
+ABSL_FLAG(std::string, user_pos_manager_data, "", "user pos manager data");
+ABSL_FLAG(int32_t, iterations, 3, "number of lookup passes over all keys");
+
+namespace mozc {
+namespace dictionary {
+namespace {
+
+// Counts tokens so that the lookups cannot be optimized away.
+class CountTokenCallback : public DictionaryInterface::Callback {
+ public:
+  ResultType OnToken(absl::string_view key, absl::string_view actual_key,
+                     const Token &token) override {
+    value_bytes_ += token.value.size();
+    return TRAVERSE_CONTINUE;
+  }
+
+  uint64_t value_bytes() const { return value_bytes_; }
+
+ private:
+  uint64_t value_bytes_ = 0;
+};
+
+std::string BuildImage(absl::Span<const std::unique_ptr<Token>> tokens,
+                       bool store_value_array) {
+  SystemDictionaryBuilder builder;
+  builder.set_store_value_array(store_value_array);
+  builder.BuildFromTokens(tokens);
+  std::ostringstream os;
+  builder.WriteToStream("", &os);
+  return os.str();
+}
+
+void RunBenchmark(absl::string_view label,
+                  absl::Span<const std::unique_ptr<Token>> tokens,
+                  bool store_value_array) {
+  const std::string image = BuildImage(tokens, store_value_array);
+  std::unique_ptr<SystemDictionary> dictionary =
+      SystemDictionary::Builder(image.data(), image.size()).Build().value();
+
+  const ConversionRequest convreq;
+  const int iterations = absl::GetFlag(FLAGS_iterations);
+  CountTokenCallback prefix_callback, exact_callback;
+
+  Stopwatch prefix_stopwatch = Stopwatch::StartNew();
+  for (int i = 0; i < iterations; ++i) {
+    for (const std::unique_ptr<Token> &token : tokens) {
+      dictionary->LookupPrefix(token->key, convreq, &prefix_callback);
+    }
+  }
+  prefix_stopwatch.Stop();
+
+  Stopwatch exact_stopwatch = Stopwatch::StartNew();
+  for (int i = 0; i < iterations; ++i) {
+    for (const std::unique_ptr<Token> &token : tokens) {
+      dictionary->LookupExact(token->key, convreq, &exact_callback);
+    }
+  }
+  exact_stopwatch.Stop();
+
+  const double num_lookups =
+      static_cast<double>(iterations) * std::max<size_t>(tokens.size(), 1);
+  std::cout << absl::StreamFormat(
+      "%-12s size=%10d bytes  prefix=%8.1f ns/lookup  exact=%8.1f ns/lookup  "
+      "(%d value bytes)\n",
+      label, image.size(),
+      absl::ToDoubleNanoseconds(prefix_stopwatch.GetElapsed()) / num_lookups,
+      absl::ToDoubleNanoseconds(exact_stopwatch.GetElapsed()) / num_lookups,
+      prefix_callback.value_bytes() + exact_callback.value_bytes());
+}
+
+}  // namespace
+}  // namespace dictionary
+}  // namespace mozc
+
+int main(int argc, char **argv) {
+  mozc::InitMozc(argv[0], &argc, &argv);
+
+  // User POS manager data for build tools has no magic number.
+  const char *kMagicNumber = "";
+  mozc::DataManager data_manager;
+  const mozc::DataManager::Status status =
+      data_manager.InitUserPosManagerDataFromFile(
+          absl::GetFlag(FLAGS_user_pos_manager_data), kMagicNumber);
+  CHECK_EQ(status, mozc::DataManager::Status::OK)
+      << "Failed to initialize data manager from "
+      << absl::GetFlag(FLAGS_user_pos_manager_data);
+
+  const mozc::dictionary::PosMatcher pos_matcher(
+      data_manager.GetPosMatcherData());
+  const std::vector<absl::string_view> files = absl::StrSplit(
+      absl::GetFlag(FLAGS_input), ' ', absl::SkipWhitespace());
+  mozc::dictionary::TextDictionaryLoader loader(pos_matcher);
+  loader.Load(absl::StrJoin(files, ","), "");
+
+  mozc::dictionary::RunBenchmark("value_trie", loader.tokens(), false);
+  mozc::dictionary::RunBenchmark("value_array", loader.tokens(), true);
+  return 0;
+}
@@ -31,9 +31,11 @@
 
 #include <algorithm>
 #include <climits>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <ios>
+#include <iterator>
 #include <map>
 #include <memory>
 #include <ostream>
@@ -45,15 +47,18 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/flags/flag.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
+#include "base/container/serialized_string_array.h"
 #include "base/file_stream.h"
 #include "base/file_util.h"
 #include "base/japanese_util.h"
+#include "base/thread.h"
 #include "base/util.h"
 #include "base/vlog.h"
 #include "dictionary/dictionary_token.h"
@@ -62,6 +67,7 @@
 #include "dictionary/system/codec_interface.h"
 #include "dictionary/system/words_info.h"
 #include "storage/louds/bit_vector_based_array_builder.h"
+#include "storage/louds/louds_trie.h"
 #include "storage/louds/louds_trie_builder.h"
 
 ABSL_FLAG(bool, preserve_intermediate_dictionary, false,
@@ -88,6 +94,65 @@ struct TokenGreaterThan {
   }
 };
 
+// Splits [0, size) into at most |num_threads| contiguous chunks and calls
+// |fn(begin, end)| for each of them concurrently. The first chunk runs on the
+// calling thread.
+void ParallelFor(size_t size, int num_threads,
+                 absl::FunctionRef<void(size_t, size_t)> fn) {
+  const size_t num_chunks =
+      std::min<size_t>(std::max(num_threads, 1), std::max<size_t>(size, 1));
+  if (num_chunks <= 1) {
+    fn(0, size);
+    return;
+  }
+  const size_t chunk_size = (size + num_chunks - 1) / num_chunks;
+  std::vector<Thread> threads;
+  threads.reserve(num_chunks - 1);
+  for (size_t begin = chunk_size; begin < size; begin += chunk_size) {
+    const size_t end = std::min(begin + chunk_size, size);
+    threads.emplace_back([fn, begin, end] { fn(begin, end); });
+  }
+  fn(0, chunk_size);
+  for (Thread &thread : threads) {
+    thread.Join();
+  }
+}
+
+// Equivalent to std::stable_sort(), but sorts |num_threads| runs concurrently
+// and then merges them pairwise. Since std::inplace_merge() is stable too, the
+// result is identical to the serial sort.
+template <typename T, typename Compare>
+void ParallelStableSort(std::vector<T> &v, int num_threads, Compare comp) {
+  const size_t num_runs =
+      std::min<size_t>(std::max(num_threads, 1), std::max<size_t>(v.size(), 1));
+  if (num_runs <= 1) {
+    std::stable_sort(v.begin(), v.end(), comp);
+    return;
+  }
+  std::vector<size_t> bounds(num_runs + 1);
+  for (size_t i = 0; i <= num_runs; ++i) {
+    bounds[i] = v.size() * i / num_runs;
+  }
+  ParallelFor(num_runs, num_threads, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      std::stable_sort(v.begin() + bounds[i], v.begin() + bounds[i + 1], comp);
+    }
+  });
+  for (size_t width = 1; width < num_runs; width *= 2) {
+    const size_t num_merges = (num_runs + 2 * width - 1) / (2 * width);
+    ParallelFor(num_merges, num_threads, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        const size_t first = 2 * width * i;
+        const size_t middle = std::min(first + width, num_runs);
+        const size_t last = std::min(first + 2 * width, num_runs);
+        std::inplace_merge(v.begin() + bounds[first],
+                           v.begin() + bounds[middle],
+                           v.begin() + bounds[last], comp);
+      }
+    });
+  }
+}
+
 void WriteSectionToFile(const DictionaryFileSection &section,
                         const std::string &filename) {
   if (absl::Status s = FileUtil::SetContents(
@@ -113,9 +178,19 @@ void SystemDictionaryBuilder::BuildFromTokensInternal(
     std::vector<Token *> tokens) {
   KeyInfoList key_info_list = ReadTokens(std::move(tokens));
 
-  BuildFrequentPos(key_info_list);
-  BuildValueTrie(key_info_list);
-  BuildKeyTrie(key_info_list);
+  if (num_threads_ > 1) {
+    // The value trie is the largest; build it while the key trie and the
+    // frequent POS table, which touch disjoint members, are built here.
+    BackgroundFuture<void> value_trie(
+        [this, &key_info_list] { BuildValueTrie(key_info_list); });
+    BuildFrequentPos(key_info_list);
+    BuildKeyTrie(key_info_list);
+    value_trie.Wait();
+  } else {
+    BuildFrequentPos(key_info_list);
+    BuildValueTrie(key_info_list);
+    BuildKeyTrie(key_info_list);
+  }
 
   SetIdForValue(&key_info_list);
   SetIdForKey(&key_info_list);
@@ -125,6 +200,12 @@ void SystemDictionaryBuilder::BuildFromTokensInternal(
   SetValueType(&key_info_list);
 
   BuildTokenArray(key_info_list);
+  if (store_subtree_cost_) {
+    BuildSubtreeCost(key_info_list);
+  }
+  if (store_value_array_) {
+    BuildValueArray(key_info_list);
+  }
 }
 
 void SystemDictionaryBuilder::WriteToFile(
@@ -164,6 +245,21 @@ void SystemDictionaryBuilder::WriteToStream(
       file_codec_->GetSectionName(codec_->GetSectionNameForPos()));
   sections.push_back(frequent_pos_section);
 
+  DictionaryFileSection value_array_section(
+      value_array_image_.data(), value_array_image_.size(),
+      file_codec_->GetSectionName(codec_->GetSectionNameForValueArray()));
+  if (!value_array_image_.empty()) {
+    sections.push_back(value_array_section);
+  }
+
+  DictionaryFileSection subtree_cost_section(
+      reinterpret_cast<const char *>(subtree_cost_.data()),
+      subtree_cost_.size(),
+      file_codec_->GetSectionName(codec_->GetSectionNameForSubtreeCost()));
+  if (!subtree_cost_.empty()) {
+    sections.push_back(subtree_cost_section);
+  }
+
   if (absl::GetFlag(FLAGS_preserve_intermediate_dictionary) &&
       !intermediate_output_file_base_path.empty()) {
     // Write out intermediate results to files.
@@ -174,6 +270,14 @@ void SystemDictionaryBuilder::WriteToStream(
     WriteSectionToFile(token_array_section, absl::StrCat(basepath, ".tokens"));
     WriteSectionToFile(frequent_pos_section,
                        absl::StrCat(basepath, ".freq_pos"));
+    if (!value_array_image_.empty()) {
+      WriteSectionToFile(value_array_section,
+                         absl::StrCat(basepath, ".value_array"));
+    }
+    if (!subtree_cost_.empty()) {
+      WriteSectionToFile(subtree_cost_section,
+                         absl::StrCat(basepath, ".subtree_cost"));
+    }
   }
 
   LOG(INFO) << "Start writing dictionary file.";
@@ -244,8 +348,8 @@ SystemDictionaryBuilder::KeyInfoList SystemDictionaryBuilder::ReadTokens(
   //    [KeyInfo(key:aaa)[Token 1][Token 2]][KeyInfo(key:abc)[Token 3]][...]
 
   // Step 1.
-  std::stable_sort(
-      tokens.begin(), tokens.end(),
+  ParallelStableSort(
+      tokens, num_threads_,
       [](const Token *l, const Token *r) { return l->key < r->key; });
 
   // Step 2.
@@ -262,9 +366,17 @@ SystemDictionaryBuilder::KeyInfoList SystemDictionaryBuilder::ReadTokens(
       last_key_info.key = token->key;
     }
     last_key_info.tokens.emplace_back(token);
-    last_key_info.tokens.back().value_type = GetValueType(token);
   }
   key_info_list.push_back(std::move(last_key_info));
+
+  ParallelFor(key_info_list.size(), num_threads_,
+              [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                  for (TokenInfo &token_info : key_info_list[i].tokens) {
+                    token_info.value_type = GetValueType(token_info.token);
+                  }
+                }
+              });
   return key_info_list;
 }
 
@@ -332,21 +444,54 @@ void SystemDictionaryBuilder::BuildValueTrie(const KeyInfoList &key_info_list) {
   value_trie_builder_.Build();
 }
 
-void SystemDictionaryBuilder::SetIdForValue(KeyInfoList *key_info_list) const {
-  for (KeyInfo &key_info : *key_info_list) {
-    for (TokenInfo &token_info : key_info.tokens) {
-      std::string value_str;
-      codec_->EncodeValue(token_info.token->value, &value_str);
-      token_info.id_in_value_trie = value_trie_builder_.GetId(value_str);
+void SystemDictionaryBuilder::BuildValueArray(
+    const KeyInfoList &key_info_list) {
+  // Tokens stored as hiragana/katakana flags have no entry in the value trie,
+  // so their slots (if any) stay empty. Other ids are dense in the trie.
+  int num_values = 0;
+  for (const KeyInfo &key_info : key_info_list) {
+    for (const TokenInfo &token_info : key_info.tokens) {
+      num_values = std::max(num_values, token_info.id_in_value_trie + 1);
     }
   }
+  std::vector<absl::string_view> values(num_values);
+  for (const KeyInfo &key_info : key_info_list) {
+    for (const TokenInfo &token_info : key_info.tokens) {
+      if (token_info.id_in_value_trie >= 0) {
+        values[token_info.id_in_value_trie] = token_info.token->value;
+      }
+    }
+  }
+  value_array_image_ =
+      SerializedStringArray::SerializeToBuffer(values, &value_array_buffer_);
+  LOG(INFO) << "Value array: " << num_values << " values, "
+            << value_array_image_.size() << " bytes";
+}
+
+void SystemDictionaryBuilder::SetIdForValue(KeyInfoList *key_info_list) const {
+  ParallelFor(key_info_list->size(), num_threads_,
+              [&](size_t begin, size_t end) {
+                std::string value_str;
+                for (size_t i = begin; i < end; ++i) {
+                  for (TokenInfo &token_info : (*key_info_list)[i].tokens) {
+                    value_str.clear();
+                    codec_->EncodeValue(token_info.token->value, &value_str);
+                    token_info.id_in_value_trie =
+                        value_trie_builder_.GetId(value_str);
+                  }
+                }
+              });
 }
 
 void SystemDictionaryBuilder::SortTokenInfo(KeyInfoList *key_info_list) const {
-  for (KeyInfo &key_info : *key_info_list) {
-    std::stable_sort(key_info.tokens.begin(), key_info.tokens.end(),
-                     TokenGreaterThan());
-  }
+  ParallelFor(key_info_list->size(), num_threads_,
+              [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                  std::vector<TokenInfo> &tokens = (*key_info_list)[i].tokens;
+                  std::stable_sort(tokens.begin(), tokens.end(),
+                                   TokenGreaterThan());
+                }
+              });
 }
 
 void SystemDictionaryBuilder::SetCostType(KeyInfoList *key_info_list) const {
@@ -446,11 +591,16 @@ void SystemDictionaryBuilder::BuildKeyTrie(const KeyInfoList &key_info_list) {
 }
 
 void SystemDictionaryBuilder::SetIdForKey(KeyInfoList *key_info_list) const {
-  for (KeyInfo &key_info : *key_info_list) {
-    std::string key_str;
-    codec_->EncodeKey(key_info.key, &key_str);
-    key_info.id_in_key_trie = key_trie_builder_.GetId(key_str);
-  }
+  ParallelFor(key_info_list->size(), num_threads_,
+              [&](size_t begin, size_t end) {
+                std::string key_str;
+                for (size_t i = begin; i < end; ++i) {
+                  KeyInfo &key_info = (*key_info_list)[i];
+                  key_str.clear();
+                  codec_->EncodeKey(key_info.key, &key_str);
+                  key_info.id_in_key_trie = key_trie_builder_.GetId(key_str);
+                }
+              });
 }
 
 void SystemDictionaryBuilder::BuildTokenArray(
@@ -465,10 +615,24 @@ void SystemDictionaryBuilder::BuildTokenArray(
       id_to_keyinfo_table[id] = &key_info;
     }
 
-    for (const KeyInfo *key_info : id_to_keyinfo_table) {
-      std::string tokens_str;
-      codec_->EncodeTokens(key_info->tokens, &tokens_str);
-      token_array_builder_.Add(tokens_str);
+    // Encode a bounded block of keys concurrently, then append them in id
+    // order so that the image does not depend on the number of threads.
+    constexpr size_t kBlockSize = 1 << 16;
+    std::vector<std::string> encoded;
+    for (size_t offset = 0; offset < id_to_keyinfo_table.size();
+         offset += kBlockSize) {
+      const size_t block_size =
+          std::min(kBlockSize, id_to_keyinfo_table.size() - offset);
+      encoded.assign(block_size, std::string());
+      ParallelFor(block_size, num_threads_, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          codec_->EncodeTokens(id_to_keyinfo_table[offset + i]->tokens,
+                               &encoded[i]);
+        }
+      });
+      for (const std::string &tokens_str : encoded) {
+        token_array_builder_.Add(tokens_str);
+      }
     }
   }
 
@@ -476,5 +640,52 @@ void SystemDictionaryBuilder::BuildTokenArray(
   token_array_builder_.Build();
 }
 
+namespace {
+
+// Fills |subtree_cost| for |node| and its descendants and returns the minimum
+// token cost in the subtree.
+int FillSubtreeCost(const storage::louds::LoudsTrie &key_trie,
+                    storage::louds::LoudsTrie::Node node,
+                    absl::Span<const int> min_cost_of_key,
+                    const SystemDictionaryCodecInterface &codec,
+                    std::vector<uint8_t> *subtree_cost) {
+  int min_cost = INT_MAX;
+  if (key_trie.IsTerminalNode(node)) {
+    min_cost = min_cost_of_key[key_trie.GetKeyIdOfTerminalNode(node)];
+  }
+  const int node_id = node.node_id();
+  for (key_trie.MoveToFirstChild(&node); key_trie.IsValidNode(node);
+       key_trie.MoveToNextSibling(&node)) {
+    min_cost = std::min(min_cost, FillSubtreeCost(key_trie, node,
+                                                  min_cost_of_key, codec,
+                                                  subtree_cost));
+  }
+  if (static_cast<size_t>(node_id) >= subtree_cost->size()) {
+    subtree_cost->resize(node_id + 1);
+  }
+  (*subtree_cost)[node_id] = codec.EncodeSubtreeCost(min_cost);
+  return min_cost;
+}
+
+}  // namespace
+
+void SystemDictionaryBuilder::BuildSubtreeCost(
+    const KeyInfoList &key_info_list) {
+  std::vector<int> min_cost_of_key(key_info_list.size(), INT_MAX);
+  for (const KeyInfo &key_info : key_info_list) {
+    int &min_cost = min_cost_of_key[key_info.id_in_key_trie];
+    for (const TokenInfo &token_info : key_info.tokens) {
+      min_cost = std::min(min_cost, token_info.token->cost);
+    }
+  }
+
+  storage::louds::LoudsTrie key_trie;
+  CHECK(key_trie.Open(
+      reinterpret_cast<const uint8_t *>(key_trie_builder_.image().data())));
+  subtree_cost_.clear();
+  FillSubtreeCost(key_trie, storage::louds::LoudsTrie::Node(), min_cost_of_key,
+                  *codec_, &subtree_cost_);
+}
+
 }  // namespace dictionary
 }  // namespace mozc
@@ -30,6 +30,7 @@
 #ifndef MOZC_DICTIONARY_SYSTEM_SYSTEM_DICTIONARY_BUILDER_H_
 #define MOZC_DICTIONARY_SYSTEM_SYSTEM_DICTIONARY_BUILDER_H_
 
+#include <algorithm>
 #include <cstdint>
 #include <deque>
 #include <map>
@@ -77,6 +78,28 @@ class SystemDictionaryBuilder final {
   }
   void BuildFromTokens(absl::Span<const std::unique_ptr<Token>> token);
 
+  // Sets the number of threads used by BuildFromTokens(). The output is
+  // byte-identical regardless of this value; 1 (default) builds serially.
+  void set_num_threads(int num_threads) {
+    num_threads_ = std::max(num_threads, 1);
+  }
+
+  // When enabled, BuildFromTokens() also emits an array of the plain value
+  // strings indexed by value trie id. SystemDictionary then looks values up
+  // directly instead of restoring them from the value trie, at the cost of a
+  // larger image. Disabled by default.
+  void set_store_value_array(bool store_value_array) {
+    store_value_array_ = store_value_array;
+  }
+
+  // When enabled, BuildFromTokens() also emits a lower bound of the token
+  // costs under each key trie node, which SystemDictionary uses for predictive
+  // lookup in cost order. Without it, the lookup falls back to BFS order.
+  // Disabled by default.
+  void set_store_subtree_cost(bool store_subtree_cost) {
+    store_subtree_cost_ = store_subtree_cost;
+  }
+
   void WriteToFile(const std::string &output_file) const;
   void WriteToStream(absl::string_view intermediate_output_file_base_path,
                      std::ostream *output_stream) const;
@@ -95,6 +118,8 @@ class SystemDictionaryBuilder final {
   void BuildValueTrie(const KeyInfoList &key_info_list);
   void BuildKeyTrie(const KeyInfoList &key_info_list);
   void BuildTokenArray(const KeyInfoList &key_info_list);
+  void BuildValueArray(const KeyInfoList &key_info_list);
+  void BuildSubtreeCost(const KeyInfoList &key_info_list);
 
   void SetIdForValue(KeyInfoList *key_info_list) const;
   void SetIdForKey(KeyInfoList *key_info_list) const;
@@ -108,9 +133,22 @@ class SystemDictionaryBuilder final {
   storage::louds::LoudsTrieBuilder key_trie_builder_;
   storage::louds::BitVectorBasedArrayBuilder token_array_builder_;
 
+  // Serialized image of SerializedStringArray; empty unless
+  // |store_value_array_| is set.
+  std::unique_ptr<uint32_t[]> value_array_buffer_;
+  absl::string_view value_array_image_;
+
+  // Encoded lower bound of the token costs under each key trie node, indexed
+  // by LOUDS node id; empty unless |store_subtree_cost_| is set.
+  std::vector<uint8_t> subtree_cost_;
+
   // mapping from {left_id, right_id} to POS index (0--255)
   std::map<uint32_t, int> frequent_pos_;
 
+  int num_threads_ = 1;
+  bool store_value_array_ = false;
+  bool store_subtree_cost_ = false;
+
   const SystemDictionaryCodecInterface *codec_ =
       SystemDictionaryCodecFactory::GetCodec();
   const DictionaryFileCodecInterface *file_codec_ =
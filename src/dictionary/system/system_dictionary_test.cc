@@ -36,6 +36,7 @@
 #include <limits>
 #include <memory>
 #include <set>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
@@ -47,15 +48,21 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
+#include "base/container/serialized_string_array.h"
 #include "base/file/temp_dir.h"
 #include "base/file_util.h"
+#include "base/thread.h"
 #include "config/config_handler.h"
 #include "data_manager/testing/mock_data_manager.h"
 #include "dictionary/dictionary_interface.h"
 #include "dictionary/dictionary_mock.h"
 #include "dictionary/dictionary_test_util.h"
 #include "dictionary/dictionary_token.h"
+#include "dictionary/file/codec_factory.h"
+#include "dictionary/file/codec_interface.h"
+#include "dictionary/file/section.h"
 #include "dictionary/pos_matcher.h"
+#include "dictionary/system/codec_interface.h"
 #include "dictionary/system/system_dictionary_builder.h"
 #include "dictionary/text_dictionary_loader.h"
 #include "protocol/commands.pb.h"
@@ -640,6 +647,92 @@ TEST_F(SystemDictionaryTest, LookupPredictiveCutOffEmulatingBFS) {
   EXPECT_FALSE(callback.IsFound(&tokens[1]));
 }
 
+TEST_F(SystemDictionaryTest, LookupPredictiveCutOffInCostOrder) {
+  Token tokens[] = {
+      {"あい", "ai", 30000, 0, 0, Token::NONE},
+      {"あいうえお", "aiueo", 0, 0, 0, Token::NONE},
+  };
+  std::vector<Token *> source_tokens = MakeTokenPointers(&tokens);
+  text_dict_.CollectTokens(&source_tokens);  // Load test data.
+  source_tokens.resize(std::min<size_t>(source_tokens.size(), 10000));
+  auto build = [&source_tokens](bool store_subtree_cost) {
+    SystemDictionaryBuilder builder;
+    builder.set_store_subtree_cost(store_subtree_cost);
+    builder.BuildFromTokens(source_tokens);
+    std::ostringstream os;
+    builder.WriteToStream("", &os);
+    return os.str();
+  };
+  const std::string bfs_image = build(false);
+  const std::string cost_image = build(true);
+  EXPECT_GT(cost_image.size(), bfs_image.size());
+
+  ConversionRequest::Options options;
+  options.predictive_lookup_in_cost_order = true;
+  const ConversionRequest convreq = ConversionRequestBuilder()
+                                        .SetConfig(config_)
+                                        .SetRequest(request_)
+                                        .SetOptions(std::move(options))
+                                        .Build();
+  {
+    // In cost order, the cheap long key is looked up even though there are
+    // many shorter entries starting with "あ", while the expensive short one
+    // is not.
+    std::unique_ptr<SystemDictionary> system_dic =
+        SystemDictionary::Builder(cost_image.data(), cost_image.size())
+            .Build()
+            .value();
+    CheckMultiTokensExistenceCallback callback({&tokens[0], &tokens[1]});
+    system_dic->LookupPredictive("あ", convreq, &callback);
+    EXPECT_FALSE(callback.IsFound(&tokens[0]));
+    EXPECT_TRUE(callback.IsFound(&tokens[1]));
+  }
+  {
+    // Without the subtree costs, the lookup falls back to BFS order.
+    std::unique_ptr<SystemDictionary> system_dic =
+        SystemDictionary::Builder(bfs_image.data(), bfs_image.size())
+            .Build()
+            .value();
+    CheckMultiTokensExistenceCallback callback({&tokens[0], &tokens[1]});
+    system_dic->LookupPredictive("あ", convreq, &callback);
+    EXPECT_TRUE(callback.IsFound(&tokens[0]));
+    EXPECT_FALSE(callback.IsFound(&tokens[1]));
+  }
+  {
+    // The subtree costs not matching the key trie are ignored, and the lookup
+    // falls back to BFS order as well.
+    const DictionaryFileCodecInterface *file_codec =
+        DictionaryFileCodecFactory::GetCodec();
+    const std::string subtree_cost_name = file_codec->GetSectionName(
+        SystemDictionaryCodecFactory::GetCodec()
+            ->GetSectionNameForSubtreeCost());
+    std::vector<DictionaryFileSection> sections;
+    ASSERT_OK(file_codec->ReadSections(cost_image.data(), cost_image.size(),
+                                       &sections));
+    bool found = false;
+    for (DictionaryFileSection &section : sections) {
+      if (section.name == subtree_cost_name) {
+        section.len /= 2;
+        found = true;
+      }
+    }
+    ASSERT_TRUE(found);
+    std::ostringstream os;
+    file_codec->WriteSections(sections, &os);
+    const std::string truncated_image = os.str();
+
+    std::unique_ptr<SystemDictionary> system_dic =
+        SystemDictionary::Builder(truncated_image.data(),
+                                  truncated_image.size())
+            .Build()
+            .value();
+    CheckMultiTokensExistenceCallback callback({&tokens[0], &tokens[1]});
+    system_dic->LookupPredictive("あ", convreq, &callback);
+    EXPECT_TRUE(callback.IsFound(&tokens[0]));
+    EXPECT_FALSE(callback.IsFound(&tokens[1]));
+  }
+}
+
 TEST_F(SystemDictionaryTest, LookupExact) {
   const std::string k0 = "は";
   const std::string k1 = "はひふへほ";
@@ -809,6 +902,49 @@ TEST_F(SystemDictionaryTest, LookupReverseWithCache) {
   system_dic->ClearReverseLookupCache();
 }
 
+TEST_F(SystemDictionaryTest, ConcurrentLookupReverseWithCache) {
+  const std::string kDoraemon = "ドラえもん";
+
+  Token source_token;
+  source_token.key = "どらえもん";
+  source_token.value = kDoraemon;
+  source_token.cost = 1;
+  source_token.lid = 2;
+  source_token.rid = 3;
+  std::vector<Token *> source_tokens = {&source_token};
+  text_dict_.CollectTokens(&source_tokens);
+  std::unique_ptr<SystemDictionary> system_dic =
+      BuildSystemDictionary(source_tokens, source_tokens.size());
+  ASSERT_TRUE(system_dic);
+
+  Token target_token = source_token;
+  target_token.key.swap(target_token.value);
+  const ConversionRequest convreq = ConvReq(config_, request_);
+
+  // One thread keeps replacing the cache while the others look up; a lookup
+  // must find the token whether or not the cache covers it.
+  std::vector<Thread> threads;
+  threads.emplace_back([&system_dic, &kDoraemon] {
+    for (int i = 0; i < 100; ++i) {
+      system_dic->PopulateReverseLookupCache(i % 2 ? kDoraemon : "ドラミ");
+      system_dic->ClearReverseLookupCache();
+    }
+  });
+  for (int t = 0; t < 3; ++t) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < 100; ++i) {
+        CheckTokenExistenceCallback callback(&target_token);
+        system_dic->LookupReverse(kDoraemon, convreq, &callback);
+        ASSERT_TRUE(callback.found())
+            << "Could not find " << PrintToken(source_token);
+      }
+    });
+  }
+  for (Thread &thread : threads) {
+    thread.Join();
+  }
+}
+
 TEST_F(SystemDictionaryTest, SpellingCorrectionTokens) {
   std::vector<Token> tokens = {
       {"あぼがど", "アボカド", 1, 0, 2, Token::SPELLING_CORRECTION},
@@ -970,6 +1106,130 @@ TEST_F(SystemDictionaryTest, DoNotReturnNoModifierTargetWithLoudsTrie) {
   }
 }
 
+TEST_F(SystemDictionaryTest, ParallelBuildIsByteIdentical) {
+  absl::SetFlag(&FLAGS_min_key_length_to_use_small_cost_encoding,
+                original_flags_min_key_length_to_use_small_cost_encoding_);
+
+  auto build = [this](int num_threads) {
+    SystemDictionaryBuilder builder;
+    builder.set_num_threads(num_threads);
+    builder.BuildFromTokens(text_dict_.tokens());
+    std::ostringstream os;
+    builder.WriteToStream("", &os);
+    return os.str();
+  };
+  const std::string expected = build(1);
+  ASSERT_FALSE(expected.empty());
+  EXPECT_EQ(build(2), expected);
+  EXPECT_EQ(build(7), expected);
+}
+
+TEST_F(SystemDictionaryTest, ValueArrayGivesSameLookupResults) {
+  auto build = [this](bool store_value_array) {
+    SystemDictionaryBuilder builder;
+    builder.set_store_value_array(store_value_array);
+    builder.BuildFromTokens(text_dict_.tokens());
+    std::ostringstream os;
+    builder.WriteToStream("", &os);
+    return os.str();
+  };
+  const std::string trie_image = build(false);
+  const std::string array_image = build(true);
+  // The value array is stored in addition to the value trie.
+  EXPECT_GT(array_image.size(), trie_image.size());
+
+  std::unique_ptr<SystemDictionary> trie_dic =
+      SystemDictionary::Builder(trie_image.data(), trie_image.size())
+          .Build()
+          .value();
+  std::unique_ptr<SystemDictionary> array_dic =
+      SystemDictionary::Builder(array_image.data(), array_image.size())
+          .Build()
+          .value();
+
+  const ConversionRequest convreq = ConvReq(config_, request_);
+  for (const std::unique_ptr<Token> &token : text_dict_.tokens()) {
+    CollectTokenCallback expected, actual;
+    trie_dic->LookupPrefix(token->key, convreq, &expected);
+    array_dic->LookupPrefix(token->key, convreq, &actual);
+    std::vector<Token> expected_tokens(expected.tokens().begin(),
+                                       expected.tokens().end());
+    EXPECT_TOKENS_EQ_UNORDERED(MakeTokenPointers(&expected_tokens),
+                               actual.tokens());
+  }
+
+  CollectTokenCallback expected, actual;
+  trie_dic->LookupPredictive("あ", convreq, &expected);
+  array_dic->LookupPredictive("あ", convreq, &actual);
+  std::vector<Token> expected_tokens(expected.tokens().begin(),
+                                     expected.tokens().end());
+  ASSERT_FALSE(expected_tokens.empty());
+  EXPECT_TOKENS_EQ_UNORDERED(MakeTokenPointers(&expected_tokens),
+                             actual.tokens());
+}
+
+TEST_F(SystemDictionaryTest, TruncatedValueArrayFallsBackToValueTrie) {
+  auto build = [this](bool store_value_array) {
+    SystemDictionaryBuilder builder;
+    builder.set_store_value_array(store_value_array);
+    builder.BuildFromTokens(text_dict_.tokens());
+    std::ostringstream os;
+    builder.WriteToStream("", &os);
+    return os.str();
+  };
+  const std::string trie_image = build(false);
+  const std::string array_image = build(true);
+
+  // Keeps only the first half of the value array.
+  const DictionaryFileCodecInterface *file_codec =
+      DictionaryFileCodecFactory::GetCodec();
+  const std::string value_array_name = file_codec->GetSectionName(
+      SystemDictionaryCodecFactory::GetCodec()->GetSectionNameForValueArray());
+  std::vector<DictionaryFileSection> sections;
+  ASSERT_OK(file_codec->ReadSections(array_image.data(), array_image.size(),
+                                     &sections));
+  std::unique_ptr<uint32_t[]> buffer;
+  for (DictionaryFileSection &section : sections) {
+    if (section.name != value_array_name) {
+      continue;
+    }
+    SerializedStringArray value_array;
+    ASSERT_TRUE(value_array.Init(absl::string_view(section.ptr, section.len)));
+    ASSERT_GT(value_array.size(), 1);
+    const std::vector<absl::string_view> values(
+        value_array.begin(), value_array.begin() + value_array.size() / 2);
+    const absl::string_view image =
+        SerializedStringArray::SerializeToBuffer(values, &buffer);
+    section.ptr = image.data();
+    section.len = image.size();
+  }
+  ASSERT_NE(buffer, nullptr);
+  std::ostringstream os;
+  file_codec->WriteSections(sections, &os);
+  const std::string truncated_image = os.str();
+
+  std::unique_ptr<SystemDictionary> trie_dic =
+      SystemDictionary::Builder(trie_image.data(), trie_image.size())
+          .Build()
+          .value();
+  std::unique_ptr<SystemDictionary> truncated_dic =
+      SystemDictionary::Builder(truncated_image.data(), truncated_image.size())
+          .Build()
+          .value();
+
+  // The values outside of the array are restored from the value trie.
+  const ConversionRequest convreq = ConvReq(config_, request_);
+  for (const std::unique_ptr<Token> &token : text_dict_.tokens()) {
+    CollectTokenCallback expected, actual;
+    trie_dic->LookupPrefix(token->key, convreq, &expected);
+    truncated_dic->LookupPrefix(token->key, convreq, &actual);
+    std::vector<Token> expected_tokens(expected.tokens().begin(),
+                                       expected.tokens().end());
+    EXPECT_TOKENS_EQ_UNORDERED(MakeTokenPointers(&expected_tokens),
+                               actual.tokens());
+  }
+}
+
 TEST_F(SystemDictionaryTest, ShouldNotUseSmallCostEncodingForHeteronyms) {
   absl::SetFlag(&FLAGS_min_key_length_to_use_small_cost_encoding,
                 original_flags_min_key_length_to_use_small_cost_encoding_);
@@ -30,6 +30,7 @@
 #ifndef MOZC_DICTIONARY_SYSTEM_TOKEN_DECODE_ITERATOR_H_
 #define MOZC_DICTIONARY_SYSTEM_TOKEN_DECODE_ITERATOR_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
@@ -37,6 +38,7 @@
 #include "absl/log/log.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "base/container/serialized_string_array.h"
 #include "base/japanese_util.h"
 #include "dictionary/dictionary_token.h"
 #include "dictionary/system/codec_interface.h"
@@ -52,6 +54,7 @@ class TokenDecodeIterator {
   TokenDecodeIterator &operator=(const TokenDecodeIterator &) = delete;
   TokenDecodeIterator(const SystemDictionaryCodecInterface *codec,
                       const storage::louds::LoudsTrie &value_trie,
+                      const SerializedStringArray &value_array,
                       const uint32_t *frequent_pos, absl::string_view key,
                       const uint8_t *ptr);
   ~TokenDecodeIterator() = default;
@@ -70,6 +73,14 @@ class TokenDecodeIterator {
   void NextInternal();
 
   void LookupValue(int id, std::string *value) const {
+    // Values are stored as is; skip restoring them from the trie. The trie is
+    // still used for the IDs outside of the array, e.g. when the array is
+    // absent or truncated.
+    if (id >= 0 && static_cast<size_t>(id) < value_array_->size()) {
+      const absl::string_view stored = (*value_array_)[id];
+      value->assign(stored.data(), stored.size());
+      return;
+    }
     char buffer[storage::louds::LoudsTrie::kMaxDepth + 1];
     const absl::string_view encoded_value =
         value_trie_->RestoreKeyString(id, buffer);
@@ -78,6 +89,7 @@ class TokenDecodeIterator {
 
   const SystemDictionaryCodecInterface *codec_;
   const storage::louds::LoudsTrie *value_trie_;
+  const SerializedStringArray *value_array_;
   const uint32_t *frequent_pos_;
 
   const absl::string_view key_;
@@ -95,10 +107,12 @@ class TokenDecodeIterator {
 
 inline TokenDecodeIterator::TokenDecodeIterator(
     const SystemDictionaryCodecInterface *codec,
-    const storage::louds::LoudsTrie &value_trie, const uint32_t *frequent_pos,
+    const storage::louds::LoudsTrie &value_trie,
+    const SerializedStringArray &value_array, const uint32_t *frequent_pos,
     absl::string_view key, const uint8_t *ptr)
     : codec_(codec),
       value_trie_(&value_trie),
+      value_array_(&value_array),
       frequent_pos_(frequent_pos),
       key_(key),
       state_(HAS_NEXT),
@@ -34,6 +34,7 @@
 #include "dictionary/text_dictionary_loader.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <iterator>
 #include <limits>
@@ -53,6 +54,7 @@
 #include "absl/types/span.h"
 #include "base/japanese_util.h"
 #include "base/multifile.h"
+#include "base/thread.h"
 #include "base/util.h"
 #include "base/vlog.h"
 #include "dictionary/dictionary_token.h"
@@ -60,6 +62,9 @@
 
 ABSL_FLAG(int32_t, tokens_reserve_size, 1400000,
           "Reserve the specified size of token buffer in advance.");
+ABSL_FLAG(int32_t, tokens_parse_batch_size, 1 << 16,
+          "Number of lines buffered and parsed at once when multiple threads "
+          "are used.");
 
 namespace mozc {
 namespace dictionary {
@@ -167,7 +172,9 @@ void TextDictionaryLoader::LoadWithLineLimit(
   }
 
   // Read system dictionary.
-  {
+  if (num_threads_ > 1) {
+    LoadTokensInParallel(dictionary_filename, &limit);
+  } else {
     InputMultiFile file(dictionary_filename);
     std::string line;
     while (limit > 0 && file.ReadLine(&line)) {
@@ -178,8 +185,8 @@ void TextDictionaryLoader::LoadWithLineLimit(
         --limit;
       }
     }
-    LOG(INFO) << tokens_.size() << " tokens from " << dictionary_filename;
   }
+  LOG(INFO) << tokens_.size() << " tokens from " << dictionary_filename;
 
   if (reading_correction_filename.empty() || limit <= 0) {
     return;
@@ -202,6 +209,55 @@ void TextDictionaryLoader::LoadWithLineLimit(
                  std::make_move_iterator(reading_correction_tokens.end()));
 }
 
+// Reads up to |*limit| lines in bounded batches and parses each batch with
+// |num_threads_| threads. Every thread fills its own contiguous range of the
+// batch, so the tokens are appended in the input order.
+void TextDictionaryLoader::LoadTokensInParallel(
+    const absl::string_view dictionary_filename, int *limit) {
+  const size_t batch_size =
+      std::max(absl::GetFlag(FLAGS_tokens_parse_batch_size), 1);
+  InputMultiFile file(dictionary_filename);
+  std::vector<std::string> lines;
+  std::vector<std::unique_ptr<Token>> batch;
+  std::string line;
+  bool eof = false;
+  while (*limit > 0 && !eof) {
+    lines.clear();
+    while (lines.size() < std::min<size_t>(batch_size, *limit)) {
+      if (!file.ReadLine(&line)) {
+        eof = true;
+        break;
+      }
+      Util::ChopReturns(&line);
+      lines.push_back(std::move(line));
+    }
+
+    batch.clear();
+    batch.resize(lines.size());
+    const size_t num_chunks = std::min<size_t>(num_threads_, lines.size());
+    std::vector<Thread> threads;
+    for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+      const size_t begin = lines.size() * chunk / num_chunks;
+      const size_t end = lines.size() * (chunk + 1) / num_chunks;
+      threads.emplace_back([this, &lines, &batch, begin, end] {
+        for (size_t i = begin; i < end; ++i) {
+          batch[i] = ParseTSVLine(lines[i]);
+        }
+      });
+    }
+    for (Thread &thread : threads) {
+      thread.Join();
+    }
+
+    for (std::unique_ptr<Token> &token : batch) {
+      if (token && *limit > 0) {
+        tokens_.push_back(std::move(token));
+        --*limit;
+      }
+    }
+  }
+}
+
 // Loads reading correction data into |tokens|.  The second argument is used to
 // determine costs of reading correction tokens and must be sorted by
 // OrderByValueThenByKey().  The output tokens are newly allocated and the
@@ -30,6 +30,7 @@
 #ifndef MOZC_DICTIONARY_TEXT_DICTIONARY_LOADER_H_
 #define MOZC_DICTIONARY_TEXT_DICTIONARY_LOADER_H_
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <utility>
@@ -71,6 +72,12 @@ class TextDictionaryLoader {
                          absl::string_view reading_correction_filename,
                          int limit);
 
+  // Sets the number of threads used to parse the dictionary files. Tokens are
+  // stored in the same order regardless of this value.
+  void set_num_threads(int num_threads) {
+    num_threads_ = std::max(num_threads, 1);
+  }
+
   // Clears the loaded tokens.
   void Clear() { tokens_.clear(); }
 
@@ -99,6 +106,10 @@ class TextDictionaryLoader {
   // Otherwise, the method returns false.
   bool RewriteSpecialToken(Token *token, absl::string_view label) const;
 
+  // Parses the dictionary file with |num_threads_| threads, keeping at most
+  // one batch of raw lines in memory. Decrements |*limit| for each token.
+  void LoadTokensInParallel(absl::string_view dictionary_filename, int *limit);
+
   std::unique_ptr<Token> ParseTSVLine(absl::string_view line) const;
   std::unique_ptr<Token> ParseTSV(
       absl::Span<const absl::string_view> columns) const;
@@ -106,6 +117,7 @@ class TextDictionaryLoader {
   const uint16_t zipcode_id_;
   const uint16_t isolated_word_id_;
   std::vector<std::unique_ptr<Token>> tokens_;
+  int num_threads_ = 1;
 
   FRIEND_TEST(TextDictionaryLoaderTest, RewriteSpecialTokenTest);
 };
@@ -29,6 +29,7 @@
 
 #include "dictionary/text_dictionary_loader.h"
 
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <vector>
@@ -220,6 +221,40 @@ TEST_F(TextDictionaryLoaderTest, LoadMultipleFilesTest) {
   }
 }
 
+TEST_F(TextDictionaryLoaderTest, ParallelLoadTest) {
+  const std::string filename1 =
+      FileUtil::JoinPath(temp_dir_.path(), "test1.tsv");
+  const std::string filename2 =
+      FileUtil::JoinPath(temp_dir_.path(), "test2.tsv");
+  const std::string filename = filename1 + "," + filename2;
+
+  ASSERT_OK(FileUtil::SetContents(filename1, kTextLines));
+  FileUnlinker unlinker1(filename1);
+  ASSERT_OK(FileUtil::SetContents(filename2, kTextLines));
+  FileUnlinker unlinker2(filename2);
+
+  for (const int limit : {-1, 5, 1}) {
+    std::unique_ptr<TextDictionaryLoader> serial = CreateTextDictionaryLoader();
+    serial->LoadWithLineLimit(filename, "", limit);
+    std::unique_ptr<TextDictionaryLoader> parallel =
+        CreateTextDictionaryLoader();
+    parallel->set_num_threads(4);
+    parallel->LoadWithLineLimit(filename, "", limit);
+
+    ASSERT_EQ(parallel->tokens().size(), serial->tokens().size());
+    for (size_t i = 0; i < serial->tokens().size(); ++i) {
+      const Token &expected = *serial->tokens()[i];
+      const Token &actual = *parallel->tokens()[i];
+      EXPECT_EQ(actual.key, expected.key);
+      EXPECT_EQ(actual.value, expected.value);
+      EXPECT_EQ(actual.lid, expected.lid);
+      EXPECT_EQ(actual.rid, expected.rid);
+      EXPECT_EQ(actual.cost, expected.cost);
+      EXPECT_EQ(actual.attributes, expected.attributes);
+    }
+  }
+}
+
 TEST_F(TextDictionaryLoaderTest, ReadingCorrectionTest) {
   std::unique_ptr<TextDictionaryLoader> loader = CreateTextDictionaryLoader();
 
@@ -30,12 +30,15 @@
 #include "dictionary/user_dictionary.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <limits>
 #include <memory>
 #include <optional>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <utility>
 #include <vector>
 
@@ -46,10 +49,10 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/ascii.h"
-#include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "base/file_util.h"
 #include "base/hash.h"
 #include "base/singleton.h"
@@ -69,32 +72,14 @@
 #include "protocol/config.pb.h"
 #include "protocol/user_dictionary_storage.pb.h"
 #include "request/conversion_request.h"
+#include "storage/louds/louds_trie.h"
+#include "storage/louds/louds_trie_builder.h"
 #include "usage_stats/usage_stats.h"
 
 namespace mozc {
 namespace dictionary {
 namespace {
 
-struct OrderByKey {
-  bool operator()(const UserPos::Token &token, absl::string_view key) const {
-    return token.key < key;
-  }
-
-  bool operator()(absl::string_view key, const UserPos::Token &token) const {
-    return key < token.key;
-  }
-};
-
-struct OrderByKeyPrefix {
-  bool operator()(const UserPos::Token &token, absl::string_view prefix) const {
-    return absl::string_view(token.key).substr(0, prefix.size()) < prefix;
-  }
-
-  bool operator()(absl::string_view prefix, const UserPos::Token &token) const {
-    return prefix < absl::string_view(token.key).substr(0, prefix.size());
-  }
-};
-
 struct OrderByKeyThenById {
   bool operator()(const UserPos::Token &lhs, const UserPos::Token &rhs) const {
     const int comp = lhs.key.compare(rhs.key);
@@ -132,22 +117,85 @@ class UserDictionaryFileManager {
 
 }  // namespace
 
+// Tokens sorted by key and then by POS ID, indexed by a LOUDS trie over the
+// distinct keys. Each key ID of the trie maps to the range of its tokens. The
+// index is immutable once loaded, so it can be built by the reloader thread
+// and read without synchronization after it's published.
 class UserDictionary::TokensIndex {
  public:
+  using Node = storage::louds::LoudsTrie::Node;
+
   TokensIndex(const UserPosInterface *user_pos,
               SuppressionDictionary *suppression_dictionary)
       : user_pos_(user_pos), suppression_dictionary_(suppression_dictionary) {}
 
+  TokensIndex(const TokensIndex &) = delete;
+  TokensIndex &operator=(const TokensIndex &) = delete;
+
   ~TokensIndex() = default;
 
   bool empty() const { return user_pos_tokens_.empty(); }
   size_t size() const { return user_pos_tokens_.size(); }
 
-  std::vector<UserPos::Token>::const_iterator begin() const {
-    return user_pos_tokens_.begin();
+  // Returns the tokens whose key is exactly |key|.
+  absl::Span<const UserPos::Token> FindExact(absl::string_view key) const {
+    Node node;
+    if (!Traverse(key, &node) || !trie_.IsTerminalNode(node)) {
+      return {};
+    }
+    return GetTokens(node);
   }
-  std::vector<UserPos::Token>::const_iterator end() const {
-    return user_pos_tokens_.end();
+
+  // Returns the tokens whose key starts with |prefix|, in the order of key.
+  absl::Span<const UserPos::Token> FindPredictive(
+      absl::string_view prefix) const {
+    Node first;
+    if (!Traverse(prefix, &first)) {
+      return {};
+    }
+    // In the subtree of |first|, the smallest key is the first terminal node
+    // on the leftmost path and the largest one is the rightmost leaf. Since
+    // the tokens are sorted by key, the tokens between them are the result.
+    Node last = first;
+    while (!trie_.IsTerminalNode(first)) {
+      trie_.MoveToFirstChild(&first);
+    }
+    for (Node child = trie_.MoveToFirstChild(last);;
+         child = trie_.MoveToFirstChild(last)) {
+      const size_t num_children = trie_.GetSiblingLabels(child).size();
+      if (num_children == 0) {
+        break;
+      }
+      last = storage::louds::LoudsTrie::MoveToNextSibling(child,
+                                                          num_children - 1);
+    }
+    const PostingRange &begin = postings_[trie_.GetKeyIdOfTerminalNode(first)];
+    const PostingRange &end = postings_[trie_.GetKeyIdOfTerminalNode(last)];
+    return absl::MakeConstSpan(user_pos_tokens_)
+        .subspan(begin.begin, end.end - begin.begin);
+  }
+
+  // Calls |func| for the tokens whose key is a prefix of |key|, from the
+  // shortest key. Stops when |func| returns false.
+  template <typename Func>
+  void ForEachPrefixToken(absl::string_view key, Func func) const {
+    if (user_pos_tokens_.empty()) {
+      return;
+    }
+    Node node;
+    for (const char c : key) {
+      if (!trie_.MoveToChildByLabel(c, &node)) {
+        return;
+      }
+      if (!trie_.IsTerminalNode(node)) {
+        continue;
+      }
+      for (const UserPos::Token &token : GetTokens(node)) {
+        if (!func(token)) {
+          return;
+        }
+      }
+    }
   }
 
   void Load(const user_dictionary::UserDictionaryStorage &storage) {
@@ -237,6 +285,8 @@ class UserDictionary::TokensIndex {
     std::sort(user_pos_tokens_.begin(), user_pos_tokens_.end(),
               OrderByKeyThenById());
 
+    BuildTrie();
+
     MOZC_VLOG(1) << user_pos_tokens_.size() << " user dic entries loaded";
 
     usage_stats::UsageStats::SetInteger(
@@ -244,9 +294,154 @@ class UserDictionary::TokensIndex {
   }
 
  private:
+  // Range of |user_pos_tokens_| sharing the same key.
+  struct PostingRange {
+    uint32_t begin = 0;
+    uint32_t end = 0;
+  };
+
+  // Builds the trie over the distinct keys of the sorted |user_pos_tokens_|.
+  void BuildTrie() {
+    trie_.Close();
+    postings_.clear();
+    if (user_pos_tokens_.empty()) {
+      return;
+    }
+    storage::louds::LoudsTrieBuilder builder;
+    size_t num_keys = 0;
+    for (size_t i = 0; i < user_pos_tokens_.size(); ++i) {
+      if (i == 0 || user_pos_tokens_[i - 1].key != user_pos_tokens_[i].key) {
+        builder.Add(user_pos_tokens_[i].key);
+        ++num_keys;
+      }
+    }
+    builder.Build();
+
+    // Key IDs are assigned densely from 0 by the builder.
+    std::vector<PostingRange> postings(num_keys);
+    for (uint32_t begin = 0; begin < user_pos_tokens_.size();) {
+      const std::string &key = user_pos_tokens_[begin].key;
+      uint32_t end = begin + 1;
+      while (end < user_pos_tokens_.size() &&
+             user_pos_tokens_[end].key == key) {
+        ++end;
+      }
+      const int id = builder.GetId(key);
+      DCHECK_GE(id, 0);
+      DCHECK_LT(id, num_keys);
+      postings[id] = {begin, end};
+      begin = end;
+    }
+    postings_ = std::move(postings);
+    trie_image_ = builder.image();
+    CHECK(trie_.Open(reinterpret_cast<const uint8_t *>(trie_image_.data())));
+  }
+
+  // Moves |node| to the node reached by |key| from the root. Returns false if
+  // there's no such node.
+  bool Traverse(absl::string_view key, Node *node) const {
+    if (user_pos_tokens_.empty()) {
+      return false;
+    }
+    for (const char c : key) {
+      if (!trie_.MoveToChildByLabel(c, node)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  absl::Span<const UserPos::Token> GetTokens(const Node &node) const {
+    const PostingRange &range = postings_[trie_.GetKeyIdOfTerminalNode(node)];
+    return absl::MakeConstSpan(user_pos_tokens_)
+        .subspan(range.begin, range.end - range.begin);
+  }
+
   const UserPosInterface *user_pos_;
   SuppressionDictionary *suppression_dictionary_;
   std::vector<UserPos::Token> user_pos_tokens_;
+  std::vector<PostingRange> postings_;
+  std::string trie_image_;
+  storage::louds::LoudsTrie trie_;
+};
+
+namespace {
+
+// Hazard pointers to the tokens indices being read, shared by all the user
+// dictionaries. A slot is either free (nullptr), claimed by a reader, or
+// holds the index the reader is using. Each slot has its own cache line so
+// that readers on different threads don't write to the same line.
+struct alignas(64) HazardSlot {
+  std::atomic<const void *> ptr = nullptr;
+};
+
+constexpr size_t kNumHazardSlots = 64;
+HazardSlot g_hazard_slots[kNumHazardSlots];
+
+// Stored in a slot claimed by a reader before it publishes the index.
+constexpr char kClaimedSlot = 0;
+
+std::atomic<const void *> *AcquireHazardSlot() {
+  // Start from a slot chosen by the thread id, so that concurrent readers
+  // usually find a free slot at the first attempt.
+  const size_t start =
+      std::hash<std::thread::id>()(std::this_thread::get_id()) %
+      kNumHazardSlots;
+  for (size_t i = start;; i = (i + 1) % kNumHazardSlots) {
+    const void *expected = nullptr;
+    if (g_hazard_slots[i].ptr.compare_exchange_strong(expected,
+                                                      &kClaimedSlot)) {
+      return &g_hazard_slots[i].ptr;
+    }
+    if ((i + 1) % kNumHazardSlots == start) {
+      // All the slots are in use.
+      std::this_thread::yield();
+    }
+  }
+}
+
+bool IsHazardPointer(const void *ptr) {
+  for (const HazardSlot &slot : g_hazard_slots) {
+    if (slot.ptr.load() == ptr) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+// Gives access to the current tokens index without taking a lock. The index
+// is published in a hazard pointer slot while this object is alive, and
+// Swap() doesn't delete an index that is still published.
+class UserDictionary::ScopedTokensIndex {
+ public:
+  explicit ScopedTokensIndex(const std::atomic<const TokensIndex *> &tokens)
+      : slot_(AcquireHazardSlot()) {
+    const TokensIndex *index = tokens.load();
+    while (true) {
+      slot_->store(index);
+      // Swap() may have replaced |index| before it was published. In that
+      // case, it may be deleted already, so retry with the new one.
+      const TokensIndex *current = tokens.load();
+      if (current == index) {
+        break;
+      }
+      index = current;
+    }
+    index_ = index;
+  }
+
+  ScopedTokensIndex(const ScopedTokensIndex &) = delete;
+  ScopedTokensIndex &operator=(const ScopedTokensIndex &) = delete;
+
+  ~ScopedTokensIndex() { slot_->store(nullptr, std::memory_order_release); }
+
+  const TokensIndex *operator->() const { return index_; }
+
+ private:
+  std::atomic<const void *> *slot_;
+  const TokensIndex *index_;
 };
 
 class UserDictionary::UserDictionaryReloader {
@@ -335,14 +530,16 @@ UserDictionary::UserDictionary(std::unique_ptr<const UserPosInterface> user_pos,
       user_pos_(std::move(user_pos)),
       pos_matcher_(pos_matcher),
       suppression_dictionary_(suppression_dictionary),
-      tokens_(std::make_unique<TokensIndex>(user_pos_.get(),
-                                            suppression_dictionary)) {
+      tokens_(new TokensIndex(user_pos_.get(), suppression_dictionary)) {
   DCHECK(user_pos_.get());
   DCHECK(suppression_dictionary_);
   Reload();
 }
 
-UserDictionary::~UserDictionary() { WaitForReloader(); }
+UserDictionary::~UserDictionary() {
+  WaitForReloader();
+  delete tokens_.load();
+}
 
 bool UserDictionary::HasKey(absl::string_view key) const {
   // TODO(noriyukit): Currently, we don't support HasKey() for user dictionary
@@ -362,25 +559,20 @@ bool UserDictionary::HasValue(absl::string_view value) const {
 void UserDictionary::LookupPredictive(
     absl::string_view key, const ConversionRequest &conversion_request,
     Callback *callback) const {
-  absl::ReaderMutexLock l(&mutex_);
-
   if (key.empty()) {
     MOZC_VLOG(2) << "string of length zero is passed.";
     return;
   }
-  if (tokens_->empty()) {
+  const ScopedTokensIndex tokens(tokens_);
+  if (tokens->empty()) {
     return;
   }
   if (conversion_request.config().incognito_mode()) {
     return;
   }
 
-  // Find the starting point of iteration over dictionary contents.
   Token token;
-  for (auto [begin, end] = std::equal_range(tokens_->begin(), tokens_->end(),
-                                            key, OrderByKeyPrefix());
-       begin != end; ++begin) {
-    const UserPos::Token &user_pos_token = *begin;
+  for (const UserPos::Token &user_pos_token : tokens->FindPredictive(key)) {
     switch (callback->OnKey(user_pos_token.key)) {
       case Callback::TRAVERSE_DONE:
         return;
@@ -408,40 +600,30 @@ void UserDictionary::LookupPredictive(
 void UserDictionary::LookupPrefix(absl::string_view key,
                                   const ConversionRequest &conversion_request,
                                   Callback *callback) const {
-  absl::ReaderMutexLock l(&mutex_);
-
   if (key.empty()) {
     LOG(WARNING) << "string of length zero is passed.";
     return;
   }
-  if (tokens_->empty()) {
+  const ScopedTokensIndex tokens(tokens_);
+  if (tokens->empty()) {
     return;
   }
   if (conversion_request.config().incognito_mode()) {
     return;
   }
 
-  // Find the starting point for iteration over dictionary contents.
-  const absl::string_view first_char = Utf8AsChars(key).front();
+  // Visit the tokens whose keys are prefixes of |key| by walking the trie
+  // along |key|. Returning false stops the iteration.
   Token token;
-  for (auto it = std::lower_bound(tokens_->begin(), tokens_->end(), first_char,
-                                  OrderByKey());
-       it != tokens_->end(); ++it) {
-    const UserPos::Token &user_pos_token = *it;
-    if (user_pos_token.key > key) {
-      break;
-    }
+  tokens->ForEachPrefixToken(key, [&](const UserPos::Token &user_pos_token) {
     if (user_pos_token.has_attribute(UserPos::Token::SUGGESTION_ONLY)) {
-      continue;
-    }
-    if (!absl::StartsWith(key, user_pos_token.key)) {
-      continue;
+      return true;
     }
     switch (callback->OnKey(user_pos_token.key)) {
       case Callback::TRAVERSE_DONE:
-        return;
+        return false;
       case Callback::TRAVERSE_NEXT_KEY:
-        continue;
+        return true;
       case Callback::TRAVERSE_CULL:
         LOG(FATAL) << "UserDictionary doesn't support culling.";
         break;
@@ -451,32 +633,32 @@ void UserDictionary::LookupPrefix(absl::string_view key,
     if (callback->OnActualKey(user_pos_token.key, user_pos_token.key,
                               /* num_expanded= */ 0) ==
         Callback::TRAVERSE_DONE) {
-      return;
+      return false;
     }
     PopulateTokenFromUserPosToken(user_pos_token, PREFIX, &token);
     switch (callback->OnToken(user_pos_token.key, user_pos_token.key, token)) {
       case Callback::TRAVERSE_DONE:
-        return;
+        return false;
       case Callback::TRAVERSE_CULL:
         LOG(FATAL) << "UserDictionary doesn't support culling.";
         break;
       default:
         break;
     }
-  }
+    return true;
+  });
 }
 
 void UserDictionary::LookupExact(absl::string_view key,
                                  const ConversionRequest &conversion_request,
                                  Callback *callback) const {
-  absl::ReaderMutexLock l(&mutex_);
-  if (key.empty() || tokens_->empty() ||
-      conversion_request.config().incognito_mode()) {
+  if (key.empty() || conversion_request.config().incognito_mode()) {
     return;
   }
-  auto [begin, end] =
-      std::equal_range(tokens_->begin(), tokens_->end(), key, OrderByKey());
-  if (begin == end) {
+  const ScopedTokensIndex tokens(tokens_);
+  const absl::Span<const UserPos::Token> user_pos_tokens =
+      tokens->FindExact(key);
+  if (user_pos_tokens.empty()) {
     return;
   }
   if (callback->OnKey(key) != Callback::TRAVERSE_CONTINUE) {
@@ -488,8 +670,7 @@ void UserDictionary::LookupExact(absl::string_view key,
   }
 
   Token token;
-  for (; begin != end; ++begin) {
-    const UserPos::Token &user_pos_token = *begin;
+  for (const UserPos::Token &user_pos_token : user_pos_tokens) {
     if (user_pos_token.has_attribute(UserPos::Token::SUGGESTION_ONLY)) {
       continue;
     }
@@ -512,16 +693,10 @@ bool UserDictionary::LookupComment(absl::string_view key,
     return false;
   }
 
-  absl::ReaderMutexLock l(&mutex_);
-  if (tokens_->empty()) {
-    return false;
-  }
+  const ScopedTokensIndex tokens(tokens_);
 
   // Set the comment that was found first.
-  for (auto [begin, end] = std::equal_range(tokens_->begin(), tokens_->end(),
-                                            key, OrderByKey());
-       begin != end; ++begin) {
-    const UserPos::Token &token = *begin;
+  for (const UserPos::Token &token : tokens->FindExact(key)) {
     if (token.value == value && !token.comment.empty()) {
       comment->assign(token.comment);
       return true;
@@ -567,17 +742,18 @@ void UserDictionary::WaitForReloader() { reloader_->Wait(); }
 
 void UserDictionary::Swap(std::unique_ptr<TokensIndex> new_tokens) {
   DCHECK(new_tokens);
-  absl::WriterMutexLock l(&mutex_);
-  tokens_ = std::move(new_tokens);
+  const TokensIndex *old_tokens = tokens_.exchange(new_tokens.release());
+  // Readers which loaded |old_tokens| have it in their hazard pointer slots.
+  // Wait for them to finish the lookups. New readers see |new_tokens|.
+  while (IsHazardPointer(old_tokens)) {
+    std::this_thread::yield();
+  }
+  delete old_tokens;
 }
 
 bool UserDictionary::Load(
     const user_dictionary::UserDictionaryStorage &storage) {
-  size_t size = 0;
-  {
-    absl::ReaderMutexLock l(&mutex_);
-    size = tokens_->size();
-  }
+  const size_t size = ScopedTokensIndex(tokens_)->size();
 
   // If UserDictionary is pretty big, we first remove the
   // current dictionary to save memory usage.
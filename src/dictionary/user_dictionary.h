@@ -30,13 +30,12 @@
 #ifndef MOZC_DICTIONARY_USER_DICTIONARY_H_
 #define MOZC_DICTIONARY_USER_DICTIONARY_H_
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <vector>
 
-#include "absl/base/thread_annotations.h"
 #include "absl/strings/string_view.h"
-#include "absl/synchronization/mutex.h"
 #include "dictionary/dictionary_interface.h"
 #include "dictionary/dictionary_token.h"
 #include "dictionary/pos_matcher.h"
@@ -111,17 +110,19 @@ class UserDictionary : public UserDictionaryInterface {
 
  private:
   class TokensIndex;
+  class ScopedTokensIndex;
   class UserDictionaryReloader;
 
-  // Swaps internal tokens index to |new_tokens|.
+  // Swaps internal tokens index to |new_tokens|. The previous index is
+  // deleted after the lookups reading it finish.
   void Swap(std::unique_ptr<TokensIndex> new_tokens);
 
   std::unique_ptr<UserDictionaryReloader> reloader_;
   std::unique_ptr<const UserPosInterface> user_pos_;
   const PosMatcher pos_matcher_;
   SuppressionDictionary *suppression_dictionary_;
-  std::unique_ptr<TokensIndex> tokens_ ABSL_GUARDED_BY(mutex_);
-  mutable absl::Mutex mutex_;
+  // Owned. Lookups read it through ScopedTokensIndex without a lock.
+  std::atomic<const TokensIndex *> tokens_;
 
   friend class UserDictionaryTest;
 };
@@ -0,0 +1,223 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Measures how UserDictionary lookups scale with the number of readers.
+//
+// user_dictionary_benchmark
+//  --user_pos_manager_data=user_pos_manager.data
+//  --threads=1,2,4,8 --reload
+//
+// Loads a generated user dictionary, then prints the total number of lookups
+// per second for each number of reader threads. With --reload, another thread
+// keeps reloading the dictionary during the measurement.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/log/check.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "base/init_mozc.h"
+#include "base/stopwatch.h"
+#include "base/thread.h"
+#include "data_manager/data_manager.h"
+#include "dictionary/dictionary_interface.h"
+#include "dictionary/dictionary_token.h"
+#include "dictionary/pos_matcher.h"
+#include "dictionary/suppression_dictionary.h"
+#include "dictionary/user_dictionary.h"
+#include "dictionary/user_pos.h"
+#include "protocol/user_dictionary_storage.pb.h"
+#include "request/conversion_request.h"
+
+ABSL_FLAG(std::string, user_pos_manager_data, "", "user pos manager data");
+ABSL_FLAG(std::string, threads, "1,2,4,8",
+          "comma separated numbers of reader threads");
+ABSL_FLAG(int32_t, entries, 1000, "number of user dictionary entries");
+ABSL_FLAG(int32_t, lookups, 200000, "number of lookups per reader thread");
+ABSL_FLAG(bool, reload, false, "reload the dictionary while looking it up");
+
+namespace mozc {
+namespace dictionary {
+namespace {
+
+// Counts tokens so that the lookups cannot be optimized away.
+class CountTokenCallback : public DictionaryInterface::Callback {
+ public:
+  ResultType OnToken(absl::string_view key, absl::string_view actual_key,
+                     const Token &token) override {
+    ++num_tokens_;
+    return TRAVERSE_CONTINUE;
+  }
+
+  uint64_t num_tokens() const { return num_tokens_; }
+
+ private:
+  uint64_t num_tokens_ = 0;
+};
+
+// Returns a distinct hiragana key for |n|.
+std::string MakeKey(int n) {
+  constexpr absl::string_view kChars[] = {
+      "あ", "い", "う", "え", "お", "か", "き", "く", "け", "こ",
+      "さ", "し", "す", "せ", "そ", "た", "ち", "つ", "て", "と"};
+  constexpr int kNumChars = std::size(kChars);
+  std::string key(kChars[n % kNumChars]);
+  for (n /= kNumChars; n > 0; n /= kNumChars) {
+    absl::StrAppend(&key, kChars[n % kNumChars]);
+  }
+  return key;
+}
+
+user_dictionary::UserDictionaryStorage MakeStorage(
+    absl::Span<const std::string> keys) {
+  user_dictionary::UserDictionaryStorage storage;
+  user_dictionary::UserDictionary *dictionary = storage.add_dictionaries();
+  for (const std::string &key : keys) {
+    user_dictionary::UserDictionary::Entry *entry = dictionary->add_entries();
+    entry->set_key(key);
+    entry->set_value(absl::StrCat("値", key));
+    entry->set_pos(user_dictionary::UserDictionary::NOUN);
+  }
+  return storage;
+}
+
+void LookupKeys(const UserDictionary &dictionary,
+                absl::Span<const std::string> keys, int lookups,
+                CountTokenCallback *callback) {
+  const ConversionRequest convreq;
+  for (int i = 0; i < lookups; ++i) {
+    const std::string &key = keys[i % keys.size()];
+    dictionary.LookupExact(key, convreq, callback);
+    dictionary.LookupPrefix(key, convreq, callback);
+  }
+}
+
+void RunBenchmark(UserDictionary &dictionary,
+                  const user_dictionary::UserDictionaryStorage &storage,
+                  absl::Span<const std::string> keys, int num_threads) {
+  const int lookups = absl::GetFlag(FLAGS_lookups);
+  std::atomic<bool> done = false;
+  std::atomic<int> num_reloads = 0;
+  std::unique_ptr<Thread> reloader;
+  if (absl::GetFlag(FLAGS_reload)) {
+    reloader = std::make_unique<Thread>([&] {
+      while (!done.load()) {
+        dictionary.Load(storage);
+        ++num_reloads;
+      }
+    });
+  }
+
+  std::vector<CountTokenCallback> callbacks(num_threads);
+  std::vector<Thread> readers;
+  Stopwatch stopwatch = Stopwatch::StartNew();
+  for (int i = 0; i < num_threads; ++i) {
+    readers.emplace_back(
+        [&, i] { LookupKeys(dictionary, keys, lookups, &callbacks[i]); });
+  }
+  for (Thread &reader : readers) {
+    reader.Join();
+  }
+  stopwatch.Stop();
+  done = true;
+  if (reloader) {
+    reloader->Join();
+  }
+
+  uint64_t num_tokens = 0;
+  for (const CountTokenCallback &callback : callbacks) {
+    num_tokens += callback.num_tokens();
+  }
+  // Each iteration of LookupKeys() makes two lookups.
+  const double num_lookups = 2.0 * lookups * num_threads;
+  std::cout << absl::StreamFormat(
+      "threads=%2d  %10.0f lookups/sec  %8.1f ns/lookup  (%d tokens, %d "
+      "reloads)\n",
+      num_threads,
+      num_lookups / absl::ToDoubleSeconds(stopwatch.GetElapsed()),
+      absl::ToDoubleNanoseconds(stopwatch.GetElapsed()) / num_lookups *
+          num_threads,
+      num_tokens, num_reloads.load());
+}
+
+}  // namespace
+}  // namespace dictionary
+}  // namespace mozc
+
+int main(int argc, char **argv) {
+  mozc::InitMozc(argv[0], &argc, &argv);
+
+  // User POS manager data for build tools has no magic number.
+  const char *kMagicNumber = "";
+  mozc::DataManager data_manager;
+  const mozc::DataManager::Status status =
+      data_manager.InitUserPosManagerDataFromFile(
+          absl::GetFlag(FLAGS_user_pos_manager_data), kMagicNumber);
+  CHECK_EQ(status, mozc::DataManager::Status::OK)
+      << "Failed to initialize data manager from "
+      << absl::GetFlag(FLAGS_user_pos_manager_data);
+
+  mozc::dictionary::SuppressionDictionary suppression_dictionary;
+  mozc::dictionary::UserDictionary dictionary(
+      mozc::dictionary::UserPos::CreateFromDataManager(data_manager),
+      mozc::dictionary::PosMatcher(data_manager.GetPosMatcherData()),
+      &suppression_dictionary);
+  // Waits for the reload from the user profile, which the constructor starts,
+  // so that it does not replace the entries loaded below.
+  dictionary.WaitForReloader();
+
+  std::vector<std::string> keys;
+  for (int i = 0; i < absl::GetFlag(FLAGS_entries); ++i) {
+    keys.push_back(mozc::dictionary::MakeKey(i));
+  }
+  const mozc::user_dictionary::UserDictionaryStorage storage =
+      mozc::dictionary::MakeStorage(keys);
+  CHECK(dictionary.Load(storage));
+
+  for (absl::string_view threads_str :
+       absl::StrSplit(absl::GetFlag(FLAGS_threads), ',', absl::SkipEmpty())) {
+    int num_threads = 0;
+    CHECK(absl::SimpleAtoi(threads_str, &num_threads)) << threads_str;
+    mozc::dictionary::RunBenchmark(dictionary, storage, keys, num_threads);
+  }
+  return 0;
+}
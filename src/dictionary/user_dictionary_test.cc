@@ -30,6 +30,7 @@
 #include "dictionary/user_dictionary.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <memory>
@@ -48,6 +49,7 @@
 #include "base/file_util.h"
 #include "base/random.h"
 #include "base/singleton.h"
+#include "base/thread.h"
 #include "config/config_handler.h"
 #include "data_manager/testing/mock_data_manager.h"
 #include "dictionary/dictionary_interface.h"
@@ -587,6 +589,107 @@ TEST_F(UserDictionaryTest, TestLookupExact) {
               ElementsAre(Entry{"水雲", "value", 100, 100}));
 }
 
+TEST_F(UserDictionaryTest, TestLookupManyEntries) {
+  std::unique_ptr<UserDictionary> dic(CreateDictionaryWithMockPos());
+  // Wait for async reload called from the constructor.
+  dic->WaitForReloader();
+
+  // Short keys over a few characters, so that many keys share prefixes.
+  Random random;
+  UserDictionaryStorage storage("");
+  UserDictionaryStorage::UserDictionary *user_dic =
+      storage.GetProto().add_dictionaries();
+  std::vector<Entry> entries;
+  for (int i = 0; i < 3000; ++i) {
+    UserDictionaryStorage::UserDictionaryEntry *entry =
+        user_dic->add_entries();
+    entry->set_key(random.Utf8StringRandomLen(5, U'ぁ', U'う'));
+    entry->set_value(absl::StrCat("value", i));
+    entry->set_pos(user_dictionary::UserDictionary::NOUN);
+    entries.push_back({entry->key(), entry->value(), 100, 100});
+  }
+  dic->Load(storage.GetProto());
+
+  auto key_less = [](const Entry &lhs, const Entry &rhs) {
+    return lhs.key < rhs.key;
+  };
+  for (int i = 0; i < 200; ++i) {
+    const std::string query = random.Utf8StringRandomLen(6, U'ぁ', U'う');
+    std::vector<Entry> predictive, prefix, exact;
+    for (const Entry &entry : entries) {
+      if (entry.key.starts_with(query)) {
+        predictive.push_back(entry);
+      }
+      if (query.starts_with(entry.key)) {
+        prefix.push_back(entry);
+      }
+      if (entry.key == query) {
+        exact.push_back(entry);
+      }
+    }
+
+    // Results are returned in the order of key.
+    const std::vector<Entry> predictive_result = LookupPredictive(query, *dic);
+    EXPECT_THAT(predictive_result, UnorderedElementsAreArray(predictive))
+        << query;
+    EXPECT_TRUE(std::is_sorted(predictive_result.begin(),
+                               predictive_result.end(), key_less));
+    const std::vector<Entry> prefix_result = LookupPrefix(query, *dic);
+    EXPECT_THAT(prefix_result, UnorderedElementsAreArray(prefix)) << query;
+    EXPECT_TRUE(
+        std::is_sorted(prefix_result.begin(), prefix_result.end(), key_less));
+    EXPECT_THAT(LookupExact(query, *dic), UnorderedElementsAreArray(exact))
+        << query;
+  }
+}
+
+TEST_F(UserDictionaryTest, ConcurrentReloadAndLookup) {
+  std::unique_ptr<UserDictionary> dic(CreateDictionaryWithMockPos());
+  // Wait for async reload called from the constructor.
+  dic->WaitForReloader();
+
+  // Two dictionaries having different values for the same keys. Every lookup
+  // has to see either of them, but never a mix of them.
+  constexpr int kNumValues[] = {10, 20};
+  UserDictionaryStorage storages[2] = {UserDictionaryStorage(""),
+                                       UserDictionaryStorage("")};
+  std::vector<Entry> expected[2];
+  for (int i = 0; i < 2; ++i) {
+    UserDictionaryStorage::UserDictionary *user_dic =
+        storages[i].GetProto().add_dictionaries();
+    for (int j = 0; j < kNumValues[i]; ++j) {
+      UserDictionaryStorage::UserDictionaryEntry *entry =
+          user_dic->add_entries();
+      entry->set_key("しけん");
+      entry->set_value(absl::StrCat("value", i, "_", j));
+      entry->set_pos(user_dictionary::UserDictionary::NOUN);
+      expected[i].push_back({entry->key(), entry->value(), 100, 100});
+    }
+  }
+  dic->Load(storages[0].GetProto());
+
+  std::atomic<bool> done = false;
+  std::vector<Thread> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&] {
+      while (!done.load()) {
+        const auto matcher = AnyOf(UnorderedElementsAreArray(expected[0]),
+                                   UnorderedElementsAreArray(expected[1]));
+        EXPECT_THAT(LookupExact("しけん", *dic), matcher);
+        EXPECT_THAT(LookupPredictive("し", *dic), matcher);
+        EXPECT_THAT(LookupPrefix("しけんかん", *dic), matcher);
+      }
+    });
+  }
+  for (int i = 0; i < 200; ++i) {
+    dic->Load(storages[i % 2].GetProto());
+  }
+  done = true;
+  for (Thread &reader : readers) {
+    reader.Join();
+  }
+}
+
 TEST_F(UserDictionaryTest, TestLookupExactWithSuggestionOnlyWords) {
   std::unique_ptr<UserDictionary> user_dic(CreateDictionary());
   user_dic->WaitForReloader();
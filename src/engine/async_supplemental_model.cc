@@ -0,0 +1,235 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "engine/async_supplemental_model.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "base/thread.h"
+#include "composer/query.h"
+#include "converter/segments.h"
+#include "prediction/result.h"
+#include "request/conversion_request.h"
+
+namespace mozc::engine {
+
+AsyncSupplementalModel::~AsyncSupplementalModel() {
+  std::optional<Thread> thread;
+  {
+    absl::MutexLock lock(&mutex_);
+    stopped_ = true;
+    thread = std::move(thread_);
+  }
+  if (thread.has_value()) {
+    thread->Join();
+  }
+}
+
+std::optional<std::vector<composer::TypeCorrectedQuery>>
+AsyncSupplementalModel::CorrectComposition(const ConversionRequest &request,
+                                           const Segments &segments) const {
+  const absl::Duration timeout = request.options().supplemental_model_timeout;
+  if (timeout == absl::InfiniteDuration()) {
+    return model_->CorrectComposition(request, segments);
+  }
+
+  auto output = std::make_shared<
+      std::optional<std::vector<composer::TypeCorrectedQuery>>>();
+  if (!RunWithTimeout(
+          [model = model_, request, segments, output] {
+            *output = model->CorrectComposition(request, segments);
+          },
+          timeout)) {
+    return std::nullopt;
+  }
+  return std::move(*output);
+}
+
+void AsyncSupplementalModel::PopulateTypeCorrectedQuery(
+    const ConversionRequest &request, const Segments &segments,
+    absl::Span<prediction::Result> results) const {
+  const absl::Duration timeout = request.options().supplemental_model_timeout;
+  if (timeout == absl::InfiniteDuration()) {
+    model_->PopulateTypeCorrectedQuery(request, segments, results);
+    return;
+  }
+
+  auto output =
+      std::make_shared<std::vector<prediction::Result>>(results.begin(),
+                                                        results.end());
+  if (RunWithTimeout(
+          [model = model_, request, segments, output] {
+            model->PopulateTypeCorrectedQuery(request, segments,
+                                              absl::MakeSpan(*output));
+          },
+          timeout)) {
+    absl::c_move(*output, results.begin());
+  }
+}
+
+void AsyncSupplementalModel::PostCorrect(
+    const ConversionRequest &request, const Segments &segments,
+    std::vector<prediction::Result> &results) const {
+  const absl::Duration timeout = request.options().supplemental_model_timeout;
+  if (timeout == absl::InfiniteDuration()) {
+    model_->PostCorrect(request, segments, results);
+    return;
+  }
+
+  auto output = std::make_shared<std::vector<prediction::Result>>(results);
+  if (RunWithTimeout(
+          [model = model_, request, segments, output] {
+            model->PostCorrect(request, segments, *output);
+          },
+          timeout)) {
+    results = std::move(*output);
+  }
+}
+
+void AsyncSupplementalModel::RescoreResults(
+    const ConversionRequest &request, const Segments &segments,
+    absl::Span<prediction::Result> results) const {
+  const absl::Duration timeout = request.options().supplemental_model_timeout;
+  if (timeout == absl::InfiniteDuration()) {
+    model_->RescoreResults(request, segments, results);
+    return;
+  }
+
+  auto output =
+      std::make_shared<std::vector<prediction::Result>>(results.begin(),
+                                                        results.end());
+  if (RunWithTimeout(
+          [model = model_, request, segments, output] {
+            model->RescoreResults(request, segments, absl::MakeSpan(*output));
+          },
+          timeout)) {
+    absl::c_move(*output, results.begin());
+  }
+}
+
+bool AsyncSupplementalModel::Predict(
+    const ConversionRequest &request, const Segments &segments,
+    std::vector<prediction::Result> &results) const {
+  const absl::Duration timeout = request.options().supplemental_model_timeout;
+  if (timeout == absl::InfiniteDuration()) {
+    return model_->Predict(request, segments, results);
+  }
+
+  struct Output {
+    bool predicted = false;
+    std::vector<prediction::Result> results;
+  };
+  auto output = std::make_shared<Output>();
+  output->results = results;
+  if (!RunWithTimeout(
+          [model = model_, request, segments, output] {
+            output->predicted =
+                model->Predict(request, segments, output->results);
+          },
+          timeout) ||
+      !output->predicted) {
+    return false;
+  }
+  results = std::move(output->results);
+  return true;
+}
+
+bool AsyncSupplementalModel::RunWithTimeout(absl::AnyInvocable<void() &&> run,
+                                            absl::Duration timeout) const {
+  auto done = std::make_shared<absl::Notification>();
+  {
+    const absl::Time now = absl::Now();
+    absl::MutexLock lock(&mutex_);
+    if (!thread_.has_value()) {
+      thread_.emplace([this] { RunTasks(); });
+    }
+    // Drops the tasks whose callers have already stopped waiting.
+    tasks_.erase(
+        std::remove_if(tasks_.begin(), tasks_.end(),
+                       [now](const Task &task) { return task.deadline < now; }),
+        tasks_.end());
+    if (tasks_.size() >= kMaxPendingTasks) {
+      timeout_count_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    tasks_.push_back(Task{std::move(run), now + timeout, done});
+  }
+  if (done->WaitForNotificationWithTimeout(timeout)) {
+    return true;
+  }
+  // The task keeps its own copies of the arguments and the output, so it can
+  // finish after the caller returns.
+  timeout_count_.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+void AsyncSupplementalModel::WaitForPendingTasksForTesting(
+    size_t size) const {
+  auto has_tasks = [this, size]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return tasks_.size() >= size;
+  };
+  absl::MutexLock lock(&mutex_, absl::Condition(&has_tasks));
+}
+
+void AsyncSupplementalModel::RunTasks() const {
+  while (true) {
+    Task task;
+    {
+      absl::MutexLock lock(
+          &mutex_,
+          absl::Condition(this, &AsyncSupplementalModel::HasTaskOrStopped));
+      if (stopped_) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    // Skips the task whose caller has already stopped waiting.
+    if (absl::Now() > task.deadline) {
+      continue;
+    }
+    std::move(task.run)();
+    task.done->Notify();
+  }
+}
+
+}  // namespace mozc::engine
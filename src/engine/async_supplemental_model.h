@@ -0,0 +1,157 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef MOZC_ENGINE_ASYNC_SUPPLEMENTAL_MODEL_H_
+#define MOZC_ENGINE_ASYNC_SUPPLEMENTAL_MODEL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "base/thread.h"
+#include "composer/query.h"
+#include "converter/segments.h"
+#include "engine/supplemental_model_interface.h"
+#include "prediction/result.h"
+#include "protocol/commands.pb.h"
+#include "protocol/engine_builder.pb.h"
+#include "request/conversion_request.h"
+
+namespace mozc::engine {
+
+// Supplemental model which calls `model` within the time budget of the
+// request, ConversionRequest::Options::supplemental_model_timeout.
+//
+// When the budget is finite, the call runs on a background thread. If it
+// finishes in time, its result is merged as if the call was synchronous.
+// Otherwise the result is discarded and the caller proceeds as if the model
+// returned nothing. Calls without the budget are passed to `model` as is.
+//
+// Usually this class is created by Modules:
+//   modules->SetAsyncSupplementalModel(model);
+class AsyncSupplementalModel : public SupplementalModelInterface {
+ public:
+  // Maximum number of the calls waiting for the background thread. A call is
+  // discarded without waiting when the queue is full, so that a stalled model
+  // doesn't accumulate the copies of the arguments.
+  static constexpr size_t kMaxPendingTasks = 8;
+
+  // `model` must outlive this object, and be callable from the background
+  // thread.
+  explicit AsyncSupplementalModel(SupplementalModelInterface *model)
+      : model_(model) {}
+
+  AsyncSupplementalModel(const AsyncSupplementalModel &) = delete;
+  AsyncSupplementalModel &operator=(const AsyncSupplementalModel &) = delete;
+
+  ~AsyncSupplementalModel() override;
+
+  bool LoadAsync(const EngineReloadRequest &request) override {
+    return model_->LoadAsync(request);
+  }
+
+  EngineReloadResponse Load(const EngineReloadRequest &request) override {
+    return model_->Load(request);
+  }
+
+  std::optional<commands::CheckSpellingResponse> CheckSpelling(
+      const commands::CheckSpellingRequest &request) const override {
+    return model_->CheckSpelling(request);
+  }
+
+  std::optional<std::vector<composer::TypeCorrectedQuery>> CorrectComposition(
+      const ConversionRequest &request,
+      const Segments &segments) const override;
+
+  void PopulateTypeCorrectedQuery(
+      const ConversionRequest &request, const Segments &segments,
+      absl::Span<prediction::Result> results) const override;
+
+  void PostCorrect(const ConversionRequest &request, const Segments &segments,
+                   std::vector<prediction::Result> &results) const override;
+
+  void RescoreResults(const ConversionRequest &request,
+                      const Segments &segments,
+                      absl::Span<prediction::Result> results) const override;
+
+  bool Predict(const ConversionRequest &request, const Segments &segments,
+               std::vector<prediction::Result> &results) const override;
+
+  // Returns the number of the calls whose results were discarded because they
+  // didn't finish in time.
+  int64_t timeout_count() const {
+    return timeout_count_.load(std::memory_order_relaxed);
+  }
+
+  // Blocks until `size` calls are waiting for the background thread.
+  void WaitForPendingTasksForTesting(size_t size) const;
+
+ private:
+  struct Task {
+    absl::AnyInvocable<void() &&> run;
+    absl::Time deadline;
+    std::shared_ptr<absl::Notification> done;
+  };
+
+  // Runs `run` on the background thread and waits for it until `timeout`.
+  // Returns true if `run` finished in time.
+  bool RunWithTimeout(absl::AnyInvocable<void() &&> run,
+                      absl::Duration timeout) const;
+
+  // Runs the tasks in `tasks_` until the object is destroyed.
+  void RunTasks() const;
+
+  bool HasTaskOrStopped() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return stopped_ || !tasks_.empty();
+  }
+
+  SupplementalModelInterface *model_;
+
+  mutable absl::Mutex mutex_;
+  mutable std::deque<Task> tasks_ ABSL_GUARDED_BY(mutex_);
+  mutable bool stopped_ ABSL_GUARDED_BY(mutex_) = false;
+  // Started on the first call with a finite budget.
+  mutable std::optional<Thread> thread_ ABSL_GUARDED_BY(mutex_);
+
+  mutable std::atomic<int64_t> timeout_count_ = 0;
+};
+
+}  // namespace mozc::engine
+
+#endif  // MOZC_ENGINE_ASYNC_SUPPLEMENTAL_MODEL_H_
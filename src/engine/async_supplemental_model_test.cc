@@ -0,0 +1,211 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "engine/async_supplemental_model.h"
+
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "base/thread.h"
+#include "composer/query.h"
+#include "converter/segments.h"
+#include "engine/supplemental_model_interface.h"
+#include "prediction/result.h"
+#include "request/conversion_request.h"
+#include "testing/gunit.h"
+
+namespace mozc::engine {
+namespace {
+
+using ::mozc::prediction::Result;
+
+// Fake model which takes `latency` for each call.
+class SlowSupplementalModel : public SupplementalModelInterface {
+ public:
+  explicit SlowSupplementalModel(absl::Duration latency) : latency_(latency) {}
+
+  std::optional<std::vector<composer::TypeCorrectedQuery>> CorrectComposition(
+      const ConversionRequest &request,
+      const Segments &segments) const override {
+    absl::SleepFor(latency_);
+    return std::vector<composer::TypeCorrectedQuery>(1);
+  }
+
+  void RescoreResults(const ConversionRequest &request,
+                      const Segments &segments,
+                      absl::Span<Result> results) const override {
+    absl::SleepFor(latency_);
+    for (Result &result : results) {
+      result.cost += 100;
+    }
+  }
+
+  bool Predict(const ConversionRequest &request, const Segments &segments,
+               std::vector<Result> &results) const override {
+    absl::SleepFor(latency_);
+    results.emplace_back().set_value("predicted");
+    return true;
+  }
+
+ private:
+  const absl::Duration latency_;
+};
+
+// Fake model which notifies `called` and blocks the calls until `release` is
+// notified.
+class BlockingSupplementalModel : public SupplementalModelInterface {
+ public:
+  bool Predict(const ConversionRequest &request, const Segments &segments,
+               std::vector<Result> &results) const override {
+    if (!called.HasBeenNotified()) {
+      called.Notify();
+    }
+    release.WaitForNotification();
+    return true;
+  }
+
+  mutable absl::Notification called;
+  absl::Notification release;
+};
+
+ConversionRequest CreateRequest(absl::Duration timeout) {
+  ConversionRequest::Options options;
+  options.supplemental_model_timeout = timeout;
+  return ConversionRequestBuilder().SetOptions(std::move(options)).Build();
+}
+
+TEST(AsyncSupplementalModelTest, WithoutTimeout) {
+  SlowSupplementalModel model(absl::Milliseconds(10));
+  AsyncSupplementalModel async_model(&model);
+  const ConversionRequest request = CreateRequest(absl::InfiniteDuration());
+  const Segments segments;
+
+  std::vector<Result> results(1);
+  async_model.RescoreResults(request, segments, absl::MakeSpan(results));
+  EXPECT_EQ(results[0].cost, 100);
+  EXPECT_TRUE(async_model.Predict(request, segments, results));
+  EXPECT_EQ(results.size(), 2);
+  EXPECT_TRUE(async_model.CorrectComposition(request, segments).has_value());
+  EXPECT_EQ(async_model.timeout_count(), 0);
+}
+
+TEST(AsyncSupplementalModelTest, FinishedInTime) {
+  SlowSupplementalModel model(absl::ZeroDuration());
+  AsyncSupplementalModel async_model(&model);
+  const ConversionRequest request = CreateRequest(absl::Seconds(60));
+  const Segments segments;
+
+  std::vector<Result> results(1);
+  async_model.RescoreResults(request, segments, absl::MakeSpan(results));
+  EXPECT_EQ(results[0].cost, 100);
+  EXPECT_TRUE(async_model.Predict(request, segments, results));
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_EQ(results[1].value(), "predicted");
+  EXPECT_TRUE(async_model.CorrectComposition(request, segments).has_value());
+  EXPECT_EQ(async_model.timeout_count(), 0);
+}
+
+TEST(AsyncSupplementalModelTest, Timeout) {
+  SlowSupplementalModel model(absl::Milliseconds(500));
+  AsyncSupplementalModel async_model(&model);
+  const ConversionRequest request = CreateRequest(absl::Milliseconds(10));
+  const Segments segments;
+
+  const absl::Time start = absl::Now();
+  std::vector<Result> results(1);
+  async_model.RescoreResults(request, segments, absl::MakeSpan(results));
+  EXPECT_EQ(results[0].cost, 0);
+  EXPECT_FALSE(async_model.Predict(request, segments, results));
+  EXPECT_EQ(results.size(), 1);
+  EXPECT_FALSE(async_model.CorrectComposition(request, segments).has_value());
+  EXPECT_EQ(async_model.timeout_count(), 3);
+  // The callers don't wait for the slow model.
+  EXPECT_LT(absl::Now() - start, absl::Milliseconds(500));
+}
+
+TEST(AsyncSupplementalModelTest, ExpiredCallsDoNotFillQueue) {
+  SlowSupplementalModel model(absl::Milliseconds(500));
+  AsyncSupplementalModel async_model(&model);
+  const ConversionRequest request = CreateRequest(absl::Milliseconds(1));
+  const Segments segments;
+
+  // The expired calls are dropped when the next call is queued, so every call
+  // waits for its own time budget instead of being rejected.
+  constexpr int kNumCalls = AsyncSupplementalModel::kMaxPendingTasks * 2;
+  std::vector<Result> results;
+  for (int i = 0; i < kNumCalls; ++i) {
+    const absl::Time start = absl::Now();
+    EXPECT_FALSE(async_model.Predict(request, segments, results));
+    EXPECT_GE(absl::Now() - start, absl::Milliseconds(1));
+  }
+  EXPECT_EQ(async_model.timeout_count(), kNumCalls);
+}
+
+TEST(AsyncSupplementalModelTest, FullQueue) {
+  BlockingSupplementalModel model;
+  AsyncSupplementalModel async_model(&model);
+  const Segments segments;
+
+  // Blocks the background thread, and then fills the queue with the calls
+  // which wait for a long time. The model doesn't return until `release` is
+  // notified, so the queued calls stay in the queue.
+  auto predict = [&] {
+    std::vector<Result> results;
+    async_model.Predict(CreateRequest(absl::Seconds(60)), segments, results);
+  };
+  std::vector<Thread> threads;
+  threads.emplace_back(predict);
+  model.called.WaitForNotification();
+  for (size_t i = 0; i < AsyncSupplementalModel::kMaxPendingTasks; ++i) {
+    threads.emplace_back(predict);
+  }
+  async_model.WaitForPendingTasksForTesting(
+      AsyncSupplementalModel::kMaxPendingTasks);
+
+  // The call is rejected without waiting for its time budget.
+  const absl::Time start = absl::Now();
+  std::vector<Result> results;
+  EXPECT_FALSE(async_model.Predict(CreateRequest(absl::Seconds(60)), segments,
+                                   results));
+  EXPECT_LT(absl::Now() - start, absl::Seconds(60));
+  EXPECT_EQ(async_model.timeout_count(), 1);
+
+  model.release.Notify();
+  for (Thread &thread : threads) {
+    thread.Join();
+  }
+}
+
+}  // namespace
+}  // namespace mozc::engine
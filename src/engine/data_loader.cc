@@ -33,14 +33,17 @@
 #include <cstdint>
 #include <memory>
 #include <optional>
+#include <string>
 #include <utility>
 
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/synchronization/notification.h"
 #include "absl/time/time.h"
+#include "base/clock.h"
 #include "base/file_util.h"
 #include "base/hash.h"
 #include "base/thread.h"
@@ -151,8 +154,24 @@ void DataLoader::ReportLoadSuccess(const DataLoader::RequestData &request) {
   current_request_id_ = request.id;
 }
 
+void DataLoader::SetDataInUse(absl::string_view data_checksum,
+                              EngineReloadRequest::EngineType engine_type) {
+  absl::WriterMutexLock lock(&mutex_);
+  data_in_use_checksum_ = std::string(data_checksum);
+  data_in_use_engine_type_ = engine_type;
+}
+
+bool DataLoader::IsDataInUse(
+    absl::string_view data_checksum,
+    EngineReloadRequest::EngineType engine_type) const {
+  absl::ReaderMutexLock lock(&mutex_);
+  return !data_checksum.empty() && data_checksum == data_in_use_checksum_ &&
+         engine_type == data_in_use_engine_type_;
+}
+
 std::unique_ptr<DataLoader::Response> DataLoader::BuildResponse(
     const DataLoader::RequestData &request_data) {
+  const absl::Time start_time = Clock::GetAbslTime();
   auto result = std::make_unique<DataLoader::Response>();
   result->response.set_status(EngineReloadResponse::DATA_MISSING);
 
@@ -175,6 +194,18 @@ std::unique_ptr<DataLoader::Response> DataLoader::BuildResponse(
     }
   }
 
+  // The engine keeps its modules when the data is identical to the current
+  // one, e.g., the same data is installed to a different path. This avoids
+  // holding two copies of the modules in memory during the reload.
+  if (IsDataInUse(data_manager->GetDataChecksum(), request.engine_type())) {
+    LOG(INFO) << "The data is already in use: " << request_data;
+    result->response.set_status(EngineReloadResponse::RELOAD_READY);
+    result->response.set_modules_reused(true);
+    result->response.set_build_time_msec(
+        absl::ToInt64Milliseconds(Clock::GetAbslTime() - start_time));
+    return result;
+  }
+
   auto modules = std::make_unique<engine::Modules>();
   {
     const absl::Status status = modules->Init(std::move(data_manager));
@@ -187,6 +218,8 @@ std::unique_ptr<DataLoader::Response> DataLoader::BuildResponse(
   }
 
   result->response.set_status(EngineReloadResponse::RELOAD_READY);
+  result->response.set_build_time_msec(
+      absl::ToInt64Milliseconds(Clock::GetAbslTime() - start_time));
   result->modules = std::move(modules);
 
   return result;
@@ -34,10 +34,12 @@
 #include <functional>
 #include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/synchronization/notification.h"
 #include "base/thread.h"
@@ -61,6 +63,8 @@ class DataLoader {
 
   struct Response {
     EngineReloadResponse response;
+    // Null when the requested data is already in use, i.e.,
+    // response.modules_reused() is true.
     std::unique_ptr<engine::Modules> modules;
   };
 
@@ -83,6 +87,12 @@ class DataLoader {
   // Returns true if the loading thread is running.
   bool IsRunning() const;
 
+  // Registers the data currently used by the engine. When a later request
+  // resolves to data with the same checksum and engine type, the loader skips
+  // building new modules so that the engine can keep the current ones.
+  void SetDataInUse(absl::string_view data_checksum,
+                    EngineReloadRequest::EngineType engine_type);
+
   // Disables specific handling for high priority data.
   void NotifyHighPriorityDataRegisteredForTesting() {
     high_priority_data_registered_.Notify();
@@ -122,6 +132,11 @@ class DataLoader {
   // Register the request.
   void ReportLoadSuccess(const RequestData &request_data);
 
+  // Returns true if the data identified by `data_checksum` is already used by
+  // the engine with `engine_type`.
+  bool IsDataInUse(absl::string_view data_checksum,
+                   EngineReloadRequest::EngineType engine_type) const;
+
   void StartReloadLoop(DataLoader::ReloadedCallback callback);
 
   // The internal data are accessed by the main thread and loader's thread
@@ -140,6 +155,12 @@ class DataLoader {
   // meaning that the model registered later is preferred.
   uint32_t sequence_id_ ABSL_GUARDED_BY(mutex_) = 0;
 
+  // Checksum and engine type of the data used by the engine. Empty checksum
+  // means that no data is registered.
+  std::string data_in_use_checksum_ ABSL_GUARDED_BY(mutex_);
+  EngineReloadRequest::EngineType data_in_use_engine_type_
+      ABSL_GUARDED_BY(mutex_) = EngineReloadRequest::DESKTOP;
+
   // Notify when a new high priority data is registered.
   absl::Notification high_priority_data_registered_;
 
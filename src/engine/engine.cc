@@ -29,6 +29,7 @@
 
 #include "engine/engine.h"
 
+#include <cstdint>
 #include <memory>
 #include <utility>
 
@@ -39,6 +40,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "base/system_util.h"
 #include "base/vlog.h"
 #include "converter/converter.h"
 #include "converter/converter_interface.h"
@@ -107,6 +109,28 @@ absl::Status Engine::ReloadModules(std::unique_ptr<engine::Modules> modules,
 
 absl::Status Engine::Init(std::unique_ptr<engine::Modules> modules,
                           bool is_mobile) {
+  if (converter_) {
+    // The supplemental model is loaded independently of the data, so the new
+    // modules keep using the current one unless another model is given.
+    if (!modules->GetSupplementalModel()) {
+      engine::Modules *current_modules = converter_->modules();
+      if (current_modules->IsSupplementalModelAsync()) {
+        modules->SetAsyncSupplementalModel(
+            current_modules->GetMutableSupplementalModel());
+      } else {
+        modules->SetSupplementalModel(
+            current_modules->GetMutableSupplementalModel());
+      }
+    }
+    // Releases the current converter before the new one loads its user data,
+    // so the two converters do not coexist in memory.
+    converter_.reset();
+  }
+
+  const EngineReloadRequest::EngineType engine_type =
+      is_mobile ? EngineReloadRequest::MOBILE : EngineReloadRequest::DESKTOP;
+  loader_.SetDataInUse(modules->GetDataManager().GetDataChecksum(),
+                       engine_type);
 
   auto immutable_converter_factory = [](const engine::Modules &modules) {
     return std::make_unique<ImmutableConverter>(modules);
@@ -187,13 +211,27 @@ bool Engine::MaybeReloadEngine(EngineReloadResponse *response) {
                          EngineReloadRequest::MOBILE;
   *response = std::move(loader_response_->response);
 
+  // When the modules are reused, the requested data is already in use and
+  // the current converter is kept as is.
   const absl::Status reload_status =
-      ReloadModules(std::move(loader_response_->modules), is_mobile);
+      response->modules_reused()
+          ? absl::OkStatus()
+          : ReloadModules(std::move(loader_response_->modules), is_mobile);
   if (reload_status.ok()) {
     response->set_status(EngineReloadResponse::RELOADED);
   }
   loader_response_.reset();
 
+  if (const uint64_t peak_memory = SystemUtil::GetPeakResidentMemory();
+      peak_memory > 0) {
+    response->set_peak_resident_memory_bytes(peak_memory);
+  }
+  LOG(INFO) << "Engine reload: status=" << response->status()
+            << " build_time_msec=" << response->build_time_msec()
+            << " modules_reused=" << response->modules_reused()
+            << " peak_resident_memory_bytes="
+            << response->peak_resident_memory_bytes();
+
   return reload_status.ok();
 }
 
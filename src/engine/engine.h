@@ -52,6 +52,17 @@
 namespace mozc {
 
 // Builds and manages a set of modules that are necessary for conversion engine.
+//
+// Thread safety: the read paths of the converter, i.e. conversion, prediction
+// and reverse conversion, may run concurrently from multiple threads as long
+// as each thread uses its own Segments and ConversionRequest. The scratch state
+// of a conversion (the lattice and candidates) lives in the Segments. The
+// prediction aggregators keep no state across requests, so realtime
+// conversions neither block nor share lattices. The state shared by requests
+// (e.g. the caches of Connector and SystemDictionary, and the previous top
+// result of DictionaryPredictor) is atomic or guarded. Learning
+// (FinishConversion() etc.), Reload() and Sync() must not run concurrently
+// with each other or with the read paths.
 class Engine : public EngineInterface {
  public:
   // There are two types of engine: desktop and mobile.  The differences are the
@@ -38,6 +38,7 @@
       'type': 'static_library',
       'sources': [
         '<(gen_out_dir)/../dictionary/pos_matcher_impl.inc',
+        'async_supplemental_model.cc',
         'modules.cc',
       ],
       'dependencies': [
@@ -29,17 +29,26 @@
 
 #include "engine/engine.h"
 
+#include <cstddef>
+#include <iterator>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/log/check.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "base/thread.h"
+#include "converter/converter_interface.h"
+#include "converter/segments.h"
 #include "data_manager/data_manager.h"
 #include "data_manager/testing/mock_data_manager.h"
 #include "engine/modules.h"
 #include "engine/supplemental_model_interface.h"
 #include "protocol/engine_builder.pb.h"
+#include "request/conversion_request.h"
+#include "testing/gmock.h"
 #include "testing/gunit.h"
 #include "testing/mozctest.h"
 
@@ -126,6 +135,23 @@ TEST_F(EngineTest, ReloadModulesTest) {
             &supplemental_model);
 }
 
+TEST_F(EngineTest, ReloadModulesKeepsSupplementalModelTest) {
+  auto modules = std::make_unique<engine::Modules>();
+  SupplementalModelForTesting supplemental_model;
+  modules->SetSupplementalModel(&supplemental_model);
+  CHECK_OK(modules->Init(std::make_unique<testing::MockDataManager>()));
+  const bool is_mobile = true;
+  CHECK_OK(engine_->ReloadModules(std::move(modules), is_mobile));
+
+  // The new modules have no supplemental model, so the current one is kept.
+  modules = std::make_unique<engine::Modules>();
+  CHECK_OK(modules->Init(std::make_unique<testing::MockDataManager>()));
+  CHECK_OK(engine_->ReloadModules(std::move(modules), is_mobile));
+
+  EXPECT_EQ(engine_->GetModulesForTesting()->GetSupplementalModel(),
+            &supplemental_model);
+}
+
 // Tests the interaction with DataLoader for successful Engine
 // reload event.
 TEST_F(EngineTest, DataLoadSuccessfulScenarioTest) {
@@ -145,6 +171,34 @@ TEST_F(EngineTest, DataLoadSuccessfulScenarioTest) {
   EXPECT_EQ(engine_->GetDataVersion(), mock_version_);
 }
 
+// Tests that the current modules are kept when the same data is requested
+// with a different request.
+TEST_F(EngineTest, ReuseModulesForSameDataTest) {
+  EngineReloadResponse response;
+  EXPECT_TRUE(engine_->SendEngineReloadRequest(mock_request_));
+  EXPECT_TRUE(engine_->MaybeReloadEngine(&response));
+  EXPECT_FALSE(response.modules_reused());
+  const engine::Modules *modules = engine_->GetModulesForTesting();
+
+  // The request differs only in priority, so the data is not rebuilt.
+  EngineReloadRequest request = mock_request_;
+  request.set_priority(kMiddlePriority - 1);
+  EXPECT_TRUE(engine_->SendEngineReloadRequest(request));
+  EXPECT_TRUE(engine_->MaybeReloadEngine(&response));
+  EXPECT_EQ(response.status(), EngineReloadResponse::RELOADED);
+  EXPECT_TRUE(response.modules_reused());
+  EXPECT_EQ(engine_->GetModulesForTesting(), modules);
+  EXPECT_EQ(engine_->GetDataVersion(), mock_version_);
+
+  // A different engine type requires new modules.
+  request.set_engine_type(EngineReloadRequest::DESKTOP);
+  request.set_priority(kMiddlePriority - 2);
+  EXPECT_TRUE(engine_->SendEngineReloadRequest(request));
+  EXPECT_TRUE(engine_->MaybeReloadEngine(&response));
+  EXPECT_FALSE(response.modules_reused());
+  EXPECT_EQ(engine_->GetDataVersion(), mock_version_);
+}
+
 // Tests situations to handle multiple new requests.
 TEST_F(EngineTest, DataUpdateSuccessfulScenarioTest) {
   EngineReloadResponse response;
@@ -191,5 +245,70 @@ TEST_F(EngineTest, RollbackDataTest) {
   // DataVersion comes from the first request (i.e. mock_request_).
   EXPECT_EQ(engine_->GetDataVersion(), mock_version_);
 }
+
+// Runs conversion and prediction on one engine from multiple threads, each
+// with its own Segments and ConversionRequest. Meant to be run under
+// ThreadSanitizer, too.
+TEST_F(EngineTest, ConcurrentConversionAndPredictionTest) {
+  absl::StatusOr<std::unique_ptr<Engine>> engine =
+      Engine::CreateDesktopEngine(std::make_unique<testing::MockDataManager>());
+  ASSERT_OK(engine);
+  const ConverterInterface *converter = (*engine)->GetConverter();
+
+  // Returns the concatenated top candidates, or an empty string on failure.
+  auto convert = [converter](absl::string_view key,
+                             ConversionRequest::RequestType request_type) {
+    ConversionRequest::Options options = {.request_type = request_type,
+                                          .key = std::string(key)};
+    const ConversionRequest request =
+        ConversionRequestBuilder().SetOptions(std::move(options)).Build();
+    Segments segments;
+    const bool converted =
+        request_type == ConversionRequest::CONVERSION
+            ? converter->StartConversion(request, &segments)
+            : converter->StartPrediction(request, &segments);
+    std::string result;
+    if (!converted) {
+      return result;
+    }
+    for (const Segment &segment : segments.conversion_segments()) {
+      if (segment.candidates_size() > 0) {
+        result.append(segment.candidate(0).value);
+      }
+    }
+    return result;
+  };
+
+  constexpr absl::string_view kKeys[] = {
+      "わたしのなまえはなかのです",
+      "きょうはいいてんきです",
+      "しんかんせんにのる",
+      "あいうえお",
+  };
+  std::vector<std::string> expected;
+  for (absl::string_view key : kKeys) {
+    expected.push_back(convert(key, ConversionRequest::CONVERSION));
+    ASSERT_FALSE(expected.back().empty()) << key;
+  }
+
+  constexpr int kNumThreads = 4;
+  constexpr int kNumIterations = 20;
+  std::vector<Thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([&, i] {
+      for (int j = 0; j < kNumIterations; ++j) {
+        const size_t k = (i + j) % std::size(kKeys);
+        EXPECT_EQ(convert(kKeys[k], ConversionRequest::CONVERSION),
+                  expected[k]);
+        EXPECT_FALSE(
+            convert(kKeys[k], ConversionRequest::PREDICTION).empty());
+      }
+    });
+  }
+  for (Thread &thread : threads) {
+    thread.Join();
+  }
+}
+
 }  // namespace engine
 }  // namespace mozc
@@ -36,6 +36,7 @@
 #include <string>
 #include <utility>
 
+#include "absl/flags/flag.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
@@ -55,6 +56,7 @@
 #include "dictionary/system/value_dictionary.h"
 #include "dictionary/user_dictionary.h"
 #include "dictionary/user_pos.h"
+#include "engine/async_supplemental_model.h"
 #include "prediction/single_kanji_prediction_aggregator.h"
 #include "prediction/suggestion_filter.h"
 
@@ -67,8 +69,33 @@ using ::mozc::dictionary::UserDictionary;
 using ::mozc::dictionary::UserPos;
 using ::mozc::dictionary::ValueDictionary;
 
+ABSL_FLAG(std::string, data_warm_up, "none",
+          "Policy to page in the data set on initialization: none, will_need, "
+          "populate or background.");
+ABSL_FLAG(bool, data_warm_up_huge_pages, false,
+          "Hints transparent huge pages for the hot sections of the data set.");
+
 namespace mozc {
 namespace engine {
+namespace {
+
+DataManager::WarmUpOptions GetWarmUpOptions() {
+  DataManager::WarmUpOptions options;
+  const std::string policy = absl::GetFlag(FLAGS_data_warm_up);
+  if (policy == "will_need") {
+    options.policy = DataManager::WarmUpPolicy::WILL_NEED;
+  } else if (policy == "populate") {
+    options.policy = DataManager::WarmUpPolicy::POPULATE;
+  } else if (policy == "background") {
+    options.policy = DataManager::WarmUpPolicy::BACKGROUND;
+  } else if (policy != "none") {
+    LOG(WARNING) << "Unknown data warm-up policy: " << policy;
+  }
+  options.huge_pages = absl::GetFlag(FLAGS_data_warm_up_huge_pages);
+  return options;
+}
+
+}  // namespace
 
 absl::Status Modules::Init(std::unique_ptr<const DataManager> data_manager) {
 #define RETURN_IF_NULL(ptr)                                                \
@@ -81,6 +108,7 @@ absl::Status Modules::Init(std::unique_ptr<const DataManager> data_manager) {
   DCHECK(data_manager) << "data_manager is null";
   RETURN_IF_NULL(data_manager);
   data_manager_ = std::move(data_manager);
+  data_manager_->WarmUp(GetWarmUpOptions());
 
   if (!suppression_dictionary_) {
     suppression_dictionary_ = std::make_unique<SuppressionDictionary>();
@@ -216,5 +244,14 @@ void Modules::PresetSingleKanjiPredictionAggregator(
       std::move(single_kanji_prediction_aggregator);
 }
 
+void Modules::SetAsyncSupplementalModel(
+    engine::SupplementalModelInterface *supplemental_model) {
+  supplemental_model_ = supplemental_model;
+  async_supplemental_model_ =
+      supplemental_model
+          ? std::make_unique<AsyncSupplementalModel>(supplemental_model)
+          : nullptr;
+}
+
 }  // namespace engine
 }  // namespace mozc
@@ -42,6 +42,7 @@
 #include "dictionary/pos_group.h"
 #include "dictionary/pos_matcher.h"
 #include "dictionary/suppression_dictionary.h"
+#include "engine/async_supplemental_model.h"
 #include "engine/supplemental_model_interface.h"
 #include "prediction/single_kanji_prediction_aggregator.h"
 #include "prediction/suggestion_filter.h"
@@ -113,19 +114,37 @@ class Modules {
     return zero_query_number_dict_;
   }
 
+  // Returns the model used by the converter, which is the wrapper
+  // AsyncSupplementalModel if the model is set by SetAsyncSupplementalModel().
   const engine::SupplementalModelInterface *GetSupplementalModel() const {
+    if (async_supplemental_model_) {
+      return async_supplemental_model_.get();
+    }
     return supplemental_model_;
   }
 
+  // Returns the model given to SetSupplementalModel() or
+  // SetAsyncSupplementalModel().
   engine::SupplementalModelInterface *GetMutableSupplementalModel() {
     return supplemental_model_;
   }
 
   void SetSupplementalModel(
       engine::SupplementalModelInterface *supplemental_model) {
+    async_supplemental_model_.reset();
     supplemental_model_ = supplemental_model;
   }
 
+  // Same as SetSupplementalModel(), but the calls from the converter run on a
+  // background thread within the time budget of the request,
+  // ConversionRequest::Options::supplemental_model_timeout.
+  void SetAsyncSupplementalModel(
+      engine::SupplementalModelInterface *supplemental_model);
+
+  bool IsSupplementalModelAsync() const {
+    return async_supplemental_model_ != nullptr;
+  }
+
  private:
   bool initialized_ = false;
   std::unique_ptr<const DataManager> data_manager_;
@@ -144,6 +163,7 @@ class Modules {
   ZeroQueryDict zero_query_number_dict_;
   // The owner of supplemental_model_ is Engine.
   engine::SupplementalModelInterface *supplemental_model_ = nullptr;
+  std::unique_ptr<engine::AsyncSupplementalModel> async_supplemental_model_;
 };
 
 }  // namespace engine
@@ -38,6 +38,7 @@
 #include "dictionary/pos_matcher.h"
 #include "dictionary/suppression_dictionary.h"
 #include "dictionary/user_dictionary_stub.h"
+#include "engine/supplemental_model_mock.h"
 #include "testing/gmock.h"
 #include "testing/gunit.h"
 
@@ -110,5 +111,27 @@ TEST(ModulesTest, Preset) {
   EXPECT_EQ(modules.GetDictionary(), dictionary_ptr);
 }
 
+TEST(ModulesTest, SupplementalModel) {
+  Modules modules;
+  EXPECT_EQ(modules.GetSupplementalModel(), nullptr);
+
+  MockSupplementalModel model;
+  modules.SetSupplementalModel(&model);
+  EXPECT_EQ(modules.GetSupplementalModel(), &model);
+  EXPECT_EQ(modules.GetMutableSupplementalModel(), &model);
+  EXPECT_FALSE(modules.IsSupplementalModelAsync());
+
+  // The converter calls the model through AsyncSupplementalModel.
+  modules.SetAsyncSupplementalModel(&model);
+  EXPECT_NE(modules.GetSupplementalModel(), nullptr);
+  EXPECT_NE(modules.GetSupplementalModel(), &model);
+  EXPECT_EQ(modules.GetMutableSupplementalModel(), &model);
+  EXPECT_TRUE(modules.IsSupplementalModelAsync());
+
+  modules.SetSupplementalModel(&model);
+  EXPECT_EQ(modules.GetSupplementalModel(), &model);
+  EXPECT_FALSE(modules.IsSupplementalModelAsync());
+}
+
 }  // namespace engine
 }  // namespace mozc
@@ -34,6 +34,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <iterator>
+#include <memory>
 #include <optional>
 #include <string>
 #include <tuple>
@@ -213,6 +214,19 @@ ConversionRequest GetConversionRequestForRealtimeCandidates(
       .Build();
 }
 
+// The unigram lookups keep only the cheapest results, so the system
+// dictionary is asked to collect the keys in cost order when it has the
+// subtree costs.
+ConversionRequest GetConversionRequestForUnigramLookup(
+    const ConversionRequest &request) {
+  ConversionRequest::Options options = request.options();
+  options.predictive_lookup_in_cost_order = true;
+  return ConversionRequestBuilder()
+      .SetConversionRequest(request)
+      .SetOptions(std::move(options))
+      .Build();
+}
+
 Segments GetSegmentsForRealtimeCandidatesGeneration(
     const Segments &original_segments) {
   Segments segments = original_segments;
@@ -252,6 +266,7 @@ class DictionaryPredictionAggregator::PredictiveLookupCallback
                            Segment::Candidate::SourceInfo source_info,
                            int zip_code_id, int unknown_id,
                            absl::string_view non_expanded_original_key,
+                           std::shared_ptr<ResultStorage> storage,
                            std::vector<Result> *results)
       : penalty_(0),
         types_(types),
@@ -261,6 +276,7 @@ class DictionaryPredictionAggregator::PredictiveLookupCallback
         source_info_(source_info),
         zip_code_id_(zip_code_id),
         unknown_id_(unknown_id),
+        storage_(std::move(storage)),
         non_expanded_original_key_(non_expanded_original_key),
         results_(results) {}
 
@@ -320,11 +336,18 @@ class DictionaryPredictionAggregator::PredictiveLookupCallback
       return TRAVERSE_CONTINUE;
     }
 
+    if (storage_ == nullptr) {
+      // All the results from this lookup share the storage and the original
+      // key.
+      storage_ = std::make_shared<ResultStorage>();
+      non_expanded_original_key_ =
+          storage_->AddString(non_expanded_original_key_);
+    }
     Result result;
-    result.InitializeByTokenAndTypes(token, types_);
+    result.InitializeByTokenAndTypes(token, types_, storage_,
+                                     non_expanded_original_key_);
     result.wcost += penalty_;
     result.source_info |= source_info_;
-    result.non_expanded_original_key = std::string(non_expanded_original_key_);
     if (penalty_ > 0) result.types |= KEY_EXPANDED_IN_DICTIONARY;
     results_->emplace_back(std::move(result));
     return (results_->size() < limit_) ? TRAVERSE_CONTINUE : TRAVERSE_DONE;
@@ -339,6 +362,12 @@ class DictionaryPredictionAggregator::PredictiveLookupCallback
   const Segment::Candidate::SourceInfo source_info_;
   const int zip_code_id_;
   const int unknown_id_;
+  // Shared by all the results from this lookup. Given by the caller when the
+  // results from several lookups share it, or created for the first result.
+  std::shared_ptr<ResultStorage> storage_;
+  // Points to `storage_` if the storage was given by the caller. Otherwise,
+  // points to the caller's string until the first result is built, and then
+  // to the copy in `storage_`.
   absl::string_view non_expanded_original_key_;
   std::vector<Result> *results_ = nullptr;
 
@@ -389,9 +418,10 @@ class DictionaryPredictionAggregator::PredictiveBigramLookupCallback
       Segment::Candidate::SourceInfo source_info, int zip_code_id,
       int unknown_id, absl::string_view non_expanded_original_key,
       std::vector<Result> *results)
-      : PredictiveLookupCallback(
-            types, limit, original_key_len, subsequent_chars, source_info,
-            zip_code_id, unknown_id, non_expanded_original_key, results),
+      : PredictiveLookupCallback(types, limit, original_key_len,
+                                 subsequent_chars, source_info, zip_code_id,
+                                 unknown_id, non_expanded_original_key,
+                                 nullptr, results),
         history_value_(history_value) {}
 
   PredictiveBigramLookupCallback(const PredictiveBigramLookupCallback &) =
@@ -456,8 +486,11 @@ class DictionaryPredictionAggregator::PrefixLookupCallback
     if (Util::CharsLen(token.value) < min_value_chars_len_) {
       return TRAVERSE_CONTINUE;
     }
+    if (storage_ == nullptr) {
+      storage_ = std::make_shared<ResultStorage>();
+    }
     Result result;
-    result.InitializeByTokenAndTypes(token, PREFIX);
+    result.InitializeByTokenAndTypes(token, PREFIX, storage_);
     if (key != actual_key) {
       result.candidate_attributes |= Segment::Candidate::TYPING_CORRECTION;
     }
@@ -466,7 +499,7 @@ class DictionaryPredictionAggregator::PrefixLookupCallback
       result.candidate_attributes |= Segment::Candidate::PARTIALLY_KEY_CONSUMED;
       result.consumed_key_size = key_len;
     }
-    results_->emplace_back(result);
+    results_->emplace_back(std::move(result));
     return (results_->size() < limit_) ? TRAVERSE_CONTINUE : TRAVERSE_DONE;
   }
 
@@ -476,6 +509,7 @@ class DictionaryPredictionAggregator::PrefixLookupCallback
   const int unknown_id_;
   const int min_value_chars_len_;
   const int input_key_len_;
+  std::shared_ptr<ResultStorage> storage_;
   std::vector<Result> *results_ = nullptr;
 };
 
@@ -505,10 +539,13 @@ class DictionaryPredictionAggregator::HandwritingLookupCallback
       next_pos = pos + 1;
     }
 
+    if (storage_ == nullptr) {
+      storage_ = std::make_shared<ResultStorage>();
+    }
     Result result;
-    result.InitializeByTokenAndTypes(token, UNIGRAM);
+    result.InitializeByTokenAndTypes(token, UNIGRAM, storage_);
     result.wcost += penalty_;
-    results_->emplace_back(result);
+    results_->emplace_back(std::move(result));
     return (results_->size() < limit_) ? TRAVERSE_CONTINUE : TRAVERSE_DONE;
   }
 
@@ -516,6 +553,7 @@ class DictionaryPredictionAggregator::HandwritingLookupCallback
   const size_t limit_;  // The maximum number of results token size.
   const int penalty_;   // Cost penalty for result tokens.
   const std::vector<std::string> constraints_;
+  std::shared_ptr<ResultStorage> storage_;
   std::vector<Result> *results_ = nullptr;
 };
 
@@ -854,11 +892,13 @@ bool DictionaryPredictionAggregator::PushBackTopConversionResult(
   // construct it manually here.
   // TODO(noriyukit): This is code duplicate in converter/nbest_generator.cc and
   // we should refactor code after finding more good design.
+  std::string key, value;
+  std::vector<uint32_t> inner_segment_boundary;
   bool inner_segment_boundary_success = true;
   for (const Segment &segment : tmp_segments.conversion_segments()) {
     const Segment::Candidate &candidate = segment.candidate(0);
-    result->value.append(candidate.value);
-    result->key.append(candidate.key);
+    value.append(candidate.value);
+    key.append(candidate.key);
     result->wcost += candidate.wcost;
     result->candidate_attributes |=
         (candidate.attributes &
@@ -870,14 +910,17 @@ bool DictionaryPredictionAggregator::PushBackTopConversionResult(
             candidate.key.size(), candidate.value.size(),
             candidate.content_key.size(), candidate.content_value.size(),
             &encoded_lengths)) {
-      result->inner_segment_boundary.push_back(encoded_lengths);
+      inner_segment_boundary.push_back(encoded_lengths);
     } else {
       inner_segment_boundary_success = false;
     }
   }
-  if (!inner_segment_boundary_success) {
+  result->set_key(key);
+  result->set_value(value);
+  if (inner_segment_boundary_success) {
+    result->set_inner_segment_boundary(inner_segment_boundary);
+  } else {
     LOG(WARNING) << "Failed to construct inner segment boundary";
-    result->inner_segment_boundary.clear();
   }
   return true;
 }
@@ -920,19 +963,20 @@ void DictionaryPredictionAggregator::AggregateRealtimeConversion(
 
   // Copy candidates into the array of Results.
   const Segment segment = tmp_segments.conversion_segment(0);
+  const auto storage = std::make_shared<ResultStorage>();
   for (size_t i = 0; i < segment.candidates_size(); ++i) {
     const Segment::Candidate &candidate = segment.candidate(i);
     results->push_back(Result());
     Result *result = &results->back();
-    result->key = candidate.key;
-    result->value = candidate.value;
+    result->SetStrings(storage, storage->AddString(candidate.key),
+                       storage->AddString(candidate.value), {},
+                       storage->AddBoundary(candidate.inner_segment_boundary));
     // TODO(toshiyuki): Fix the cost.
     // This should be |candidate.wcost + candidate.structure_cost|.
     // |wcost| does not include transition cost between internal nodes.
     result->wcost = candidate.wcost;
     result->lid = candidate.lid;
     result->rid = candidate.rid;
-    result->inner_segment_boundary = candidate.inner_segment_boundary;
     result->SetTypesAndTokenAttributes(REALTIME, Token::NONE);
     result->candidate_attributes |= Segment::Candidate::NO_VARIANTS_EXPANSION;
     if (candidate.key.size() < segment.key().size()) {
@@ -970,9 +1014,11 @@ PredictionType DictionaryPredictionAggregator::AggregateUnigramCandidate(
   const size_t cutoff_threshold =
       GetCandidateCutoffThreshold(request.request_type());
   const size_t prev_results_size = results->size();
-  GetPredictiveResults(*dictionary_, "", request, segments, UNIGRAM,
-                       cutoff_threshold, Segment::Candidate::SOURCE_INFO_NONE,
-                       zip_code_id_, unknown_id_, results);
+  GetPredictiveResults(*dictionary_, "",
+                       GetConversionRequestForUnigramLookup(request), segments,
+                       UNIGRAM, cutoff_threshold,
+                       Segment::Candidate::SOURCE_INFO_NONE, zip_code_id_,
+                       unknown_id_, results);
   const size_t unigram_results_size = results->size() - prev_results_size;
 
   // If size reaches max_results_size (== cutoff_threshold).
@@ -1076,16 +1122,16 @@ DictionaryPredictionAggregator::AggregateUnigramCandidateForHandwriting(
     }
     const int recognition_cost = -500.0 * log(elm.probability());
     constexpr int kAsisCostOffset = 3453;  // 500 * log(1000) = ~3453
-    Result asis_result = {
-        .key = elm.composition_string(),
-        .value = elm.composition_string(),
-        .types = UNIGRAM,
-        // Set small cost for the top recognition result.
-        .wcost = (i == 0) ? 0 : kAsisCostOffset + recognition_cost,
-        .candidate_attributes = (Segment::Candidate::NO_VARIANTS_EXPANSION |
-                                 Segment::Candidate::NO_EXTRA_DESCRIPTION |
-                                 Segment::Candidate::NO_MODIFICATION),
-    };
+    Result asis_result;
+    asis_result.set_key(elm.composition_string());
+    asis_result.set_value(elm.composition_string());
+    asis_result.types = UNIGRAM;
+    // Set small cost for the top recognition result.
+    asis_result.wcost = (i == 0) ? 0 : kAsisCostOffset + recognition_cost;
+    asis_result.candidate_attributes =
+        (Segment::Candidate::NO_VARIANTS_EXPANSION |
+         Segment::Candidate::NO_EXTRA_DESCRIPTION |
+         Segment::Candidate::NO_MODIFICATION);
 
     const std::optional<DictionaryPredictionAggregator::HandwritingQueryInfo>
         query_info = processed_count < size_to_process
@@ -1100,7 +1146,7 @@ DictionaryPredictionAggregator::AggregateUnigramCandidateForHandwriting(
           query_info->constraints, results);
       dictionary_->LookupExact(query_info->query, request, &callback);
       // Rewrite key with the look-up query.
-      asis_result.key = query_info->query;
+      asis_result.set_key(query_info->query);
     }
     results->emplace_back(std::move(asis_result));
   }
@@ -1131,9 +1177,11 @@ void DictionaryPredictionAggregator::LookupUnigramCandidateForMixedConversion(
 
   std::vector<Result> raw_result;
   // No history key
-  GetPredictiveResults(dictionary, "", request, segments, UNIGRAM,
-                       cutoff_threshold, Segment::Candidate::SOURCE_INFO_NONE,
-                       zip_code_id, unknown_id, &raw_result);
+  GetPredictiveResults(dictionary, "",
+                       GetConversionRequestForUnigramLookup(request), segments,
+                       UNIGRAM, cutoff_threshold,
+                       Segment::Candidate::SOURCE_INFO_NONE, zip_code_id,
+                       unknown_id, &raw_result);
 
   // Hereafter, we split "Needed Results" and "(maybe) Unneeded Results."
   // The algorithm is:
@@ -1169,7 +1217,7 @@ void DictionaryPredictionAggregator::LookupUnigramCandidateForMixedConversion(
       // - We do not filter user dictionary word.
       const bool should_check_redundant = !iter->IsUserDictionaryResult();
       if (should_check_redundant &&
-          MaybeRedundant(reference_result.value, iter->value)) {
+          MaybeRedundant(reference_result.value(), iter->value())) {
         // Swap out the redundant result.
         --max_iter;
         std::iter_swap(iter, max_iter);
@@ -1272,10 +1320,9 @@ void DictionaryPredictionAggregator::CheckBigramResult(
 
   const std::string &history_key = history_token.key;
   const std::string &history_value = history_token.value;
-  const std::string key(result->key, history_key.size(),
-                        result->key.size() - history_key.size());
-  const std::string value(result->value, history_value.size(),
-                          result->value.size() - history_value.size());
+  const absl::string_view key = result->key().substr(history_key.size());
+  const absl::string_view value =
+      result->value().substr(history_value.size());
 
   // Don't suggest 0-length key/value.
   if (key.empty() || value.empty()) {
@@ -1306,7 +1353,7 @@ void DictionaryPredictionAggregator::CheckBigramResult(
 
   // If character type doesn't change, this boundary might NOT
   // be a word boundary. Only use iif the entire key is reasonably long.
-  const size_t key_len = Util::CharsLen(result->key);
+  const size_t key_len = Util::CharsLen(result->key());
   if (ctype == last_history_ctype &&
       ((ctype == Util::HIRAGANA && key_len <= 9) ||
        (ctype == Util::KATAKANA && key_len <= 5))) {
@@ -1365,7 +1412,7 @@ void DictionaryPredictionAggregator::GetPredictiveResults(
     const std::string input_key = absl::StrCat(history_key, request.key());
     PredictiveLookupCallback callback(types, lookup_limit, input_key.size(),
                                       empty_expanded, source_info, zip_code_id,
-                                      unknown_id, "", results);
+                                      unknown_id, "", nullptr, results);
     dictionary.LookupPredictive(input_key, request, &callback);
     return;
   }
@@ -1381,16 +1428,18 @@ void DictionaryPredictionAggregator::GetPredictiveResults(
     const std::string input_key = absl::StrCat(history_key, base);
     PredictiveLookupCallback callback(types, lookup_limit, input_key.size(),
                                       expanded, source_info, zip_code_id,
-                                      unknown_id, "", results);
+                                      unknown_id, "", nullptr, results);
     dictionary.LookupPredictive(input_key, request, &callback);
     return;
   }
 
   // `non_expanded_original_key` keeps the original key request before
   // key expansions. This key is passed to the callback so that it can
-  // identify whether the key is actually expanded or not.
-  const std::string non_expanded_original_key =
-      absl::StrCat(history_key, segments.conversion_segment(0).key());
+  // identify whether the key is actually expanded or not. The results from
+  // all the expanded lookups share the storage and the key in it.
+  const auto storage = std::make_shared<ResultStorage>();
+  const absl::string_view non_expanded_original_key = storage->AddString(
+      absl::StrCat(history_key, segments.conversion_segment(0).key()));
 
   // |expanded| is a very small set, so calling LookupPredictive multiple
   // times is not so expensive.  Also, the number of lookup results is limited
@@ -1400,7 +1449,7 @@ void DictionaryPredictionAggregator::GetPredictiveResults(
         absl::StrCat(history_key, base, expanded_char);
     PredictiveLookupCallback callback(
         types, lookup_limit, input_key.size(), empty_expanded, source_info,
-        zip_code_id, unknown_id, non_expanded_original_key, results);
+        zip_code_id, unknown_id, non_expanded_original_key, storage, results);
     dictionary.LookupPredictive(input_key, request, &callback);
   }
 }
@@ -1455,10 +1504,13 @@ void DictionaryPredictionAggregator::GetPredictiveResultsForEnglishKey(
     PredictiveLookupCallback callback(types, lookup_limit, key.size(),
                                       empty_expanded,
                                       Segment::Candidate::SOURCE_INFO_NONE,
-                                      zip_code_id_, unknown_id_, "", results);
+                                      zip_code_id_, unknown_id_, "", nullptr,
+                                      results);
     dictionary.LookupPredictive(key, request, &callback);
     for (size_t i = prev_results_size; i < results->size(); ++i) {
-      Util::UpperString(&(*results)[i].value);
+      std::string value((*results)[i].value());
+      Util::UpperString(&value);
+      (*results)[i].set_value(value);
     }
   } else if (Util::IsCapitalizedAscii(input_key)) {
     // For capitalized key, look up its lower case version and then transform
@@ -1468,25 +1520,28 @@ void DictionaryPredictionAggregator::GetPredictiveResultsForEnglishKey(
     PredictiveLookupCallback callback(types, lookup_limit, key.size(),
                                       empty_expanded,
                                       Segment::Candidate::SOURCE_INFO_NONE,
-                                      zip_code_id_, unknown_id_, "", results);
+                                      zip_code_id_, unknown_id_, "", nullptr,
+                                      results);
     dictionary.LookupPredictive(key, request, &callback);
     for (size_t i = prev_results_size; i < results->size(); ++i) {
-      Util::CapitalizeString(&(*results)[i].value);
+      std::string value((*results)[i].value());
+      Util::CapitalizeString(&value);
+      (*results)[i].set_value(value);
     }
   } else {
     // For other cases (lower and as-is), just look up directly.
     PredictiveLookupCallback callback(types, lookup_limit, input_key.size(),
                                       empty_expanded,
                                       Segment::Candidate::SOURCE_INFO_NONE,
-                                      zip_code_id_, unknown_id_, "", results);
+                                      zip_code_id_, unknown_id_, "", nullptr,
+                                      results);
     dictionary.LookupPredictive(input_key, request, &callback);
   }
   // If input mode is FULL_ASCII, then convert the results to full-width.
   if (request.composer().GetInputMode() == transliteration::FULL_ASCII) {
-    std::string tmp;
     for (size_t i = prev_results_size; i < results->size(); ++i) {
-      tmp.assign((*results)[i].value);
-      (*results)[i].value = japanese_util::HalfWidthAsciiToFullWidthAscii(tmp);
+      (*results)[i].set_value(
+          japanese_util::HalfWidthAsciiToFullWidthAscii((*results)[i].value()));
     }
   }
 }
@@ -1530,6 +1585,7 @@ void DictionaryPredictionAggregator::AppendZeroQueryToResults(
     absl::Span<const ZeroQueryResult> candidates, uint16_t lid, uint16_t rid,
     std::vector<Result> *results) {
   int cost = 0;
+  const auto storage = std::make_shared<ResultStorage>();
 
   for (size_t i = 0; i < candidates.size(); ++i) {
     // Increment cost to show the candidates in order.
@@ -1539,8 +1595,9 @@ void DictionaryPredictionAggregator::AppendZeroQueryToResults(
     Result *result = &results->back();
     result->SetTypesAndTokenAttributes(SUFFIX, Token::NONE);
     result->SetSourceInfoForZeroQuery(candidates[i].second);
-    result->key = candidates[i].first;
-    result->value = candidates[i].first;
+    const absl::string_view key_and_value =
+        storage->AddString(candidates[i].first);
+    result->SetStrings(storage, key_and_value, key_and_value);
     result->wcost = cost;
     result->lid = lid;
     result->rid = rid;
@@ -1791,7 +1848,11 @@ void DictionaryPredictionAggregator::AggregateTypingCorrectedPrediction(
     // Appends the result with TYPING_CORRECTION attribute.
     for (Result &result : corrected_results) {
       PopulateTypeCorrectedQuery(query, &result);
-      result.value = manager->ConvertConversionString(result.value);
+      const std::string value =
+          manager->ConvertConversionString(result.value());
+      if (value != result.value()) {
+        result.set_value(value);
+      }
       results->emplace_back(std::move(result));
     }
   }
@@ -1834,13 +1895,17 @@ bool DictionaryPredictionAggregator::AggregateNumberCandidates(
     return false;
   }
 
-  for (NumberDecoder::Result &decode_result : decode_results) {
+  const auto storage = std::make_shared<ResultStorage>();
+  for (const NumberDecoder::Result &decode_result : decode_results) {
     Result result;
     const bool is_arabic =
         Util::GetScriptType(decode_result.candidate) == Util::NUMBER;
     result.types = PredictionType::NUMBER;
-    result.key = input_key.substr(0, decode_result.consumed_key_byte_len);
-    result.value = std::move(decode_result.candidate);
+    result.SetStrings(
+        storage,
+        storage->AddString(
+            input_key.substr(0, decode_result.consumed_key_byte_len)),
+        storage->AddString(decode_result.candidate));
     result.candidate_attributes |= Segment::Candidate::NO_SUGGEST_LEARNING;
     // Heuristic cost:
     // Large digit number (1億, 1兆, etc) should have larger cost
@@ -1850,7 +1915,7 @@ bool DictionaryPredictionAggregator::AggregateNumberCandidates(
     result.rid = is_arabic ? number_id_ : kanji_number_id_;
     if (decode_result.consumed_key_byte_len < input_key.size()) {
       result.candidate_attributes |= Segment::Candidate::PARTIALLY_KEY_CONSUMED;
-      result.consumed_key_size = Util::CharsLen(result.key);
+      result.consumed_key_size = Util::CharsLen(result.key());
     }
     results->push_back(std::move(result));
   }
@@ -327,7 +327,7 @@ PredictionTypes AddDefaultPredictionTypes(PredictionTypes types,
 bool FindResultByValue(absl::Span<const Result> results,
                        const absl::string_view value) {
   for (const auto &result : results) {
-    if (result.value == value && !result.removed) {
+    if (result.value() == value && !result.removed) {
       return true;
     }
   }
@@ -338,7 +338,7 @@ bool FindResultByKeyValue(absl::Span<const Result> results,
                           const absl::string_view key,
                           const absl::string_view value) {
   for (const auto &result : results) {
-    if (result.key == key && result.value == value && !result.removed) {
+    if (result.key() == key && result.value() == value && !result.removed) {
       return true;
     }
   }
@@ -708,8 +708,8 @@ TEST_F(DictionaryPredictionAggregatorTest, Regression3042706) {
   EXPECT_TRUE(REALTIME | aggregator.AggregatePredictionForRequest(
                              convreq, segments, &results));
   for (auto r : results) {
-    EXPECT_FALSE(absl::StartsWith(r.value, "京都"));
-    EXPECT_TRUE(absl::StartsWith(r.key, "だい"));
+    EXPECT_FALSE(absl::StartsWith(r.value(), "京都"));
+    EXPECT_TRUE(absl::StartsWith(r.key(), "だい"));
   }
 }
 
@@ -1046,7 +1046,7 @@ TEST_F(DictionaryPredictionAggregatorTest, AggregateUnigramCandidate) {
 
   for (const auto &result : results) {
     EXPECT_EQ(result.types, UNIGRAM);
-    EXPECT_TRUE(absl::StartsWith(result.key, kKey));
+    EXPECT_TRUE(absl::StartsWith(result.key(), kKey));
   }
 }
 
@@ -1111,7 +1111,7 @@ TEST_F(DictionaryPredictionAggregatorTest,
     // Check if "aaa" is not filtered.
     auto iter = std::find_if(
         results.begin(), results.end(), [&kHiraganaA](const Result &res) {
-          return res.key == kHiraganaA && res.value == "aaa" &&
+          return res.key() == kHiraganaA && res.value() == "aaa" &&
                  res.IsUserDictionaryResult();
         });
     EXPECT_NE(results.end(), iter);
@@ -1120,7 +1120,8 @@ TEST_F(DictionaryPredictionAggregatorTest,
     // from user dictionary with unknown POS ID.
     iter = std::find_if(results.begin(), results.end(),
                         [&kHiraganaAA](const Result &res) {
-                          return res.key == kHiraganaAA && res.value == "bbb" &&
+                          return res.key() == kHiraganaAA &&
+                                 res.value() == "bbb" &&
                                  res.IsUserDictionaryResult();
                         });
     EXPECT_EQ(iter, results.end());
@@ -1143,7 +1144,7 @@ TEST_F(DictionaryPredictionAggregatorTest,
     // Check if "aaa" is not found as its key is あ.
     auto iter = std::find_if(
         results.begin(), results.end(), [&kHiraganaA](const Result &res) {
-          return res.key == kHiraganaA && res.value == "aaa" &&
+          return res.key() == kHiraganaA && res.value() == "aaa" &&
                  res.IsUserDictionaryResult();
         });
     EXPECT_EQ(iter, results.end());
@@ -1152,13 +1153,84 @@ TEST_F(DictionaryPredictionAggregatorTest,
     // exactly "ああ".
     iter = std::find_if(results.begin(), results.end(),
                         [&kHiraganaAA](const Result &res) {
-                          return res.key == kHiraganaAA && res.value == "bbb" &&
+                          return res.key() == kHiraganaAA &&
+                                 res.value() == "bbb" &&
                                  res.IsUserDictionaryResult();
                         });
     EXPECT_NE(results.end(), iter);
   }
 }
 
+TEST_F(DictionaryPredictionAggregatorTest, ShareNonExpandedOriginalKey) {
+  std::unique_ptr<MockDataAndAggregator> data_and_aggregator =
+      CreateAggregatorWithMockData();
+  const DictionaryPredictionAggregatorTestPeer &aggregator =
+      data_and_aggregator->aggregator();
+
+  table_->AddRule("_", "", "い");
+  table_->AddRule("$", "", "と");
+  table_->AddRule("と*", "", "ど");
+  composer_->InsertCharacter("_$");
+  Segments segments;
+  segments.add_segment()->set_key("いと");
+
+  {
+    MockDictionary *mock = data_and_aggregator->mutable_dictionary();
+    EXPECT_CALL(*mock, LookupPredictive(StrEq("いと"), _, _))
+        .WillRepeatedly(InvokeCallbackWithKeyValues{{
+            {"いと", "糸"},
+            {"いとこ", "従兄弟"},
+        }});
+    EXPECT_CALL(*mock, LookupPredictive(StrEq("いど"), _, _))
+        .WillRepeatedly(InvokeCallbackWithKeyValues{{
+            {"いど", "井戸"},
+        }});
+  }
+
+  std::vector<Result> results;
+  const ConversionRequest convreq = CreatePredictionConversionRequest();
+  aggregator.AggregateUnigramCandidate(convreq, segments, &results);
+  ASSERT_EQ(results.size(), 3);
+
+  // The original key is not copied for each result but shared by all the
+  // results from the expanded lookups.
+  EXPECT_EQ(results[0].non_expanded_original_key(), "いと");
+  for (const Result &result : results) {
+    EXPECT_EQ(result.non_expanded_original_key().data(),
+              results[0].non_expanded_original_key().data());
+  }
+}
+
+TEST_F(DictionaryPredictionAggregatorTest, UnigramLookupInCostOrder) {
+  std::unique_ptr<MockDataAndAggregator> data_and_aggregator =
+      CreateAggregatorWithMockData();
+  const DictionaryPredictionAggregatorTestPeer &aggregator =
+      data_and_aggregator->aggregator();
+
+  Segments segments;
+  SetUpInputForSuggestion("ぐーぐる", composer_.get(), &segments);
+
+  {
+    MockDictionary *mock = data_and_aggregator->mutable_dictionary();
+    EXPECT_CALL(*mock, LookupPredictive(_, _, _)).Times(AnyNumber());
+    EXPECT_CALL(*mock,
+                LookupPredictive(StrEq("ぐーぐる"),
+                                 Truly([](const ConversionRequest &request) {
+                                   return request.options()
+                                       .predictive_lookup_in_cost_order;
+                                 }),
+                                 _))
+        .Times(2);
+  }
+
+  std::vector<Result> results;
+  const ConversionRequest convreq = CreateSuggestionConversionRequest();
+  EXPECT_FALSE(convreq.options().predictive_lookup_in_cost_order);
+  aggregator.AggregateUnigramCandidate(convreq, segments, &results);
+  aggregator.AggregateUnigramCandidateForMixedConversion(convreq, segments,
+                                                         &results);
+}
+
 TEST_F(DictionaryPredictionAggregatorTest, MobileUnigram) {
   std::unique_ptr<MockDataAndAggregator> data_and_aggregator =
       CreateAggregatorWithMockData();
@@ -1205,7 +1277,7 @@ TEST_F(DictionaryPredictionAggregatorTest, MobileUnigram) {
 
   int prefix_count = 0;
   for (const auto &result : results) {
-    if (absl::StartsWith(result.value, "東京")) {
+    if (absl::StartsWith(result.value(), "東京")) {
       ++prefix_count;
     }
   }
@@ -1217,7 +1289,7 @@ TEST_F(DictionaryPredictionAggregatorTest, MobileUnigram) {
       "東京", "TOKYO", "東京!", "東京!?", "東京❤",
   };
   for (int i = 0; i < std::size(kExpected); ++i) {
-    EXPECT_EQ(results[i].value, kExpected[i]);
+    EXPECT_EQ(results[i].value(), kExpected[i]);
   }
 }
 
@@ -1298,14 +1370,14 @@ TEST_F(DictionaryPredictionAggregatorTest, AggregateBigramPrediction) {
     for (size_t i = 0; i < results.size(); ++i) {
       // "グーグルアドセンス", "グーグル", "アドセンス"
       // are in the dictionary.
-      if (results[i].value == "グーグルアドセンス") {
+      if (results[i].value() == "グーグルアドセンス") {
         EXPECT_FALSE(results[i].removed);
       } else {
         EXPECT_TRUE(results[i].removed);
       }
       EXPECT_EQ(results[i].types, BIGRAM);
-      EXPECT_TRUE(absl::StartsWith(results[i].key, kHistoryKey));
-      EXPECT_TRUE(absl::StartsWith(results[i].value, kHistoryValue));
+      EXPECT_TRUE(absl::StartsWith(results[i].key(), kHistoryKey));
+      EXPECT_TRUE(absl::StartsWith(results[i].value(), kHistoryValue));
       // Not zero query
       EXPECT_FALSE(results[i].source_info &
                    Segment::Candidate::DICTIONARY_PREDICTOR_ZERO_QUERY_SUFFIX);
@@ -1361,8 +1433,8 @@ TEST_F(DictionaryPredictionAggregatorTest, AggregateZeroQueryBigramPrediction) {
     EXPECT_FALSE(results.empty());
 
     for (const auto &result : results) {
-      EXPECT_TRUE(absl::StartsWith(result.key, kHistoryKey));
-      EXPECT_TRUE(absl::StartsWith(result.value, kHistoryValue));
+      EXPECT_TRUE(absl::StartsWith(result.key(), kHistoryKey));
+      EXPECT_TRUE(absl::StartsWith(result.value(), kHistoryValue));
       // Zero query
       EXPECT_FALSE(result.source_info &
                    Segment::Candidate::DICTIONARY_PREDICTOR_ZERO_QUERY_SUFFIX);
@@ -1426,12 +1498,12 @@ TEST_F(DictionaryPredictionAggregatorTest, AggregateZeroQueryBigramPrediction) {
     EXPECT_FALSE(FindResultByValue(results, "ありがとうね"));
 
     for (const auto &result : results) {
-      EXPECT_TRUE(absl::StartsWith(result.key, kHistory));
-      EXPECT_TRUE(absl::StartsWith(result.value, kHistory));
+      EXPECT_TRUE(absl::StartsWith(result.key(), kHistory));
+      EXPECT_TRUE(absl::StartsWith(result.value(), kHistory));
       // Zero query
       EXPECT_FALSE(result.source_info &
                    Segment::Candidate::DICTIONARY_PREDICTOR_ZERO_QUERY_SUFFIX);
-      if (result.key == "ありがとうね") {
+      if (result.key() == "ありがとうね") {
         EXPECT_TRUE(result.removed);
       } else {
         EXPECT_FALSE(result.removed);
@@ -1720,8 +1792,8 @@ TEST_F(DictionaryPredictionAggregatorTest, AggregateRealtimeConversion) {
                                            &results);
     ASSERT_EQ(results.size(), 1);
     EXPECT_EQ(results[0].types, REALTIME);
-    EXPECT_EQ(results[0].key, kKey);
-    EXPECT_EQ(results[0].inner_segment_boundary.size(), 3);
+    EXPECT_EQ(results[0].key(), kKey);
+    EXPECT_EQ(results[0].inner_segment_boundary().size(), 3);
     EXPECT_TRUE(results[0].candidate_attributes &
                 Segment::Candidate::NO_VARIANTS_EXPANSION);
   }
@@ -1751,9 +1823,9 @@ TEST_F(DictionaryPredictionAggregatorTest, AggregateRealtimeConversion) {
       EXPECT_TRUE(results[i].types & REALTIME);
       EXPECT_TRUE(results[i].candidate_attributes &
                   Segment::Candidate::NO_VARIANTS_EXPANSION);
-      if (results[i].key == kKey &&
-          results[i].value == "WatashinoNamaehaNakanodesu" &&
-          results[i].inner_segment_boundary.size() == 3) {
+      if (results[i].key() == kKey &&
+          results[i].value() == "WatashinoNamaehaNakanodesu" &&
+          results[i].inner_segment_boundary().size() == 3) {
         EXPECT_TRUE(results[i].types & REALTIME_TOP);
         realtime_top_found = true;
       }
@@ -1821,9 +1893,9 @@ TEST_F(DictionaryPredictionAggregatorTest, PropagateUserHistoryAttribute) {
                 Segment::Candidate::NO_VARIANTS_EXPANSION);
     EXPECT_TRUE(results[0].candidate_attributes &
                 Segment::Candidate::USER_SEGMENT_HISTORY_REWRITER);
-    EXPECT_EQ(results[0].key, kKey);
-    EXPECT_EQ(results[0].value, "WatashinoNamaehaNakanodesu");
-    EXPECT_EQ(results[0].inner_segment_boundary.size(), 3);
+    EXPECT_EQ(results[0].key(), kKey);
+    EXPECT_EQ(results[0].value(), "WatashinoNamaehaNakanodesu");
+    EXPECT_EQ(results[0].inner_segment_boundary().size(), 3);
   }
 }
 
@@ -2115,9 +2187,9 @@ TEST_P(AggregateEnglishPredictionTest, AggregateEnglishPrediction) {
   std::set<std::string> values;
   for (const auto &result : results) {
     EXPECT_EQ(result.types, ENGLISH);
-    EXPECT_TRUE(absl::StartsWith(result.value, entry.expected_prefix))
-        << result.value << " doesn't start with " << entry.expected_prefix;
-    values.insert(result.value);
+    EXPECT_TRUE(absl::StartsWith(result.value(), entry.expected_prefix))
+        << result.value() << " doesn't start with " << entry.expected_prefix;
+    values.emplace(result.value());
   }
   for (const auto &expected_value : entry.expected_values) {
     EXPECT_TRUE(values.find(expected_value) != values.end())
@@ -2206,7 +2278,7 @@ TEST_F(DictionaryPredictionAggregatorTest,
 
   EXPECT_EQ(results.size(), 5);
   for (int i = 0; i < results.size(); ++i) {
-    EXPECT_EQ(results[i].key, expected[i].correction);
+    EXPECT_EQ(results[i].key(), expected[i].correction);
     if (i == 2) {
       // "よろさくです" is COMPLETION only.
       EXPECT_FALSE(results[i].types & TYPING_CORRECTION);
@@ -2245,8 +2317,8 @@ TEST_F(DictionaryPredictionAggregatorTest,
 
   EXPECT_EQ(results.size(), 1);
 
-  EXPECT_EQ(results[0].key, expected[0].correction);
-  EXPECT_EQ(results[0].value, "よろしく！");  // default is full width.
+  EXPECT_EQ(results[0].key(), expected[0].correction);
+  EXPECT_EQ(results[0].value(), "よろしく！");  // default is full width.
 }
 
 TEST_F(DictionaryPredictionAggregatorTest,
@@ -2275,7 +2347,7 @@ TEST_F(DictionaryPredictionAggregatorTest,
   ConversionRequest convreq = CreatePredictionConversionRequest();
   aggregator.AggregateTypingCorrectedPrediction(convreq, segments, &results);
   EXPECT_EQ(results.size(), 2);
-  EXPECT_EQ(results[1].value, "２５");  // default is full width.
+  EXPECT_EQ(results[1].value(), "２５");  // default is full width.
 
   data_and_aggregator->set_supplemental_model(nullptr);
 }
@@ -2308,13 +2380,13 @@ TEST_F(DictionaryPredictionAggregatorTest, ZeroQuerySuggestionAfterNumbers) {
           Segment::Candidate::DICTIONARY_PREDICTOR_ZERO_QUERY_NUMBER_SUFFIX &
           it->source_info);
 
-      if (it->value == kExpectedValue) {
+      if (it->value() == kExpectedValue) {
         target = it;
         break;
       }
     }
     EXPECT_NE(results.end(), target);
-    EXPECT_EQ(target->value, kExpectedValue);
+    EXPECT_EQ(target->value(), kExpectedValue);
     EXPECT_EQ(target->lid, pos_matcher.GetCounterSuffixWordId());
     EXPECT_EQ(target->rid, pos_matcher.GetCounterSuffixWordId());
   }
@@ -2334,7 +2406,7 @@ TEST_F(DictionaryPredictionAggregatorTest, ZeroQuerySuggestionAfterNumbers) {
     bool found = false;
     for (auto it = results.begin(); it != results.end(); ++it) {
       EXPECT_EQ(it->types, SUFFIX);
-      if (it->value == kExpectedValue) {
+      if (it->value() == kExpectedValue) {
         EXPECT_TRUE(
             Segment::Candidate::DICTIONARY_PREDICTOR_ZERO_QUERY_NUMBER_SUFFIX &
             it->source_info);
@@ -2382,7 +2454,7 @@ TEST_F(DictionaryPredictionAggregatorTest, TriggerNumberZeroQuerySuggestion) {
     bool found = false;
     for (auto it = results.begin(); it != results.end(); ++it) {
       EXPECT_EQ(it->types, SUFFIX);
-      if (it->value == test_case.find_suffix_value &&
+      if (it->value() == test_case.find_suffix_value &&
           it->lid == pos_matcher.GetCounterSuffixWordId()) {
         EXPECT_TRUE(
             Segment::Candidate::DICTIONARY_PREDICTOR_ZERO_QUERY_NUMBER_SUFFIX &
@@ -2427,7 +2499,7 @@ TEST_F(DictionaryPredictionAggregatorTest, TriggerZeroQuerySuggestion) {
     for (size_t i = 0; i < results.size(); ++i) {
       const auto &result = results[i];
       EXPECT_EQ(result.types, SUFFIX);
-      if (result.value == test_case.find_value && result.lid == 0 /* EOS */) {
+      if (result.value() == test_case.find_value && result.lid == 0 /* EOS */) {
         rank = static_cast<int>(i);
         break;
       }
@@ -2571,8 +2643,8 @@ TEST_F(DictionaryPredictionAggregatorTest,
   ASSERT_EQ(2, results.size());
 
   EXPECT_EQ(results[0].types, REALTIME);
-  EXPECT_EQ(results[0].value, kExpectedSuggestionValues[0]);
-  EXPECT_EQ(results[1].value, kExpectedSuggestionValues[1]);
+  EXPECT_EQ(results[0].value(), kExpectedSuggestionValues[0]);
+  EXPECT_EQ(results[1].value(), kExpectedSuggestionValues[1]);
 }
 
 TEST_F(DictionaryPredictionAggregatorTest,
@@ -2640,7 +2712,7 @@ TEST_F(DictionaryPredictionAggregatorTest,
   EXPECT_EQ(results[0].types, REALTIME);
   EXPECT_NE(0, (results[0].candidate_attributes &
                 Segment::Candidate::SPELLING_CORRECTION));
-  EXPECT_EQ(results[0].value, kExpectedSuggestionValueWithDe);
+  EXPECT_EQ(results[0].value(), kExpectedSuggestionValueWithDe);
 }
 
 TEST_F(DictionaryPredictionAggregatorTest, PropagateUserDictionaryAttribute) {
@@ -2667,7 +2739,7 @@ TEST_F(DictionaryPredictionAggregatorTest, PropagateUserDictionaryAttribute) {
     EXPECT_NE(NO_PREDICTION, aggregator.AggregatePredictionForRequest(
                                  convreq, segments, &results));
     EXPECT_FALSE(results.empty());
-    EXPECT_EQ(results[0].value, "ユーザー");
+    EXPECT_EQ(results[0].value(), "ユーザー");
     EXPECT_TRUE(results[0].candidate_attributes &
                 Segment::Candidate::USER_DICTIONARY);
   }
@@ -2703,7 +2775,7 @@ TEST_F(DictionaryPredictionAggregatorTest, PropagateUserDictionaryAttribute) {
     EXPECT_NE(NO_PREDICTION, aggregator.AggregatePredictionForRequest(
                                  convreq, segments, &results));
     EXPECT_FALSE(results.empty());
-    EXPECT_EQ(results[0].value, kValue);
+    EXPECT_EQ(results[0].value(), kValue);
     EXPECT_TRUE(results[0].candidate_attributes &
                 Segment::Candidate::USER_DICTIONARY);
   }
@@ -2948,7 +3020,7 @@ TEST_F(DictionaryPredictionAggregatorTest, DoNotModifyHistorySegment) {
   EXPECT_TRUE(
       aggregator.AggregatePredictionForRequest(convreq, segments, &results));
   EXPECT_EQ(results.size(), 1);
-  EXPECT_EQ(results[0].value, "conversion_result");
+  EXPECT_EQ(results[0].value(), "conversion_result");
   EXPECT_EQ(segments.history_segment(0).candidate(0).value, "103");
 }
 
@@ -2968,7 +3040,7 @@ TEST_F(DictionaryPredictionAggregatorTest, NumberDecoderCandidates) {
                                convreq, segments, &results));
   const auto &result =
       std::find_if(results.begin(), results.end(),
-                   [](Result r) { return r.value == "45" && !r.removed; });
+                   [](Result r) { return r.value() == "45" && !r.removed; });
   ASSERT_NE(result, results.end());
   EXPECT_TRUE(result->candidate_attributes &
               Segment::Candidate::PARTIALLY_KEY_CONSUMED);
@@ -3024,8 +3096,8 @@ TEST_F(DictionaryPredictionAggregatorTest, SingleKanji) {
     auto create_single_kanji_result = [](absl::string_view key,
                                          absl::string_view value) {
       Result result;
-      result.key = std::string(key);
-      result.value = std::string(value);
+      result.set_key(key);
+      result.set_value(value);
       result.SetTypesAndTokenAttributes(SINGLE_KANJI, Token::NONE);
       return result;
     };
@@ -3047,7 +3119,7 @@ TEST_F(DictionaryPredictionAggregatorTest, SingleKanji) {
   EXPECT_FALSE(results.empty());
   for (const auto &result : results) {
     if (!(result.types & SINGLE_KANJI)) {
-      EXPECT_GT(Util::CharsLen(result.value), 1);
+      EXPECT_GT(Util::CharsLen(result.value()), 1);
     }
   }
 }
@@ -3166,10 +3238,10 @@ TEST_F(DictionaryPredictionAggregatorTest, Handwriting) {
   EXPECT_TRUE(FindResultByKeyValue(results, "かんじじてん", "換字字典"));
 
   for (const Result &result : results) {
-    if (result.value == "かん字じ典") {
+    if (result.value() == "かん字じ典") {
       // Top recognition result
       EXPECT_EQ(result.wcost, 0);
-    } else if (result.key == "かんじじてん") {
+    } else if (result.key() == "かんじじてん") {
       EXPECT_GE(result.wcost, kCostOffset);
     }
   }
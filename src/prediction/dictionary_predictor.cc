@@ -118,10 +118,10 @@ KeyValueView GetCandidateKeyAndValue(const Result &result
                                      const KeyValueView history) {
   if (result.types & PredictionType::BIGRAM) {
     // remove the prefix of history key and history value.
-    return {absl::string_view(result.key).substr(history.key.size()),
-            absl::string_view(result.value).substr(history.value.size())};
+    return {result.key().substr(history.key.size()),
+            result.value().substr(history.value.size())};
   }
-  return {result.key, result.value};
+  return {result.key(), result.value()};
 }
 
 // Returns the non-expanded lookup key for the result
@@ -129,11 +129,11 @@ absl::string_view GetCandidateOriginalLookupKey(
     absl::string_view input_key ABSL_ATTRIBUTE_LIFETIME_BOUND,
     const Result &result ABSL_ATTRIBUTE_LIFETIME_BOUND,
     absl::string_view history_key) {
-  if (result.non_expanded_original_key.empty()) {
+  absl::string_view lookup_key = result.non_expanded_original_key();
+  if (lookup_key.empty()) {
     return input_key;
   }
 
-  absl::string_view lookup_key = result.non_expanded_original_key;
   if (result.types & PredictionType::BIGRAM) {
     lookup_key.remove_prefix(history_key.size());
   }
@@ -143,7 +143,7 @@ absl::string_view GetCandidateOriginalLookupKey(
 absl::string_view GetCandidateKey(const Result &result
                                       ABSL_ATTRIBUTE_LIFETIME_BOUND,
                                   absl::string_view history_key) {
-  absl::string_view candidate_key = result.key;
+  absl::string_view candidate_key = result.key();
   if (result.types & PredictionType::BIGRAM) {
     candidate_key.remove_prefix(history_key.size());
   }
@@ -191,7 +191,7 @@ void MaybeFixRealtimeTopCost(absl::string_view input_key,
     // length as input_key.
     if (result.types & PredictionType::REALTIME &&
         result.cost < realtime_cost_min &&
-        result.key.size() == input_key.size()) {
+        result.key().size() == input_key.size()) {
       realtime_cost_min = result.cost;
     }
   }
@@ -390,7 +390,7 @@ bool DictionaryPredictor::AddPredictionToCandidates(
   if (IsDebug(request)) {
     for (const auto &result : results) {
       if (!result.removed) {
-        merged_types[result.value] |= result.types;
+        merged_types[result.value()] |= result.types;
       }
     }
   }
@@ -496,7 +496,7 @@ int DictionaryPredictor::CalculateSingleKanjiCostOffset(
       continue;
     }
 
-    if (result.value == input_key) {
+    if (result.value() == input_key) {
       const int cost = GetLMCost(result, rid);
       if (fallback_cost == -1 || fallback_cost > cost) {
         fallback_cost = cost;
@@ -504,7 +504,7 @@ int DictionaryPredictor::CalculateSingleKanjiCostOffset(
     }
 
     if (((result.types & (prediction::REALTIME | prediction::UNIGRAM)) &&
-         Util::CharsLen(result.value) != 1)) {
+         Util::CharsLen(result.value()) != 1)) {
       continue;
     }
     int lm_cost = GetLMCost(result, rid);
@@ -513,12 +513,12 @@ int DictionaryPredictor::CalculateSingleKanjiCostOffset(
       lm_cost += CalculatePrefixPenalty(request, input_key, result,
                                         immutable_converter_, cache);
     }
-    const auto it = min_cost_map.find(result.value);
+    const auto it = min_cost_map.find(result.value());
     if (it == min_cost_map.end()) {
-      min_cost_map[result.value] = lm_cost;
+      min_cost_map[result.value()] = lm_cost;
       continue;
     }
-    min_cost_map[result.value] = std::min(it->second, lm_cost);
+    min_cost_map[result.value()] = std::min(it->second, lm_cost);
   }
 
   // Use the wcost of the highest cost to calculate the single kanji cost
@@ -586,8 +586,8 @@ bool DictionaryPredictor::ResultFilter::ShouldRemove(const Result &result,
   // When |include_exact_key| is true, we don't filter the results
   // which have the exactly same key as the input even if it's a bad
   // suggestion.
-  if (!(include_exact_key_ && (result.key == input_key_)) &&
-      suggestion_filter_.IsBadSuggestion(result.value)) {
+  if (!(include_exact_key_ && (result.key() == input_key_)) &&
+      suggestion_filter_.IsBadSuggestion(result.value())) {
     *log_message = "Bad suggestion";
     return true;
   }
@@ -602,9 +602,9 @@ bool DictionaryPredictor::ResultFilter::ShouldRemove(const Result &result,
   // if |include_exact_key| is true, that's not the case.
   if (!include_exact_key_ && !(result.types & PredictionType::REALTIME) &&
       (((result.types & PredictionType::BIGRAM) &&
-        exact_bigram_key_ == result.value) ||
+        exact_bigram_key_ == result.value()) ||
        (!(result.types & PredictionType::BIGRAM) &&
-        input_key_ == result.value))) {
+        input_key_ == result.value()))) {
     *log_message = "Key == candidate";
     return true;
   }
@@ -655,8 +655,8 @@ bool DictionaryPredictor::ResultFilter::ShouldRemove(const Result &result,
       // example:
       // - "勝った" for the reading, "かった".
       // - "勝" for the reading, "かつ".
-      result.inner_segment_boundary.size() >= 2 &&
-      Util::CharsLen(result.value) != 1 &&
+      result.inner_segment_boundary().size() >= 2 &&
+      Util::CharsLen(result.value()) != 1 &&
       (realtime_count_++ >= 3 || added_num >= 5)) {
     *log_message = "Added realtime >= 3 || added >= 5";
     return true;
@@ -733,14 +733,16 @@ void DictionaryPredictor::FillCandidate(
   }
   candidate->source_info = result.source_info;
   if (result.types & PredictionType::REALTIME) {
-    candidate->inner_segment_boundary = result.inner_segment_boundary;
+    candidate->inner_segment_boundary.assign(
+        result.inner_segment_boundary().begin(),
+        result.inner_segment_boundary().end());
   }
   if (result.types & PredictionType::TYPING_CORRECTION) {
     candidate->attributes |= Segment::Candidate::TYPING_CORRECTION;
   }
   SetDescription(result.types, candidate);
   if (IsDebug(request)) {
-    auto it = merged_types.find(result.value);
+    auto it = merged_types.find(result.value());
     SetDebugDescription(it == merged_types.end() ? 0 : it->second, candidate);
     candidate->cost_before_rescoring = result.cost_before_rescoring;
   }
@@ -865,7 +867,7 @@ void DictionaryPredictor::SetPredictionCost(
     const size_t query_len = (result.types & PredictionType::BIGRAM)
                                  ? bigram_key_len
                                  : unigram_key_len;
-    const size_t key_len = Util::CharsLen(result.key);
+    const size_t key_len = Util::CharsLen(result.key());
 
     if (IsAggressiveSuggestion(query_len, key_len, cost, is_suggestion,
                                results->size())) {
@@ -966,7 +968,7 @@ void DictionaryPredictor::SetPredictionCostForMixedConversion(
     // Demote filtered word here, because they are not filtered for exact match.
     // Even for exact match, we don't want to show aggressive words with high
     // ranking.
-    if (suggestion_filter_.IsBadSuggestion(result.value)) {
+    if (suggestion_filter_.IsBadSuggestion(result.value())) {
       // Cost penalty means for bad suggestion.
       // 3453 = 500 * log(1000)
       constexpr int kBadSuggestionPenalty = 3453;
@@ -1124,10 +1126,10 @@ void DictionaryPredictor::RemoveMissSpelledCandidates(
           Segment::Candidate::SPELLING_CORRECTION) {
         continue;
       }
-      if (target_result.key == result.key) {
+      if (target_result.key() == result.key()) {
         same_key_index.push_back(j);
       }
-      if (target_result.value == result.value) {
+      if (target_result.value() == result.value()) {
         same_value_index.push_back(j);
       }
     }
@@ -1148,7 +1150,8 @@ void DictionaryPredictor::RemoveMissSpelledCandidates(
         (*results)[k].removed = true;
         MOZC_WORD_LOG((*results)[k], "Removed. same_key_index.");
       }
-      if (request_key_len <= GetMissSpelledPosition(result.key, result.value)) {
+      if (request_key_len <=
+          GetMissSpelledPosition(result.key(), result.value())) {
         (*results)[i].removed = true;
         MOZC_WORD_LOG((*results)[i], "Removed. Invalid MissSpelledPosition.");
       }
@@ -1183,11 +1186,11 @@ int DictionaryPredictor::CalculatePrefixPenalty(
     const Result &result,
     const ImmutableConverterInterface *immutable_converter,
     absl::flat_hash_map<PrefixPenaltyKey, int> *cache) const {
-  if (input_key == result.key) {
-    LOG(WARNING) << "Invalid prefix key: " << result.key;
+  if (input_key == result.key()) {
+    LOG(WARNING) << "Invalid prefix key: " << result.key();
     return 0;
   }
-  const std::string &candidate_key = result.key;
+  const absl::string_view candidate_key = result.key();
   const uint16_t result_rid = result.rid;
   const size_t key_len = Util::CharsLen(candidate_key);
   const PrefixPenaltyKey cache_key = std::make_pair(result_rid, key_len);
@@ -1311,9 +1314,9 @@ std::shared_ptr<Result> DictionaryPredictor::MaybeGetPreviousTopResult(
   // 5. current result is not a partial suggestion.
   if (prev_top_result && cur_top_key_length >= prev_top_key_length &&
       std::abs(current_top_result.cost - prev_top_result->cost) < max_diff &&
-      current_top_result.key.size() < prev_top_result->key.size() &&
+      current_top_result.key().size() < prev_top_result->key().size() &&
       !(current_top_result.types & PREFIX) &&
-      absl::StartsWith(prev_top_result->key, current_top_result.key)) {
+      absl::StartsWith(prev_top_result->key(), current_top_result.key())) {
     // Do not need to remember the previous key as `prev_top_result` is still
     // top result.
     return prev_top_result;
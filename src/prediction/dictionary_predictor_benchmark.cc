@@ -0,0 +1,226 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Counts the heap allocations made by the dictionary predictor.
+//
+// dictionary_predictor_benchmark
+//  --engine_data_path=mozc.data --keys=き,きょう --iterations=100
+//
+// For each key, runs DictionaryPredictionAggregator::AggregateResults() and
+// DictionaryPredictor::PredictForRequest() for suggestion and prediction, and
+// prints the number of allocations, the allocated bytes and the time per call.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/log/check.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "base/init_mozc.h"
+#include "base/stopwatch.h"
+#include "composer/composer.h"
+#include "composer/table.h"
+#include "config/config_handler.h"
+#include "converter/converter.h"
+#include "converter/converter_interface.h"
+#include "converter/immutable_converter.h"
+#include "converter/immutable_converter_interface.h"
+#include "converter/segments.h"
+#include "data_manager/data_manager.h"
+#include "engine/modules.h"
+#include "prediction/dictionary_prediction_aggregator.h"
+#include "prediction/dictionary_predictor.h"
+#include "prediction/predictor_interface.h"
+#include "prediction/result.h"
+#include "protocol/commands.pb.h"
+#include "protocol/config.pb.h"
+#include "request/conversion_request.h"
+#include "rewriter/rewriter.h"
+#include "rewriter/rewriter_interface.h"
+
+ABSL_FLAG(std::string, engine_data_path, "", "path to engine data file");
+ABSL_FLAG(std::string, magic, "", "expected magic number of data file");
+ABSL_FLAG(std::string, keys, "き,きょう,きょうの,わたしのなまえ",
+          "comma separated hiragana keys");
+ABSL_FLAG(int32_t, iterations, 100, "number of calls per key");
+
+namespace {
+
+std::atomic<uint64_t> g_num_allocations = 0;
+std::atomic<uint64_t> g_allocated_bytes = 0;
+
+}  // namespace
+
+// Counts every allocation made through the global operator new.
+void *operator new(size_t size) {
+  ++g_num_allocations;
+  g_allocated_bytes += size;
+  if (void *ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+namespace mozc {
+namespace prediction {
+namespace {
+
+struct Measurement {
+  double allocations = 0;
+  double bytes = 0;
+  double microseconds = 0;
+};
+
+template <typename F>
+Measurement Measure(int iterations, F func) {
+  const uint64_t num_allocations = g_num_allocations.load();
+  const uint64_t allocated_bytes = g_allocated_bytes.load();
+  Stopwatch stopwatch = Stopwatch::StartNew();
+  for (int i = 0; i < iterations; ++i) {
+    func();
+  }
+  stopwatch.Stop();
+  return {
+      .allocations =
+          static_cast<double>(g_num_allocations.load() - num_allocations) /
+          iterations,
+      .bytes = static_cast<double>(g_allocated_bytes.load() - allocated_bytes) /
+               iterations,
+      .microseconds =
+          absl::ToDoubleMicroseconds(stopwatch.GetElapsed()) / iterations,
+  };
+}
+
+void RunBenchmark(const DictionaryPredictionAggregator &aggregator,
+                  const PredictorInterface &predictor, absl::string_view key,
+                  ConversionRequest::RequestType request_type,
+                  int iterations) {
+  const composer::Table table;
+  const commands::Request request;
+  const config::Config &config = config::ConfigHandler::DefaultConfig();
+  composer::Composer composer(&table, &request, &config);
+  composer.InsertCharacterPreedit(key);
+  const ConversionRequest conversion_request =
+      ConversionRequestBuilder()
+          .SetComposer(composer)
+          .SetRequest(request)
+          .SetConfig(config)
+          .SetOptions({.request_type = request_type})
+          .Build();
+  Segments segments;
+  Segment *segment = segments.add_segment();
+  segment->set_key(key);
+  segment->set_segment_type(Segment::FREE);
+
+  size_t num_results = 0;
+  const Measurement aggregate = Measure(iterations, [&] {
+    num_results += aggregator.AggregateResults(conversion_request, segments)
+                       .size();
+  });
+  const Measurement predict = Measure(iterations, [&] {
+    Segments tmp_segments = segments;
+    CHECK(predictor.PredictForRequest(conversion_request, &tmp_segments));
+  });
+  std::cout << absl::StreamFormat(
+      "%-10s %s\n"
+      "  aggregate: %8.1f allocs %10.0f bytes %8.1f us  (%d results)\n"
+      "  predict:   %8.1f allocs %10.0f bytes %8.1f us\n",
+      request_type == ConversionRequest::SUGGESTION ? "suggestion"
+                                                    : "prediction",
+      key, aggregate.allocations, aggregate.bytes, aggregate.microseconds,
+      num_results / iterations, predict.allocations, predict.bytes,
+      predict.microseconds);
+}
+
+}  // namespace
+}  // namespace prediction
+}  // namespace mozc
+
+int main(int argc, char **argv) {
+  mozc::InitMozc(argv[0], &argc, &argv);
+
+  absl::StatusOr<std::unique_ptr<mozc::DataManager>> data_manager =
+      absl::GetFlag(FLAGS_magic).empty()
+          ? mozc::DataManager::CreateFromFile(
+                absl::GetFlag(FLAGS_engine_data_path))
+          : mozc::DataManager::CreateFromFile(
+                absl::GetFlag(FLAGS_engine_data_path),
+                absl::GetFlag(FLAGS_magic));
+  CHECK_OK(data_manager);
+  auto modules = std::make_unique<mozc::engine::Modules>();
+  CHECK_OK(modules->Init(*std::move(data_manager)));
+
+  // Builds the converter as the desktop engine does, but with only the
+  // dictionary predictor so that the user history does not change the
+  // results between iterations.
+  const mozc::Converter converter(
+      std::move(modules),
+      [](const mozc::engine::Modules &modules) {
+        return std::make_unique<mozc::ImmutableConverter>(modules);
+      },
+      [](const mozc::engine::Modules &modules,
+         const mozc::ConverterInterface *converter,
+         const mozc::ImmutableConverterInterface *immutable_converter) {
+        return std::make_unique<mozc::prediction::DictionaryPredictor>(
+            modules, converter, immutable_converter);
+      },
+      [](const mozc::engine::Modules &modules,
+         const mozc::ConverterInterface *converter) {
+        return std::make_unique<mozc::Rewriter>(modules, *converter);
+      });
+  const mozc::prediction::DictionaryPredictionAggregator aggregator(
+      *converter.modules(), &converter, converter.immutable_converter());
+
+  const int iterations = absl::GetFlag(FLAGS_iterations);
+  for (absl::string_view key :
+       absl::StrSplit(absl::GetFlag(FLAGS_keys), ',', absl::SkipEmpty())) {
+    for (const mozc::ConversionRequest::RequestType request_type :
+         {mozc::ConversionRequest::SUGGESTION,
+          mozc::ConversionRequest::PREDICTION}) {
+      mozc::prediction::RunBenchmark(aggregator, *converter.predictor(), key,
+                                     request_type, iterations);
+    }
+  }
+  return 0;
+}
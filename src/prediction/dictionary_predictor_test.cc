@@ -174,8 +174,8 @@ Result CreateResult4(absl::string_view key, absl::string_view value,
                      PredictionTypes types,
                      Token::AttributesBitfield token_attrs) {
   Result result;
-  strings::Assign(result.key, key);
-  strings::Assign(result.value, value);
+  result.set_key(key);
+  result.set_value(value);
   result.SetTypesAndTokenAttributes(types, token_attrs);
   return result;
 }
@@ -184,8 +184,8 @@ Result CreateResult5(absl::string_view key, absl::string_view value, int wcost,
                      PredictionTypes types,
                      Token::AttributesBitfield token_attrs) {
   Result result;
-  strings::Assign(result.key, key);
-  strings::Assign(result.value, value);
+  result.set_key(key);
+  result.set_value(value);
   result.wcost = wcost;
   result.SetTypesAndTokenAttributes(types, token_attrs);
   return result;
@@ -195,8 +195,8 @@ Result CreateResult6(absl::string_view key, absl::string_view value, int wcost,
                      int cost, PredictionTypes types,
                      Token::AttributesBitfield token_attrs) {
   Result result;
-  strings::Assign(result.key, key);
-  strings::Assign(result.value, value);
+  result.set_key(key);
+  result.set_value(value);
   result.wcost = wcost;
   result.cost = cost;
   result.SetTypesAndTokenAttributes(types, token_attrs);
@@ -220,7 +220,10 @@ void PushBackInnerSegmentBoundary(size_t key_len, size_t value_len,
                                          content_value_len, &encoded)) {
     return;
   }
-  result->inner_segment_boundary.push_back(encoded);
+  std::vector<uint32_t> boundary(result->inner_segment_boundary().begin(),
+                                 result->inner_segment_boundary().end());
+  boundary.push_back(encoded);
+  result->set_inner_segment_boundary(boundary);
 }
 
 void SetSegmentForCommit(absl::string_view candidate_value,
@@ -530,9 +533,9 @@ TEST_F(DictionaryPredictorTest, SetPredictionCostForMixedConversion) {
   predictor.SetPredictionCostForMixedConversion(convreq, segments, &results);
 
   EXPECT_EQ(results.size(), 3);
-  EXPECT_EQ(results[0].value, "てすと");
-  EXPECT_EQ(results[1].value, "テスト");
-  EXPECT_EQ(results[2].value, "テストテスト");
+  EXPECT_EQ(results[0].value(), "てすと");
+  EXPECT_EQ(results[1].value(), "テスト");
+  EXPECT_EQ(results[2].value(), "テストテスト");
   EXPECT_GT(results[2].cost, results[0].cost);
   EXPECT_GT(results[2].cost, results[1].cost);
 }
@@ -561,7 +564,7 @@ TEST_F(DictionaryPredictorTest, SetLMCostForUserDictionaryWord) {
     predictor.SetPredictionCostForMixedConversion(convreq, segments, &results);
 
     EXPECT_EQ(results.size(), 1);
-    EXPECT_EQ(results[0].value, kAikaKanji);
+    EXPECT_EQ(results[0].value(), kAikaKanji);
     EXPECT_GT(kOriginalWordCost, results[0].cost);
     EXPECT_LE(1, results[0].cost);
   }
@@ -579,7 +582,7 @@ TEST_F(DictionaryPredictorTest, SetLMCostForUserDictionaryWord) {
     predictor.SetPredictionCostForMixedConversion(convreq, segments, &results);
 
     EXPECT_EQ(results.size(), 1);
-    EXPECT_EQ(results[0].value, kAikaKanji);
+    EXPECT_EQ(results[0].value(), kAikaKanji);
     EXPECT_GT(kOriginalWordCost, results[0].cost);
     EXPECT_LE(1, results[0].cost);
   }
@@ -600,7 +603,7 @@ TEST_F(DictionaryPredictorTest, SetLMCostForUserDictionaryWord) {
     predictor.SetPredictionCostForMixedConversion(convreq, segments, &results);
 
     EXPECT_EQ(results.size(), 1);
-    EXPECT_EQ(results[0].value, kAikaKanji);
+    EXPECT_EQ(results[0].value(), kAikaKanji);
     EXPECT_LE(kOriginalWordCost, results[0].cost);
   }
 
@@ -617,7 +620,7 @@ TEST_F(DictionaryPredictorTest, SetLMCostForUserDictionaryWord) {
     predictor.SetPredictionCostForMixedConversion(convreq, segments, &results);
 
     EXPECT_EQ(results.size(), 1);
-    EXPECT_EQ(results[0].value, kAikaKanji);
+    EXPECT_EQ(results[0].value(), kAikaKanji);
     EXPECT_EQ(results[0].cost, kOriginalWordCost);
   }
 }
@@ -818,13 +821,10 @@ TEST_F(DictionaryPredictorTest, PropagateAttributes) {
     // REALTIME: inner_segment_boundary
     Result result = CreateResult5("てすと", "リアルタイム", 100,
                                   prediction::REALTIME, Token::NONE);
-    uint32_t encoded;
-    Segment::Candidate::EncodeLengths(strlen("てす"), strlen("リアル"),
-                                      strlen("て"), strlen("リア"), &encoded);
-    result.inner_segment_boundary.push_back(encoded);
-    Segment::Candidate::EncodeLengths(strlen("と"), strlen("タイム"),
-                                      strlen("と"), strlen("タイム"), &encoded);
-    result.inner_segment_boundary.push_back(encoded);
+    PushBackInnerSegmentBoundary(strlen("てす"), strlen("リアル"),
+                                 strlen("て"), strlen("リア"), &result);
+    PushBackInnerSegmentBoundary(strlen("と"), strlen("タイム"), strlen("と"),
+                                 strlen("タイム"), &result);
 
     EXPECT_TRUE(get_top_candidate(result, prediction::REALTIME, &c));
     EXPECT_EQ(c.value, "リアルタイム");
@@ -970,8 +970,8 @@ TEST_F(DictionaryPredictorTest, PropagateResultCosts) {
   std::vector<Result> results(kTestSize);
   for (size_t i = 0; i < kTestSize; ++i) {
     Result *result = &results[i];
-    result->key = std::string(1, 'a' + i);
-    result->value = std::string(1, 'A' + i);
+    result->set_key(std::string(1, 'a' + i));
+    result->set_value(std::string(1, 'A' + i));
     result->wcost = i;
     result->cost = i + 1000;
     result->SetTypesAndTokenAttributes(prediction::REALTIME, Token::NONE);
@@ -1006,8 +1006,8 @@ TEST_F(DictionaryPredictorTest, PredictNCandidates) {
   std::vector<Result> results(kTotalCandidateSize);
   for (size_t i = 0; i < kTotalCandidateSize; ++i) {
     Result *result = &results[i];
-    result->key = std::string(1, 'a' + i);
-    result->value = std::string(1, 'A' + i);
+    result->set_key(std::string(1, 'a' + i));
+    result->set_value(std::string(1, 'A' + i));
     result->wcost = i;
     result->SetTypesAndTokenAttributes(prediction::REALTIME, Token::NONE);
     if (i < kLowCostCandidateSize) {
@@ -1516,7 +1516,7 @@ TEST_F(DictionaryPredictorTest, TypingCorrectionResultsLimit) {
                     Token::NONE),
   };
   for (auto &result : results) {
-    result.non_expanded_original_key = result.key;
+    result.set_non_expanded_original_key(result.key());
   }
 
   Segments segments;
@@ -1941,7 +1941,7 @@ TEST_F(DictionaryPredictorTest, MaybeGetPreviousTopResultTest) {
     auto result =
         predictor.MaybeGetPreviousTopResult(cur_top, convreq, segments);
     EXPECT_TRUE(result);
-    EXPECT_EQ(result->value, "志賀高原");
+    EXPECT_EQ(result->value(), "志賀高原");
   }
 
   // top is partial
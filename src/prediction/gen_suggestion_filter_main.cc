@@ -59,6 +59,7 @@ ABSL_FLAG(std::string, safe_list_files, "",
 namespace {
 using ::mozc::storage::ExistenceFilter;
 using ::mozc::storage::ExistenceFilterBuilder;
+using ::mozc::storage::ExistenceFilterLayout;
 
 void ReadHashList(const std::string &name, std::vector<uint64_t> *words) {
   std::string line;
@@ -95,8 +96,8 @@ ExistenceFilterBuilder GetFilter(const size_t num_bytes,
                                  absl::Span<const uint64_t> hash_list) {
   LOG(INFO) << "num_bytes: " << num_bytes;
 
-  ExistenceFilterBuilder filter(
-      ExistenceFilterBuilder::CreateOptimal(num_bytes, hash_list.size()));
+  ExistenceFilterBuilder filter(ExistenceFilterBuilder::CreateOptimal(
+      num_bytes, hash_list.size(), ExistenceFilterLayout::kBlocked));
   for (uint64_t hash : hash_list) {
     filter.Insert(hash);
   }
@@ -154,7 +155,8 @@ int main(int argc, char **argv) {
   static constexpr float kErrorRate = 0.00001;
   const size_t num_bytes =
       std::max(ExistenceFilterBuilder::MinFilterSizeInBytesForErrorRate(
-                   kErrorRate, hash_list.size()),
+                   kErrorRate, hash_list.size(),
+                   ExistenceFilterLayout::kBlocked),
                kMinimumFilterBytes);
 
   std::vector<std::string> safe_word_list;
@@ -43,6 +43,7 @@
         'user_history_predictor_test.cc',
         'predictor_test.cc',
         'single_kanji_prediction_aggregator_test.cc',
+        'suggestion_filter_test.cc',
         'zero_query_dict_test.cc',
       ],
       'dependencies': [
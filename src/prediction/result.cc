@@ -29,11 +29,18 @@
 
 #include "prediction/result.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
 #include <tuple>
+#include <utility>
 
 #include "absl/base/nullability.h"
 #include "absl/log/log.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "base/strings/unicode.h"
 #include "composer/query.h"
 #include "converter/segments.h"
@@ -76,16 +83,113 @@ bool ValueLess(absl::string_view lhs, absl::string_view rhs) {
 
 using ::mozc::dictionary::Token;
 
+absl::string_view ResultStorage::AddString(absl::string_view str) {
+  if (str.empty()) {
+    return absl::string_view();
+  }
+  char *ptr = Allocate(str.size());
+  std::memcpy(ptr, str.data(), str.size());
+  return absl::string_view(ptr, str.size());
+}
+
+absl::Span<const uint32_t> ResultStorage::AddBoundary(
+    absl::Span<const uint32_t> boundary) {
+  if (boundary.empty()) {
+    return absl::Span<const uint32_t>();
+  }
+  const size_t size = boundary.size() * sizeof(uint32_t);
+  char *ptr = Allocate(size);
+  std::memcpy(ptr, boundary.data(), size);
+  return absl::MakeConstSpan(reinterpret_cast<const uint32_t *>(ptr),
+                             boundary.size());
+}
+
+char *ResultStorage::Allocate(size_t size) {
+  // Keeps `next_` aligned for uint32_t.
+  size = (size + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1);
+  if (static_cast<size_t>(end_ - next_) < size) {
+    const size_t block_size = std::max(kBlockSize, size);
+    blocks_.push_back(std::make_unique_for_overwrite<char[]>(block_size));
+    next_ = blocks_.back().get();
+    end_ = next_ + block_size;
+  }
+  char *ptr = next_;
+  next_ += size;
+  return ptr;
+}
+
 void Result::InitializeByTokenAndTypes(const Token &token,
                                        PredictionTypes types) {
   SetTypesAndTokenAttributes(types, token.attributes);
-  key = token.key;
-  value = token.value;
+  set_key(token.key);
+  set_value(token.value);
+  wcost = token.cost;
+  lid = token.lid;
+  rid = token.rid;
+}
+
+void Result::InitializeByTokenAndTypes(const Token &token,
+                                       PredictionTypes types,
+                                       std::shared_ptr<ResultStorage> storage,
+                                       absl::string_view
+                                           non_expanded_original_key) {
+  SetTypesAndTokenAttributes(types, token.attributes);
+  SetStrings(storage, storage->AddString(token.key),
+             storage->AddString(token.value), non_expanded_original_key);
   wcost = token.cost;
   lid = token.lid;
   rid = token.rid;
 }
 
+void Result::set_key(absl::string_view key) {
+  const std::shared_ptr<ResultStorage> prev_storage = DetachStorage();
+  key_ = storage_->AddString(key);
+}
+
+void Result::set_value(absl::string_view value) {
+  const std::shared_ptr<ResultStorage> prev_storage = DetachStorage();
+  value_ = storage_->AddString(value);
+}
+
+void Result::set_inner_segment_boundary(absl::Span<const uint32_t> boundary) {
+  const std::shared_ptr<ResultStorage> prev_storage = DetachStorage();
+  inner_segment_boundary_ = storage_->AddBoundary(boundary);
+}
+
+void Result::set_non_expanded_original_key(absl::string_view key) {
+  const std::shared_ptr<ResultStorage> prev_storage = DetachStorage();
+  non_expanded_original_key_ = storage_->AddString(key);
+}
+
+void Result::SetStrings(std::shared_ptr<ResultStorage> storage,
+                        absl::string_view key, absl::string_view value,
+                        absl::string_view non_expanded_original_key,
+                        absl::Span<const uint32_t> inner_segment_boundary) {
+  key_ = key;
+  value_ = value;
+  non_expanded_original_key_ = non_expanded_original_key;
+  inner_segment_boundary_ = inner_segment_boundary;
+  storage_ = std::move(storage);
+}
+
+std::shared_ptr<ResultStorage> Result::DetachStorage() {
+  if (storage_ == nullptr) {
+    storage_ = std::make_shared<ResultStorage>();
+    return nullptr;
+  }
+  if (storage_.use_count() == 1) {
+    return nullptr;
+  }
+  // Other results may read the shared storage on another thread, so the
+  // strings of this result are copied to a storage of its own.
+  auto storage = std::make_shared<ResultStorage>();
+  key_ = storage->AddString(key_);
+  value_ = storage->AddString(value_);
+  inner_segment_boundary_ = storage->AddBoundary(inner_segment_boundary_);
+  non_expanded_original_key_ = storage->AddString(non_expanded_original_key_);
+  return std::exchange(storage_, std::move(storage));
+}
+
 void Result::SetTypesAndTokenAttributes(PredictionTypes prediction_types,
                                         Token::AttributesBitfield token_attr) {
   types = prediction_types;
@@ -32,6 +32,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -41,6 +42,7 @@
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "composer/query.h"
 #include "converter/segments.h"
 #include "dictionary/dictionary_token.h"
@@ -92,9 +94,45 @@ enum PredictionType {
 using PredictionTypes = int32_t;
 using ZeroQueryResult = std::pair<std::string, ZeroQueryType>;
 
+// Stores the strings and the inner segment boundaries of prediction results.
+// The results built by one lookup share a storage, so that building them does
+// not allocate memory for every string. The storage only grows, and it is
+// freed together with the last result referring to it.
+class ResultStorage {
+ public:
+  ResultStorage() = default;
+  ResultStorage(const ResultStorage &) = delete;
+  ResultStorage &operator=(const ResultStorage &) = delete;
+
+  // Copies `str` to the storage and returns the copy.
+  absl::string_view AddString(absl::string_view str);
+  // Copies `boundary` to the storage and returns the copy.
+  absl::Span<const uint32_t> AddBoundary(absl::Span<const uint32_t> boundary);
+
+ private:
+  // Returns `size` bytes aligned for uint32_t.
+  char *Allocate(size_t size);
+
+  static constexpr size_t kBlockSize = 2048;
+
+  // Used first, so that the storage of a few results needs no other block.
+  alignas(uint32_t) char initial_block_[128];
+  char *next_ = initial_block_;
+  char *end_ = initial_block_ + sizeof(initial_block_);
+  std::vector<std::unique_ptr<char[]>> blocks_;
+};
+
 struct Result {
   void InitializeByTokenAndTypes(const dictionary::Token &token,
                                  PredictionTypes types);
+  // Same as above, but stores the strings in `storage`, which the caller
+  // shares with the other results it builds. `non_expanded_original_key` must
+  // be stored in `storage` or outlive the result. The caller must not let
+  // another thread use `storage` while it adds strings.
+  void InitializeByTokenAndTypes(
+      const dictionary::Token &token, PredictionTypes types,
+      std::shared_ptr<ResultStorage> storage,
+      absl::string_view non_expanded_original_key = {});
   void SetTypesAndTokenAttributes(
       PredictionTypes prediction_types,
       dictionary::Token::AttributesBitfield token_attr);
@@ -103,8 +141,39 @@ struct Result {
     return (candidate_attributes & Segment::Candidate::USER_DICTIONARY) != 0;
   }
 
-  std::string key;
-  std::string value;
+  absl::string_view key() const { return key_; }
+  absl::string_view value() const { return value_; }
+  // Boundary information for realtime conversion.
+  // This will be set only for realtime conversion result candidates.
+  // This contains inner segment size for key and value.
+  // If the candidate key and value are
+  // "わたしの|なまえは|なかのです", " 私の|名前は|中野です",
+  // |inner_segment_boundary| have [(4,2), (4, 3), (5, 4)].
+  absl::Span<const uint32_t> inner_segment_boundary() const {
+    return inner_segment_boundary_;
+  }
+  // Lookup key without expansion. Empty if the key was not expanded.
+  // Please refer to Composer for query expansion.
+  absl::string_view non_expanded_original_key() const {
+    return non_expanded_original_key_;
+  }
+
+  // The setters copy the argument to the storage of this result. A storage
+  // shared with other results is left untouched; the strings of this result
+  // are first moved to a new storage.
+  void set_key(absl::string_view key);
+  void set_value(absl::string_view value);
+  void set_inner_segment_boundary(absl::Span<const uint32_t> boundary);
+  void set_non_expanded_original_key(absl::string_view key);
+
+  // Sets the strings and the boundary, which must be stored in `storage` or
+  // outlive this result. Used by the lookups that share a storage across
+  // their results.
+  void SetStrings(std::shared_ptr<ResultStorage> storage, absl::string_view key,
+                  absl::string_view value,
+                  absl::string_view non_expanded_original_key = {},
+                  absl::Span<const uint32_t> inner_segment_boundary = {});
+
   // Indicating which PredictionType creates this instance.
   // UNIGRAM, BIGRAM, REALTIME, SUFFIX, ENGLISH or TYPING_CORRECTION
   // is set exclusively.
@@ -122,19 +191,9 @@ struct Result {
   int lid = 0;
   int rid = 0;
   uint32_t candidate_attributes = 0;
-  // Boundary information for realtime conversion.
-  // This will be set only for realtime conversion result candidates.
-  // This contains inner segment size for key and value.
-  // If the candidate key and value are
-  // "わたしの|なまえは|なかのです", " 私の|名前は|中野です",
-  // |inner_segment_boundary| have [(4,2), (4, 3), (5, 4)].
-  std::vector<uint32_t> inner_segment_boundary;
   // Segment::Candidate::SourceInfo.
   // Will be used for usage stats.
   uint32_t source_info = 0;
-  // Lookup key without expansion.
-  // Please refer to Composer for query expansion.
-  std::string non_expanded_original_key;
   size_t consumed_key_size = 0;
   // The total penalty added to this result.
   int penalty = 0;
@@ -159,10 +218,10 @@ struct Result {
         "lid: %d, "
         "rid: %d, attrs: %d, bdd: %s, srcinfo: %d, origkey: %s, "
         "consumed_key_size: %d, penalty: %d, tc_adjustment: %d, removed: %v",
-        r.key, r.value, r.types, r.wcost, r.cost, r.cost_before_rescoring,
+        r.key_, r.value_, r.types, r.wcost, r.cost, r.cost_before_rescoring,
         r.lid, r.rid, r.candidate_attributes,
-        absl::StrJoin(r.inner_segment_boundary, ","), r.source_info,
-        r.non_expanded_original_key, r.consumed_key_size, r.penalty,
+        absl::StrJoin(r.inner_segment_boundary_, ","), r.source_info,
+        r.non_expanded_original_key_, r.consumed_key_size, r.penalty,
         r.typing_correction_adjustment, r.removed);
 #ifndef NDEBUG
     sink.Append(", log:\n");
@@ -171,6 +230,21 @@ struct Result {
     }
 #endif  // NDEBUG
   }
+
+ private:
+  // Makes `storage_` a storage that only this result refers to, moving the
+  // strings of this result to a new storage if the current one is shared.
+  // Returns the previous storage in that case; the setters keep it until they
+  // have copied their argument, which may point into it.
+  std::shared_ptr<ResultStorage> DetachStorage();
+
+  absl::string_view key_;
+  absl::string_view value_;
+  absl::Span<const uint32_t> inner_segment_boundary_;
+  absl::string_view non_expanded_original_key_;
+  // Owns the strings above unless they point to static data. Shared with
+  // copies of this result and with the results from the same lookup.
+  std::shared_ptr<ResultStorage> storage_;
 };
 
 namespace result_internal {
@@ -191,7 +265,7 @@ bool ValueLess(absl::string_view lhs, absl::string_view rhs);
 struct ResultWCostLess {
   bool operator()(const Result &lhs, const Result &rhs) const {
     if (lhs.wcost == rhs.wcost) {
-      return result_internal::ValueLess(lhs.value, rhs.value);
+      return result_internal::ValueLess(lhs.value(), rhs.value());
     }
     return lhs.wcost < rhs.wcost;
   }
@@ -201,7 +275,7 @@ struct ResultWCostLess {
 struct ResultCostLess {
   bool operator()(const Result &lhs, const Result &rhs) const {
     if (lhs.cost == rhs.cost) {
-      return result_internal::ValueLess(lhs.value, rhs.value);
+      return result_internal::ValueLess(lhs.value(), rhs.value());
     }
     return lhs.cost < rhs.cost;
   }
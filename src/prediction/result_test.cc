@@ -0,0 +1,142 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "prediction/result.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "dictionary/dictionary_token.h"
+#include "testing/gmock.h"
+#include "testing/gunit.h"
+
+namespace mozc::prediction {
+namespace {
+
+using ::mozc::dictionary::Token;
+using ::testing::ElementsAre;
+
+TEST(ResultStorageTest, AddString) {
+  ResultStorage storage;
+  EXPECT_TRUE(storage.AddString("").empty());
+
+  // Longer than the initial block and a single block.
+  const std::string long_str(5000, 'a');
+  std::vector<absl::string_view> strs;
+  for (int i = 0; i < 100; ++i) {
+    strs.push_back(storage.AddString(std::to_string(i)));
+  }
+  const absl::string_view long_view = storage.AddString(long_str);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(strs[i], std::to_string(i));
+  }
+  EXPECT_EQ(long_view, long_str);
+}
+
+TEST(ResultStorageTest, AddBoundary) {
+  ResultStorage storage;
+  // Makes the next allocation unaligned if the storage did not align it.
+  storage.AddString("abc");
+  const std::vector<uint32_t> boundary = {1, 2, 3};
+  const absl::Span<const uint32_t> copy = storage.AddBoundary(boundary);
+  EXPECT_NE(copy.data(), boundary.data());
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(copy.data()) % alignof(uint32_t), 0);
+  EXPECT_THAT(copy, ElementsAre(1, 2, 3));
+}
+
+TEST(ResultTest, Setters) {
+  Result result;
+  result.set_key("key");
+  result.set_value("value");
+  result.set_inner_segment_boundary({1, 2});
+  result.set_non_expanded_original_key("original");
+  EXPECT_EQ(result.key(), "key");
+  EXPECT_EQ(result.value(), "value");
+  EXPECT_THAT(result.inner_segment_boundary(), ElementsAre(1, 2));
+  EXPECT_EQ(result.non_expanded_original_key(), "original");
+
+  // The argument may point to the strings of the result itself.
+  result.set_value(result.key());
+  EXPECT_EQ(result.value(), "key");
+}
+
+TEST(ResultTest, InitializeByTokenAndTypesWithSharedStorage) {
+  auto storage = std::make_shared<ResultStorage>();
+  const absl::string_view original_key = storage->AddString("original");
+  const Token token1("key1", "value1", 100, 1, 2, Token::NONE);
+  const Token token2("key2", "value2", 200, 3, 4, Token::NONE);
+
+  Result result1, result2;
+  result1.InitializeByTokenAndTypes(token1, UNIGRAM, storage, original_key);
+  result2.InitializeByTokenAndTypes(token2, UNIGRAM, storage, original_key);
+  EXPECT_EQ(result1.key(), "key1");
+  EXPECT_EQ(result1.value(), "value1");
+  EXPECT_EQ(result1.wcost, 100);
+  EXPECT_EQ(result2.key(), "key2");
+  EXPECT_EQ(result2.value(), "value2");
+  EXPECT_EQ(result1.non_expanded_original_key().data(),
+            result2.non_expanded_original_key().data());
+
+  // The results keep the strings after the storage is released by the lookup.
+  storage.reset();
+  EXPECT_EQ(result1.key(), "key1");
+  EXPECT_EQ(result2.non_expanded_original_key(), "original");
+}
+
+TEST(ResultTest, CopyOnWrite) {
+  Result result;
+  result.set_key("key");
+  result.set_value("value");
+
+  // A copy shares the strings.
+  Result copy = result;
+  EXPECT_EQ(copy.key().data(), result.key().data());
+
+  // Setting a string of the copy does not change the original.
+  copy.set_value("new_value");
+  copy.set_key(copy.key());
+  EXPECT_EQ(copy.key(), "key");
+  EXPECT_EQ(copy.value(), "new_value");
+  EXPECT_EQ(result.key(), "key");
+  EXPECT_EQ(result.value(), "value");
+  EXPECT_NE(copy.key().data(), result.key().data());
+
+  // The copy keeps its strings after the original is destroyed.
+  result = Result();
+  EXPECT_EQ(copy.key(), "key");
+  EXPECT_EQ(copy.value(), "new_value");
+}
+
+}  // namespace
+}  // namespace mozc::prediction
@@ -36,7 +36,6 @@
 
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
-#include "base/strings/assign.h"
 #include "base/util.h"
 #include "composer/composer.h"
 #include "converter/segments.h"
@@ -118,13 +117,18 @@ void SingleKanjiPredictionAggregator::AppendResults(
     absl::string_view kanji_key, absl::string_view original_input_key,
     absl::Span<const std::string> kanji_list, const int offset,
     std::vector<Result> *results) const {
+  if (kanji_list.empty()) {
+    return;
+  }
+  // All the results share the storage and the key.
+  const auto storage = std::make_shared<ResultStorage>();
+  const absl::string_view key = storage->AddString(kanji_key);
   for (const std::string &kanji : kanji_list) {
     Result result;
     // Set the wcost to keep the `kanji_list` order.
     result.wcost = offset + results->size();
     result.types = SINGLE_KANJI;
-    strings::Assign(result.key, kanji_key);
-    result.value = kanji;
+    result.SetStrings(storage, key, storage->AddString(kanji));
     result.lid = general_symbol_id_;
     result.rid = general_symbol_id_;
     if (kanji_key.size() < original_input_key.size()) {
@@ -132,7 +136,7 @@ void SingleKanjiPredictionAggregator::AppendResults(
       result.consumed_key_size = Util::CharsLen(kanji_key);
     }
 
-    results->push_back(result);
+    results->push_back(std::move(result));
   }
 }
 
@@ -63,7 +63,7 @@ void SetUpInputWithKey(absl::string_view key, composer::Composer *composer,
 bool FindResultByKey(absl::Span<const Result> results,
                      const absl::string_view key) {
   for (const auto &result : results) {
-    if (result.key == key && !result.removed) {
+    if (result.key() == key && !result.removed) {
       return true;
     }
   }
@@ -141,7 +141,7 @@ TEST_F(SingleKanjiPredictionAggregatorTest, ResultsFromPrefix) {
   EXPECT_TRUE(FindResultByKey(results, "あけぼの"));
   EXPECT_TRUE(FindResultByKey(results, "あけ"));
   for (int i = 0; i < results.size(); ++i) {
-    if (results[i].key == "あけぼの") {
+    if (results[i].key() == "あけぼの") {
       EXPECT_EQ(results[i].wcost, i);
     } else {
       EXPECT_GT(results[i].wcost, i);  // Cost offset should be added
@@ -158,7 +158,7 @@ TEST_F(SingleKanjiPredictionAggregatorTest, Result) {
       aggregator.AggregateResults(convreq, segments);
   EXPECT_GT(results.size(), 1);
   const auto &result = results[0];
-  EXPECT_EQ(result.key, "あけぼの");
+  EXPECT_EQ(result.key(), "あけぼの");
   EXPECT_EQ(result.types, SINGLE_KANJI);
   EXPECT_EQ(result.lid, pos_matcher_->GetGeneralSymbolId());
   EXPECT_EQ(result.rid, pos_matcher_->GetGeneralSymbolId());
@@ -176,7 +176,7 @@ TEST_F(SingleKanjiPredictionAggregatorTest, PrefixResult) {
       aggregator.AggregateResults(convreq, segments);
   EXPECT_GT(results.size(), 1);
   const auto &result = results[0];
-  EXPECT_EQ(result.key, "あけぼの");
+  EXPECT_EQ(result.key(), "あけぼの");
   EXPECT_EQ(result.types, SINGLE_KANJI);
   EXPECT_EQ(result.lid, pos_matcher_->GetGeneralSymbolId());
   EXPECT_EQ(result.rid, pos_matcher_->GetGeneralSymbolId());
@@ -209,7 +209,7 @@ TEST_F(SingleKanjiPredictionAggregatorTest, SvsVariation) {
 
   auto contains = [&](absl::string_view value) {
     for (const auto &result : results) {
-      if (result.value == value) {
+      if (result.value() == value) {
         return true;
       }
     }
@@ -29,6 +29,8 @@
 
 #include "prediction/suggestion_filter.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <utility>
@@ -39,13 +41,51 @@
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "base/hash.h"
-#include "base/util.h"
 #include "storage/existence_filter.h"
 
 namespace mozc {
 
 using ::mozc::storage::ExistenceFilter;
 
+namespace {
+
+// Returns the position of the first character that Util::LowerString()
+// changes, or `text.size()` if there is none. The upper case characters are
+// 'A'-'Z' and U+FF21-U+FF3A ('Ａ'-'Ｚ', "\xEF\xBC\xA1"-"\xEF\xBC\xBA").
+size_t FindUpper(absl::string_view text) {
+  for (size_t i = 0; i < text.size(); ++i) {
+    const char c = text[i];
+    if (('A' <= c && c <= 'Z') ||
+        (c == '\xEF' && i + 2 < text.size() && text[i + 1] == '\xBC' &&
+         '\xA1' <= text[i + 2] && text[i + 2] <= '\xBA')) {
+      return i;
+    }
+  }
+  return text.size();
+}
+
+// Lowers the characters in [pos, size) of `str` in place. The result is
+// equivalent to Util::LowerString() for valid UTF-8 strings.
+void LowerFrom(size_t pos, char *str, size_t size) {
+  for (size_t i = pos; i < size; ++i) {
+    const char c = str[i];
+    if ('A' <= c && c <= 'Z') {
+      str[i] = c + ('a' - 'A');
+    } else if (c == '\xEF' && i + 2 < size && str[i + 1] == '\xBC' &&
+               '\xA1' <= str[i + 2] && str[i + 2] <= '\xBA') {
+      // U+FF21-U+FF3A to U+FF41-U+FF5A ("\xEF\xBD\x81"-"\xEF\xBD\x9A").
+      str[i + 1] = '\xBD';
+      str[i + 2] = str[i + 2] - ('\xA1' - '\x81');
+      i += 2;
+    }
+  }
+}
+
+// Texts up to this length are lowered on the stack.
+constexpr size_t kMaxStackTextSize = 256;
+
+}  // namespace
+
 absl::StatusOr<SuggestionFilter> SuggestionFilter::Create(
     const absl::Span<const uint32_t> data) {
   absl::StatusOr<ExistenceFilter> filter = ExistenceFilter::Read(data);
@@ -64,8 +104,19 @@ SuggestionFilter SuggestionFilter::CreateOrDie(
 }
 
 bool SuggestionFilter::IsBadSuggestion(const absl::string_view text) const {
+  // This is called for every prediction candidate, so avoid allocation.
+  const size_t pos = FindUpper(text);
+  if (pos == text.size()) {
+    return filter_.Exists(Fingerprint(text));
+  }
+  if (text.size() <= kMaxStackTextSize) {
+    char buf[kMaxStackTextSize];
+    std::copy(text.begin(), text.end(), buf);
+    LowerFrom(pos, buf, text.size());
+    return filter_.Exists(Fingerprint(absl::string_view(buf, text.size())));
+  }
   std::string lower_text(text);
-  Util::LowerString(&lower_text);
+  LowerFrom(pos, lower_text.data(), lower_text.size());
   return filter_.Exists(Fingerprint(lower_text));
 }
 
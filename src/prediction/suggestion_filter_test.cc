@@ -0,0 +1,100 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "prediction/suggestion_filter.h"
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "base/hash.h"
+#include "base/util.h"
+#include "storage/existence_filter.h"
+#include "testing/gunit.h"
+
+namespace mozc {
+namespace {
+
+using ::mozc::storage::ExistenceFilterBuilder;
+using ::mozc::storage::ExistenceFilterLayout;
+
+SuggestionFilter CreateFilter(ExistenceFilterBuilder &builder) {
+  constexpr absl::string_view kWords[] = {"abc", "ｂａｄ", "mixedｗｏｒｄ"};
+  for (const absl::string_view word : kWords) {
+    builder.Insert(Fingerprint(word));
+  }
+  return SuggestionFilter(builder.Build());
+}
+
+TEST(SuggestionFilterTest, IsBadSuggestion) {
+  ExistenceFilterBuilder builder =
+      ExistenceFilterBuilder::CreateOptimal(1024, 3);
+  const SuggestionFilter filter = CreateFilter(builder);
+
+  EXPECT_TRUE(filter.IsBadSuggestion("abc"));
+  EXPECT_TRUE(filter.IsBadSuggestion("ABC"));
+  EXPECT_TRUE(filter.IsBadSuggestion("aBc"));
+  EXPECT_TRUE(filter.IsBadSuggestion("ｂａｄ"));
+  EXPECT_TRUE(filter.IsBadSuggestion("ＢＡＤ"));
+  EXPECT_TRUE(filter.IsBadSuggestion("MiXeDｗＯｒＤ"));
+  EXPECT_FALSE(filter.IsBadSuggestion("abcd"));
+  EXPECT_FALSE(filter.IsBadSuggestion("ＡＢＣ"));
+  EXPECT_FALSE(filter.IsBadSuggestion(""));
+}
+
+TEST(SuggestionFilterTest, IsBadSuggestionWithBlockedLayout) {
+  ExistenceFilterBuilder builder = ExistenceFilterBuilder::CreateOptimal(
+      1024, 3, ExistenceFilterLayout::kBlocked);
+  const SuggestionFilter filter = CreateFilter(builder);
+
+  EXPECT_TRUE(filter.IsBadSuggestion("ABC"));
+  EXPECT_TRUE(filter.IsBadSuggestion("ＢＡＤ"));
+  EXPECT_FALSE(filter.IsBadSuggestion("abcd"));
+}
+
+TEST(SuggestionFilterTest, LowerStringIsCompatible) {
+  // Long texts take a different path from short ones.
+  std::string long_text;
+  for (int i = 0; i < 100; ++i) {
+    long_text.append("AＡaａあ");
+  }
+  const absl::string_view kTexts[] = {"AZ@[`{ＡＺ＠［｀｛あア亜", long_text};
+  for (const absl::string_view text : kTexts) {
+    std::string lower(text);
+    Util::LowerString(&lower);
+    ExistenceFilterBuilder builder =
+        ExistenceFilterBuilder::CreateOptimal(1024, 1);
+    builder.Insert(Fingerprint(lower));
+    const SuggestionFilter filter(builder.Build());
+    EXPECT_TRUE(filter.IsBadSuggestion(text)) << text;
+    EXPECT_TRUE(filter.IsBadSuggestion(lower)) << text;
+  }
+}
+
+}  // namespace
+}  // namespace mozc
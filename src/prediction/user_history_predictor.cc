@@ -52,6 +52,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "base/bits.h"
@@ -368,6 +369,7 @@ std::string UserHistoryPredictor::GetUserHistoryFileName() {
 uint16_t UserHistoryPredictor::revert_id() { return kRevertId; }
 
 void UserHistoryPredictor::WaitForSyncer() {
+  absl::MutexLock lock(&sync_mutex_);
   if (sync_.has_value()) {
     sync_->Wait();
     sync_.reset();
@@ -380,6 +382,11 @@ bool UserHistoryPredictor::Wait() {
 }
 
 bool UserHistoryPredictor::CheckSyncerAndDelete() const {
+  absl::MutexLock lock(&sync_mutex_);
+  return CheckSyncerAndDeleteLocked();
+}
+
+bool UserHistoryPredictor::CheckSyncerAndDeleteLocked() const {
   if (sync_.has_value()) {
     if (!sync_->Ready()) {
       return false;
@@ -401,7 +408,8 @@ bool UserHistoryPredictor::Reload() {
 }
 
 bool UserHistoryPredictor::AsyncLoad() {
-  if (!CheckSyncerAndDelete()) {  // now loading/saving
+  absl::MutexLock lock(&sync_mutex_);
+  if (!CheckSyncerAndDeleteLocked()) {  // now loading/saving
     return true;
   }
 
@@ -418,7 +426,8 @@ bool UserHistoryPredictor::AsyncSave() {
     return true;
   }
 
-  if (!CheckSyncerAndDelete()) {  // now loading/saving
+  absl::MutexLock lock(&sync_mutex_);
+  if (!CheckSyncerAndDeleteLocked()) {  // now loading/saving
     return true;
   }
 
@@ -40,8 +40,10 @@
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "base/container/freelist.h"
 #include "base/container/trie.h"
 #include "base/thread.h"
@@ -275,7 +277,7 @@ class UserHistoryPredictor : public PredictorInterface {
   bool AsyncLoad();
 
   // Waits until syncer finishes.
-  void WaitForSyncer();
+  void WaitForSyncer() ABSL_LOCKS_EXCLUDED(sync_mutex_);
 
   // Returns id for RevertEntry
   static uint16_t revert_id();
@@ -350,7 +352,11 @@ class UserHistoryPredictor : public PredictorInterface {
   using DicCache = mozc::storage::LruCache<uint32_t, Entry>;
   using DicElement = DicCache::Element;
 
-  bool CheckSyncerAndDelete() const;
+  // Returns false while the syncer is loading or saving. Otherwise deletes the
+  // finished syncer and returns true.
+  bool CheckSyncerAndDelete() const ABSL_LOCKS_EXCLUDED(sync_mutex_);
+  bool CheckSyncerAndDeleteLocked() const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(sync_mutex_);
 
   // If |entry| is the target of prediction,
   // create a new result and insert it to |results|.
@@ -514,7 +520,10 @@ class UserHistoryPredictor : public PredictorInterface {
   bool content_word_learning_enabled_;
   mutable std::atomic<bool> updated_;
   std::unique_ptr<DicCache> dic_;
-  mutable std::optional<BackgroundFuture<void>> sync_;
+  // Prediction checks the syncer from multiple threads through const methods.
+  mutable absl::Mutex sync_mutex_;
+  mutable std::optional<BackgroundFuture<void>> sync_
+      ABSL_GUARDED_BY(sync_mutex_);
   const engine::Modules &modules_;
 
   mutable std::atomic<bool> aggressive_bigram_enabled_ = false;
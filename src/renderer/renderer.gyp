@@ -60,6 +60,16 @@
         '<(mozc_oss_src_dir)/base/base.gyp:base',
       ],
     },
+    {
+      'target_name': 'renderer_command_delta',
+      'type': 'static_library',
+      'sources': [
+        'renderer_command_delta.cc',
+      ],
+      'dependencies': [
+        '<(mozc_oss_src_dir)/protocol/protocol.gyp:renderer_proto',
+      ],
+    },
     {
       'target_name': 'renderer_client',
       'type': 'static_library',
@@ -67,6 +77,7 @@
         'renderer_client.cc',
       ],
       'dependencies': [
+        '<(mozc_oss_src_dir)/base/absl.gyp:absl_random',
         '<(mozc_oss_src_dir)/base/absl.gyp:absl_synchronization',
         '<(mozc_oss_src_dir)/base/base.gyp:base',
         '<(mozc_oss_src_dir)/base/base.gyp:version',
@@ -74,6 +85,7 @@
         '<(mozc_oss_src_dir)/protocol/protocol.gyp:commands_proto',
         '<(mozc_oss_src_dir)/protocol/protocol.gyp:config_proto',
         '<(mozc_oss_src_dir)/protocol/protocol.gyp:renderer_proto',
+        'renderer_command_delta',
       ],
     },
     {
@@ -91,6 +103,7 @@
         '<(mozc_oss_src_dir)/ipc/ipc.gyp:ipc',
         '<(mozc_oss_src_dir)/protocol/protocol.gyp:commands_proto',
         '<(mozc_oss_src_dir)/protocol/protocol.gyp:renderer_proto',
+        'renderer_command_delta',
       ],
     },
     {
@@ -116,6 +129,23 @@
         '<(mozc_oss_src_dir)/base/base.gyp:version',
         '<(mozc_oss_src_dir)/testing/testing.gyp:gtest_main',
         'renderer_client',
+        'renderer_command_delta',
+      ],
+      'variables': {
+        'test_size': 'small',
+      },
+    },
+    {
+      'target_name': 'renderer_command_delta_test',
+      'type': 'executable',
+      'sources': [
+        'renderer_command_delta_test.cc',
+      ],
+      'dependencies': [
+        '<(mozc_oss_src_dir)/protocol/protocol.gyp:commands_proto',
+        '<(mozc_oss_src_dir)/protocol/protocol.gyp:renderer_proto',
+        '<(mozc_oss_src_dir)/testing/testing.gyp:gtest_main',
+        'renderer_command_delta',
       ],
       'variables': {
         'test_size': 'small',
@@ -202,6 +232,7 @@
       'type': 'none',
       'dependencies': [
         'renderer_client_test',
+        'renderer_command_delta_test',
         'renderer_server_test',
         'renderer_style_handler_test',
         'table_layout_test',
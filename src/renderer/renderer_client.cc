@@ -35,9 +35,11 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/log/log.h"
+#include "absl/random/random.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
@@ -50,6 +52,7 @@
 #include "ipc/ipc.h"
 #include "ipc/named_event.h"
 #include "protocol/renderer_command.pb.h"
+#include "renderer/renderer_command_delta.h"
 
 #ifdef __APPLE__
 #include "base/mac/mac_util.h"
@@ -71,17 +74,25 @@ constexpr size_t kMaxErrorTimes = 5;
 constexpr absl::Duration kRetryIntervalTime = absl::Seconds(30);
 constexpr char kServiceName[] = "renderer";
 
-inline void CallCommand(IPCClientInterface *client,
-                        const commands::RendererCommand &command) {
+bool CallCommand(IPCClientInterface *client,
+                 const commands::RendererCommand &command,
+                 std::string *result) {
+  // Delta-encoded commands lack required fields.
   std::string buf;
-  command.SerializeToString(&buf);
-
-  // basically, we don't need to get the result
-  std::string result;
+  command.SerializePartialToString(&buf);
 
-  if (!client->Call(buf, &result, kIpcTimeout)) {
+  if (!client->Call(buf, result, kIpcTimeout)) {
     LOG(ERROR) << "Cannot send the request: ";
+    return false;
   }
+  return true;
+}
+
+inline void CallCommand(IPCClientInterface *client,
+                        const commands::RendererCommand &command) {
+  // basically, we don't need to get the result
+  std::string result;
+  CallCommand(client, command, &result);
 }
 }  // namespace
 
@@ -185,9 +196,8 @@ class RendererLauncher : public RendererLauncherInterface {
     // ignore NOOP|SHUTDOWN
     if (command.type() == commands::RendererCommand::UPDATE) {
       absl::MutexLock l(&mu_);
-      if (!pending_command_.has_value()) {
-        pending_command_ = command;
-      }
+      // The latest command supersedes the older ones.
+      pending_command_ = command;
     }
   }
 
@@ -342,7 +352,10 @@ RendererClient::RendererClient()
       version_mismatch_nums_(0),
       ipc_client_factory_interface_(IPCClientFactory::GetIPCClientFactory()),
       renderer_launcher_(new RendererLauncher),
-      renderer_launcher_interface_(nullptr) {
+      renderer_launcher_interface_(nullptr),
+      // Different clients may update the same renderer. Start from a random
+      // number so that their sequence numbers don't collide.
+      next_sequence_number_(absl::Uniform<uint64_t>(absl::BitGen())) {
   renderer_launcher_interface_ = renderer_launcher_.get();
 
   name_ = kServiceName;
@@ -480,6 +493,7 @@ bool RendererClient::ExecCommand(const commands::RendererCommand &command) {
       return true;
     }
     LOG(WARNING) << "cannot connect to renderer. restarting";
+    last_command_.reset();
     renderer_launcher_interface_->SetPendingCommand(command);
     renderer_launcher_interface_->StartRenderer(name_, renderer_path_,
                                                 disable_renderer_path_check_,
@@ -518,11 +532,52 @@ bool RendererClient::ExecCommand(const commands::RendererCommand &command) {
     return true;
   }
 
-  CallCommand(client.get(), command);
+  if (command.type() == commands::RendererCommand::UPDATE) {
+    SendUpdateCommand(std::move(client), command);
+  } else {
+    CallCommand(client.get(), command);
+  }
 
   return true;
 }
 
+void RendererClient::SendUpdateCommand(
+    std::unique_ptr<IPCClientInterface> client,
+    const commands::RendererCommand &command) {
+  commands::RendererCommand full_command = command;
+  full_command.set_sequence_number(next_sequence_number_++);
+
+  std::string result;
+  if (last_command_.has_value()) {
+    // Send only the difference from the command the renderer has.
+    commands::RendererCommand delta;
+    EncodeRendererCommandDelta(*last_command_, full_command, &delta);
+    if (!CallCommand(client.get(), delta, &result)) {
+      last_command_.reset();
+      return;
+    }
+    if (result != kRendererCommandDeltaRejected) {
+      last_command_ = std::move(full_command);
+      return;
+    }
+    // The renderer doesn't have the base command, e.g. another client has
+    // updated it. Resend the full command. An IPC client can be used only for
+    // one call.
+    MOZC_VLOG(1) << "Delta is rejected. Sending the full command.";
+    client = CreateIPCClient();
+    if (client == nullptr || !client->Connected()) {
+      last_command_.reset();
+      return;
+    }
+  }
+
+  if (CallCommand(client.get(), full_command, &result)) {
+    last_command_ = std::move(full_command);
+  } else {
+    last_command_.reset();
+  }
+}
+
 std::unique_ptr<IPCClientInterface> RendererClient::CreateIPCClient() const {
   if (ipc_client_factory_interface_ == nullptr) {
     return nullptr;
@@ -30,7 +30,9 @@
 #ifndef MOZC_RENDERER_RENDERER_CLIENT_H_
 #define MOZC_RENDERER_RENDERER_CLIENT_H_
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 
 #include "client/client_interface.h"
@@ -68,7 +70,7 @@ class RendererLauncherInterface {
   virtual bool CanConnect() const = 0;
 
   // |command| is sent to the server just after
-  // renderer is launched.
+  // renderer is launched. Only the latest UPDATE command is kept.
   virtual void SetPendingCommand(const commands::RendererCommand &command) = 0;
 
   // Sets the flag of error dialog suppression.
@@ -110,6 +112,8 @@ class RendererClient : public RendererInterface {
   // Otherwise command::RendererCommand::SHUDDOWN is used.
   bool Shutdown(bool force);
 
+  // UPDATE commands are sent as deltas against the last command acknowledged
+  // by the renderer, and as full commands when the renderer doesn't have it.
   bool ExecCommand(const commands::RendererCommand &command) override;
 
   // Don't check the renderer server path.
@@ -121,6 +125,8 @@ class RendererClient : public RendererInterface {
 
  private:
   std::unique_ptr<IPCClientInterface> CreateIPCClient() const;
+  void SendUpdateCommand(std::unique_ptr<IPCClientInterface> client,
+                         const commands::RendererCommand &command);
 
   bool is_window_visible_;
   bool disable_renderer_path_check_;
@@ -132,6 +138,10 @@ class RendererClient : public RendererInterface {
 
   std::unique_ptr<RendererLauncherInterface> renderer_launcher_;
   RendererLauncherInterface *renderer_launcher_interface_;
+
+  // The last UPDATE command acknowledged by the renderer.
+  std::optional<commands::RendererCommand> last_command_;
+  uint64_t next_sequence_number_;
 };
 
 }  // namespace renderer
@@ -42,8 +42,10 @@
 #include "base/number_util.h"
 #include "base/version.h"
 #include "ipc/ipc.h"
+#include "protocol/candidate_window.pb.h"
 #include "protocol/commands.pb.h"
 #include "protocol/renderer_command.pb.h"
+#include "renderer/renderer_command_delta.h"
 #include "testing/gunit.h"
 
 namespace mozc {
@@ -63,6 +65,8 @@ struct IPCClientParams {
   bool connected = false;
   uint32_t server_protocol_version = IPC_PROTOCOL_VERSION;
   std::string server_product_version = Version::GetMozcVersion();
+  std::string last_request;
+  std::string response;
 };
 
 class TestIPCClient : public IPCClientInterface {
@@ -85,6 +89,8 @@ class TestIPCClient : public IPCClientInterface {
   bool Call(const std::string &request, std::string *response,
             absl::Duration timeout) override {
     ++params_.counter;
+    params_.last_request = request;
+    *response = params_.response;
     return true;
   }
 
@@ -524,6 +530,57 @@ TEST_F(RendererClientTest, SetPendingCommandTest) {
   }
 }
 
+TEST_F(RendererClientTest, DeltaUpdateTest) {
+  RendererClient client = NewClient();
+  launcher_.Reset();
+  launcher_.set_can_connect(true);
+  client_params_.connected = true;
+  Reset();
+
+  commands::RendererCommand command;
+  command.set_type(commands::RendererCommand::UPDATE);
+  command.set_visible(true);
+  commands::CandidateWindow *candidate_window =
+      command.mutable_output()->mutable_candidate_window();
+  candidate_window->set_focused_index(0);
+  candidate_window->set_size(1);
+  candidate_window->set_position(0);
+  commands::CandidateWindow::Candidate *candidate =
+      candidate_window->add_candidate();
+  candidate->set_index(0);
+  candidate->set_value("candidate");
+
+  commands::RendererCommand request;
+
+  // The first command is sent as is.
+  EXPECT_TRUE(client.ExecCommand(command));
+  EXPECT_EQ(client_params_.counter, 1);
+  ASSERT_TRUE(request.ParsePartialFromString(client_params_.last_request));
+  EXPECT_FALSE(request.has_delta());
+  EXPECT_EQ(request.output().candidate_window().candidate_size(), 1);
+  const uint64_t sequence_number = request.sequence_number();
+
+  // Only the difference is sent once acknowledged.
+  candidate_window->set_focused_index(1);
+  EXPECT_TRUE(client.ExecCommand(command));
+  EXPECT_EQ(client_params_.counter, 2);
+  ASSERT_TRUE(request.ParsePartialFromString(client_params_.last_request));
+  EXPECT_EQ(request.delta().base_sequence_number(), sequence_number);
+  EXPECT_FALSE(request.has_visible());
+  EXPECT_EQ(request.output().candidate_window().focused_index(), 1);
+  EXPECT_EQ(request.output().candidate_window().candidate_size(), 0);
+
+  // The full command is resent if the renderer rejects the delta.
+  client_params_.response = kRendererCommandDeltaRejected;
+  candidate_window->set_focused_index(2);
+  EXPECT_TRUE(client.ExecCommand(command));
+  EXPECT_EQ(client_params_.counter, 4);
+  ASSERT_TRUE(request.ParsePartialFromString(client_params_.last_request));
+  EXPECT_FALSE(request.has_delta());
+  EXPECT_EQ(request.output().candidate_window().focused_index(), 2);
+  EXPECT_EQ(request.output().candidate_window().candidate_size(), 1);
+}
+
 }  // namespace
 }  // namespace renderer
 }  // namespace mozc
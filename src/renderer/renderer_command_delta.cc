@@ -0,0 +1,276 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "renderer/renderer_command_delta.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/protobuf/descriptor.h"
+#include "base/protobuf/message.h"
+#include "base/protobuf/repeated_ptr_field.h"
+#include "protocol/renderer_command.pb.h"
+
+namespace mozc {
+namespace renderer {
+namespace {
+
+using ::mozc::commands::RendererCommand;
+
+// Fields always set in deltas. They are not the subject of the diff.
+bool IsBookkeepingField(const protobuf::FieldDescriptor *field) {
+  return field->containing_type() == RendererCommand::descriptor() &&
+         (field->number() == RendererCommand::kTypeFieldNumber ||
+          field->number() == RendererCommand::kSequenceNumberFieldNumber ||
+          field->number() == RendererCommand::kDeltaFieldNumber);
+}
+
+bool IsSingularMessage(const protobuf::FieldDescriptor *field) {
+  return !field->is_repeated() &&
+         field->cpp_type() == protobuf::FieldDescriptor::CPPTYPE_MESSAGE;
+}
+
+bool HasField(const protobuf::Message &message,
+              const protobuf::FieldDescriptor *field) {
+  const protobuf::Reflection *reflection = message.GetReflection();
+  return field->is_repeated() ? reflection->FieldSize(message, field) > 0
+                              : reflection->HasField(message, field);
+}
+
+// Compares the |index|-th values of the repeated |field|, or the values of
+// the singular |field| if |index| is negative.
+bool ValueEquals(const protobuf::Message &a, const protobuf::Message &b,
+                 const protobuf::FieldDescriptor *field, int index) {
+  const protobuf::Reflection *r = a.GetReflection();
+  const bool s = index < 0;
+  switch (field->cpp_type()) {
+    case protobuf::FieldDescriptor::CPPTYPE_INT32:
+      return s ? r->GetInt32(a, field) == r->GetInt32(b, field)
+               : r->GetRepeatedInt32(a, field, index) ==
+                     r->GetRepeatedInt32(b, field, index);
+    case protobuf::FieldDescriptor::CPPTYPE_INT64:
+      return s ? r->GetInt64(a, field) == r->GetInt64(b, field)
+               : r->GetRepeatedInt64(a, field, index) ==
+                     r->GetRepeatedInt64(b, field, index);
+    case protobuf::FieldDescriptor::CPPTYPE_UINT32:
+      return s ? r->GetUInt32(a, field) == r->GetUInt32(b, field)
+               : r->GetRepeatedUInt32(a, field, index) ==
+                     r->GetRepeatedUInt32(b, field, index);
+    case protobuf::FieldDescriptor::CPPTYPE_UINT64:
+      return s ? r->GetUInt64(a, field) == r->GetUInt64(b, field)
+               : r->GetRepeatedUInt64(a, field, index) ==
+                     r->GetRepeatedUInt64(b, field, index);
+    case protobuf::FieldDescriptor::CPPTYPE_DOUBLE:
+      return s ? r->GetDouble(a, field) == r->GetDouble(b, field)
+               : r->GetRepeatedDouble(a, field, index) ==
+                     r->GetRepeatedDouble(b, field, index);
+    case protobuf::FieldDescriptor::CPPTYPE_FLOAT:
+      return s ? r->GetFloat(a, field) == r->GetFloat(b, field)
+               : r->GetRepeatedFloat(a, field, index) ==
+                     r->GetRepeatedFloat(b, field, index);
+    case protobuf::FieldDescriptor::CPPTYPE_BOOL:
+      return s ? r->GetBool(a, field) == r->GetBool(b, field)
+               : r->GetRepeatedBool(a, field, index) ==
+                     r->GetRepeatedBool(b, field, index);
+    case protobuf::FieldDescriptor::CPPTYPE_ENUM:
+      return s ? r->GetEnumValue(a, field) == r->GetEnumValue(b, field)
+               : r->GetRepeatedEnumValue(a, field, index) ==
+                     r->GetRepeatedEnumValue(b, field, index);
+    case protobuf::FieldDescriptor::CPPTYPE_STRING: {
+      std::string scratch_a, scratch_b;
+      return s ? r->GetStringReference(a, field, &scratch_a) ==
+                     r->GetStringReference(b, field, &scratch_b)
+               : r->GetRepeatedStringReference(a, field, index, &scratch_a) ==
+                     r->GetRepeatedStringReference(b, field, index,
+                                                   &scratch_b);
+    }
+    case protobuf::FieldDescriptor::CPPTYPE_MESSAGE:
+      // Only used for the elements of repeated fields. Singular messages are
+      // compared field by field in Diff().
+      return r->GetRepeatedMessage(a, field, index).SerializeAsString() ==
+             r->GetRepeatedMessage(b, field, index).SerializeAsString();
+  }
+  return false;
+}
+
+bool FieldEquals(const protobuf::Message &a, const protobuf::Message &b,
+                 const protobuf::FieldDescriptor *field) {
+  if (!field->is_repeated()) {
+    return ValueEquals(a, b, field, -1);
+  }
+  const protobuf::Reflection *reflection = a.GetReflection();
+  const int size = reflection->FieldSize(a, field);
+  if (size != reflection->FieldSize(b, field)) {
+    return false;
+  }
+  for (int i = 0; i < size; ++i) {
+    if (!ValueEquals(a, b, field, i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// |delta| is initially a copy of the new message. Removes the fields of
+// |delta| which are the same as in |base|, and records the fields set only in
+// |base| to |cleared_fields|. |path| is the path from the root to |delta|.
+// Returns true if any difference is found.
+bool Diff(const protobuf::Message &base, protobuf::Message *delta,
+          std::vector<int> *path,
+          protobuf::RepeatedPtrField<RendererCommand::FieldPath>
+              *cleared_fields) {
+  const protobuf::Descriptor *descriptor = delta->GetDescriptor();
+  const protobuf::Reflection *reflection = delta->GetReflection();
+  bool changed = false;
+  for (int i = 0; i < descriptor->field_count(); ++i) {
+    const protobuf::FieldDescriptor *field = descriptor->field(i);
+    if (IsBookkeepingField(field)) {
+      continue;
+    }
+    const bool in_base = HasField(base, field);
+    if (!HasField(*delta, field)) {
+      if (in_base) {
+        RendererCommand::FieldPath *cleared = cleared_fields->Add();
+        cleared->mutable_field_number()->Add(path->begin(), path->end());
+        cleared->add_field_number(field->number());
+        changed = true;
+      }
+      continue;
+    }
+    if (!in_base) {
+      changed = true;
+      continue;
+    }
+    if (IsSingularMessage(field)) {
+      path->push_back(field->number());
+      const bool sub_changed =
+          Diff(reflection->GetMessage(base, field),
+               reflection->MutableMessage(delta, field), path, cleared_fields);
+      path->pop_back();
+      if (sub_changed) {
+        changed = true;
+      } else {
+        reflection->ClearField(delta, field);
+      }
+      continue;
+    }
+    if (FieldEquals(base, *delta, field)) {
+      reflection->ClearField(delta, field);
+    } else {
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+// Clears the fields of |message| which are replaced by the ones in |delta|.
+// Singular messages set in both are not replaced but updated recursively.
+void ClearReplacedFields(const protobuf::Message &delta,
+                         protobuf::Message *message) {
+  const protobuf::Reflection *reflection = delta.GetReflection();
+  std::vector<const protobuf::FieldDescriptor *> fields;
+  reflection->ListFields(delta, &fields);
+  for (const protobuf::FieldDescriptor *field : fields) {
+    if (IsBookkeepingField(field)) {
+      continue;
+    }
+    if (!IsSingularMessage(field)) {
+      reflection->ClearField(message, field);
+    } else if (reflection->HasField(*message, field)) {
+      ClearReplacedFields(reflection->GetMessage(delta, field),
+                          reflection->MutableMessage(message, field));
+    }
+  }
+}
+
+void ClearFieldPath(const RendererCommand::FieldPath &path,
+                    protobuf::Message *message) {
+  for (int i = 0; i < path.field_number_size(); ++i) {
+    const protobuf::FieldDescriptor *field =
+        message->GetDescriptor()->FindFieldByNumber(path.field_number(i));
+    if (field == nullptr) {
+      return;
+    }
+    const protobuf::Reflection *reflection = message->GetReflection();
+    if (i + 1 == path.field_number_size()) {
+      reflection->ClearField(message, field);
+      return;
+    }
+    if (!IsSingularMessage(field) || !reflection->HasField(*message, field)) {
+      return;
+    }
+    message = reflection->MutableMessage(message, field);
+  }
+}
+
+}  // namespace
+
+bool EncodeRendererCommandDelta(const RendererCommand &base,
+                                const RendererCommand &command,
+                                RendererCommand *delta) {
+  *delta = command;
+  delta->clear_delta();
+  std::vector<int> path;
+  protobuf::RepeatedPtrField<RendererCommand::FieldPath> *cleared_fields =
+      delta->mutable_delta()->mutable_cleared_fields();
+  const bool changed = Diff(base, delta, &path, cleared_fields);
+  delta->set_type(command.type());
+  delta->mutable_delta()->set_base_sequence_number(base.sequence_number());
+  return changed;
+}
+
+bool ApplyRendererCommandDelta(const RendererCommand &delta,
+                               RendererCommand *command) {
+  if (!delta.has_delta() || !command->has_sequence_number() ||
+      delta.delta().base_sequence_number() != command->sequence_number()) {
+    return false;
+  }
+  for (const RendererCommand::FieldPath &path :
+       delta.delta().cleared_fields()) {
+    ClearFieldPath(path, command);
+  }
+  ClearReplacedFields(delta, command);
+  // Replaced fields are cleared above, so merging sets them to the new values.
+  command->MergeFrom(delta);
+  command->clear_delta();
+  return true;
+}
+
+bool IsEmptyRendererCommandDelta(const RendererCommand &delta) {
+  if (!delta.has_delta() || !delta.delta().cleared_fields().empty()) {
+    return false;
+  }
+  std::vector<const protobuf::FieldDescriptor *> fields;
+  delta.GetReflection()->ListFields(delta, &fields);
+  return std::all_of(fields.begin(), fields.end(), IsBookkeepingField);
+}
+
+}  // namespace renderer
+}  // namespace mozc
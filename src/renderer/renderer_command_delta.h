@@ -0,0 +1,77 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef MOZC_RENDERER_RENDERER_COMMAND_DELTA_H_
+#define MOZC_RENDERER_RENDERER_COMMAND_DELTA_H_
+
+#include "absl/strings/string_view.h"
+#include "protocol/renderer_command.pb.h"
+
+namespace mozc {
+namespace renderer {
+
+// Delta encoding of RendererCommand.
+//
+// Consecutive UPDATE commands usually differ only in a few fields, e.g. the
+// focused candidate, the page of candidates or the preedit. Instead of the
+// full command, the client can send a delta which only contains the fields
+// that differ from the command last acknowledged by the renderer.
+//
+// Singular message fields are compared recursively. The other fields,
+// including repeated ones, are sent as a whole when they differ. Fields which
+// are set in the base command but not in the new one are listed in
+// |RendererCommand::Delta::cleared_fields|.
+
+// The response of the renderer to a delta whose base command is not the one
+// the renderer has, e.g. when another client has updated the renderer in the
+// meantime or the renderer has been restarted. The client should resend the
+// full command.
+inline constexpr absl::string_view kRendererCommandDeltaRejected =
+    "delta_rejected";
+
+// Encodes |command| as a delta against |base| into |delta|. Returns false if
+// |command| has no difference from |base| except for |sequence_number|. Even
+// in that case, |delta| is a valid (empty) delta.
+bool EncodeRendererCommandDelta(const commands::RendererCommand &base,
+                                const commands::RendererCommand &command,
+                                commands::RendererCommand *delta);
+
+// Applies |delta| to |command|, which must be the base command of |delta|.
+// Returns false if the sequence number of |command| doesn't match the base
+// sequence number of |delta|. |command| is not modified in that case.
+bool ApplyRendererCommandDelta(const commands::RendererCommand &delta,
+                               commands::RendererCommand *command);
+
+// Returns true if |delta| carries no change.
+bool IsEmptyRendererCommandDelta(const commands::RendererCommand &delta);
+
+}  // namespace renderer
+}  // namespace mozc
+
+#endif  // MOZC_RENDERER_RENDERER_COMMAND_DELTA_H_
@@ -0,0 +1,231 @@
+// Copyright 2010-2021, Google Inc.
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "renderer/renderer_command_delta.h"
+
+#include <string>
+
+#include "protocol/candidate_window.pb.h"
+#include "protocol/commands.pb.h"
+#include "protocol/renderer_command.pb.h"
+#include "testing/gmock.h"
+#include "testing/gunit.h"
+
+namespace mozc {
+namespace renderer {
+namespace {
+
+using ::mozc::commands::CandidateWindow;
+using ::mozc::commands::Output;
+using ::mozc::commands::RendererCommand;
+using ::testing::ElementsAre;
+
+void AddCandidates(int first, int size, CandidateWindow *candidate_window) {
+  for (int i = first; i < first + size; ++i) {
+    CandidateWindow::Candidate *candidate =
+        candidate_window->add_candidate();
+    candidate->set_index(i);
+    candidate->set_value(std::string(i + 1, 'a'));
+    candidate->set_id(i);
+  }
+}
+
+RendererCommand MakeCommand() {
+  RendererCommand command;
+  command.set_type(RendererCommand::UPDATE);
+  command.set_visible(true);
+  command.set_sequence_number(10);
+  command.mutable_preedit_rectangle()->set_left(10);
+  command.mutable_preedit_rectangle()->set_bottom(20);
+  Output *output = command.mutable_output();
+  output->set_id(1);
+  commands::Preedit::Segment *segment =
+      output->mutable_preedit()->add_segment();
+  segment->set_annotation(commands::Preedit::Segment::UNDERLINE);
+  segment->set_value("test");
+  segment->set_value_length(4);
+  output->mutable_preedit()->set_cursor(4);
+  CandidateWindow *candidate_window = output->mutable_candidate_window();
+  candidate_window->set_focused_index(0);
+  candidate_window->set_size(20);
+  candidate_window->set_position(0);
+  AddCandidates(0, 9, candidate_window);
+  return command;
+}
+
+// Messages are compared in the serialized form, as EXPECT_PROTO_EQ doesn't
+// support the recursive CandidateWindow message.
+RendererCommand EncodeAndApply(const RendererCommand &base,
+                               const RendererCommand &command,
+                               RendererCommand *delta) {
+  EncodeRendererCommandDelta(base, command, delta);
+  RendererCommand applied = base;
+  EXPECT_TRUE(ApplyRendererCommandDelta(*delta, &applied));
+  return applied;
+}
+
+TEST(RendererCommandDeltaTest, FocusMove) {
+  const RendererCommand base = MakeCommand();
+  RendererCommand command = base;
+  command.set_sequence_number(11);
+  command.mutable_output()->mutable_candidate_window()->set_focused_index(1);
+
+  RendererCommand delta;
+  EXPECT_EQ(command.SerializeAsString(),
+            EncodeAndApply(base, command, &delta).SerializeAsString());
+
+  EXPECT_EQ(delta.sequence_number(), 11);
+  EXPECT_EQ(delta.delta().base_sequence_number(), 10);
+  EXPECT_TRUE(delta.delta().cleared_fields().empty());
+  EXPECT_EQ(delta.type(), RendererCommand::UPDATE);
+  EXPECT_FALSE(delta.has_visible());
+  EXPECT_FALSE(delta.has_preedit_rectangle());
+  EXPECT_FALSE(delta.output().has_id());
+  EXPECT_FALSE(delta.output().has_preedit());
+  const CandidateWindow &candidate_window = delta.output().candidate_window();
+  EXPECT_EQ(candidate_window.focused_index(), 1);
+  EXPECT_FALSE(candidate_window.has_size());
+  EXPECT_EQ(candidate_window.candidate_size(), 0);
+  EXPECT_LT(delta.ByteSizeLong(), command.ByteSizeLong() / 4);
+}
+
+TEST(RendererCommandDeltaTest, PageChange) {
+  const RendererCommand base = MakeCommand();
+  RendererCommand command = base;
+  command.set_sequence_number(11);
+  CandidateWindow *candidate_window =
+      command.mutable_output()->mutable_candidate_window();
+  candidate_window->set_focused_index(9);
+  candidate_window->clear_candidate();
+  AddCandidates(9, 9, candidate_window);
+
+  RendererCommand delta;
+  EXPECT_EQ(command.SerializeAsString(),
+            EncodeAndApply(base, command, &delta).SerializeAsString());
+
+  // Repeated fields are replaced as a whole.
+  EXPECT_EQ(delta.output().candidate_window().candidate_size(), 9);
+  EXPECT_EQ(delta.output().candidate_window().candidate(0).index(), 9);
+  EXPECT_FALSE(delta.output().has_preedit());
+}
+
+TEST(RendererCommandDeltaTest, PreeditAppend) {
+  const RendererCommand base = MakeCommand();
+  RendererCommand command = base;
+  command.set_sequence_number(11);
+  commands::Preedit *preedit = command.mutable_output()->mutable_preedit();
+  preedit->mutable_segment(0)->set_value("tests");
+  preedit->mutable_segment(0)->set_value_length(5);
+  preedit->set_cursor(5);
+
+  RendererCommand delta;
+  EXPECT_EQ(command.SerializeAsString(),
+            EncodeAndApply(base, command, &delta).SerializeAsString());
+  EXPECT_EQ(delta.output().preedit().cursor(), 5);
+  EXPECT_FALSE(delta.output().has_candidate_window());
+}
+
+TEST(RendererCommandDeltaTest, ClearedFields) {
+  const RendererCommand base = MakeCommand();
+  RendererCommand command = base;
+  command.set_sequence_number(11);
+  command.clear_preedit_rectangle();
+  command.mutable_output()->clear_preedit();
+  command.mutable_output()->mutable_candidate_window()->clear_focused_index();
+
+  RendererCommand delta;
+  EXPECT_EQ(command.SerializeAsString(),
+            EncodeAndApply(base, command, &delta).SerializeAsString());
+
+  // Paths from RendererCommand in the declaration order.
+  ASSERT_EQ(delta.delta().cleared_fields_size(), 3);
+  EXPECT_THAT(delta.delta().cleared_fields(0).field_number(),
+              ElementsAre(RendererCommand::kOutputFieldNumber,
+                          Output::kPreeditFieldNumber));
+  EXPECT_THAT(delta.delta().cleared_fields(1).field_number(),
+              ElementsAre(RendererCommand::kOutputFieldNumber,
+                          Output::kCandidateWindowFieldNumber,
+                          CandidateWindow::kFocusedIndexFieldNumber));
+  EXPECT_THAT(delta.delta().cleared_fields(2).field_number(),
+              ElementsAre(RendererCommand::kPreeditRectangleFieldNumber));
+}
+
+TEST(RendererCommandDeltaTest, NewFields) {
+  RendererCommand base;
+  base.set_type(RendererCommand::UPDATE);
+  base.set_sequence_number(10);
+  RendererCommand command = MakeCommand();
+  command.set_sequence_number(11);
+
+  RendererCommand delta;
+  EXPECT_EQ(command.SerializeAsString(),
+            EncodeAndApply(base, command, &delta).SerializeAsString());
+  EXPECT_EQ(command.output().SerializeAsString(),
+            delta.output().SerializeAsString());
+}
+
+TEST(RendererCommandDeltaTest, NoChange) {
+  const RendererCommand base = MakeCommand();
+  RendererCommand command = base;
+  command.set_sequence_number(11);
+
+  RendererCommand delta;
+  EXPECT_FALSE(EncodeRendererCommandDelta(base, command, &delta));
+  EXPECT_TRUE(IsEmptyRendererCommandDelta(delta));
+  EXPECT_FALSE(IsEmptyRendererCommandDelta(command));
+
+  RendererCommand applied = base;
+  EXPECT_TRUE(ApplyRendererCommandDelta(delta, &applied));
+  EXPECT_EQ(command.SerializeAsString(), applied.SerializeAsString());
+}
+
+TEST(RendererCommandDeltaTest, BaseMismatch) {
+  const RendererCommand base = MakeCommand();
+  RendererCommand command = base;
+  command.set_sequence_number(11);
+  command.set_visible(false);
+
+  RendererCommand delta;
+  EXPECT_TRUE(EncodeRendererCommandDelta(base, command, &delta));
+  EXPECT_FALSE(IsEmptyRendererCommandDelta(delta));
+
+  RendererCommand other = base;
+  other.set_sequence_number(12);
+  EXPECT_FALSE(ApplyRendererCommandDelta(delta, &other));
+  other.set_sequence_number(10);
+  EXPECT_EQ(base.SerializeAsString(), other.SerializeAsString());
+
+  // Full commands are not deltas.
+  RendererCommand applied = base;
+  EXPECT_FALSE(ApplyRendererCommandDelta(command, &applied));
+}
+
+}  // namespace
+}  // namespace renderer
+}  // namespace mozc
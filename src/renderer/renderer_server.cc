@@ -33,6 +33,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
 
 #include "absl/flags/flag.h"
 #include "absl/log/log.h"
@@ -49,6 +50,7 @@
 #include "protocol/commands.pb.h"
 #include "protocol/config.pb.h"
 #include "protocol/renderer_command.pb.h"
+#include "renderer/renderer_command_delta.h"
 #include "renderer/renderer_interface.h"
 
 #ifdef _WIN32
@@ -205,6 +207,28 @@ bool RendererServer::Process(absl::string_view request, std::string *response) {
   // No need to set the result code.
   response->clear();
 
+  // Delta-encoded commands lack required fields.
+  commands::RendererCommand command;
+  if (command.ParsePartialFromArray(request.data(), request.size()) &&
+      command.type() == commands::RendererCommand::UPDATE) {
+    if (command.has_delta()) {
+      if (!ApplyRendererCommandDelta(command, &last_command_)) {
+        MOZC_VLOG(1) << "Unknown base command: "
+                     << command.delta().base_sequence_number();
+        *response = kRendererCommandDeltaRejected;
+        return true;
+      }
+      if (IsEmptyRendererCommandDelta(command)) {
+        // Nothing to redraw.
+        return true;
+      }
+      latest_sequence_number_ = last_command_.sequence_number();
+      return AsyncExecCommand(last_command_.SerializeAsString());
+    }
+    latest_sequence_number_ = command.sequence_number();
+    last_command_ = std::move(command);
+  }
+
   // Cannot call the method directly like renderer_interface_->ExecCommand()
   // as it's not thread-safe.
   return AsyncExecCommand(request);
@@ -219,6 +243,13 @@ bool RendererServer::ExecCommandInternal(
 
   MOZC_VLOG(2) << command;
 
+  if (command.type() == commands::RendererCommand::UPDATE &&
+      command.has_sequence_number() &&
+      command.sequence_number() != latest_sequence_number_) {
+    MOZC_VLOG(2) << "Skipping a superseded command";
+    return true;
+  }
+
   // Check process info if update mode
   if (command.type() == commands::RendererCommand::UPDATE) {
     // set HWND of message-only window
@@ -30,6 +30,7 @@
 #ifndef MOZC_RENDERER_RENDERER_SERVER_H_
 #define MOZC_RENDERER_RENDERER_SERVER_H_
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -37,6 +38,7 @@
 #include "absl/strings/string_view.h"
 #include "ipc/ipc.h"
 #include "ipc/process_watch_dog.h"
+#include "protocol/renderer_command.pb.h"
 #include "renderer/renderer_interface.h"
 
 namespace mozc {
@@ -83,6 +85,8 @@ class RendererServer : public IPCServer {
 
   // Call ExecCommandInternal() from the implementation
   // of AsyncExecCommand()
+  // UPDATE commands superseded by a newer one already received in Process()
+  // are skipped, so that a slow renderer draws only the latest state.
   bool ExecCommandInternal(const commands::RendererCommand &command);
 
   // return timeout (msec) passed by FLAGS_timeout
@@ -92,6 +96,12 @@ class RendererServer : public IPCServer {
 
  private:
   uint32_t timeout_;
+  // The last UPDATE command received, used as the base of delta-encoded
+  // commands. Only accessed from the IPC listener thread.
+  commands::RendererCommand last_command_;
+  // The sequence number of the last UPDATE command passed to
+  // AsyncExecCommand().
+  std::atomic<uint64_t> latest_sequence_number_ = 0;
   std::unique_ptr<ProcessWatchDog> watch_dog_;
   std::unique_ptr<RendererServerSendCommand> send_command_;
 };
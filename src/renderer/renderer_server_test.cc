@@ -33,11 +33,13 @@
 #include <string>
 
 #include "absl/log/log.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "ipc/ipc.h"
 #include "ipc/ipc_test_util.h"
+#include "protocol/candidate_window.pb.h"
 #include "protocol/renderer_command.pb.h"
 #include "renderer/renderer_client.h"
 #include "renderer/renderer_interface.h"
@@ -61,6 +63,7 @@ class TestRenderer : public RendererInterface {
       return false;
     }
     counter_++;
+    last_command_ = command;
     return true;
   }
 
@@ -68,11 +71,16 @@ class TestRenderer : public RendererInterface {
 
   int counter() const { return counter_; }
 
+  const commands::RendererCommand &last_command() const {
+    return last_command_;
+  }
+
   void Shutdown() { finished_ = true; }
 
  private:
   int counter_;
   bool finished_;
+  commands::RendererCommand last_command_;
 };
 
 class TestRendererServer : public RendererServer {
@@ -146,6 +154,60 @@ TEST_F(RendererServerTest, IPCTest) {
   client.ExecCommand(command);
   EXPECT_EQ(renderer.counter(), 4);
 
+  // UPDATE commands are sent as deltas.
+  {
+    renderer.Reset();
+    commands::RendererCommand update;
+    update.set_type(commands::RendererCommand::UPDATE);
+    update.set_visible(true);
+    commands::CandidateWindow *candidate_window =
+        update.mutable_output()->mutable_candidate_window();
+    candidate_window->set_focused_index(0);
+    candidate_window->set_size(2);
+    candidate_window->set_position(0);
+    for (int i = 0; i < 2; ++i) {
+      commands::CandidateWindow::Candidate *candidate =
+          candidate_window->add_candidate();
+      candidate->set_index(i);
+      candidate->set_value(absl::StrCat("candidate", i));
+    }
+
+    client.ExecCommand(update);
+    EXPECT_EQ(renderer.counter(), 1);
+
+    // The renderer receives the full command reconstructed from the delta.
+    candidate_window->set_focused_index(1);
+    client.ExecCommand(update);
+    EXPECT_EQ(renderer.counter(), 2);
+    const commands::RendererCommand &last_command = renderer.last_command();
+    EXPECT_FALSE(last_command.has_delta());
+    EXPECT_EQ(last_command.output().candidate_window().focused_index(), 1);
+    EXPECT_EQ(last_command.output().candidate_window().candidate_size(), 2);
+
+    // A command without changes doesn't reach the renderer.
+    client.ExecCommand(update);
+    EXPECT_EQ(renderer.counter(), 2);
+
+    // Another client updates the renderer. The next delta from |client| is
+    // rejected, and the full command is sent instead.
+    RendererClient another_client;
+    another_client.SetIPCClientFactory(&on_memory_client_factory);
+    another_client.DisableRendererServerCheck();
+    another_client.SetRendererLauncherInterface(&launcher);
+    commands::RendererCommand hide;
+    hide.set_type(commands::RendererCommand::UPDATE);
+    another_client.ExecCommand(hide);
+    EXPECT_EQ(renderer.counter(), 3);
+    EXPECT_FALSE(last_command.visible());
+
+    candidate_window->set_focused_index(0);
+    client.ExecCommand(update);
+    EXPECT_EQ(renderer.counter(), 4);
+    EXPECT_TRUE(last_command.visible());
+    EXPECT_EQ(last_command.output().candidate_window().focused_index(), 0);
+    EXPECT_EQ(last_command.output().candidate_window().candidate_size(), 2);
+  }
+
   // Gracefully shutdown the server.
   renderer.Shutdown();
   client.ExecCommand(command);
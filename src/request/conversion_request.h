@@ -31,11 +31,13 @@
 #define MOZC_REQUEST_CONVERSION_REQUEST_H_
 
 #include <cstddef>
+#include <cstdint>
 #include <string>
 #include <utility>
 
 #include "absl/log/check.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "base/strings/assign.h"
 #include "base/util.h"
 #include "composer/composer.h"
@@ -120,6 +122,18 @@ class ConversionRequest {
     // If true, use conversion_segment(0).key() instead of ComposerData.
     // TODO(b/365909808): Create a new string field to store the key.
     bool use_already_typing_corrected_key = false;
+
+    // If true, the system dictionary collects predictive lookup results in the
+    // order of their token costs instead of breadth-first order, so that the
+    // lookup limit keeps the cheapest keys rather than the shortest ones.
+    bool predictive_lookup_in_cost_order = false;
+
+    // Time budget for each call to the supplemental model. The result of a
+    // call which doesn't finish in time is discarded. This is effective only
+    // when the model is wrapped with engine::AsyncSupplementalModel. If not
+    // set, DecoderExperimentParams::supplemental_model_timeout_msec of the
+    // request is used.
+    absl::Duration supplemental_model_timeout = absl::InfiniteDuration();
   };
 
   ConversionRequest()
@@ -181,6 +195,12 @@ class ConversionRequest {
       options_.key = GetKey(composer_, options_.request_type,
                             options_.composer_key_selection);
     }
+    const int32_t timeout_msec =
+        request_.decoder_experiment_params().supplemental_model_timeout_msec();
+    if (options_.supplemental_model_timeout == absl::InfiniteDuration() &&
+        timeout_msec > 0) {
+      options_.supplemental_model_timeout = absl::Milliseconds(timeout_msec);
+    }
   }
 
   ConversionRequest(const ConversionRequest &) = default;
@@ -34,6 +34,7 @@
 #include <cstdint>
 #include <iterator>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -74,11 +75,20 @@ absl::StatusOr<CollocationFilter> CollocationFilter::Create(
 
 bool CollocationFilter::Exists(const absl::string_view left,
                                const absl::string_view right) const {
-  if (left.empty() || right.empty()) {
+  FingerprintBuilder builder;
+  builder.Append(left);
+  return Exists(builder, right);
+}
+
+bool CollocationFilter::Exists(const FingerprintBuilder &left,
+                               const absl::string_view right) const {
+  if (left.size() == 0 || right.empty()) {
     return false;
   }
-  const uint64_t id = Fingerprint(absl::StrCat(left, right));
-  return filter_.Exists(id);
+  // Same as Fingerprint(absl::StrCat(left, right)).
+  FingerprintBuilder builder = left;
+  builder.Append(right);
+  return filter_.Exists(builder.Build());
 }
 
 absl::StatusOr<SuppressionFilter> SuppressionFilter::Create(
@@ -93,9 +103,11 @@ absl::StatusOr<SuppressionFilter> SuppressionFilter::Create(
 bool SuppressionFilter::Exists(const Segment::Candidate &cand) const {
   // TODO(noriyukit): We should share key generation rule with
   // gen_collocation_suppression_data_main.cc.
-  const uint64_t id =
-      Fingerprint(absl::StrCat(cand.content_value, "\t", cand.content_key));
-  return filter_.Exists(id);
+  FingerprintBuilder builder;
+  builder.Append(cand.content_value);
+  builder.Append("\t");
+  builder.Append(cand.content_key);
+  return filter_.Exists(builder.Build());
 }
 
 }  // namespace collocation_rewriter_internal
@@ -500,6 +512,22 @@ bool CollocationRewriter::RewriteCollocation(Segments *segments) const {
   std::vector<bool> segs_changed(segments->segments_size(), false);
   bool changed = false;
 
+  // Right tokens are used for both the previous and the next segments, so
+  // they are generated once per segment. The cache is cleared when the
+  // candidates of the segment are reordered.
+  std::vector<std::optional<RightTokens>> right_tokens(
+      segments->segments_size());
+  auto get_right_tokens = [&](size_t i) -> const RightTokens & {
+    if (!right_tokens[i].has_value()) {
+      right_tokens[i] = GenerateRightTokens(segments->segment(i));
+    }
+    return *right_tokens[i];
+  };
+  auto mark_changed = [&](size_t i) {
+    segs_changed[i] = true;
+    right_tokens[i].reset();
+  };
+
   for (size_t i = segments->history_segments_size();
        i < segments->segments_size(); ++i) {
     bool rewrote_next = false;
@@ -510,19 +538,21 @@ bool CollocationRewriter::RewriteCollocation(Segments *segments) const {
 
     if (i + 1 < segments->segments_size() &&
         RewriteUsingNextSegment(segments->mutable_segment(i + 1),
+                                get_right_tokens(i + 1),
                                 segments->mutable_segment(i))) {
       changed = true;
       rewrote_next = true;
-      segs_changed[i] = true;
-      segs_changed[i + 1] = true;
+      mark_changed(i);
+      mark_changed(i + 1);
     }
 
     if (!segs_changed[i] && !rewrote_next && i > 0 &&
         RewriteFromPrevSegment(segments->segment(i - 1).candidate(0),
+                               get_right_tokens(i),
                                segments->mutable_segment(i))) {
       changed = true;
-      segs_changed[i - 1] = true;
-      segs_changed[i] = true;
+      mark_changed(i - 1);
+      mark_changed(i);
     }
 
     const Segment::Candidate &cand = segments->segment(i).candidate(0);
@@ -539,16 +569,18 @@ bool CollocationRewriter::RewriteCollocation(Segments *segments) const {
          cand.value != "・")) {  // "・" workaround
       if (!segs_changed[i - 2] && !segs_changed[i] &&
           RewriteUsingNextSegment(segments->mutable_segment(i),
+                                  get_right_tokens(i),
                                   segments->mutable_segment(i - 2))) {
         changed = true;
-        segs_changed[i] = true;
-        segs_changed[i - 2] = true;
+        mark_changed(i);
+        mark_changed(i - 2);
       } else if (!segs_changed[i] &&
                  RewriteFromPrevSegment(segments->segment(i - 2).candidate(0),
+                                        get_right_tokens(i),
                                         segments->mutable_segment(i))) {
         changed = true;
-        segs_changed[i] = true;
-        segs_changed[i - 2] = true;
+        mark_changed(i);
+        mark_changed(i - 2);
       }
     }
   }
@@ -593,36 +625,38 @@ bool CollocationRewriter::IsName(const Segment::Candidate &cand) const {
   return ret;
 }
 
-bool CollocationRewriter::RewriteFromPrevSegment(
-    const Segment::Candidate &prev_cand, Segment *seg) const {
-  std::string prev;
-  CollocationUtil::GetNormalizedScript(prev_cand.value, true, &prev);
-
-  const size_t i_max = std::min(seg->candidates_size(), kCandidateSize);
+CollocationRewriter::RightTokens CollocationRewriter::GenerateRightTokens(
+    const Segment &seg) const {
+  const size_t size = std::min(seg.candidates_size(), kCandidateSize);
+  RightTokens tokens(size);
+  for (size_t i = 0; i < size; ++i) {
+    const Segment::Candidate &cand = seg.candidate(i);
+    if (IsName(cand) || suppression_filter_.Exists(cand) ||
+        !GenerateLookupTokens(cand, seg.candidate(0), RIGHT, &tokens[i])) {
+      tokens[i].clear();
+    }
+  }
+  return tokens;
+}
 
-  // Reuse |curs| in the loop as this method is performance critical.
-  std::vector<std::string> curs;
-  for (size_t i = 0; i < i_max; ++i) {
+bool CollocationRewriter::RewriteFromPrevSegment(
+    const Segment::Candidate &prev_cand, const RightTokens &curs,
+    Segment *seg) const {
+  std::string prev_str;
+  CollocationUtil::GetNormalizedScript(prev_cand.value, true, &prev_str);
+  FingerprintBuilder prev;
+  prev.Append(prev_str);
+
+  DCHECK_EQ(curs.size(), std::min(seg->candidates_size(), kCandidateSize));
+  for (size_t i = 0; i < curs.size(); ++i) {
     if (seg->candidate(i).cost > seg->candidate(0).cost + kMaxCostDiff) {
       continue;
     }
-    if (IsName(seg->candidate(i))) {
-      continue;
-    }
-    if (suppression_filter_.Exists(seg->candidate(i))) {
-      continue;
-    }
-    curs.clear();
-    if (!GenerateLookupTokens(seg->candidate(i), seg->candidate(0), RIGHT,
-                              &curs)) {
-      continue;
-    }
-
-    for (const std::string &cur : curs) {
+    for (const std::string &cur : curs[i]) {
       if (collocation_filter_.Exists(prev, cur)) {
         if (i != 0) {
-          MOZC_VLOG(3) << prev << cur << " " << seg->candidate(0).value << "->"
-                       << seg->candidate(i).value;
+          MOZC_VLOG(3) << prev_str << cur << " " << seg->candidate(0).value
+                       << "->" << seg->candidate(i).value;
         }
         seg->move_candidate(i, 0);
         seg->mutable_candidate(0)->attributes |=
@@ -635,29 +669,11 @@ bool CollocationRewriter::RewriteFromPrevSegment(
 }
 
 bool CollocationRewriter::RewriteUsingNextSegment(Segment *next_seg,
+                                                  const RightTokens &nexts,
                                                   Segment *seg) const {
   const size_t i_max = std::min(seg->candidates_size(), kCandidateSize);
-  const size_t j_max = std::min(next_seg->candidates_size(), kCandidateSize);
-
-  // Cache the results for the next segment
-  std::vector<int> next_seg_ok(j_max);  // Avoiding std::vector<bool>
-  std::vector<std::vector<std::string>> nexts(j_max);
-  for (size_t j = 0; j < j_max; ++j) {
-    next_seg_ok[j] = 0;
-
-    if (IsName(next_seg->candidate(j))) {
-      continue;
-    }
-    if (suppression_filter_.Exists(next_seg->candidate(j))) {
-      continue;
-    }
-    if (!GenerateLookupTokens(next_seg->candidate(j), next_seg->candidate(0),
-                              RIGHT, &nexts[j])) {
-      continue;
-    }
-
-    next_seg_ok[j] = 1;
-  }
+  DCHECK_EQ(nexts.size(),
+            std::min(next_seg->candidates_size(), kCandidateSize));
 
   // Reuse |curs| in the loop as this method is performance critical.
   std::vector<std::string> curs;
@@ -677,15 +693,15 @@ bool CollocationRewriter::RewriteUsingNextSegment(Segment *next_seg,
       continue;
     }
 
-    for (const std::string &cur : curs) {
-      for (size_t j = 0; j < j_max; ++j) {
+    for (const std::string &cur_str : curs) {
+      // The fingerprint of |cur| is computed once for all the pairs.
+      FingerprintBuilder cur;
+      cur.Append(cur_str);
+      for (size_t j = 0; j < nexts.size(); ++j) {
         if (next_seg->candidate(j).cost >
             next_seg->candidate(0).cost + kMaxCostDiff) {
           continue;
         }
-        if (!next_seg_ok[j]) {
-          continue;
-        }
 
         for (const std::string &next : nexts[j]) {
           if (collocation_filter_.Exists(cur, next)) {
@@ -32,11 +32,14 @@
 
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
+#include "base/hash.h"
 #include "converter/segments.h"
 #include "data_manager/data_manager.h"
 #include "dictionary/pos_matcher.h"
@@ -57,6 +60,10 @@ class CollocationFilter {
 
   bool Exists(absl::string_view left, absl::string_view right) const;
 
+  // Same as above, but |left| is given as the fingerprint of the left string.
+  // It is computed once and reused for many right strings.
+  bool Exists(const FingerprintBuilder &left, absl::string_view right) const;
+
  private:
   storage::ExistenceFilter filter_;
 };
@@ -96,10 +103,17 @@ class CollocationRewriter : public RewriterInterface {
                Segments *segments) const override;
 
  private:
+  // Lookup tokens of the top candidates of a segment used as the right side
+  // of collocations. Tokens are empty for the candidates which cannot be
+  // rewritten.
+  using RightTokens = std::vector<std::vector<std::string>>;
+
   bool IsName(const Segment::Candidate &cand) const;
+  RightTokens GenerateRightTokens(const Segment &seg) const;
   bool RewriteFromPrevSegment(const Segment::Candidate &prev_cand,
-                              Segment *seg) const;
-  bool RewriteUsingNextSegment(Segment *next_seg, Segment *seg) const;
+                              const RightTokens &curs, Segment *seg) const;
+  bool RewriteUsingNextSegment(Segment *next_seg, const RightTokens &nexts,
+                               Segment *seg) const;
   bool RewriteCollocation(Segments *segments) const;
 
   const dictionary::PosMatcher pos_matcher_;
@@ -30,7 +30,6 @@
 #ifndef MOZC_REWRITER_DICE_REWRITER_H_
 #define MOZC_REWRITER_DICE_REWRITER_H_
 
-#include "absl/random/random.h"
 #include "rewriter/rewriter_interface.h"
 
 namespace mozc {
@@ -45,9 +44,6 @@ class DiceRewriter : public RewriterInterface {
 
   bool Rewrite(const ConversionRequest &request,
                Segments *segments) const override;
-
- private:
-  mutable absl::BitGen bitgen_;
 };
 
 }  // namespace mozc
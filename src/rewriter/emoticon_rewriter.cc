@@ -189,7 +189,9 @@ bool EmoticonRewriter::RewriteCandidate(Segments *segments) const {
       begin = dic_.begin();
       CHECK(begin != dic_.end());
       // use secure random not to predict the next emoticon.
-      begin += absl::Uniform(bitgen_, 0u, dic_.size());
+      // The generator is local so that Rewrite() can run concurrently.
+      absl::BitGen bitgen;
+      begin += absl::Uniform(bitgen, 0u, dic_.size());
       end = begin + 1;
       initial_insert_pos = RewriterUtil::CalculateInsertPosition(segment, 4);
       initial_insert_size = 1;
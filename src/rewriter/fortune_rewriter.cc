@@ -34,9 +34,11 @@
 #include <iterator>
 #include <string>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/random/random.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/civil_time.h"
 #include "absl/time/time.h"
 #include "base/clock.h"
@@ -67,13 +69,16 @@ bool IsValidFortuneType(FortuneType fortune_type) {
   return (fortune_type < NUM_FORTUNE_TYPES);
 }
 
+// Shared by all the rewriter instances through Singleton, so the state is
+// guarded by a mutex for concurrent conversions.
 class FortuneData {
  public:
   FortuneData() : fortune_type_(FORTUNE_TYPE_EXCELLENT_LUCK) {
     ChangeFortune();
   }
 
-  void ChangeFortune() {
+  void ChangeFortune() ABSL_LOCKS_EXCLUDED(mutex_) {
+    absl::MutexLock lock(&mutex_);
     const int *levels = kNormalLevels;
 
     const absl::Time at = Clock::GetAbslTime();
@@ -107,12 +112,16 @@ class FortuneData {
     DCHECK(IsValidFortuneType(fortune_type_));
   }
 
-  FortuneType fortune_type() const { return fortune_type_; }
+  FortuneType fortune_type() const ABSL_LOCKS_EXCLUDED(mutex_) {
+    absl::MutexLock lock(&mutex_);
+    return fortune_type_;
+  }
 
  private:
-  FortuneType fortune_type_;
-  absl::CivilDay last_updated_day_;
-  absl::BitGen gen_;
+  mutable absl::Mutex mutex_;
+  FortuneType fortune_type_ ABSL_GUARDED_BY(mutex_);
+  absl::CivilDay last_updated_day_ ABSL_GUARDED_BY(mutex_);
+  absl::BitGen gen_ ABSL_GUARDED_BY(mutex_);
 };
 
 // Insert Fortune message into the |segment|
@@ -47,15 +47,17 @@ namespace mozc {
 namespace {
 
 using ::mozc::storage::ExistenceFilterBuilder;
+using ::mozc::storage::ExistenceFilterLayout;
 
 std::string GenExistenceData(const absl::Span<const std::string> entries,
                              double error_rate) {
   const int n = entries.size();
-  const int m =
-      ExistenceFilterBuilder::MinFilterSizeInBytesForErrorRate(error_rate, n);
+  const int m = ExistenceFilterBuilder::MinFilterSizeInBytesForErrorRate(
+      error_rate, n, ExistenceFilterLayout::kBlocked);
   LOG(INFO) << "entry: " << n << " err: " << error_rate << " bytes: " << m;
 
-  ExistenceFilterBuilder builder(ExistenceFilterBuilder::CreateOptimal(m, n));
+  ExistenceFilterBuilder builder(ExistenceFilterBuilder::CreateOptimal(
+      m, n, ExistenceFilterLayout::kBlocked));
 
   for (const std::string &entry : entries) {
     const uint64_t id = Fingerprint(entry);
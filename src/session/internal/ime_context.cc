@@ -97,12 +97,25 @@ const keymap::KeyMapManager &ImeContext::GetKeyMapManager() const {
 // static
 void ImeContext::CopyContext(const ImeContext &src, ImeContext *dest) {
   DCHECK(dest);
+  dest->converter_.reset(src.converter().Clone());
+  CopyContextExceptConverter(src, dest);
+}
+
+// static
+void ImeContext::SnapshotContext(ImeContext *src, ImeContext *dest) {
+  DCHECK(src);
+  DCHECK(dest);
+  dest->converter_.reset(src->mutable_converter()->Snapshot());
+  CopyContextExceptConverter(*src, dest);
+}
 
+// static
+void ImeContext::CopyContextExceptConverter(const ImeContext &src,
+                                            ImeContext *dest) {
   dest->set_create_time(src.create_time());
   dest->set_last_command_time(src.last_command_time());
 
   *dest->mutable_composer() = src.composer();
-  dest->converter_.reset(src.converter().Clone());
   dest->key_event_transformer_ = src.key_event_transformer_;
 
   dest->set_state(src.state());
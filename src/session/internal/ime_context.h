@@ -131,7 +131,16 @@ class ImeContext final {
   // consistency with other classes.
   static void CopyContext(const ImeContext &src, ImeContext *dest);
 
+  // Same as CopyContext, but the converter of |dest| shares the segments with
+  // the converter of |src| until either of them modifies them. Used for the
+  // undo stack, so that taking a snapshot doesn't copy every candidate.
+  static void SnapshotContext(ImeContext *src, ImeContext *dest);
+
  private:
+  // Copies the members other than the converter.
+  static void CopyContextExceptConverter(const ImeContext &src,
+                                         ImeContext *dest);
+
   // TODO(team): Actual use of |create_time_| is to keep the time when the
   // session holding this instance is created and not the time when this
   // instance is created. We may want to move out |create_time_| from ImeContext
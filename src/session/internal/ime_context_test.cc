@@ -192,5 +192,59 @@ TEST(ImeContextTest, CopyContext) {
   }
 }
 
+TEST(ImeContextTest, SnapshotContext) {
+  composer::Table table;
+  table.AddRule("a", "あ", "");
+  table.AddRule("n", "ん", "");
+  const commands::Request request;
+  config::Config config;
+
+  MockConverter converter;
+
+  Segments segments;
+  Segment *segment = segments.add_segment();
+  segment->set_key("あん");
+  Segment::Candidate *candidate = segment->add_candidate();
+  candidate->value = "庵";
+  EXPECT_CALL(converter, StartConversion(_, _))
+      .WillOnce(DoAll(SetArgPointee<1>(segments), Return(true)));
+
+  ImeContext source;
+  source.set_composer(std::make_unique<Composer>(&table, &request, &config));
+  source.set_converter(
+      std::make_unique<SessionConverter>(&converter, &request, &config));
+
+  ImeContext destination;
+  destination.set_composer(
+      std::make_unique<Composer>(&table, &request, &config));
+  destination.set_converter(
+      std::make_unique<SessionConverter>(&converter, &request, &config));
+
+  source.set_state(ImeContext::CONVERSION);
+  source.mutable_composer()->InsertCharacter("a");
+  source.mutable_composer()->InsertCharacter("n");
+  source.mutable_converter()->Convert(source.composer());
+
+  ImeContext::SnapshotContext(&source, &destination);
+  EXPECT_EQ(destination.state(), ImeContext::CONVERSION);
+  EXPECT_EQ(destination.composer().GetQueryForConversion(), "あん");
+
+  // The segments are shared between the contexts.
+  Segments::MemoryUsage source_usage;
+  source.converter().AddSegmentsMemoryUsage(&source_usage);
+  Segments::MemoryUsage total_usage;
+  source.converter().AddSegmentsMemoryUsage(&total_usage);
+  destination.converter().AddSegmentsMemoryUsage(&total_usage);
+  EXPECT_GT(source_usage.bytes(), 0);
+  EXPECT_EQ(total_usage.bytes(), source_usage.bytes());
+
+  // Resetting the source doesn't affect the destination.
+  source.mutable_converter()->Reset();
+  commands::Output output;
+  destination.converter().FillOutput(destination.composer(), &output);
+  EXPECT_EQ(output.preedit().segment_size(), 1);
+  EXPECT_EQ(output.preedit().segment(0).value(), "庵");
+}
+
 }  // namespace session
 }  // namespace mozc
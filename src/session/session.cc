@@ -49,6 +49,7 @@
 #include "composer/composer.h"
 #include "composer/key_event_util.h"
 #include "composer/table.h"
+#include "converter/segments.h"
 #include "engine/engine_interface.h"
 #include "protocol/commands.pb.h"
 #include "protocol/config.pb.h"
@@ -246,10 +247,11 @@ void Session::InitContext(ImeContext *context) const {
 }
 
 void Session::PushUndoContext() {
-  // Copy the current context and push it to the undo stack.
+  // Copy the current context and push it to the undo stack. The copy shares
+  // the segments with the current context.
   auto prev_context = std::make_unique<ImeContext>();
   InitContext(prev_context.get());
-  ImeContext::CopyContext(*context_, prev_context.get());
+  ImeContext::SnapshotContext(context_.get(), prev_context.get());
   undo_contexts_.push_back(std::move(prev_context));
   // If the stack size exceeds the limitation, purge the oldest entries.
   while (undo_contexts_.size() > kMultipleUndoMaxSize) {
@@ -268,6 +270,15 @@ void Session::PopUndoContext() {
 
 void Session::ClearUndoContext() { undo_contexts_.clear(); }
 
+size_t Session::GetSegmentsMemoryUsage() const {
+  Segments::MemoryUsage usage;
+  context_->converter().AddSegmentsMemoryUsage(&usage);
+  for (const std::unique_ptr<ImeContext> &context : undo_contexts_) {
+    context->converter().AddSegmentsMemoryUsage(&usage);
+  }
+  return usage.bytes();
+}
+
 bool Session::HasUndoContext() const { return !undo_contexts_.empty(); }
 
 void Session::MaybeSetUndoStatus(commands::Command *command) const {
@@ -263,10 +263,16 @@ class Session : public SessionInterface {
 
   const ImeContext &context() const;
 
+  // Returns the approximate memory of the segments held by this session,
+  // including the undo stack. The segments shared between the contexts are
+  // counted once.
+  size_t GetSegmentsMemoryUsage() const;
+
  private:
   FRIEND_TEST(SessionTest, OutputInitialComposition);
   FRIEND_TEST(SessionTest, IsFullWidthInsertSpace);
   FRIEND_TEST(SessionTest, RequestUndo);
+  FRIEND_TEST(SessionTest, UndoContextSharesSegments);
   FRIEND_TEST(SessionTest, SetConfig);
 
   // Underlying conversion engine for this session. Please note that:
@@ -1193,7 +1193,28 @@ void SessionConverter::FillOutput(const composer::Composer &composer,
 SessionConverter *SessionConverter::Clone() const {
   SessionConverter *session_converter =
       new SessionConverter(converter_, request_, config_);
+  session_converter->segments_ = segments_;
+  session_converter->incognito_segments_ = incognito_segments_;
+  CopyStateTo(session_converter);
+  return session_converter;
+}
 
+SessionConverter *SessionConverter::Snapshot() {
+  SessionConverter *session_converter =
+      new SessionConverter(converter_, request_, config_);
+  segments_.Snapshot(&session_converter->segments_);
+  incognito_segments_.Snapshot(&session_converter->incognito_segments_);
+  CopyStateTo(session_converter);
+  return session_converter;
+}
+
+void SessionConverter::AddSegmentsMemoryUsage(
+    Segments::MemoryUsage *usage) const {
+  usage->Add(segments_);
+  usage->Add(incognito_segments_);
+}
+
+void SessionConverter::CopyStateTo(SessionConverter *session_converter) const {
   // Copy the members in order of their declarations.
   session_converter->state_ = state_;
   // TODO(team): copy of |converter_| member.
@@ -1202,8 +1223,7 @@ SessionConverter *SessionConverter::Clone() const {
   // moment it's ok because the current design guarantees that the converter is
   // singleton. However, we should refactor such bad design; see also the
   // comment right above.
-  session_converter->segments_ = segments_;
-  session_converter->incognito_segments_ = incognito_segments_;
+  // |segments_| and |incognito_segments_| are set by the caller.
   session_converter->segment_index_ = segment_index_;
   session_converter->previous_suggestions_ = previous_suggestions_;
   session_converter->conversion_preferences_ = conversion_preferences();
@@ -1220,8 +1240,6 @@ SessionConverter *SessionConverter::Clone() const {
     session_converter->candidate_list_.MoveToId(candidate_list_.focused_id());
     session_converter->SetCandidateListVisible(candidate_list_visible_);
   }
-
-  return session_converter;
 }
 
 void SessionConverter::ResetResult() { result_.Clear(); }
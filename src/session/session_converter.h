@@ -242,6 +242,8 @@ class SessionConverter : public SessionConverterInterface {
   // TODO(hsumita): Copy all member variables.
   // Currently, converter_ is not copied.
   SessionConverter *Clone() const override;
+  SessionConverter *Snapshot() override;
+  void AddSegmentsMemoryUsage(Segments::MemoryUsage *usage) const override;
 
   void set_selection_shortcut(
       config::Config::SelectionShortcut selection_shortcut) override {
@@ -266,6 +268,10 @@ class SessionConverter : public SessionConverterInterface {
   // Resets the session state variables.
   void ResetState();
 
+  // Copies the members other than the segments to |session_converter|, for
+  // Clone() and Snapshot().
+  void CopyStateTo(SessionConverter *session_converter) const;
+
   // Notifies the converter that the current segment is focused.
   void SegmentFocus();
 
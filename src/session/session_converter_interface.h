@@ -38,6 +38,7 @@
 
 #include "absl/strings/string_view.h"
 #include "composer/composer.h"
+#include "converter/segments.h"
 #include "protocol/commands.pb.h"
 #include "protocol/config.pb.h"
 #include "transliteration/transliteration.h"
@@ -232,6 +233,13 @@ class SessionConverterInterface {
   // Callee object doesn't have the ownership of the cloned instance.
   virtual SessionConverterInterface *Clone() const = 0;
 
+  // Same as Clone(), but the returned instance shares the segments with this
+  // instance until either of them modifies them. See Segments::Snapshot().
+  virtual SessionConverterInterface *Snapshot() = 0;
+
+  // Adds the memory of the segments to `usage`.
+  virtual void AddSegmentsMemoryUsage(Segments::MemoryUsage *usage) const = 0;
+
   virtual void set_selection_shortcut(
       config::Config::SelectionShortcut selection_shortcut) = 0;
 
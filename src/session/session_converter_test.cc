@@ -139,6 +139,10 @@ class SessionConverterTest : public testing::TestWithTempUserProfile {
     converter->segments_ = src;
   }
 
+  static Segments *MutableSegments(SessionConverter *converter) {
+    return &converter->segments_;
+  }
+
   static const commands::Result &GetResult(const SessionConverter &converter) {
     return converter.result_;
   }
@@ -2757,6 +2761,38 @@ TEST_F(SessionConverterTest, Clone) {
   }
 }
 
+TEST_F(SessionConverterTest, Snapshot) {
+  MockConverter mock_converter;
+  SessionConverter src(&mock_converter, request_.get(), config_.get());
+  Segments segments;
+  SetKamaboko(&segments);
+  EXPECT_CALL(mock_converter, StartConversion(_, _))
+      .WillOnce(DoAll(SetArgPointee<1>(segments), Return(true)));
+  EXPECT_TRUE(src.Convert(*composer_));
+
+  std::unique_ptr<SessionConverter> dest(src.Snapshot());
+  ASSERT_NE(dest, nullptr);
+  ExpectSameSessionConverter(src, *dest);
+
+  // The snapshot shares the segments with the source.
+  Segments::MemoryUsage src_usage;
+  src.AddSegmentsMemoryUsage(&src_usage);
+  Segments::MemoryUsage total_usage;
+  src.AddSegmentsMemoryUsage(&total_usage);
+  dest->AddSegmentsMemoryUsage(&total_usage);
+  EXPECT_GT(src_usage.bytes(), 0);
+  EXPECT_EQ(total_usage.bytes(), src_usage.bytes());
+
+  // Modifying the source doesn't change the snapshot.
+  MutableSegments(&src)
+      ->mutable_conversion_segment(1)
+      ->mutable_candidate(0)
+      ->value = "modified";
+  EXPECT_EQ(GetSegments(src).conversion_segment(1).candidate(0).value,
+            "modified");
+  EXPECT_THAT(GetSegments(*dest), EqualsSegments(segments));
+}
+
 // Suggest() in the suggestion state was not accepted.  (http://b/1948334)
 TEST_F(SessionConverterTest, Issue1948334) {
   MockConverter mock_converter;
@@ -44,6 +44,7 @@
 #include "absl/log/log.h"
 #include "absl/random/random.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "base/clock.h"
 #include "base/stopwatch.h"
 #include "base/version.h"
@@ -375,12 +376,21 @@ bool SessionHandler::EvalCommand(commands::Command *command) {
     case commands::Input::GET_SERVER_VERSION:
       eval_succeeded = GetServerVersion(command);
       break;
+    case commands::Input::EVAL_BATCH:
+      eval_succeeded = EvalBatch(command);
+      break;
     default:
       eval_succeeded = false;
   }
 
+  // The inputs in a batch are counted one by one when they are evaluated, so
+  // the batch itself is not counted in the usage stats.
+  const bool is_batch = command->input().type() == commands::Input::EVAL_BATCH;
+
   if (eval_succeeded) {
-    UsageStats::IncrementCount("SessionAllEvent");
+    if (!is_batch) {
+      UsageStats::IncrementCount("SessionAllEvent");
+    }
     if (command->input().type() != commands::Input::CREATE_SESSION) {
       // Fill a session ID even if command->input() doesn't have a id to ensure
       // that response size should not be 0, which causes disconnection of IPC.
@@ -398,13 +408,81 @@ bool SessionHandler::EvalCommand(commands::Command *command) {
   }
 
   stopwatch.Stop();
-  UsageStats::UpdateTiming(
-      "ElapsedTimeUSec",
-      static_cast<uint32_t>(absl::ToInt64Microseconds(stopwatch.GetElapsed())));
+  if (!is_batch) {
+    UsageStats::UpdateTiming("ElapsedTimeUSec",
+                             static_cast<uint32_t>(absl::ToInt64Microseconds(
+                                 stopwatch.GetElapsed())));
+  }
+
+  // The first key event is likely to pay for the page faults of the data set,
+  // so its latency is recorded separately to compare the warm-up policies.
+  if (!first_key_event_recorded_ &&
+      command->input().type() == commands::Input::SEND_KEY) {
+    first_key_event_recorded_ = true;
+    LOG(INFO) << "First key event took " << stopwatch.GetElapsed();
+    UsageStats::UpdateTiming("FirstKeyEventElapsedTimeUSec",
+                             static_cast<uint32_t>(absl::ToInt64Microseconds(
+                                 stopwatch.GetElapsed())));
+  }
 
   return is_available_;
 }
 
+bool SessionHandler::EvalCommands(absl::Span<commands::Command> commands) {
+  for (commands::Command &command : commands) {
+    if (!EvalCommand(&command)) {
+      LOG(WARNING) << "EvalCommand() returned false. Skipping the rest.";
+      return false;
+    }
+    if (command.output().error_code() == commands::Output::SESSION_FAILURE) {
+      LOG(WARNING) << "Command failed at id: " << command.input().id()
+                   << ". Skipping the rest.";
+      return false;
+    }
+  }
+  return true;
+}
+
+bool SessionHandler::EvalBatch(commands::Command *command) {
+  const commands::Input &input = command->input();
+  std::vector<commands::Command> commands(input.batch_inputs_size());
+  for (int i = 0; i < input.batch_inputs_size(); ++i) {
+    const commands::Input &batch_input = input.batch_inputs(i);
+    if (batch_input.type() == commands::Input::EVAL_BATCH) {
+      LOG(WARNING) << "EVAL_BATCH cannot be nested";
+      return false;
+    }
+    *commands[i].mutable_input() = batch_input;
+    if (!batch_input.has_id()) {
+      commands[i].mutable_input()->set_id(input.id());
+    }
+    if (input.has_config() && !batch_input.has_config()) {
+      *commands[i].mutable_input()->mutable_config() = input.config();
+    }
+  }
+
+  // Fails the whole batch if a command fails, so that the client can recover
+  // the session, e.g. when the session has been deleted by Cleanup(). The
+  // commands after SHUTDOWN are not evaluated, and their outputs are empty.
+  if (!EvalCommands(absl::MakeSpan(commands)) && is_available_) {
+    return false;
+  }
+
+  commands::Output *output = command->mutable_output();
+  if (input.batch_final_output_only()) {
+    if (!commands.empty()) {
+      *output->add_batch_outputs() =
+          std::move(*commands.back().mutable_output());
+    }
+    return true;
+  }
+  output->mutable_batch_outputs()->Reserve(commands.size());
+  for (commands::Command &batch_command : commands) {
+    *output->add_batch_outputs() = std::move(*batch_command.mutable_output());
+  }
+  return true;
+}
+
 std::unique_ptr<session::Session> SessionHandler::NewSession() {
   // Session doesn't take the ownership of engine.
   return std::make_unique<session::Session>(engine_.get());
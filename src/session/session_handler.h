@@ -39,6 +39,7 @@
 #include "absl/random/random.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "composer/table.h"
 #include "dictionary/user_dictionary_session_handler.h"
 #include "engine/engine_interface.h"
@@ -71,6 +72,11 @@ class SessionHandler : public SessionHandlerInterface {
 
   bool EvalCommand(commands::Command *command) override;
 
+  // Evaluates |commands| in order, as EvalCommand() does for each of them.
+  // Returns false and skips the remaining commands once a command fails or
+  // the handler becomes unavailable, e.g. after SHUTDOWN.
+  bool EvalCommands(absl::Span<commands::Command> commands);
+
   // Starts watch dog timer to cleanup sessions.
   void StartWatchDog() override;
 
@@ -129,6 +135,9 @@ class SessionHandler : public SessionHandlerInterface {
   bool NoOperation(commands::Command *command);
   bool ReloadSupplementalModel(commands::Command *command);
   bool GetServerVersion(commands::Command *command) const;
+  // Evaluates command->input().batch_inputs() and sets their outputs to
+  // command->output().batch_outputs().
+  bool EvalBatch(commands::Command *command);
 
   // Replaces engine_ with a new instance if it is ready.
   void MaybeReloadEngine(commands::Command *command);
@@ -141,6 +150,8 @@ class SessionHandler : public SessionHandlerInterface {
   std::optional<SessionWatchDog> session_watch_dog_;
 #endif  // MOZC_DISABLE_SESSION_WATCHDOG
   bool is_available_ = false;
+  // True once the latency of the first key event is recorded.
+  bool first_key_event_recorded_ = false;
   uint32_t max_session_size_ = 0;
   absl::Time last_session_empty_time_ = absl::InfinitePast();
   absl::Time last_cleanup_time_ = absl::InfinitePast();
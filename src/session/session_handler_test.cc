@@ -46,6 +46,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "base/clock.h"
 #include "base/clock_mock.h"
 #include "composer/query.h"
@@ -463,6 +464,23 @@ TEST_F(SessionHandlerTest, ElapsedTimeTest) {
   Clock::SetClockForUnitTest(nullptr);
 }
 
+TEST_F(SessionHandlerTest, FirstKeyEventElapsedTimeTest) {
+  SessionHandler handler(CreateMockDataEngine());
+
+  uint64_t id = 0;
+
+  ClockMock clock(absl::FromUnixSeconds(1000));
+  Clock::SetClockForUnitTest(&clock);
+  EXPECT_TRUE(CreateSession(handler, &id));
+  EXPECT_STATS_NOT_EXIST("FirstKeyEventElapsedTimeUSec");
+
+  // Only the first key event is recorded.
+  EXPECT_TRUE(IsGoodSession(handler, id));
+  EXPECT_TRUE(IsGoodSession(handler, id));
+  EXPECT_TIMING_STATS("FirstKeyEventElapsedTimeUSec", 0, 1, 0, 0);
+  Clock::SetClockForUnitTest(nullptr);
+}
+
 TEST_F(SessionHandlerTest, ConfigTest) {
   config::Config config;
   config::ConfigHandler::GetConfig(&config);
@@ -792,6 +810,189 @@ TEST_F(SessionHandlerTest, GetServerVersionTest) {
   EXPECT_EQ(command.output().server_version().data_version(), "24.20240101.01");
 }
 
+TEST_F(SessionHandlerTest, EvalCommands) {
+  SessionHandler handler(CreateMockDataEngine());
+  uint64_t id1 = 0, id2 = 0;
+  ASSERT_TRUE(CreateSession(handler, &id1));
+  ASSERT_TRUE(CreateSession(handler, &id2));
+
+  // Evaluating the commands at once gives the same outputs as evaluating them
+  // one by one.
+  std::vector<commands::Command> commands(4);
+  commands[0].mutable_input()->mutable_key()->set_special_key(
+      commands::KeyEvent::ON);
+  commands[1].mutable_input()->mutable_key()->set_key_code('a');
+  commands[2].mutable_input()->mutable_key()->set_key_code('i');
+  commands[3].mutable_input()->mutable_key()->set_special_key(
+      commands::KeyEvent::SPACE);
+  for (commands::Command &command : commands) {
+    command.mutable_input()->set_id(id1);
+    command.mutable_input()->set_type(commands::Input::SEND_KEY);
+  }
+  EXPECT_TRUE(handler.EvalCommands(absl::MakeSpan(commands)));
+
+  for (const commands::Command &batched : commands) {
+    commands::Command command;
+    *command.mutable_input() = batched.input();
+    command.mutable_input()->set_id(id2);
+    EXPECT_TRUE(handler.EvalCommand(&command));
+    EXPECT_EQ(batched.output().id(), id1);
+    EXPECT_EQ(batched.output().consumed(), command.output().consumed());
+    EXPECT_EQ(batched.output().preedit().DebugString(),
+              command.output().preedit().DebugString());
+  }
+}
+
+TEST_F(SessionHandlerTest, EvalCommandsStopsAtShutdown) {
+  SessionHandler handler(CreateMockDataEngine());
+  uint64_t id = 0;
+  ASSERT_TRUE(CreateSession(handler, &id));
+
+  std::vector<commands::Command> commands(2);
+  commands[0].mutable_input()->set_type(commands::Input::SHUTDOWN);
+  commands[1].mutable_input()->set_type(commands::Input::SEND_KEY);
+  commands[1].mutable_input()->set_id(id);
+  commands[1].mutable_input()->mutable_key()->set_key_code('a');
+  EXPECT_FALSE(handler.EvalCommands(absl::MakeSpan(commands)));
+  EXPECT_FALSE(commands[1].has_output());
+}
+
+TEST_F(SessionHandlerTest, EvalCommandsStopsAtSessionFailure) {
+  SessionHandler handler(CreateMockDataEngine());
+  uint64_t id = 0;
+  ASSERT_TRUE(CreateSession(handler, &id));
+  ASSERT_TRUE(DeleteSession(handler, id));
+
+  std::vector<commands::Command> commands(2);
+  for (commands::Command &command : commands) {
+    command.mutable_input()->set_type(commands::Input::SEND_KEY);
+    command.mutable_input()->set_id(id);
+    command.mutable_input()->mutable_key()->set_key_code('a');
+  }
+  EXPECT_FALSE(handler.EvalCommands(absl::MakeSpan(commands)));
+  EXPECT_EQ(commands[0].output().error_code(),
+            commands::Output::SESSION_FAILURE);
+  EXPECT_FALSE(commands[1].has_output());
+  EXPECT_TRUE(handler.IsAvailable());
+}
+
+TEST_F(SessionHandlerTest, EvalBatch) {
+  SessionHandler handler(CreateMockDataEngine());
+  uint64_t id1 = 0, id2 = 0;
+  ASSERT_TRUE(CreateSession(handler, &id1));
+  ASSERT_TRUE(CreateSession(handler, &id2));
+
+  commands::Command command;
+  commands::Input *input = command.mutable_input();
+  input->set_type(commands::Input::EVAL_BATCH);
+  input->set_id(id1);
+  for (const char key_code : {'a', 'i'}) {
+    commands::Input *batch_input = input->add_batch_inputs();
+    batch_input->set_type(commands::Input::SEND_KEY);
+    batch_input->mutable_key()->set_key_code(key_code);
+  }
+  // An input with an ID is sent to the session of the ID.
+  commands::Input *batch_input = input->add_batch_inputs();
+  batch_input->set_type(commands::Input::SEND_KEY);
+  batch_input->set_id(id2);
+  batch_input->mutable_key()->set_key_code('u');
+
+  EXPECT_TRUE(handler.EvalCommand(&command));
+  EXPECT_EQ(command.output().id(), id1);
+  ASSERT_EQ(command.output().batch_outputs_size(), 3);
+  EXPECT_EQ(command.output().batch_outputs(0).id(), id1);
+  EXPECT_EQ(command.output().batch_outputs(1).id(), id1);
+  EXPECT_EQ(command.output().batch_outputs(2).id(), id2);
+  EXPECT_TRUE(command.output().batch_outputs(1).consumed());
+  EXPECT_EQ(command.output().batch_outputs(1).preedit().segment(0).value(),
+            "あい");
+  EXPECT_EQ(command.output().batch_outputs(2).preedit().segment(0).value(),
+            "う");
+
+  // Only the output for the last input is returned.
+  command.clear_output();
+  input->set_batch_final_output_only(true);
+  input->mutable_batch_inputs()->RemoveLast();
+  EXPECT_TRUE(handler.EvalCommand(&command));
+  ASSERT_EQ(command.output().batch_outputs_size(), 1);
+  EXPECT_EQ(command.output().batch_outputs(0).preedit().segment(0).value(),
+            "あいあい");
+
+  // EVAL_BATCH cannot be nested.
+  commands::Command nested;
+  nested.mutable_input()->set_type(commands::Input::EVAL_BATCH);
+  *nested.mutable_input()->add_batch_inputs() = command.input();
+  EXPECT_TRUE(handler.EvalCommand(&nested));
+  EXPECT_EQ(nested.output().error_code(), commands::Output::SESSION_FAILURE);
+}
+
+TEST_F(SessionHandlerTest, EvalBatchUsageStats) {
+  SessionHandler handler(CreateMockDataEngine());
+
+  ClockMock clock(absl::FromUnixSeconds(1000));
+  Clock::SetClockForUnitTest(&clock);
+  uint64_t id = 0;
+  ASSERT_TRUE(CreateSession(handler, &id));
+
+  commands::Command command;
+  commands::Input *input = command.mutable_input();
+  input->set_type(commands::Input::EVAL_BATCH);
+  input->set_id(id);
+  for (const char key_code : {'a', 'i'}) {
+    commands::Input *batch_input = input->add_batch_inputs();
+    batch_input->set_type(commands::Input::SEND_KEY);
+    batch_input->mutable_key()->set_key_code(key_code);
+  }
+  EXPECT_TRUE(handler.EvalCommand(&command));
+
+  // CreateSession and the two keys. The batch itself is not counted.
+  EXPECT_COUNT_STATS("SessionAllEvent", 3);
+  EXPECT_TIMING_STATS("ElapsedTimeUSec", 0, 3, 0, 0);
+  Clock::SetClockForUnitTest(nullptr);
+}
+
+TEST_F(SessionHandlerTest, EvalBatchFailsForDeletedSession) {
+  SessionHandler handler(CreateMockDataEngine());
+  uint64_t id = 0;
+  ASSERT_TRUE(CreateSession(handler, &id));
+  ASSERT_TRUE(DeleteSession(handler, id));
+
+  commands::Command command;
+  commands::Input *input = command.mutable_input();
+  input->set_type(commands::Input::EVAL_BATCH);
+  input->set_id(id);
+  commands::Input *batch_input = input->add_batch_inputs();
+  batch_input->set_type(commands::Input::SEND_KEY);
+  batch_input->mutable_key()->set_key_code('a');
+
+  // The whole batch fails so that the client recreates the session.
+  EXPECT_TRUE(handler.EvalCommand(&command));
+  EXPECT_EQ(command.output().id(), 0);
+  EXPECT_EQ(command.output().error_code(), commands::Output::SESSION_FAILURE);
+  EXPECT_EQ(command.output().batch_outputs_size(), 0);
+}
+
+TEST_F(SessionHandlerTest, EvalBatchStopsAtShutdown) {
+  SessionHandler handler(CreateMockDataEngine());
+  uint64_t id = 0;
+  ASSERT_TRUE(CreateSession(handler, &id));
+
+  commands::Command command;
+  commands::Input *input = command.mutable_input();
+  input->set_type(commands::Input::EVAL_BATCH);
+  input->set_id(id);
+  input->add_batch_inputs()->set_type(commands::Input::SHUTDOWN);
+  commands::Input *batch_input = input->add_batch_inputs();
+  batch_input->set_type(commands::Input::SEND_KEY);
+  batch_input->mutable_key()->set_key_code('a');
+
+  // The outputs are returned for the commands up to SHUTDOWN.
+  EXPECT_FALSE(handler.EvalCommand(&command));
+  EXPECT_NE(command.output().error_code(), commands::Output::SESSION_FAILURE);
+  ASSERT_EQ(command.output().batch_outputs_size(), 2);
+  EXPECT_FALSE(command.output().batch_outputs(1).has_consumed());
+}
+
 TEST_F(SessionHandlerTest, ReloadFromMinimalEngine) {
   std::unique_ptr<Engine> engine = Engine::CreateEngine();
 
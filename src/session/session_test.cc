@@ -2580,6 +2580,40 @@ TEST_F(SessionTest, UndoForSingleSegment) {
   }
 }
 
+TEST_F(SessionTest, UndoContextSharesSegments) {
+  MockConverter converter;
+  MockEngine engine;
+  EXPECT_CALL(engine, GetConverter()).WillRepeatedly(Return(&converter));
+
+  Session session(&engine);
+  InitSessionToPrecomposition(&session);
+
+  commands::Command command;
+  Segments segments;
+  InsertCharacterChars("aiueo", &session, &command);
+  SetAiueo(&segments);
+  EXPECT_CALL(converter, StartConversion(_, _))
+      .WillOnce(DoAll(SetArgPointee<1>(segments), Return(true)));
+  command.Clear();
+  session.Convert(&command);
+  EXPECT_PREEDIT("あいうえお", command);
+
+  // Pushing the undo context doesn't copy the segments.
+  const size_t usage = session.GetSegmentsMemoryUsage();
+  EXPECT_GT(usage, 0);
+  session.PushUndoContext();
+  EXPECT_EQ(session.GetSegmentsMemoryUsage(), usage);
+
+  command.Clear();
+  session.ConvertNext(&command);
+  EXPECT_PREEDIT("アイウエオ", command);
+
+  // The undo context keeps the state before ConvertNext.
+  command.Clear();
+  session.Undo(&command);
+  EXPECT_PREEDIT("あいうえお", command);
+}
+
 TEST_F(SessionTest, ClearUndoContextByKeyEventIssue5529702) {
   MockConverter converter;
   MockEngine engine;
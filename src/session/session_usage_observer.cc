@@ -103,6 +103,8 @@ bool IsSessionIndependentCommand(commands::Input::CommandType type) {
     case commands::Input::SET_REQUEST:
     case commands::Input::SEND_ENGINE_RELOAD_REQUEST:
     case commands::Input::RELOAD_SPELL_CHECKER:
+    // The inputs in a batch are observed one by one.
+    case commands::Input::EVAL_BATCH:
       // LINT.ThenChange()
       return true;
     default:
@@ -49,6 +49,11 @@
 #include "base/bits.h"
 #include "base/vlog.h"
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MOZC_EXISTENCE_FILTER_USE_SSE2
+#endif  // __SSE2__ || _M_X64
+
 namespace mozc {
 namespace storage {
 namespace existence_filter_internal {
@@ -118,8 +123,61 @@ BlockBitmap BlockBitmapBuilder::Build() const {
 
 namespace {
 
+using ::mozc::storage::existence_filter_internal::kLineBits;
+using ::mozc::storage::existence_filter_internal::kLineShift;
+using ::mozc::storage::existence_filter_internal::kLineWords;
+
 constexpr uint32_t kHeaderSize = 3;
 
+// The third header word holds num_hashes in the lower 16 bits and the layout
+// in the upper 16 bits. Data generated before the layout was introduced has
+// zero (kBitmap) there.
+constexpr int kLayoutShift = 16;
+constexpr uint32_t kNumHashesMask = (1 << kLayoutShift) - 1;
+
+// Probe positions of a hash value in the kBlocked layout.
+struct LineProbe {
+  uint32_t line;
+  uint32_t mask[kLineWords];
+};
+
+// The line is taken from the upper 32 bits of the hash by a multiply-shift
+// range reduction. The positions in the line are taken 9 bits at a time from
+// the remixed hash, so up to 7 positions fit in 64 bits.
+LineProbe GetLineProbe(uint64_t hash, int num_hashes, uint32_t num_lines) {
+  LineProbe probe = {};
+  probe.line = static_cast<uint32_t>(((hash >> 32) * num_lines) >> 32);
+  uint64_t bits = hash * 0x9e3779b97f4a7c15ULL;
+  for (int i = 0; i < num_hashes; ++i) {
+    const uint32_t pos = bits & (kLineBits - 1);
+    probe.mask[pos >> 5] |= static_cast<uint32_t>(1) << (pos & 31);
+    bits >>= kLineShift;
+  }
+  return probe;
+}
+
+// Returns true if all the bits in `mask` are set in `line`.
+bool ContainsAllBits(const uint32_t *line, const uint32_t *mask) {
+#ifdef MOZC_EXISTENCE_FILTER_USE_SSE2
+  __m128i missing = _mm_setzero_si128();
+  for (int i = 0; i < kLineWords; i += 4) {
+    const __m128i l =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(line + i));
+    const __m128i m =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(mask + i));
+    missing = _mm_or_si128(missing, _mm_andnot_si128(l, m));
+  }
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(missing, _mm_setzero_si128())) ==
+         0xFFFF;
+#else   // MOZC_EXISTENCE_FILTER_USE_SSE2
+  uint32_t missing = 0;
+  for (int i = 0; i < kLineWords; ++i) {
+    missing |= mask[i] & ~line[i];
+  }
+  return missing == 0;
+#endif  // MOZC_EXISTENCE_FILTER_USE_SSE2
+}
+
 absl::StatusOr<ExistenceFilterParams> ReadHeader(
     absl::Span<const uint32_t> buf) {
   if (buf.size() < kHeaderSize) {
@@ -131,10 +189,24 @@ absl::StatusOr<ExistenceFilterParams> ReadHeader(
   ExistenceFilterParams params;
   params.size = *it++;
   params.expected_nelts = *it++;
-  params.num_hashes = *it++;
+  const uint32_t hashes_and_layout = *it++;
+  params.num_hashes = hashes_and_layout & kNumHashesMask;
   if (params.num_hashes >= 8 || params.num_hashes <= 0) {
     return absl::InvalidArgumentError("Bad number of hashes (header.k)");
   }
+  switch (hashes_and_layout >> kLayoutShift) {
+    case static_cast<uint32_t>(ExistenceFilterLayout::kBitmap):
+      params.layout = ExistenceFilterLayout::kBitmap;
+      break;
+    case static_cast<uint32_t>(ExistenceFilterLayout::kBlocked):
+      params.layout = ExistenceFilterLayout::kBlocked;
+      if (params.size == 0 || params.size % kLineBits != 0) {
+        return absl::InvalidArgumentError("Bad size for the blocked layout");
+      }
+      break;
+    default:
+      return absl::InvalidArgumentError("Unknown layout");
+  }
   return params;
 }
 
@@ -155,6 +227,11 @@ std::ostream& operator<<(std::ostream& os,
 }
 
 bool ExistenceFilter::Exists(uint64_t hash) const {
+  if (params_.layout == ExistenceFilterLayout::kBlocked) {
+    const LineProbe probe =
+        GetLineProbe(hash, params_.num_hashes, params_.size >> kLineShift);
+    return ContainsAllBits(rep_.GetLine(probe.line), probe.mask);
+  }
   for (int i = 0; i < params_.num_hashes; ++i) {
     hash = absl::rotl(hash, 8);
     const uint32_t index = hash % params_.size;
@@ -186,10 +263,14 @@ absl::StatusOr<ExistenceFilter> ExistenceFilter::Read(
 }
 
 ExistenceFilterBuilder ExistenceFilterBuilder::CreateOptimal(
-    size_t size_in_bytes, uint32_t estimated_insertions) {
+    size_t size_in_bytes, uint32_t estimated_insertions,
+    ExistenceFilterLayout layout) {
   CHECK_LT(size_in_bytes, (1 << 29)) << "Requested size is too big";
   CHECK_GT(estimated_insertions, 0);
-  const uint32_t m = std::max<size_t>(1, size_in_bytes * 8);
+  uint32_t m = std::max<size_t>(1, size_in_bytes * 8);
+  if (layout == ExistenceFilterLayout::kBlocked) {
+    m = (m + kLineBits - 1) & ~(kLineBits - 1);
+  }
   const uint32_t n = estimated_insertions;
 
   int optimal_k =
@@ -203,10 +284,20 @@ ExistenceFilterBuilder ExistenceFilterBuilder::CreateOptimal(
 
   MOZC_VLOG(1) << "optimal_k: " << optimal_k;
 
-  return ExistenceFilterBuilder({m, n, optimal_k});
+  return ExistenceFilterBuilder({m, n, optimal_k, layout});
 }
 
 void ExistenceFilterBuilder::Insert(uint64_t hash) {
+  if (params_.layout == ExistenceFilterLayout::kBlocked) {
+    const LineProbe probe =
+        GetLineProbe(hash, params_.num_hashes, params_.size >> kLineShift);
+    for (uint32_t i = 0; i < kLineBits; ++i) {
+      if ((probe.mask[i >> 5] >> (i & 31)) & 1) {
+        rep_.Set((probe.line << kLineShift) + i);
+      }
+    }
+    return;
+  }
   for (int i = 0; i < params_.num_hashes; ++i) {
     hash = absl::rotl(hash, 8);
     const uint32_t index = hash % params_.size;
@@ -228,6 +319,19 @@ size_t ExistenceFilterBuilder::MinFilterSizeInBytesForErrorRate(
   return static_cast<size_t>(ceil(min_bits / 8));
 }
 
+size_t ExistenceFilterBuilder::MinFilterSizeInBytesForErrorRate(
+    float error_rate, size_t num_elements, ExistenceFilterLayout layout) {
+  const size_t bytes =
+      MinFilterSizeInBytesForErrorRate(error_rate, num_elements);
+  if (layout == ExistenceFilterLayout::kBitmap) {
+    return bytes;
+  }
+  // The uneven load of the lines raises the false positive rate of blocked
+  // filters. Empirically, 1/8 more bits keeps the error rate at or below the
+  // one of kBitmap for error rates from 1e-2 to 1e-5.
+  return bytes + bytes / 8;
+}
+
 std::string ExistenceFilterBuilder::SerializeAsString() {
   const size_t required_bytes =
       (kHeaderSize + BitsToWords(params_.size)) * sizeof(uint32_t);
@@ -238,7 +342,10 @@ std::string ExistenceFilterBuilder::SerializeAsString() {
   // write header
   it = StoreUnaligned<uint32_t>(params_.size, it);
   it = StoreUnaligned<uint32_t>(params_.expected_nelts, it);
-  it = StoreUnaligned<uint32_t>(params_.num_hashes, it);
+  it = StoreUnaligned<uint32_t>(
+      params_.num_hashes |
+          (static_cast<uint32_t>(params_.layout) << kLayoutShift),
+      it);
   // This method is called on data generation and we can call LOG(INFO) here.
   LOG(INFO) << "Header written: " << params_;
 
@@ -52,6 +52,14 @@ inline constexpr int kBlockMask = kBlockBits - 1;
 inline constexpr int kBlockBytes = kBlockBits >> 3;
 inline constexpr int kBlockWords = kBlockBits >> 5;
 
+// A line is a 512-bit (64-byte) region of the bitmap, i.e., a cache line on
+// most platforms. Blocks always consist of whole lines.
+inline constexpr int kLineShift = 9;
+inline constexpr int kLineBits = 1 << kLineShift;
+inline constexpr int kLineWords = kLineBits >> 5;
+inline constexpr int kLinesPerBlockShift = kBlockShift - kLineShift;
+inline constexpr int kLinesPerBlockMask = (1 << kLinesPerBlockShift) - 1;
+
 // BlockBitmap is an immutable view, directly referencing data given to the
 // constructors.
 class BlockBitmap {
@@ -70,6 +78,12 @@ class BlockBitmap {
     return (blocks_[bindex][windex] >> bitpos) & 1;
   }
 
+  // Returns the kLineWords words of the `line`-th line.
+  inline const uint32_t *GetLine(uint32_t line) const {
+    return blocks_[line >> kLinesPerBlockShift].data() +
+           ((line & kLinesPerBlockMask) << (kLineShift - 5));
+  }
+
  protected:
   // Array of blocks. Each block has kBlockBits region except for last block.
   std::vector<absl::Span<const uint32_t>> blocks_;
@@ -101,19 +115,34 @@ class BlockBitmapBuilder {
 
 }  // namespace existence_filter_internal
 
+// Layout of the bits in ExistenceFilter.
+enum class ExistenceFilterLayout : uint32_t {
+  // Each hash value is mapped to num_hashes independent positions in the
+  // whole bitmap.
+  kBitmap = 0,
+  // Each hash value is mapped to one 512-bit line, and all the num_hashes
+  // positions are taken in the line (blocked bloom filter). A lookup touches
+  // only one cache line at the cost of a slightly higher false positive rate.
+  kBlocked = 1,
+};
+
 // ExistenceFilter parameters.
 struct ExistenceFilterParams {
   template <typename Sink>
   friend void AbslStringify(Sink& sink, const ExistenceFilterParams& params) {
-    absl::Format(&sink,
-                 "size: %d bits, estimated insertions: %d, num_hashes: %d",
-                 params.size, params.expected_nelts, params.num_hashes);
+    absl::Format(
+        &sink,
+        "size: %d bits, estimated insertions: %d, num_hashes: %d, layout: %d",
+        params.size, params.expected_nelts, params.num_hashes,
+        static_cast<uint32_t>(params.layout));
   }
 
   uint32_t size;            // the number of bits in the bit vector
   uint32_t expected_nelts;  // the number of values that will be stored
   int num_hashes;  // the number of hash values to use per insert/lookup.
                    // num_hashes must be less than 8.
+  // For kBlocked, size must be a multiple of 512.
+  ExistenceFilterLayout layout = ExistenceFilterLayout::kBitmap;
 };
 
 // For Mozc's LOG().
@@ -155,8 +184,10 @@ class ExistenceFilterBuilder {
   explicit ExistenceFilterBuilder(ExistenceFilterParams params)
       : params_(std::move(params)), rep_(params_.size) {}
 
-  static ExistenceFilterBuilder CreateOptimal(size_t size_in_bytes,
-                                              uint32_t estimated_insertions);
+  // For kBlocked, the size is rounded up to a multiple of 64 bytes.
+  static ExistenceFilterBuilder CreateOptimal(
+      size_t size_in_bytes, uint32_t estimated_insertions,
+      ExistenceFilterLayout layout = ExistenceFilterLayout::kBitmap);
 
   // Inserts a hash value into the filter
   // We generate 'k' separate internal hash values
@@ -173,6 +204,12 @@ class ExistenceFilterBuilder {
   static size_t MinFilterSizeInBytesForErrorRate(float error_rate,
                                                  size_t num_elements);
 
+  // Same as above for the given layout. kBlocked needs a larger filter for the
+  // same error rate.
+  static size_t MinFilterSizeInBytesForErrorRate(float error_rate,
+                                                 size_t num_elements,
+                                                 ExistenceFilterLayout layout);
+
  private:
   ExistenceFilterParams params_;
   existence_filter_internal::BlockBitmapBuilder rep_;
@@ -71,9 +71,11 @@ std::vector<uint32_t> StringToAlignedBuffer(const absl::string_view str) {
   return aligned_buf;
 }
 
-void RunTest(int m, int n) {
+void RunTest(int m, int n,
+             ExistenceFilterLayout layout = ExistenceFilterLayout::kBitmap) {
   LOG(INFO) << "Test " << m << " " << n;
-  ExistenceFilterBuilder builder = ExistenceFilterBuilder::CreateOptimal(m, n);
+  ExistenceFilterBuilder builder =
+      ExistenceFilterBuilder::CreateOptimal(m, n, layout);
 
   for (int i = 0; i < n; ++i) {
     int val = i * 2;
@@ -98,6 +100,58 @@ TEST(ExistenceFilterTest, RunTest) {
   RunTest(m, n);
 }
 
+TEST(ExistenceFilterTest, RunTestWithBlockedLayout) {
+  int n = 50000;
+  int m = ExistenceFilterBuilder::MinFilterSizeInBytesForErrorRate(
+      0.01, 50000, ExistenceFilterLayout::kBlocked);
+  RunTest(m, n, ExistenceFilterLayout::kBlocked);
+}
+
+TEST(ExistenceFilterTest, BlockedLayoutErrorRate) {
+  constexpr int kNumElements = 10000;
+  constexpr float kErrorRate = 0.001;
+  const size_t num_bytes =
+      ExistenceFilterBuilder::MinFilterSizeInBytesForErrorRate(
+          kErrorRate, kNumElements, ExistenceFilterLayout::kBlocked);
+  ExistenceFilterBuilder builder = ExistenceFilterBuilder::CreateOptimal(
+      num_bytes, kNumElements, ExistenceFilterLayout::kBlocked);
+  for (int i = 0; i < kNumElements; ++i) {
+    builder.Insert(Fingerprint(i));
+  }
+  const ExistenceFilter filter = builder.Build();
+  int false_positives = 0;
+  constexpr int kNumQueries = 1000000;
+  for (int i = kNumElements; i < kNumElements + kNumQueries; ++i) {
+    if (filter.Exists(Fingerprint(i))) {
+      ++false_positives;
+    }
+  }
+  EXPECT_LT(false_positives, kNumQueries * kErrorRate * 1.5);
+}
+
+TEST(ExistenceFilterTest, ReadLayout) {
+  ExistenceFilterBuilder builder = ExistenceFilterBuilder::CreateOptimal(
+      100, 10, ExistenceFilterLayout::kBlocked);
+  builder.Insert(Fingerprint("a"));
+  std::vector<uint32_t> buf =
+      StringToAlignedBuffer(builder.SerializeAsString());
+  // The size is rounded up to 2 lines.
+  EXPECT_EQ(buf[0], 1024);
+
+  absl::StatusOr<ExistenceFilter> filter = ExistenceFilter::Read(buf);
+  ASSERT_OK(filter);
+  EXPECT_TRUE(filter->Exists(Fingerprint("a")));
+
+  // Unknown layout.
+  buf[2] |= 0x00ff0000;
+  EXPECT_FALSE(ExistenceFilter::Read(buf).ok());
+
+  // The size of the blocked layout must be a multiple of 512.
+  buf[0] = 1000;
+  buf[2] = (buf[2] & 0xffff) | (1 << 16);
+  EXPECT_FALSE(ExistenceFilter::Read(buf).ok());
+}
+
 TEST(ExistenceFilterTest, MinFilterSizeEstimateTest) {
   EXPECT_EQ(ExistenceFilterBuilder::MinFilterSizeInBytesForErrorRate(0.1, 100),
             61);
@@ -139,6 +139,22 @@ class Louds {
     ++node->node_id_;
   }
 
+  // Moves the given node to its |n|-th next sibling, which is equivalent to
+  // calling MoveToNextSibling() |n| times.
+  static void MoveToNextSibling(Node *node, int n) {
+    node->edge_index_ += n;
+    node->node_id_ += n;
+  }
+
+  // Returns the number of siblings on the right of |node|, including |node|
+  // itself.  For example, it's 2 for node 2 and 1 for node 3 in the above
+  // diagram of tree.  Returns 0 if |node| is invalid.  Since the siblings are
+  // represented by consecutive 1's, this is computed on words of the bit
+  // array instead of checking the validity of each sibling.
+  int CountSiblingsFrom(const Node &node) const {
+    return index_.CountConsecutive1Bits(node.edge_index_);
+  }
+
   // Moves the given node to its unique parent.  For example, in the above
   // diagram of tree, moves are as follows:
   //   * node 2 -> node 1
@@ -136,6 +136,35 @@ TEST_P(LoudsTest, Basic) {
     EXPECT_EQ(node.node_id(), 5);
   }
 
+  // Number of siblings.
+  {
+    Louds::Node node;
+    EXPECT_EQ(louds.CountSiblingsFrom(node), 1);
+
+    louds.MoveToFirstChild(&node);
+    EXPECT_EQ(louds.CountSiblingsFrom(node), 2);
+
+    Louds::Node sibling = node;
+    Louds::MoveToNextSibling(&sibling, 1);
+    EXPECT_EQ(sibling.node_id(), 3);
+    EXPECT_EQ(louds.CountSiblingsFrom(sibling), 1);
+
+    Louds::MoveToNextSibling(&sibling, 1);
+    EXPECT_FALSE(louds.IsValidNode(sibling));
+    EXPECT_EQ(louds.CountSiblingsFrom(sibling), 0);
+
+    louds.MoveToFirstChild(&node);  // Leaf.
+    EXPECT_EQ(louds.CountSiblingsFrom(node), 0);
+
+    louds.InitNodeFromNodeId(3, &node);
+    louds.MoveToFirstChild(&node);
+    EXPECT_EQ(node.node_id(), 4);
+    EXPECT_EQ(louds.CountSiblingsFrom(node), 2);
+    Louds::MoveToNextSibling(&node, 1);
+    EXPECT_EQ(node.node_id(), 5);
+    EXPECT_EQ(louds.CountSiblingsFrom(node), 1);
+  }
+
   // 4 -> 3 -> 1
   {
     Louds::Node node;
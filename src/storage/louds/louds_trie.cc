@@ -87,6 +87,7 @@ bool LoudsTrie::Open(const uint8_t *image, size_t louds_lb0_cache_size,
                             0,  // Select0 is not carried out.
                             termvec_lb1_cache_size);
   edge_character_ = reinterpret_cast<const char *>(edge_character);
+  num_nodes_ = edge_character_size;
 
   return true;
 }
@@ -95,17 +96,7 @@ void LoudsTrie::Close() {
   louds_.Reset();
   terminal_bit_vector_.Reset();
   edge_character_ = nullptr;
-}
-
-bool LoudsTrie::MoveToChildByLabel(char label, Node *node) const {
-  MoveToFirstChild(node);
-  while (IsValidNode(*node)) {
-    if (GetEdgeLabelToParentNode(*node) == label) {
-      return true;
-    }
-    MoveToNextSibling(node);
-  }
-  return false;
+  num_nodes_ = 0;
 }
 
 bool LoudsTrie::Traverse(absl::string_view key, Node *node) const {
@@ -81,6 +81,10 @@ class LoudsTrie {
     return terminal_bit_vector_.Get(node.node_id() - 1) != 0;
   }
 
+  // Returns the number of the nodes including the root, which is also the
+  // largest node ID.
+  size_t num_nodes() const { return num_nodes_; }
+
   // Returns the label of the edge from |node|'s parent (predecessor) to |node|.
   char GetEdgeLabelToParentNode(const Node &node) const {
     return edge_character_[node.node_id() - 1];
@@ -135,9 +139,38 @@ class LoudsTrie {
     return node;
   }
 
+  static void MoveToNextSibling(Node *node, int n) {
+    Louds::MoveToNextSibling(node, n);
+  }
+  static Node MoveToNextSibling(Node node, int n) {
+    MoveToNextSibling(&node, n);
+    return node;
+  }
+
+  // Returns the labels of the edges to |node| and its right siblings.  The
+  // i-th label is the one for MoveToNextSibling(node, i).  Since the labels of
+  // siblings are contiguous, this is useful to iterate over children, e.g.,
+  // GetSiblingLabels(MoveToFirstChild(node)), without checking the validity of
+  // each child.
+  absl::string_view GetSiblingLabels(const Node &node) const {
+    return absl::string_view(edge_character_ + node.node_id() - 1,
+                             louds_.CountSiblingsFrom(node));
+  }
+
   // Moves |node| to its child connected by the edge with |label|.  If there's
   // no edge having |label|, |node| becomes invalid and false is returned.
-  bool MoveToChildByLabel(char label, Node *node) const;
+  bool MoveToChildByLabel(char label, Node *node) const {
+    MoveToFirstChild(node);
+    // Find |label| in the contiguous labels of the children at once.
+    const absl::string_view labels = GetSiblingLabels(*node);
+    const size_t pos = labels.find(label);
+    if (pos == absl::string_view::npos) {
+      MoveToNextSibling(node, labels.size());
+      return false;
+    }
+    MoveToNextSibling(node, pos);
+    return true;
+  }
 
   // Traverses a trie for |key|, starting from |node|, and modifies |node| to
   // the destination terminal node.  Here, |node| is not necessarily the root.
@@ -200,6 +233,7 @@ class LoudsTrie {
   // This array also doesn't have an entry for super root.
   // In other words, id=2 in louds_ corresponds to edge_character_[1].
   const char *edge_character_ = nullptr;
+  size_t num_nodes_ = 0;
 };
 
 }  // namespace louds
@@ -31,8 +31,10 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <string>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "storage/louds/louds_trie_builder.h"
 #include "testing/gunit.h"
@@ -141,6 +143,7 @@ TEST_P(LoudsTrieTest, NodeBasedApis) {
             param.louds_lb0_cache_size, param.louds_lb1_cache_size,
             param.louds_select0_cache_size, param.louds_select1_cache_size,
             param.termvec_lb1_cache_size);
+  EXPECT_EQ(trie.num_nodes(), 9);
 
   char buf[LoudsTrie::kMaxDepth + 1];  // for RestoreKeyString().
 
@@ -322,6 +325,9 @@ TEST_P(LoudsTrieTest, NodeBasedApis) {
     EXPECT_EQ(node, node_abcd);
   }
 
+  // "abcd" is the last node in BFS order, so it has the largest ID.
+  EXPECT_EQ(node_abcd.node_id(), trie.num_nodes());
+
   // There is no child nor right sibling for "abcd".
   EXPECT_FALSE(trie.IsValidNode(trie.MoveToFirstChild(node_abcd)));
   EXPECT_FALSE(trie.IsValidNode(trie.MoveToNextSibling(node_abcd)));
@@ -529,6 +535,62 @@ TEST_P(LoudsTrieTest, RestoreKeyString) {
 }
 INSTANTIATE_TEST_CASE(GenRestoreKeyStringTest);
 
+TEST_P(LoudsTrieTest, MoveToChildByLabelWithWideFanOut) {
+  // Every label in [1, 255] under the root and under "x", so that the children
+  // span multiple words of the LOUDS bit vector.
+  LoudsTrieBuilder builder;
+  for (int c = 1; c < 256; ++c) {
+    const char label = static_cast<char>(c);
+    builder.Add(std::string(1, label));
+    if (c % 3 == 0) {
+      builder.Add(std::string("x") + label);
+    }
+  }
+  builder.Build();
+
+  const CacheSizeParam &param = GetParam();
+  LoudsTrie trie;
+  trie.Open(reinterpret_cast<const uint8_t *>(builder.image().data()),
+            param.louds_lb0_cache_size, param.louds_lb1_cache_size,
+            param.louds_select0_cache_size, param.louds_select1_cache_size,
+            param.termvec_lb1_cache_size);
+
+  for (const absl::string_view prefix : {"", "x", "xx", "a"}) {
+    const LoudsTrie::Node parent = Traverse(trie, prefix);
+    ASSERT_TRUE(trie.IsValidNode(parent));
+
+    // Collect the children by walking the siblings one by one.
+    std::string expected_labels;
+    for (LoudsTrie::Node node = trie.MoveToFirstChild(parent);
+         trie.IsValidNode(node); trie.MoveToNextSibling(&node)) {
+      expected_labels += trie.GetEdgeLabelToParentNode(node);
+    }
+    const absl::string_view labels =
+        trie.GetSiblingLabels(trie.MoveToFirstChild(parent));
+    EXPECT_EQ(labels, expected_labels) << prefix;
+
+    for (int c = 0; c < 256; ++c) {
+      const char label = static_cast<char>(c);
+      LoudsTrie::Node node = parent;
+      const size_t pos = expected_labels.find(label);
+      if (pos == std::string::npos) {
+        EXPECT_FALSE(trie.MoveToChildByLabel(label, &node)) << prefix << c;
+        EXPECT_FALSE(trie.IsValidNode(node));
+        continue;
+      }
+      ASSERT_TRUE(trie.MoveToChildByLabel(label, &node)) << prefix << c;
+      EXPECT_EQ(node, LoudsTrie::MoveToNextSibling(
+                          trie.MoveToFirstChild(parent), pos));
+      EXPECT_EQ(trie.GetEdgeLabelToParentNode(node), label);
+      const std::string key = absl::StrCat(prefix, std::string(1, label));
+      EXPECT_TRUE(trie.HasKey(key));
+      EXPECT_EQ(trie.ExactSearch(key), builder.GetId(key));
+    }
+  }
+  trie.Close();
+}
+INSTANTIATE_TEST_CASE(GenMoveToChildByLabelWithWideFanOutTest);
+
 }  // namespace
 }  // namespace louds
 }  // namespace storage
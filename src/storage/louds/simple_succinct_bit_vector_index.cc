@@ -216,6 +216,23 @@ int SimpleSuccinctBitVectorIndex::Rank1(int n) const {
   return result;
 }
 
+int SimpleSuccinctBitVectorIndex::CountConsecutive1Bits(int index) const {
+  // Count trailing 1-bits word by word.  Note that |length_| is a multiple of
+  // 4.
+  int result = 0;
+  for (int offset = 4 * (index / 32); offset < length_; offset += 4) {
+    const int shift = index % 32;
+    const uint32_t word = LoadUnaligned<uint32_t>(data_ + offset) >> shift;
+    const int count = absl::countr_one(word);
+    result += count;
+    if (count < 32 - shift) {
+      return result;
+    }
+    index += count;
+  }
+  return result;
+}
+
 int SimpleSuccinctBitVectorIndex::Select0(int n) const {
   DCHECK_GT(n, 0);
 
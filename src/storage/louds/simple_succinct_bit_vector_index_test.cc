@@ -192,4 +192,25 @@ TEST_P(SimpleSuccinctBitVectorIndexTest, Pattern2) {
 }
 INSTANTIATE_TEST_CASE(GenPattern2Test);
 
+TEST(SimpleSuccinctBitVectorIndexCountTest, CountConsecutive1Bits) {
+  // Runs of 1-bits crossing word boundaries and reaching the end of data.
+  static constexpr char kData[] =
+      "\xF0\xFF\xFF\xFF\xFF\xFF\x0F\x00\x5A\xFF\xFF\xFF";
+  constexpr int kLength = sizeof(kData) - 1;
+  SimpleSuccinctBitVectorIndex bit_vector;
+  bit_vector.Init(reinterpret_cast<const uint8_t *>(kData), kLength);
+
+  EXPECT_EQ(bit_vector.CountConsecutive1Bits(0), 0);
+  EXPECT_EQ(bit_vector.CountConsecutive1Bits(4), 48);
+  EXPECT_EQ(bit_vector.CountConsecutive1Bits(40), 12);
+  EXPECT_EQ(bit_vector.CountConsecutive1Bits(72), 24);
+  for (int i = 0; i <= kLength * 8; ++i) {
+    int expected = 0;
+    while (i + expected < kLength * 8 && bit_vector.Get(i + expected) != 0) {
+      ++expected;
+    }
+    EXPECT_EQ(bit_vector.CountConsecutive1Bits(i), expected) << i;
+  }
+}
+
 }  // namespace
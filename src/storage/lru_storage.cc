@@ -30,13 +30,12 @@
 #include "storage/lru_storage.h"
 
 #include <algorithm>
+#include <bit>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
 #include <ios>
-#include <iterator>
-#include <list>
 #include <memory>
 #include <string>
 #include <utility>
@@ -48,6 +47,7 @@
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "base/bits.h"
@@ -71,6 +71,27 @@ constexpr size_t kMaxValueSize = 1024;   // 1024 byte
 // * 4 bytes for fingerprint seed
 constexpr size_t kFileHeaderSize = 12;
 
+// Layout of the index header (in uint32 words) placed right after the item
+// array.
+enum IndexHeaderField {
+  kIndexMagic = 0,
+  kIndexVersion,
+  kIndexState,
+  kIndexUsedSize,
+  kIndexHead,
+  kIndexTail,
+  kIndexNumBuckets,
+  kIndexReserved,
+  kIndexHeaderWords,
+};
+
+constexpr uint32_t kIndexMagicValue = 0x4d4c5255;  // "MLRU"
+
+// The index is marked dirty while it is being updated, so that an index left
+// half-updated by a killed process is rebuilt on the next Open().
+constexpr uint32_t kIndexClean = 0;
+constexpr uint32_t kIndexDirty = 1;
+
 constexpr uint64_t k62DaysInSec = 62 * 24 * 60 * 60;
 
 uint64_t GetFP(const char *ptr) { return LoadUnaligned<uint64_t>(ptr); }
@@ -108,6 +129,32 @@ class CompareByTimeStamp {
   }
 };
 
+// The hash table is kept at most half full.
+uint32_t GetNumBuckets(size_t size) {
+  return std::bit_ceil(static_cast<uint32_t>(size * 2));
+}
+
+size_t GetItemArraySize(size_t value_size, size_t size) {
+  return (value_size + LruStorage::kItemHeaderSize) * size;
+}
+
+size_t GetIndexSize(size_t size) {
+  return (kIndexHeaderWords + 2 * size + GetNumBuckets(size)) *
+         sizeof(uint32_t);
+}
+
+size_t GetVersion1FileSize(size_t value_size, size_t size) {
+  return kFileHeaderSize + GetItemArraySize(value_size, size);
+}
+
+size_t GetFileSize(size_t value_size, size_t size) {
+  return GetVersion1FileSize(value_size, size) + GetIndexSize(size);
+}
+
+uint32_t GetBucket(uint64_t fp, uint32_t mask) {
+  return static_cast<uint32_t>(fp) & mask;
+}
+
 }  // namespace
 
 std::unique_ptr<LruStorage> LruStorage::Create(const char *filename) {
@@ -172,23 +219,30 @@ bool LruStorage::CreateStorageFile(const char *filename, size_t value_size,
               static_cast<std::streamsize>(ary.size() * sizeof(ary[0])));
   }
 
+  // Index section for an empty LRU.  The links of unused items are never read.
+  std::vector<uint32_t> index(GetIndexSize(size) / sizeof(uint32_t), 0);
+  index[kIndexMagic] = kIndexMagicValue;
+  index[kIndexVersion] = kFileVersion;
+  index[kIndexState] = kIndexClean;
+  index[kIndexUsedSize] = 0;
+  index[kIndexHead] = kNil;
+  index[kIndexTail] = kNil;
+  index[kIndexNumBuckets] = GetNumBuckets(size);
+  std::fill_n(index.begin() + kIndexHeaderWords, 2 * size, kNil);
+  ofs.write(reinterpret_cast<const char *>(index.data()),
+            static_cast<std::streamsize>(index.size() * sizeof(index[0])));
+
   return true;
 }
 
 // Reopen file after initializing mapped page.
 bool LruStorage::Clear() {
   // Don't need to clear the page if the lru list is empty
-  if (mmap_.empty() || lru_list_.empty()) {
+  if (mmap_.empty() || used_size_ == 0) {
     return true;
   }
-  const size_t offset = sizeof(value_size_) + sizeof(size_) + sizeof(seed_);
-  if (offset >= mmap_.size()) {  // should not happen
-    return false;
-  }
-  std::fill(mmap_.begin() + offset, mmap_.end(), 0);
-  lru_list_.clear();
-  lru_map_.clear();
-  Open(mmap_.begin(), mmap_.size());
+  std::fill(begin_, end_, 0);
+  RebuildIndex();
   return true;
 }
 
@@ -201,6 +255,10 @@ bool LruStorage::Merge(const char *filename) {
 }
 
 bool LruStorage::Merge(const LruStorage &storage) {
+  if (index_header_ == nullptr) {
+    return false;
+  }
+
   if (storage.value_size() != value_size()) {
     return false;
   }
@@ -248,12 +306,15 @@ bool LruStorage::Merge(const LruStorage &storage) {
   // TODO(taku): this part is not atomic.
   // If the converter process is killed while memcpy or memset is running,
   // the storage data will be broken.
+  MarkIndexDirty();
   char *new_end = absl::c_copy_n(buf, new_size, begin_);
   if (new_size < old_size) {
     std::fill(new_end, end_, 0);
   }
 
-  return Open(mmap_.begin(), mmap_.size());
+  RebuildIndex();
+  DeleteElementsUntouchedFor62Days();
+  return true;
 }
 
 bool LruStorage::OpenOrCreate(const char *filename, size_t new_value_size,
@@ -324,18 +385,74 @@ bool LruStorage::Open(const char *filename) {
   }
   mmap_ = *std::move(mmap);
 
-  if (mmap_.size() < 8) {
+  if (mmap_.size() < kFileHeaderSize) {
     LOG(ERROR) << "file size is too small";
     return false;
   }
 
+  const uint32_t value_size = LoadUnaligned<uint32_t>(mmap_.begin());
+  const uint32_t size = LoadUnaligned<uint32_t>(mmap_.begin() + 4);
+  if (mmap_.size() == GetVersion1FileSize(value_size, size) &&
+      !MigrateFromVersion1(filename)) {
+    return false;
+  }
+
   filename_ = filename;
   return Open(mmap_.begin(), mmap_.size());
 }
 
+bool LruStorage::MigrateFromVersion1(const char *filename) {
+  MOZC_VLOG(1) << "Migrating " << filename << " to the version "
+               << kFileVersion << " layout.";
+  const uint32_t value_size = LoadUnaligned<uint32_t>(mmap_.begin());
+  const uint32_t size = LoadUnaligned<uint32_t>(mmap_.begin() + 4);
+  const uint32_t seed = LoadUnaligned<uint32_t>(mmap_.begin() + 8);
+  const std::string items(mmap_.begin() + kFileHeaderSize,
+                          GetItemArraySize(value_size, size));
+  mmap_.Close();
+
+  // Build the new file next to the old one and replace it atomically so that
+  // the history is not lost even if the migration is interrupted.
+  const std::string tmp_filename = absl::StrCat(filename, ".tmp");
+  if (!CreateStorageFile(tmp_filename.c_str(), value_size, size, seed)) {
+    LOG(ERROR) << "Cannot create " << tmp_filename;
+    return false;
+  }
+  {
+    absl::StatusOr<Mmap> mmap = Mmap::Map(tmp_filename, Mmap::READ_WRITE);
+    if (!mmap.ok()) {
+      LOG(ERROR) << "Cannot open " << tmp_filename << ": " << mmap.status();
+      FileUtil::UnlinkOrLogError(tmp_filename);
+      return false;
+    }
+    absl::c_copy(items, mmap->begin() + kFileHeaderSize);
+    // The index is built from the items on Open().
+    StoreUnaligned<uint32_t>(
+        kIndexDirty, mmap->begin() + GetVersion1FileSize(value_size, size) +
+                         kIndexState * sizeof(uint32_t));
+  }
+  if (absl::Status s = FileUtil::AtomicRename(tmp_filename, filename);
+      !s.ok()) {
+    LOG(ERROR) << "Cannot rename " << tmp_filename << " to " << filename
+               << ": " << s;
+    FileUtil::UnlinkOrLogError(tmp_filename);
+    return false;
+  }
+
+  absl::StatusOr<Mmap> mmap = Mmap::Map(filename, Mmap::READ_WRITE);
+  if (!mmap.ok()) {
+    LOG(ERROR) << "Cannot open " << filename
+               << " with read+write mode: " << mmap.status();
+    return false;
+  }
+  mmap_ = *std::move(mmap);
+  return true;
+}
+
 bool LruStorage::Open(char *ptr, size_t ptr_size) {
   begin_ = ptr;
-  end_ = ptr + ptr_size;
+  used_size_ = 0;
+  index_outdated_ = false;
 
   value_size_ = LoadUnalignedAdvance<uint32_t>(begin_);
   size_ = LoadUnalignedAdvance<uint32_t>(begin_);
@@ -356,30 +473,30 @@ bool LruStorage::Open(char *ptr, size_t ptr_size) {
     return false;
   }
 
-  if (mmap_.size() != kFileHeaderSize + item_size() * size_) {
+  if (ptr_size != GetFileSize(value_size_, size_)) {
     LOG(ERROR) << "LRU file is broken";
     return false;
   }
 
-  std::vector<char *> ary;
-  for (char *begin = begin_; begin < end_; begin += item_size()) {
-    ary.push_back(begin);
+  // Both the file header and the items are multiples of 4 bytes, so the index
+  // section is aligned.
+  end_ = begin_ + GetItemArraySize(value_size_, size_);
+  index_header_ = reinterpret_cast<uint32_t *>(end_);
+  links_ = index_header_ + kIndexHeaderWords;
+  buckets_ = links_ + 2 * size_;
+  bucket_mask_ = GetNumBuckets(size_) - 1;
+
+  if (index_header_[kIndexMagic] != kIndexMagicValue ||
+      index_header_[kIndexVersion] != kFileVersion) {
+    LOG(ERROR) << "Unknown LRU file version";
+    return false;
   }
-  std::stable_sort(ary.begin(), ary.end(), CompareByTimeStamp());
 
-  lru_list_.clear();
-  lru_map_.clear();
-  char *next = nullptr;
-  for (size_t i = 0; i < ary.size(); ++i) {
-    if (GetTimeStamp(ary[i]) != 0) {
-      lru_list_.push_back(ary[i]);
-      lru_map_[GetFP(ary[i])] = std::prev(lru_list_.end());
-    } else if (next == nullptr) {
-      next = ary[i];
-    }
+  if (!IsValidIndex()) {
+    LOG(WARNING) << "LRU index is outdated or broken. Rebuilding.";
+    RebuildIndex();
   }
-  next_item_ = (next != nullptr) ? next : end_;
-  DCHECK_LE(next_item_, end_);
+  used_size_ = index_header_[kIndexUsedSize];
 
   // At the time file is opened, perform clean up.
   DeleteElementsUntouchedFor62Days();
@@ -387,160 +504,352 @@ bool LruStorage::Open(char *ptr, size_t ptr_size) {
   return true;
 }
 
+bool LruStorage::IsValidIndex() const {
+  if (index_header_[kIndexState] != kIndexClean ||
+      index_header_[kIndexNumBuckets] != bucket_mask_ + 1) {
+    return false;
+  }
+  const uint32_t used_size = index_header_[kIndexUsedSize];
+  const uint32_t head = index_header_[kIndexHead];
+  const uint32_t tail = index_header_[kIndexTail];
+  if (used_size > size_) {
+    return false;
+  }
+  if (used_size == 0) {
+    return head == kNil && tail == kNil;
+  }
+  return head < used_size && tail < used_size && links_[2 * head] == kNil &&
+         links_[2 * tail + 1] == kNil;
+}
+
+void LruStorage::RebuildIndex() {
+  index_outdated_ = false;
+  MarkIndexDirty();
+
+  // Collects the live items from new to old.  If the same fingerprint appears
+  // more than once, only the newest one is kept.
+  std::vector<const char *> ary;
+  for (const char *item = begin_; item < end_; item += item_size()) {
+    if (GetTimeStamp(item) != 0) {
+      ary.push_back(item);
+    }
+  }
+  std::stable_sort(ary.begin(), ary.end(), CompareByTimeStamp());
+  absl::flat_hash_set<uint64_t> seen;
+  std::vector<bool> live(size_, false);
+  for (const char *item : ary) {
+    if (seen.insert(GetFP(item)).second) {
+      live[(item - begin_) / item_size()] = true;
+    }
+  }
+
+  // Packs the live items at the beginning of the array if they are not.
+  const size_t num_live = seen.size();
+  if (std::find(live.begin(), live.begin() + num_live, false) !=
+      live.begin() + num_live) {
+    std::string buf;
+    for (size_t i = 0; i < size_; ++i) {
+      if (live[i]) {
+        buf.append(GetItem(i), item_size());
+      }
+    }
+    std::fill(absl::c_copy(buf, begin_), end_, 0);
+  }
+
+  std::vector<uint32_t> order(num_live);
+  for (uint32_t i = 0; i < num_live; ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+    return GetTimeStamp(GetItem(a)) > GetTimeStamp(GetItem(b));
+  });
+
+  std::fill_n(buckets_, bucket_mask_ + 1, 0);
+  std::fill_n(links_, 2 * size_, kNil);
+  index_header_[kIndexNumBuckets] = bucket_mask_ + 1;
+  index_header_[kIndexHead] = kNil;
+  index_header_[kIndexTail] = kNil;
+  SetUsedSize(0);
+  // Pushes from old to new so that the newest one comes to the front.
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    InsertBucket(GetFP(GetItem(*it)), *it);
+    PushFront(*it);
+  }
+  SetUsedSize(static_cast<uint32_t>(num_live));
+
+  MarkIndexClean();
+}
+
 void LruStorage::Close() {
   // Perform clean up before closing the file.
   DeleteElementsUntouchedFor62Days();
 
   filename_.clear();
   mmap_.Close();
-  lru_list_.clear();
-  lru_map_.clear();
+  begin_ = end_ = nullptr;
+  index_header_ = links_ = buckets_ = nullptr;
+  used_size_ = 0;
+  index_outdated_ = false;
+}
+
+void LruStorage::SetUsedSize(uint32_t used_size) {
+  used_size_ = used_size;
+  index_header_[kIndexUsedSize] = used_size;
+}
+
+void LruStorage::MarkIndexDirty() { index_header_[kIndexState] = kIndexDirty; }
+
+void LruStorage::MarkIndexClean() {
+  // The index doesn't know the items written by Write() until it is rebuilt.
+  if (!index_outdated_) {
+    index_header_[kIndexState] = kIndexClean;
+  }
+}
+
+void LruStorage::RebuildIndexIfOutdated() {
+  if (index_outdated_) {
+    RebuildIndex();
+  }
+}
+
+uint32_t LruStorage::FindItem(uint64_t fp) const {
+  if (buckets_ == nullptr) {
+    return kNil;
+  }
+  for (uint32_t b = GetBucket(fp, bucket_mask_); buckets_[b] != 0;
+       b = (b + 1) & bucket_mask_) {
+    const uint32_t i = buckets_[b] - 1;
+    if (GetFP(GetItem(i)) == fp) {
+      return i;
+    }
+  }
+  return kNil;
+}
+
+void LruStorage::InsertBucket(uint64_t fp, uint32_t i) {
+  uint32_t b = GetBucket(fp, bucket_mask_);
+  while (buckets_[b] != 0) {
+    b = (b + 1) & bucket_mask_;
+  }
+  buckets_[b] = i + 1;
+}
+
+uint32_t LruStorage::FindBucketOfItem(uint32_t i) const {
+  uint32_t b = GetBucket(GetFP(GetItem(i)), bucket_mask_);
+  while (buckets_[b] != i + 1) {
+    DCHECK_NE(buckets_[b], 0) << "Item " << i << " is not in the hash table";
+    b = (b + 1) & bucket_mask_;
+  }
+  return b;
+}
+
+void LruStorage::EraseBucket(uint32_t bucket) {
+  // Backward shift deletion: moves the following entries in the probe sequence
+  // into the hole so that no tombstone is needed.
+  uint32_t hole = bucket;
+  for (uint32_t b = (hole + 1) & bucket_mask_; buckets_[b] != 0;
+       b = (b + 1) & bucket_mask_) {
+    const uint32_t home =
+        GetBucket(GetFP(GetItem(buckets_[b] - 1)), bucket_mask_);
+    // The entry at |b| can be moved to |hole| iff its home bucket is not in
+    // the cyclic range (hole, b].
+    if (((b - home) & bucket_mask_) >= ((b - hole) & bucket_mask_)) {
+      buckets_[hole] = buckets_[b];
+      hole = b;
+    }
+  }
+  buckets_[hole] = 0;
+}
+
+void LruStorage::Unlink(uint32_t i) {
+  const uint32_t prev = links_[2 * i];
+  const uint32_t next = links_[2 * i + 1];
+  if (prev == kNil) {
+    index_header_[kIndexHead] = next;
+  } else {
+    links_[2 * prev + 1] = next;
+  }
+  if (next == kNil) {
+    index_header_[kIndexTail] = prev;
+  } else {
+    links_[2 * next] = prev;
+  }
+}
+
+void LruStorage::PushFront(uint32_t i) {
+  const uint32_t head = index_header_[kIndexHead];
+  links_[2 * i] = kNil;
+  links_[2 * i + 1] = head;
+  if (head == kNil) {
+    index_header_[kIndexTail] = i;
+  } else {
+    links_[2 * head] = i;
+  }
+  index_header_[kIndexHead] = i;
+}
+
+void LruStorage::MoveToFront(uint32_t i) {
+  if (index_header_[kIndexHead] == i) {
+    return;
+  }
+  Unlink(i);
+  PushFront(i);
 }
 
 const char *LruStorage::Lookup(const absl::string_view key,
                                uint32_t *last_access_time) const {
   const uint64_t fp = FingerprintWithSeed(key, seed_);
-  const auto it = lru_map_.find(fp);
-  if (it == lru_map_.end()) {
+  const uint32_t i = FindItem(fp);
+  if (i == kNil) {
     return nullptr;
   }
-  const uint32_t timestamp = GetTimeStamp(*it->second);
+  const uint32_t timestamp = GetTimeStamp(GetItem(i));
   if (IsOlderThan62Days(timestamp)) {
     return nullptr;
   }
   *last_access_time = timestamp;
-  return GetValue(*it->second);
+  return GetValue(GetItem(i));
 }
 
 void LruStorage::GetAllValues(std::vector<std::string> *values) const {
   DCHECK(values);
   values->clear();
+  if (index_header_ == nullptr) {
+    return;
+  }
   // Iterate data from the most recently used element to the least recently used
   // element.
-  for (const char *ptr : lru_list_) {
+  for (uint32_t i = index_header_[kIndexHead]; i != kNil;
+       i = links_[2 * i + 1]) {
+    const char *ptr = GetItem(i);
     const uint32_t timestamp = GetTimeStamp(ptr);
     if (IsOlderThan62Days(timestamp)) {
       break;
     }
     // Default constructor of string is not applicable
     // because value's size() must return value_size_.
-    DCHECK(ptr);
     values->emplace_back(GetValue(ptr), value_size_);
   }
 }
 
 bool LruStorage::Touch(const absl::string_view key) {
+  RebuildIndexIfOutdated();
   const uint64_t fp = FingerprintWithSeed(key, seed_);
-  auto it = lru_map_.find(fp);
-  if (it == lru_map_.end()) {
+  const uint32_t i = FindItem(fp);
+  if (i == kNil) {
     return false;
   }
-  const uint32_t timestamp = GetTimeStamp(*it->second);
+  const uint32_t timestamp = GetTimeStamp(GetItem(i));
   if (IsOlderThan62Days(timestamp)) {
     return false;
   }
-  Update(*it->second);
-  // Move the node pointed to by it->second to the front.
-  lru_list_.splice(lru_list_.begin(), lru_list_, it->second);
+  MarkIndexDirty();
+  Update(GetItem(i));
+  MoveToFront(i);
+  MarkIndexClean();
   return true;
 }
 
 bool LruStorage::Insert(const absl::string_view key, const char *value) {
-  if (value == nullptr) {
+  if (value == nullptr || index_header_ == nullptr) {
     return false;
   }
+  RebuildIndexIfOutdated();
   const uint64_t fp = FingerprintWithSeed(key, seed_);
 
-  // If the data corresponding to |key| already exists in LRU, update it.
-  {
-    auto it = lru_map_.find(fp);
-    if (it != lru_map_.end()) {
-      // Overwrite the data pointed to by it->second and move it to the front.
-      Update(*it->second, fp, value, value_size_);
-      lru_list_.splice(lru_list_.begin(), lru_list_, it->second);
-      return true;
-    }
-  }
+  MarkIndexDirty();
 
-  // If the LRU is full or we run out of the mmap region, drop the least
-  // recently used element (actually, the least recently used element is
-  // overwritten with new data).
-  if (lru_map_.size() >= size_ || next_item_ == end_) {
-    auto it = std::prev(lru_list_.end());  // Least recently used data.
-    const uint64_t old_fp = GetFP(*it);
-    lru_map_.erase(old_fp);
-    lru_list_.splice(lru_list_.begin(), lru_list_, it);  // Move to front.
-    Update(*it, fp, value, value_size_);
-    lru_map_[fp] = it;
+  // If the data corresponding to |key| already exists in LRU, update it.
+  if (const uint32_t i = FindItem(fp); i != kNil) {
+    // Overwrite the data and move it to the front.
+    Update(GetItem(i), fp, value, value_size_);
+    MoveToFront(i);
+    MarkIndexClean();
     return true;
   }
 
-  // A new item can be assigned in the mmap region.
-  if (next_item_ < end_) {
-    Update(next_item_, fp, value, value_size_);
-    lru_list_.push_front(next_item_);
-    lru_map_[fp] = lru_list_.begin();
-    // Advance next_item_ for next item.
-    next_item_ += item_size();
-    DCHECK_LE(next_item_, end_);
+  // If the LRU is full, drop the least recently used element (actually, the
+  // least recently used element is overwritten with new data).
+  if (used_size_ >= size_) {
+    const uint32_t i = index_header_[kIndexTail];  // Least recently used data.
+    EraseBucket(FindBucketOfItem(i));
+    Update(GetItem(i), fp, value, value_size_);
+    InsertBucket(fp, i);
+    MoveToFront(i);
+    MarkIndexClean();
     return true;
   }
 
-  LOG(ERROR) << "Insertion failed because no more mmap region is available.";
-  return false;
+  // A new item can be assigned in the mmap region.
+  const uint32_t i = used_size_;
+  Update(GetItem(i), fp, value, value_size_);
+  InsertBucket(fp, i);
+  PushFront(i);
+  SetUsedSize(used_size_ + 1);
+  MarkIndexClean();
+  return true;
 }
 
 bool LruStorage::TryInsert(const absl::string_view key, const char *value) {
+  RebuildIndexIfOutdated();
   const uint64_t fp = FingerprintWithSeed(key, seed_);
-  auto it = lru_map_.find(fp);
-  if (it != lru_map_.end()) {
-    Update(*it->second, fp, value, value_size_);
-    lru_list_.splice(lru_list_.begin(), lru_list_, it->second);
+  if (const uint32_t i = FindItem(fp); i != kNil) {
+    MarkIndexDirty();
+    Update(GetItem(i), fp, value, value_size_);
+    MoveToFront(i);
+    MarkIndexClean();
   }
   return true;
 }
 
 bool LruStorage::Delete(const absl::string_view key) {
+  RebuildIndexIfOutdated();
   const uint64_t fp = FingerprintWithSeed(key, seed_);
-  return Delete(fp);
-}
-
-bool LruStorage::Delete(uint64_t fp) {
-  auto it = lru_map_.find(fp);
-  return (it == lru_map_.end() || Delete(fp, it->second));
+  const uint32_t i = FindItem(fp);
+  return (i == kNil || DeleteItem(i));
 }
 
-bool LruStorage::Delete(std::list<char *>::iterator it) {
-  return (it == lru_list_.end() || Delete(GetFP(*it), it));
-}
-
-bool LruStorage::Delete(uint64_t fp, std::list<char *>::iterator it) {
+bool LruStorage::DeleteItem(uint32_t i) {
   // Determine the last element in the mmap region.
-  if (next_item_ < begin_ + item_size()) {
-    LOG(ERROR) << "next_item_ points to invalid location (broken?)";
+  if (used_size_ == 0 || i >= used_size_) {
+    LOG(ERROR) << "Item index is out of range (broken?)";
     return false;
   }
-  next_item_ -= item_size();
+  const uint32_t last = used_size_ - 1;
 
-  // Backup the location of mmap region to which another element will be moved.
-  char *deleted_item_pos = *it;
+  MarkIndexDirty();
 
-  // Erase the LRU structure for (fp, it).
-  lru_map_.erase(fp);
-  lru_list_.erase(it);
+  // Erase the LRU structure for |i|.
+  EraseBucket(FindBucketOfItem(i));
+  Unlink(i);
 
-  if (next_item_ != deleted_item_pos) {
+  if (last != i) {
     // Move the region for the last element to the deleted location.  Then,
-    // update the LRU structure for the moved element (the pointer to mmap
-    // region in the list node is updated.)
-    std::copy_n(next_item_, item_size(), deleted_item_pos);
-    const uint64_t fp = GetFP(next_item_);
-    *lru_map_[fp] = deleted_item_pos;
+    // update the hash table and the LRU list for the moved element.
+    buckets_[FindBucketOfItem(last)] = i + 1;
+    const uint32_t prev = links_[2 * last];
+    const uint32_t next = links_[2 * last + 1];
+    links_[2 * i] = prev;
+    links_[2 * i + 1] = next;
+    if (prev == kNil) {
+      index_header_[kIndexHead] = i;
+    } else {
+      links_[2 * prev + 1] = i;
+    }
+    if (next == kNil) {
+      index_header_[kIndexTail] = i;
+    } else {
+      links_[2 * next] = i;
+    }
+    std::copy_n(GetItem(last), item_size(), GetItem(i));
   }
 
-  // Clear the region for the next_item_.
-  std::fill_n(next_item_, item_size(), 0);
+  // Clear the region for the last item.
+  std::fill_n(GetItem(last), item_size(), 0);
+  links_[2 * last] = links_[2 * last + 1] = kNil;
+  SetUsedSize(last);
 
+  MarkIndexClean();
   return true;
 }
 
@@ -548,14 +857,15 @@ int LruStorage::DeleteElementsBefore(uint32_t timestamp) {
   if (mmap_.empty() || begin_ >= end_) {
     return 0;
   }
+  RebuildIndexIfOutdated();
   int num_deleted = 0;
-  while (!lru_list_.empty()) {
-    auto it = std::prev(lru_list_.end());
-    const uint32_t last_access_time = GetTimeStamp(*it);
+  while (used_size_ > 0) {
+    const uint32_t i = index_header_[kIndexTail];
+    const uint32_t last_access_time = GetTimeStamp(GetItem(i));
     if (last_access_time >= timestamp) {
       break;
     }
-    if (Delete(it)) {
+    if (DeleteItem(i)) {
       ++num_deleted;
       continue;
     }
@@ -575,6 +885,8 @@ int LruStorage::DeleteElementsUntouchedFor62Days() {
 void LruStorage::Write(size_t i, uint64_t fp, const absl::string_view value,
                        uint32_t last_access_time) {
   DCHECK_LT(i, size_);
+  index_outdated_ = true;
+  MarkIndexDirty();
   char *ptr = begin_ + (i * item_size());
   ptr = StoreUnaligned<uint64_t>(fp, ptr);
   ptr = StoreUnaligned<uint32_t>(last_access_time, ptr);
@@ -32,18 +32,32 @@
 
 #include <cstddef>
 #include <cstdint>
-#include <list>
 #include <memory>
 #include <string>
 #include <vector>
 
-#include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
 #include "base/mmap.h"
 
 namespace mozc {
 namespace storage {
 
+// LRU storage backed by a memory mapped file.
+//
+// File layout (all integers are little endian uint32 unless noted):
+//   * File header: value size, capacity (|size|) and fingerprint seed.
+//   * Item array: |size| items of item_size() bytes, each of which consists of
+//     a fingerprint (uint64), a last access time and the value.  The used
+//     items are always packed at the beginning of the array.
+//   * Index section (since version 2): a small header followed by the doubly
+//     linked LRU list (prev/next item index per item) and an open addressing
+//     hash table from fingerprint to item index.
+//
+// Since the LRU order and the hash table live in the mapped region, Open()
+// doesn't need to rebuild them from the item array.  The index is rebuilt
+// only when the file is in the old layout (version 1, which has no index
+// section and is migrated on Open()) or when the index is found to be
+// inconsistent, e.g., the process was killed while updating it.
 class LruStorage {
  public:
   LruStorage() = default;
@@ -121,7 +135,7 @@ class LruStorage {
   size_t size() const { return size_; }
 
   // Returns the number of items in LRU.
-  size_t used_size() const { return lru_list_.size(); }
+  size_t used_size() const { return used_size_; }
 
   // Returns the seed used for fingerprinting.
   uint32_t seed() const { return seed_; }
@@ -130,7 +144,9 @@ class LruStorage {
 
   // Writes one entry at |i| th index.
   // i must be 0 <= i < size.
-  // This data will not update the index of the storage.
+  // This data will not update the index of the storage.  The index is marked
+  // as outdated and is rebuilt before the next update (Touch(), Insert(),
+  // etc.), Merge() or Open().  Until then, Lookup() doesn't see the entry.
   void Write(size_t i, uint64_t fp, absl::string_view value,
              uint32_t last_access_time);
 
@@ -156,26 +172,62 @@ class LruStorage {
   // * 4 bytes for timestamp.
   static constexpr size_t kItemHeaderSize = 12;
 
+  // The version of the file layout written by CreateStorageFile().
+  static constexpr uint32_t kFileVersion = 2;
+
  private:
   // Initializes this LRU from memory buffer.
   bool Open(char *ptr, size_t ptr_size);
 
-  // Deletes the element from |fp| or |it|.
-  bool Delete(uint64_t fp);
-  bool Delete(std::list<char *>::iterator it);
+  // Converts the file in the version 1 layout to the current one.
+  bool MigrateFromVersion1(const char *filename);
+
+  // Rebuilds the LRU list and the hash table from the item array.
+  void RebuildIndex();
+
+  // Returns true if the index header looks consistent with the item array.
+  bool IsValidIndex() const;
+
+  char *GetItem(uint32_t i) { return begin_ + i * item_size(); }
+  const char *GetItem(uint32_t i) const { return begin_ + i * item_size(); }
+
+  // Returns the index of the item for |fp|, or kNil if not found.
+  uint32_t FindItem(uint64_t fp) const;
+
+  // Hash table operations.
+  void InsertBucket(uint64_t fp, uint32_t i);
+  uint32_t FindBucketOfItem(uint32_t i) const;
+  void EraseBucket(uint32_t bucket);
+
+  // LRU list operations.
+  void Unlink(uint32_t i);
+  void PushFront(uint32_t i);
+  void MoveToFront(uint32_t i);
+
+  // Deletes the |i|-th item and moves the last item into the hole so that the
+  // used items are kept packed.
+  bool DeleteItem(uint32_t i);
+
+  void SetUsedSize(uint32_t used_size);
+  void MarkIndexDirty();
+  void MarkIndexClean();
+  void RebuildIndexIfOutdated();
 
-  // Actual implementation of Delete() methods.
-  bool Delete(uint64_t fp, std::list<char *>::iterator it);
+  static constexpr uint32_t kNil = 0xFFFFFFFF;
 
   size_t value_size_ = 0;
   size_t size_ = 0;
   uint32_t seed_ = 0;
-  char *next_item_ = nullptr;
-  char *begin_ = nullptr;
-  char *end_ = nullptr;
+  uint32_t used_size_ = 0;
+  char *begin_ = nullptr;  // Beginning of the item array.
+  char *end_ = nullptr;    // End of the item array.
+  uint32_t *index_header_ = nullptr;
+  uint32_t *links_ = nullptr;    // {prev, next} for each item.
+  uint32_t *buckets_ = nullptr;  // Item index + 1, or 0 for an empty bucket.
+  uint32_t bucket_mask_ = 0;
+  // Set by Write().  While set, the index is kept marked as dirty in the file.
+  bool index_outdated_ = false;
   std::string filename_;
-  std::list<char *> lru_list_;  // Front is the most recently used data.
-  absl::flat_hash_map<uint64_t, std::list<char *>::iterator> lru_map_;
   Mmap mmap_;
 };
 
@@ -42,10 +42,12 @@
 
 #include "absl/log/check.h"
 #include "absl/random/random.h"
+#include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
 #include "base/clock_mock.h"
 #include "base/file/temp_dir.h"
 #include "base/file_util.h"
+#include "base/hash.h"
 #include "base/random.h"
 #include "storage/lru_cache.h"
 #include "testing/gmock.h"
@@ -557,5 +559,168 @@ TEST_F(LruStorageTest, OldDataAreNotLookedUp) {
   EXPECT_TRUE(storage.Touch("4444"));
 }
 
+TEST_F(LruStorageTest, IndexIsKeptAcrossReopen) {
+  // All the operations happen at the same time, so the LRU order cannot be
+  // restored from the timestamps.
+  ScopedClockMock clock(absl::FromUnixSeconds(100));
+
+  constexpr size_t kNumElements = 100;
+  TempFile file(testing::MakeTempFileOrDie());
+  mozc::storage::LruCache<std::string, uint32_t> cache(kNumElements);
+  mozc::Random random;
+  {
+    LruStorage storage;
+    ASSERT_TRUE(
+        storage.OpenOrCreate(file.path().c_str(), 4, kNumElements, kSeed));
+    for (int i = 0; i < 1000; ++i) {
+      const std::string key =
+          absl::StrCat(absl::Uniform<size_t>(random, 0, kNumElements * 2));
+      switch (absl::Uniform(random, 0, 3)) {
+        case 0: {
+          const uint32_t value = absl::Uniform(random, 0u, 10000000u);
+          cache.Insert(key, value);
+          EXPECT_TRUE(
+              storage.Insert(key, reinterpret_cast<const char *>(&value)));
+          break;
+        }
+        case 1:
+          EXPECT_EQ(storage.Touch(key), cache.Lookup(key) != nullptr);
+          break;
+        default:
+          cache.Erase(key);
+          EXPECT_TRUE(storage.Delete(key));
+          break;
+      }
+    }
+    EXPECT_EQ(storage.used_size(), cache.Size());
+  }
+
+  LruStorage storage;
+  ASSERT_TRUE(storage.Open(file.path().c_str()));
+  EXPECT_EQ(storage.used_size(), cache.Size());
+  std::vector<std::string> values;
+  storage.GetAllValues(&values);
+  ASSERT_EQ(values.size(), cache.Size());
+  size_t i = 0;
+  for (const auto &elem : cache) {
+    EXPECT_EQ(storage.LookupAsString(elem.key),
+              absl::string_view(reinterpret_cast<const char *>(&elem.value),
+                                sizeof(elem.value)));
+    EXPECT_EQ(values[i++],
+              absl::string_view(reinterpret_cast<const char *>(&elem.value),
+                                sizeof(elem.value)));
+  }
+}
+
+TEST_F(LruStorageTest, MigrateFromVersion1) {
+  ScopedClockMock clock(absl::FromUnixSeconds(100));
+
+  // Builds a file in the version 1 layout, which has no index section.
+  constexpr uint32_t kValueSize = 4;
+  constexpr uint32_t kSize = 4;
+  std::string content;
+  for (const uint32_t v : {kValueSize, kSize, kSeed}) {
+    content.append(reinterpret_cast<const char *>(&v), sizeof(v));
+  }
+  const struct {
+    const char *key;
+    const char *value;
+    uint32_t last_access_time;
+  } kItems[] = {
+      {"1111", "aaaa", 10},
+      {"2222", "bbbb", 30},
+      {"3333", "cccc", 20},
+  };
+  for (const auto &item : kItems) {
+    const uint64_t fp = FingerprintWithSeed(item.key, kSeed);
+    content.append(reinterpret_cast<const char *>(&fp), sizeof(fp));
+    content.append(reinterpret_cast<const char *>(&item.last_access_time),
+                   sizeof(item.last_access_time));
+    content.append(item.value, kValueSize);
+  }
+  content.append(LruStorage::kItemHeaderSize + kValueSize, '\0');
+
+  TempFile file(testing::MakeTempFileOrDie());
+  ASSERT_OK(FileUtil::SetContents(file.path(), content));
+
+  {
+    LruStorage storage;
+    ASSERT_TRUE(storage.Open(file.path().c_str()));
+    EXPECT_EQ(storage.size(), kSize);
+    EXPECT_EQ(storage.used_size(), 3);
+    EXPECT_EQ(storage.LookupAsString("1111"), "aaaa");
+    EXPECT_EQ(storage.LookupAsString("2222"), "bbbb");
+    EXPECT_EQ(storage.LookupAsString("3333"), "cccc");
+    std::vector<std::string> values;
+    storage.GetAllValues(&values);
+    EXPECT_THAT(values, ::testing::ElementsAre("bbbb", "cccc", "aaaa"));
+    EXPECT_TRUE(storage.Insert("4444", "dddd"));
+  }
+
+  absl::StatusOr<std::string> migrated = FileUtil::GetContents(file.path());
+  ASSERT_OK(migrated);
+  EXPECT_GT(migrated->size(), content.size());
+  // The items are kept as is.
+  EXPECT_EQ(migrated->substr(0, content.size() - 16),
+            content.substr(0, content.size() - 16));
+
+  LruStorage storage;
+  ASSERT_TRUE(storage.Open(file.path().c_str()));
+  std::vector<std::string> values;
+  storage.GetAllValues(&values);
+  EXPECT_THAT(values, ::testing::ElementsAre("dddd", "bbbb", "cccc", "aaaa"));
+}
+
+TEST_F(LruStorageTest, OutdatedIndexIsRebuilt) {
+  ScopedClockMock clock(absl::FromUnixSeconds(100));
+
+  TempFile file(testing::MakeTempFileOrDie());
+  {
+    LruStorage storage;
+    ASSERT_TRUE(storage.OpenOrCreate(file.path().c_str(), 4, 4, kSeed));
+    EXPECT_TRUE(storage.Insert("1111", "aaaa"));
+    EXPECT_TRUE(storage.Insert("2222", "bbbb"));
+    // Write() bypasses the index.
+    storage.Write(2, FingerprintWithSeed("3333", kSeed), "cccc", 50);
+  }
+
+  LruStorage storage;
+  ASSERT_TRUE(storage.Open(file.path().c_str()));
+  EXPECT_EQ(storage.used_size(), 3);
+  EXPECT_EQ(storage.LookupAsString("1111"), "aaaa");
+  EXPECT_EQ(storage.LookupAsString("2222"), "bbbb");
+  EXPECT_EQ(storage.LookupAsString("3333"), "cccc");
+  std::vector<std::string> values;
+  storage.GetAllValues(&values);
+  EXPECT_EQ(values.back(), "cccc");
+}
+
+TEST_F(LruStorageTest, WriteThenInsertKeepsWrittenItem) {
+  ScopedClockMock clock(absl::FromUnixSeconds(100));
+
+  TempFile file(testing::MakeTempFileOrDie());
+  {
+    LruStorage storage;
+    ASSERT_TRUE(storage.OpenOrCreate(file.path().c_str(), 4, 4, kSeed));
+    EXPECT_TRUE(storage.Insert("1111", "aaaa"));
+    storage.Write(1, FingerprintWithSeed("2222", kSeed), "bbbb", 50);
+    // The insertion must neither overwrite the written item nor mark the
+    // index as up to date.
+    EXPECT_TRUE(storage.Insert("3333", "cccc"));
+    EXPECT_EQ(storage.used_size(), 3);
+    EXPECT_EQ(storage.LookupAsString("2222"), "bbbb");
+  }
+
+  LruStorage storage;
+  ASSERT_TRUE(storage.Open(file.path().c_str()));
+  EXPECT_EQ(storage.used_size(), 3);
+  EXPECT_EQ(storage.LookupAsString("1111"), "aaaa");
+  EXPECT_EQ(storage.LookupAsString("2222"), "bbbb");
+  EXPECT_EQ(storage.LookupAsString("3333"), "cccc");
+  std::vector<std::string> values;
+  storage.GetAllValues(&values);
+  EXPECT_THAT(values, ::testing::ElementsAre("cccc", "aaaa", "bbbb"));
+}
+
 }  // namespace storage
 }  // namespace mozc
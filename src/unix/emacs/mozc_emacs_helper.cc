@@ -27,11 +27,13 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/flags/flag.h"
@@ -39,6 +41,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "base/init_mozc.h"
 #include "base/version.h"
 #include "client/client.h"
@@ -73,51 +76,110 @@ void PrintGreetingMessage() {
   fflush(stdout);
 }
 
-// Main loop, which takes an input line as a command and print a corresponding
-// result returned by Mozc server in S-expression.
-void ProcessLoop() {
-  ClientPool client_pool;
+// Maximum number of input lines processed at once.
+constexpr size_t kMaxBatchSize = 256;
+
+// A command read from Emacs.
+struct Event {
+  uint32_t event_id = 0;
+  uint32_t session_id = 0;
   commands::Command command;
-  std::string line;
+};
+
+// Prints a result returned by Mozc server in S-expression.
+void PrintEvent(Event &event) {
+  RemoveUsageData(event.command.mutable_output());
+
+  std::vector<std::string> buffer;
+  PrintMessage(event.command.output(), &buffer);
+  const std::string output = absl::StrJoin(buffer, "");
+  absl::FPrintF(
+      stdout, "((emacs-event-id . %u)(emacs-session-id . %u)(output . %s))\n",
+      event.event_id, event.session_id, output);
+}
+
+// Sends |events|, which are SEND_KEY events for the same session, to the
+// server in one request, and prints the results. Clears |events|.
+void SendKeyEvents(std::vector<Event> &events, ClientPool &client_pool) {
+  if (events.empty()) {
+    return;
+  }
+  std::vector<commands::KeyEvent> keys;
+  keys.reserve(events.size());
+  for (const Event &event : events) {
+    keys.push_back(event.command.input().key());
+  }
+  std::shared_ptr<client::Client> client =
+      client_pool.GetClient(events.front().session_id);
+  CHECK(client.get());
+  std::vector<commands::Output> outputs;
+  if (!client->SendKeys(keys, &outputs)) {
+    ErrorExit(kErrSessionError, "Session failed");
+  }
+  for (size_t i = 0; i < events.size(); ++i) {
+    *events[i].command.mutable_output() = std::move(outputs[i]);
+    PrintEvent(events[i]);
+  }
+  events.clear();
+}
 
-  while (std::getline(std::cin, line)) {
-    command.clear_input();
-    command.clear_output();
-    uint32_t event_id = 0;
-    uint32_t session_id = 0;
+// Processes input lines as commands and prints the corresponding results
+// returned by Mozc server in S-expression. The lines are parsed and answered
+// one by one, except that consecutive keys for the same session are sent to
+// the server in one request.
+void ProcessInputLines(absl::Span<const std::string> lines,
+                       ClientPool &client_pool) {
+  std::vector<Event> key_events;
+  for (const std::string &line : lines) {
+    Event event;
+    InputLineError error;
+    if (!TryParseInputLine(line, &event.event_id, &event.session_id,
+                           event.command.mutable_input(), &error)) {
+      // Answers the preceding events before exiting, as if the lines were
+      // processed one by one.
+      SendKeyEvents(key_events, client_pool);
+      ErrorExit(error.error, error.message);
+    }
 
-    // Parse an input line.
-    ParseInputLine(line, &event_id, &session_id, command.mutable_input());
+    const commands::Input::CommandType type = event.command.input().type();
+    if (type == commands::Input::SEND_KEY && !key_events.empty() &&
+        key_events.front().session_id == event.session_id) {
+      key_events.push_back(std::move(event));
+      continue;
+    }
+    SendKeyEvents(key_events, client_pool);
 
-    switch (command.input().type()) {
+    switch (type) {
       case commands::Input::CREATE_SESSION:
-        session_id = client_pool.CreateClient();
+        event.session_id = client_pool.CreateClient();
+        PrintEvent(event);
         break;
       case commands::Input::DELETE_SESSION:
-        client_pool.DeleteClient(session_id);
+        client_pool.DeleteClient(event.session_id);
+        PrintEvent(event);
         break;
-      case commands::Input::SEND_KEY: {
-        std::shared_ptr<client::Client> client =
-            client_pool.GetClient(session_id);
-        CHECK(client.get());
-        if (!client->SendKey(command.input().key(), command.mutable_output())) {
-          ErrorExit(kErrSessionError, "Session failed");
-        }
+      case commands::Input::SEND_KEY:
+        key_events.push_back(std::move(event));
         break;
-      }
       default:
         ErrorExit(kErrVoidFunction, "Unknown function");
     }
+  }
+  SendKeyEvents(key_events, client_pool);
+}
 
-    RemoveUsageData(command.mutable_output());
+// Main loop, which takes input lines as commands and prints the results in
+// the same order. Lines already sent by Emacs are processed as a batch, and
+// the results are flushed once per batch.
+void ProcessLoop() {
+  // Makes std::cin buffer the input by itself, so that ReadInputLines() can
+  // tell the lines already sent.
+  std::ios::sync_with_stdio(false);
 
-    // Output results.
-    std::vector<std::string> buffer;
-    PrintMessage(command.output(), &buffer);
-    const std::string output = absl::StrJoin(buffer, "");
-    absl::FPrintF(
-        stdout, "((emacs-event-id . %u)(emacs-session-id . %u)(output . %s))\n",
-        event_id, session_id, output);
+  ClientPool client_pool;
+  std::vector<std::string> lines;
+  while (ReadInputLines(std::cin, kMaxBatchSize, &lines)) {
+    ProcessInputLines(lines, client_pool);
     fflush(stdout);
   }
 }
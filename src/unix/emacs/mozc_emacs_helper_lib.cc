@@ -30,8 +30,10 @@
 #include "unix/emacs/mozc_emacs_helper_lib.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
+#include <istream>
 #include <string>
 #include <utility>
 #include <vector>
@@ -74,22 +76,26 @@ void PrintFieldValue(const protobuf::Message &message,
 // ARGUMENTs depend on a command.
 // An input line must be surrounded by a pair of parentheses,
 // like a S-expression.
-void ParseInputLine(absl::string_view line, uint32_t *event_id,
-                    uint32_t *session_id, commands::Input *input) {
+bool TryParseInputLine(absl::string_view line, uint32_t *event_id,
+                       uint32_t *session_id, commands::Input *input,
+                       InputLineError *error) {
   CHECK(event_id);
   CHECK(session_id);
   CHECK(input);
+  CHECK(error);
 
   std::vector<std::string> tokens;
   if (!TokenizeSExpr(line, &tokens) ||
       tokens.size() < 4 ||  // Must be at least '(' EVENT_ID COMMAND ')'.
       tokens.front() != "(" || tokens.back() != ")") {
-    ErrorExit(kErrScanError, "S expression in the wrong format");
+    *error = {kErrScanError, "S expression in the wrong format"};
+    return false;
   }
 
   // Read an event ID (a sequence number).
   if (!absl::SimpleAtoi(tokens[1], event_id)) {
-    ErrorExit(kErrWrongTypeArgument, "Event ID is not an integer");
+    *error = {kErrWrongTypeArgument, "Event ID is not an integer"};
+    return false;
   }
 
   // Read a command.
@@ -103,36 +109,42 @@ void ParseInputLine(absl::string_view line, uint32_t *event_id,
   } else {
     // Mozc has SendTestKey and SendCommand commands in addition to the above.
     // But this code doesn't support them because of no need so far.
-    ErrorExit(kErrVoidFunction, "Unknown function");
+    *error = {kErrVoidFunction, "Unknown function"};
+    return false;
   }
 
   switch (input->type()) {
     case commands::Input::CREATE_SESSION: {
       // Suppose: (EVENT_ID CreateSession)
       if (tokens.size() != 4) {
-        ErrorExit(kErrWrongNumberOfArguments, "Wrong number of arguments");
+        *error = {kErrWrongNumberOfArguments, "Wrong number of arguments"};
+        return false;
       }
       break;
     }
     case commands::Input::DELETE_SESSION: {
       // Suppose: (EVENT_ID DeleteSession SESSION_ID)
       if (tokens.size() != 5) {
-        ErrorExit(kErrWrongNumberOfArguments, "Wrong number of arguments");
+        *error = {kErrWrongNumberOfArguments, "Wrong number of arguments"};
+        return false;
       }
       // Parse session ID.
       if (!absl::SimpleAtoi(tokens[3], session_id)) {
-        ErrorExit(kErrWrongTypeArgument, "Session ID is not an integer");
+        *error = {kErrWrongTypeArgument, "Session ID is not an integer"};
+        return false;
       }
       break;
     }
     case commands::Input::SEND_KEY: {
       // Suppose: (EVENT_ID SendKey SESSION_ID KEY...)
       if (tokens.size() < 6) {
-        ErrorExit(kErrWrongNumberOfArguments, "Wrong number of arguments");
+        *error = {kErrWrongNumberOfArguments, "Wrong number of arguments"};
+        return false;
       }
       // Parse session ID.
       if (!absl::SimpleAtoi(tokens[3], session_id)) {
-        ErrorExit(kErrWrongTypeArgument, "Session ID is not an integer");
+        *error = {kErrWrongTypeArgument, "Session ID is not an integer"};
+        return false;
       }
       // Parse keys.
       std::vector<std::string> keys;
@@ -141,15 +153,18 @@ void ParseInputLine(absl::string_view line, uint32_t *event_id,
         if (absl::ascii_isdigit(tokens[i][0])) {  // Numeric key code
           uint32_t key_code;
           if (!absl::SimpleAtoi(tokens[i], &key_code) || key_code > 255) {
-            ErrorExit(kErrWrongTypeArgument, "Wrong character code");
+            *error = {kErrWrongTypeArgument, "Wrong character code"};
+            return false;
           }
           keys.push_back(std::string(1, static_cast<char>(key_code)));
         } else if (tokens[i][0] == '\"') {  // String literal
           if (!key_string.empty()) {
-            ErrorExit(kErrWrongTypeArgument, "Wrong number of key strings");
+            *error = {kErrWrongTypeArgument, "Wrong number of key strings"};
+            return false;
           }
           if (!UnquoteString(tokens[i], &key_string)) {
-            ErrorExit(kErrWrongTypeArgument, "Wrong key string literal");
+            *error = {kErrWrongTypeArgument, "Wrong key string literal"};
+            return false;
           }
         } else {  // Key symbol
           keys.push_back(tokens[i]);
@@ -169,6 +184,35 @@ void ParseInputLine(absl::string_view line, uint32_t *event_id,
     default:
       ABSL_UNREACHABLE();
   }
+  return true;
+}
+
+// Same as TryParseInputLine(), but calls ErrorExit() on a malformed line.
+void ParseInputLine(absl::string_view line, uint32_t *event_id,
+                    uint32_t *session_id, commands::Input *input) {
+  InputLineError error;
+  if (!TryParseInputLine(line, event_id, session_id, input, &error)) {
+    ErrorExit(error.error, error.message);
+  }
+}
+
+// Reads an input line, and then the following lines which are already in the
+// buffer of |input|, up to |max_lines| lines in total. It doesn't wait for
+// more input after the first line, so that events sent at once, e.g. by
+// pasting, are processed as a batch. Returns false at the end of the input.
+bool ReadInputLines(std::istream &input, const size_t max_lines,
+                    std::vector<std::string> *lines) {
+  DCHECK_GT(max_lines, 0);
+  lines->clear();
+  std::string line;
+  while (lines->size() < max_lines && std::getline(input, line)) {
+    lines->push_back(std::move(line));
+    if (input.rdbuf()->in_avail() <= 0) {
+      // No more input is buffered.
+      break;
+    }
+  }
+  return !lines->empty();
 }
 
 // Prints the content of a protocol buffer in S-expression.
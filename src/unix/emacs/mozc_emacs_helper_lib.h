@@ -30,7 +30,9 @@
 #ifndef MOZC_UNIX_EMACS_MOZC_EMACS_HELPER_LIB_H_
 #define MOZC_UNIX_EMACS_MOZC_EMACS_HELPER_LIB_H_
 
+#include <cstddef>
 #include <cstdint>
+#include <istream>
 #include <string>
 #include <vector>
 
@@ -65,6 +67,27 @@ inline constexpr absl::string_view kErrSessionError = "session-error";
 void ParseInputLine(absl::string_view line, uint32_t *event_id,
                     uint32_t *session_id, mozc::commands::Input *input);
 
+// The reason why TryParseInputLine() failed, given as the arguments for
+// ErrorExit().
+struct InputLineError {
+  absl::string_view error;
+  absl::string_view message;
+};
+
+// Same as ParseInputLine(), but returns false and sets |error| instead of
+// calling ErrorExit() if |line| is malformed, so that the caller can finish
+// the preceding commands first.
+bool TryParseInputLine(absl::string_view line, uint32_t *event_id,
+                       uint32_t *session_id, mozc::commands::Input *input,
+                       InputLineError *error);
+
+// Reads an input line, and then the following lines which are already in the
+// buffer of |input|, up to |max_lines| lines in total. It doesn't wait for
+// more input after the first line, so that events sent at once, e.g. by
+// pasting, are processed as a batch. Returns false at the end of the input.
+bool ReadInputLines(std::istream &input, size_t max_lines,
+                    std::vector<std::string> *lines);
+
 // Prints the content of a protocol buffer in S-expression.
 // - 'message' and 'group' are mapped to alist (associative list)
 // - 'repeated' is expressed as a list
@@ -30,6 +30,7 @@
 #include "unix/emacs/mozc_emacs_helper_lib.h"
 
 #include <cstdint>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -154,6 +155,46 @@ TEST_F(MozcEmacsHelperLibTest, ParseInputLine) {
                         "key_string: \"\\007\\010\\t\\n \\177\" }");
 }
 
+TEST_F(MozcEmacsHelperLibTest, TryParseInputLine) {
+  uint32_t event_id = 0;
+  uint32_t session_id = 0;
+  commands::Input input;
+  InputLineError error;
+  EXPECT_TRUE(TryParseInputLine("(1 SendKey 2 97)", &event_id, &session_id,
+                                &input, &error));
+  EXPECT_EQ(event_id, 1);
+  EXPECT_EQ(session_id, 2);
+  EXPECT_EQ(input.type(), commands::Input::SEND_KEY);
+
+  // Malformed lines are reported instead of exiting.
+  EXPECT_FALSE(TryParseInputLine("(2 SendKey 2 97", &event_id, &session_id,
+                                 &input, &error));
+  EXPECT_EQ(error.error, kErrScanError);
+  EXPECT_FALSE(TryParseInputLine("(3 Unknown 2 97)", &event_id, &session_id,
+                                 &input, &error));
+  EXPECT_EQ(error.error, kErrVoidFunction);
+  EXPECT_FALSE(TryParseInputLine("(4 SendKey x 97)", &event_id, &session_id,
+                                 &input, &error));
+  EXPECT_EQ(error.error, kErrWrongTypeArgument);
+  EXPECT_EQ(error.message, "Session ID is not an integer");
+}
+
+TEST_F(MozcEmacsHelperLibTest, ReadInputLines) {
+  std::istringstream input(
+      "(0 CreateSession)\n(1 SendKey 1 97)\n(2 SendKey 1 98)\n"
+      "(3 SendKey 1 99)\n(4 DeleteSession 1)");
+  std::vector<std::string> lines;
+  // All the lines are buffered, so they are read up to |max_lines|.
+  EXPECT_TRUE(ReadInputLines(input, 3, &lines));
+  EXPECT_THAT(lines, ElementsAreArray({"(0 CreateSession)", "(1 SendKey 1 97)",
+                                       "(2 SendKey 1 98)"}));
+  EXPECT_TRUE(ReadInputLines(input, 3, &lines));
+  EXPECT_THAT(lines,
+              ElementsAreArray({"(3 SendKey 1 99)", "(4 DeleteSession 1)"}));
+  EXPECT_FALSE(ReadInputLines(input, 3, &lines));
+  EXPECT_THAT(lines, IsEmpty());
+}
+
 TEST_F(MozcEmacsHelperLibTest, PrintMessage) {
   // KeyEvent
   commands::KeyEvent key_event;